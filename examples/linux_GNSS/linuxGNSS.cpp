@@ -23,6 +23,9 @@
 
 
 #include <ultimateGNSSParser.h>
+#include <GNSSCapture.h>
+#include <GNSSFlightRecorder.h>
+#include <GNSSSharedFix.h>
 #include <sys/ioctl.h>
 #include <sys/types.h>
 
@@ -30,6 +33,9 @@
 
 
 int fd = -1;    // Serial port file descriptor
+class GNSSCaptureWriter capture; // the recorder of the received bytes (see the -r option)
+class GNSSFlightRecorder flightRecorder; // the ring of the last received bytes and rejected lines (see the -f option)
+class GNSSSharedPublisher sharedFix; // the last epoch for the other processes (see the -S option)
 
 
 
@@ -47,6 +53,9 @@ void help_screen (const char * const progname) {
   fprintf (stderr, "\t\t-s\t\t--speed\t\tthe serial port baudrate (9600, 115200)\r\n");
   fprintf (stderr, "\t\t-h\t\t--help\t\t\tprint this help screen\n");
   fprintf (stderr, "\t\t-m\t\t--monitor\t\ttwo modes of serial port monitoring:\n\t\t\t\t\t0\t-\tprint every byte received from serial port.\n\t\t\t\t\t1\t-\tASCII text\n");
+  fprintf (stderr, "\t\t-r\t\t--record\t\trecord the received bytes with the receive timestamps to the given capture file (replay it with GNSS_replay -R)\n");
+  fprintf (stderr, "\t\t-f\t\t--flight\t\tkeep the last 4 MB of the received bytes and the rejected lines in the given flight recorder file (dump it with GNSS_replay -F)\n");
+  fprintf (stderr, "\t\t-S\t\t--shm\t\t\tpublish every epoch in the given shared memory segment (e.g. /gnss0, read it with GNSS_shared_reader)\n");
   fprintf (stderr, "\t\t-v\t\t--verbosity\tincreasing verbosity level\n\n");
 }
 
@@ -132,6 +141,9 @@ static struct option long_options[] = {
                                         {"speed",     required_argument, 0, 's'},
                                         {"help",      no_argument,       0, 'h'},
                                         {"monitor",   required_argument, 0, 'm'},
+                                        {"record",    required_argument, 0, 'r'},
+                                        {"flight",    required_argument, 0, 'f'},
+                                        {"shm",       required_argument, 0, 'S'},
                                         {"verbosity", no_argument,       0, 'v'},
                                         {0,           0,                 0,  0 }
 };
@@ -154,7 +166,7 @@ int program_parameters_parser (const int argc, char * const argv[]) {
   while (1) {
     int option_index = 0;
     
-    c = getopt_long(argc, argv, "D:s:hm:v", long_options, &option_index);
+    c = getopt_long(argc, argv, "D:s:hm:r:f:S:v", long_options, &option_index);
     if (c == -1)
       break;
     
@@ -177,6 +189,24 @@ int program_parameters_parser (const int argc, char * const argv[]) {
       case 'm':
               loMonitor = ((NULL==optarg)?0:(atoi(optarg)?1:0));
               break;
+      case 'r':
+              if (capture.open(optarg)) {
+                fprintf(stderr, "The capture file %s can not be created\r\n", optarg);
+                exit (-1);
+              }
+              break;
+      case 'f':
+              if (flightRecorder.open(optarg)) {
+                fprintf(stderr, "The flight recorder file %s can not be opened\r\n", optarg);
+                exit (-1);
+              }
+              break;
+      case 'S':
+              if (sharedFix.open(optarg)) {
+                fprintf(stderr, "The shared memory segment %s can not be created\r\n", optarg);
+                exit (-1);
+              }
+              break;
       case 'v':
               verbosity += 1;
               if (1 < verbosity) fprintf(stderr, "Verbosity level is now %u\n", verbosity);
@@ -257,6 +287,17 @@ int8_t data_read_callback(void) {
 class GNSSCollector myGPS(&data_available_callback, &data_read_callback);
 
 
+// the received bytes are given to both recorders (they do nothing if their files are not opened)
+void raw_data_callback(const char *paData, uint16_t paLength, void *paUserData) {
+  capture.write(paData, paLength);
+  flightRecorder.record(paData, paLength);
+}
+
+void line_callback(const char *paLine, int8_t paStatus, void *paUserData) {
+  flightRecorder.mark(paLine, paStatus);
+}
+
+
 int8_t myNMEAParser (const struct NMEA_fields *paSlices) {
 
 //return (1); // Do not parse any sentence by the library, but library checks the checksums and slices the messages,
@@ -324,11 +365,15 @@ int main (int argc, char *argv[]) {
   myGPS.setBreakTime(35); // The ATGM336H needs longer period here, default value is correct for most receivers
   
   myGPS.setCustomParser(myNMEAParser);
+  myGPS.setRawCallback(raw_data_callback);
+  myGPS.setLineCallback(line_callback);
   
   while (1) {
     fprintf(stderr,"............................................................................................................................................................\r\n");
     myGPS.collectData((0 < verbosity)?true:false,(1<verbosity)?true:false);
+    capture.flush();
     all_GNSS_data = myGPS.getGNSSData();
+    sharedFix.publish(all_GNSS_data, myGPS.getGSVData()); // it does nothing if the segment is not opened
     if (2 < verbosity)
       myGPS.printGSVData(true);
     myGPS.printGNSSData(true);
@@ -0,0 +1,164 @@
+/*
+  Receiving the NMEA 0183 data from many GNSS receivers in the single thread with the C++20 coroutines (linux environment)
+  By: Kazimierz Wilk
+  License: GNU Lesser General Public License. See license file for more information.
+  
+  This example shows how to serve any number of receivers (serial port devices, FIFOs, etc.) in the single thread
+  without the "while(1) { collectData(); getGNSSData(); }" loop per receiver.
+  Every receiver is handled by its own coroutine waiting for the $xxGGA sentence and for the end of the epoch.
+  The epoll loop feeds the collectors with the received bytes and the coroutines are resumed directly from the feed() calls.
+  
+  Usage: GNSS_coroutines [-s speed] device [device ...]
+  e.g.:  GNSS_coroutines -s 115200 /dev/ttyACM0 /dev/ttyUSB0
+*/
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+
+#include <ultimateGNSSParser.h>
+#include <GNSSCoroutine.h>
+
+#include "serial_port_control.h"
+
+
+#define MAX_RECEIVERS 1024
+
+struct receiver {
+  const char         *name;
+  int                 fd;
+  GNSSCollector      *collector;
+  GNSSAsyncCollector *async;
+};
+
+/************************************************************************************************************************
+ ************************************************************************************************************************
+ ********************************************* the coroutine of the single receiver *************************************
+ ************************************************************************************************************************
+ ************************************************************************************************************************/
+
+GNSSTask track_receiver(GNSSAsyncCollector &paGNSS, const char *paName) {
+  const struct GNSS_data *loData;
+  
+  while (1) {
+    // the position is available right after the $xxGGA sentence is parsed - we don't wait for the end of the epoch
+    loData = co_await paGNSS.next<MSG_GGA>();
+    if (NULL == loData) {
+      co_return;
+    }
+    fprintf(stderr, "%-16s GGA   %02u:%02u:%02u.%03u  %0.11lf%c,%0.11lf%c  quality %c\r\n", paName,
+            loData->UTC_H, loData->UTC_M, loData->UTC_S, loData->UTC_fract,
+            loData->lat, loData->lat_dir, loData->lon, loData->lon_dir, (loData->quality ? loData->quality : '-'));
+    
+    loData = co_await paGNSS.next_epoch();
+    if (NULL == loData) {
+      co_return;
+    }
+    fprintf(stderr, "%-16s epoch %02u:%02u:%02u.%03u  sats %u  hdop %2.3lf  sentences RMC:%u GGA:%u GSA:%u GSV:%u GST:%u\r\n", paName,
+            loData->UTC_H, loData->UTC_M, loData->UTC_S, loData->UTC_fract, loData->sats, loData->hdop,
+            loData->msgs_rcvd[MSG_RMC], loData->msgs_rcvd[MSG_GGA], loData->msgs_rcvd[MSG_GSA], loData->msgs_rcvd[MSG_GSV], loData->msgs_rcvd[MSG_GST]);
+  }
+}
+
+/************************************************************************************************************************
+ ************************************************************************************************************************
+ ************************************************************************************************************************/
+
+int main (int argc, char *argv[]) {
+  
+  static struct receiver loReceivers[MAX_RECEIVERS];
+  struct epoll_event loEvents[64];
+  struct epoll_event loEvent;
+  char loBuf[512];
+  unsigned int loSpeed = 9600;
+  int loCnt = 0;
+  int loActive;
+  int loEpoll;
+  int i, n;
+  
+  if ((3 <= argc) && !strcmp("-s", argv[1])) {
+    loSpeed = atoi(argv[2]);
+    argv += 2;
+    argc -= 2;
+  }
+  
+  if (2 > argc) {
+    fprintf(stderr, "Program usage: %s [-s speed] device [device ...]\n", argv[0]);
+    return (-1);
+  }
+  
+  loEpoll = epoll_create1(0);
+  if (0 > loEpoll) {
+    fprintf(stderr, "Error %d epoll_create1: %s\r\n", errno, strerror(errno));
+    return (-1);
+  }
+  
+  for (i = 1; (i < argc) && (MAX_RECEIVERS > loCnt); i++) {
+    struct receiver *loRcv = &loReceivers[loCnt];
+    
+    loRcv->name = argv[i];
+    loRcv->fd = open(argv[i], O_RDONLY | O_NOCTTY | O_NONBLOCK);
+    if (0 > loRcv->fd) {
+      fprintf(stderr, "Error %d opening %s: %s\r\n", errno, argv[i], strerror(errno));
+      continue;
+    }
+    if (isatty(loRcv->fd)) {
+      spc_set_interface_attribs(loRcv->fd, loSpeed);
+    }
+    
+    loRcv->collector = new GNSSCollector(NULL, NULL); // the bytes are given with feed(), so no data source callbacks are needed
+    loRcv->collector->setBreakTime(35);
+    loRcv->async = new GNSSAsyncCollector(*loRcv->collector);
+    
+    loEvent.events = EPOLLIN;
+    loEvent.data.ptr = loRcv;
+    if (epoll_ctl(loEpoll, EPOLL_CTL_ADD, loRcv->fd, &loEvent)) {
+      fprintf(stderr, "Error %d epoll_ctl %s: %s\r\n", errno, argv[i], strerror(errno));
+      close(loRcv->fd);
+      delete loRcv->async;
+      delete loRcv->collector;
+      continue;
+    }
+    
+    track_receiver(*loRcv->async, loRcv->name); // runs until the first co_await
+    loCnt++;
+  }
+  
+  loActive = loCnt;
+  while (0 < loActive) {
+    // the timeout is needed to detect the break between the epochs when no more bytes are received
+    n = epoll_wait(loEpoll, loEvents, sizeof(loEvents)/sizeof(loEvents[0]), 5);
+    
+    for (i = 0; i < n; i++) {
+      struct receiver *loRcv = (struct receiver *)loEvents[i].data.ptr;
+      ssize_t loLen = read(loRcv->fd, loBuf, sizeof(loBuf));
+      
+      if ((0 < loLen) || ((0 > loLen) && (EAGAIN == errno))) {
+        if (0 < loLen) {
+          loRcv->collector->feed(loBuf, (uint16_t)loLen, GNSSCollector::getPlatformTimeMs());
+        }
+        continue;
+      }
+      
+      // the end of data or the error - the coroutine is resumed with NULL and finishes
+      fprintf(stderr, "%-16s closed\r\n", loRcv->name);
+      epoll_ctl(loEpoll, EPOLL_CTL_DEL, loRcv->fd, NULL);
+      close(loRcv->fd);
+      loRcv->fd = -1;
+      delete loRcv->async;
+      loRcv->async = NULL;
+      loActive--;
+    }
+    
+    for (i = 0; i < loCnt; i++) {
+      if (0 <= loReceivers[i].fd) {
+        loReceivers[i].collector->process(GNSSCollector::getPlatformTimeMs());
+      }
+    }
+  }
+  
+  for (i = 0; i < loCnt; i++) {
+    delete loReceivers[i].collector;
+  }
+  close(loEpoll);
+  return (0);
+}
@@ -0,0 +1,160 @@
+/*
+  Relaying the NMEA 0183 sentences of the single receiver to many local clients (linux environment)
+  By: Kazimierz Wilk
+  License: GNU Lesser General Public License. See license file for more information.
+  
+  This example shows how one serial port serves any number of the programs (loggers, maps, gpsd-like tools, ...):
+  the collector parses the received bytes as usual and the fan-out server relays every correct sentence
+  to the TCP and unix socket clients. Every sentence is stored once - the clients are sent the parts of the shared buffer.
+  The slow client never stops the parsing: it is served when its socket is writable again and loses the oldest sentences
+  when it is too slow for the shared buffer.
+  
+  The client can send "FILTER GGA,RMC\n" to get only the given sentence types ("FILTER\n" - all of them again), e.g.:
+    nc 127.0.0.1 10110
+    (echo "FILTER GGA"; cat) | nc -U /tmp/gnss.sock
+  
+  Usage: GNSS_fanout [-t port] [-a address] [-u path] [-n clients] [-s speed] device|-
+  e.g.:  GNSS_fanout -t 10110 -u /tmp/gnss.sock -s 115200 /dev/ttyACM0
+*/
+
+#include <getopt.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+
+#include <ultimateGNSSParser.h>
+#include <GNSSFanout.h>
+
+#include "serial_port_control.h"
+
+
+static volatile sig_atomic_t stop = 0;
+
+void stop_handler(int paSignal) {
+  (void)paSignal;
+  stop = 1;
+}
+
+
+void help_screen (const char * const progname) {
+  fprintf (stderr, "This tool relays the correct NMEA sentences of the receiver to the TCP and unix socket clients.\n");
+  fprintf (stderr, "Program usage: %s [options sequence] device|-\n\n", progname);
+  fprintf (stderr, "Program options:\n");
+  fprintf (stderr, "\t\t-t\t\tthe TCP port (10110 if neither -t nor -u is given)\n");
+  fprintf (stderr, "\t\t-a\t\tthe address of the TCP port (127.0.0.1 by default, 0.0.0.0 - all the interfaces)\n");
+  fprintf (stderr, "\t\t-u\t\tthe path of the unix socket\n");
+  fprintf (stderr, "\t\t-n\t\tthe maximum number of the clients (64 by default)\n");
+  fprintf (stderr, "\t\t-s\t\tthe serial port baudrate (9600 by default)\n");
+  fprintf (stderr, "\t\t-h\t\tprint this help screen\n\n");
+}
+
+
+int main(int argc, char *argv[]) {
+  const char *loAddress = "127.0.0.1";
+  const char *loUnixPath = NULL;
+  unsigned int loSpeed = 9600;
+  uint16_t loMaxClients = 64;
+  int32_t loPort = -1;
+  uint32_t loEndMs = 0;
+  struct pollfd loPoll[2];
+  char loBuf[4096];
+  ssize_t loLen;
+  int loFd;
+  int c;
+  
+  while (-1 != (c = getopt(argc, argv, "t:a:u:n:s:h"))) {
+    switch (c) {
+      case 't':
+              loPort = atoi(optarg);
+              break;
+      case 'a':
+              loAddress = optarg;
+              break;
+      case 'u':
+              loUnixPath = optarg;
+              break;
+      case 'n':
+              loMaxClients = atoi(optarg);
+              break;
+      case 's':
+              loSpeed = atoi(optarg);
+              break;
+      case 'h':
+      default:
+              help_screen(argv[0]);
+              return (0);
+    }
+  }
+  if (optind >= argc) {
+    help_screen(argv[0]);
+    return (1);
+  }
+  if ((0 > loPort) && (NULL == loUnixPath)) {
+    loPort = 10110;
+  }
+  
+  if (!strcmp("-", argv[optind])) {
+    loFd = STDIN_FILENO;
+  } else {
+    loFd = open(argv[optind], O_RDONLY | O_NOCTTY);
+    if (0 > loFd) {
+      fprintf(stderr, "Error %d opening %s: %s\r\n", errno, argv[optind], strerror(errno));
+      return (1);
+    }
+    if (isatty(loFd)) {
+      spc_set_interface_attribs(loFd, loSpeed);
+    }
+  }
+  fcntl(loFd, F_SETFL, fcntl(loFd, F_GETFL) | O_NONBLOCK);
+  
+  GNSSFanoutServer loServer(loMaxClients);
+  if ((0 <= loPort) && loServer.listenTCP((uint16_t)loPort, loAddress)) {
+    fprintf(stderr, "Can not listen on %s:%d\r\n", loAddress, loPort);
+    return (1);
+  }
+  if ((NULL != loUnixPath) && loServer.listenUnix(loUnixPath)) {
+    fprintf(stderr, "Can not listen on %s\r\n", loUnixPath);
+    return (1);
+  }
+  
+  GNSSCollector loCollector(NULL, NULL); // the bytes are given with feed(), so no data source callbacks are needed
+  loCollector.setLineCallback(GNSSFanoutServer::lineCallback, &loServer);
+  
+  signal(SIGINT, stop_handler);
+  signal(SIGTERM, stop_handler);
+  
+  loPoll[0].fd     = loFd;
+  loPoll[0].events = POLLIN;
+  loPoll[1].fd     = loServer.getFd();
+  loPoll[1].events = POLLIN;
+  while (!stop) {
+    // the timeout is needed to detect the break between the epochs when no more bytes are received
+    if ((0 > poll(loPoll, 2, 5)) && (EINTR != errno)) {
+      break;
+    }
+    if (0 > loPoll[0].fd) {
+      // the end of the input - the clients get the rest of the sentences first (the stalled ones are not waited for too long)
+      if (!loServer.isPending() || ((GNSSCollector::getPlatformTimeMs() - loEndMs) > 2000)) {
+        break;
+      }
+    } else if (loPoll[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+      loLen = read(loFd, loBuf, sizeof(loBuf));
+      if (0 < loLen) {
+        loCollector.feed(loBuf, (uint16_t)loLen, GNSSCollector::getPlatformTimeMs());
+        loServer.flush();
+      } else if ((0 == loLen) || (EAGAIN != errno)) {
+        loPoll[0].fd = -1; // poll() skips it from now on
+        loEndMs = GNSSCollector::getPlatformTimeMs();
+      }
+    } else {
+      loCollector.feed(NULL, 0, GNSSCollector::getPlatformTimeMs());
+    }
+    if (loPoll[1].revents & POLLIN) {
+      loServer.service(0);
+    }
+  }
+  
+  loServer.close(); // the clients still connected are counted too
+  fprintf(stderr, "%lu sentences relayed, %lu lost by the slow clients\r\n", (unsigned long)loServer.getRelayed(), (unsigned long)loServer.getLost());
+  return (0);
+}
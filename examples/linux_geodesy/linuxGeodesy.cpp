@@ -0,0 +1,353 @@
+/*
+  Converting the recorded fixes to ECEF and to the local east-north-up frame in batches (linux environment)
+  By: Kazimierz Wilk
+  License: GNU Lesser General Public License. See license file for more information.
+  
+  This example shows how the epochs are collected into the structure of arrays (GNSSEpochBatch) and converted
+  by the batch kernels of GNSSGeodesy (AVX2 when the CPU has it) instead of the fix by fix scalar code.
+  The log file is replayed on all the CPU cores and every batch of the epochs is converted to ENU relative
+  to the -r reference (the first fix by default), or to ECEF with -e, and printed as CSV.
+  With -d the distance and the initial bearing from the reference are printed instead, computed in the given
+  accuracy tier: 0 - equirectangular (the plane), 1 - haversine (the sphere), 2 - Vincenty (the WGS84 ellipsoid).
+  
+  With -b it compares the vector and the scalar kernels on the random fixes of the whole globe (with the poles
+  and the dateline): the throughput of both (the conversions and every distance tier), the largest error
+  of the conversions against the long double reference and the largest difference of the distance tiers.
+  
+  Usage: GNSS_geodesy [-r lat,lon,height] [-e | -d tier] [-n batch] log_file
+         GNSS_geodesy -b [-n fixes]
+  e.g.:  GNSS_geodesy -r 52.2297,21.0122,145.3 /var/log/gnss/2024-05-17.nmea
+         GNSS_geodesy -r 52.2297,21.0122,0 -d 2 /var/log/gnss/2024-05-17.nmea
+*/
+
+#include <getopt.h>
+#include <time.h>
+#include <math.h>
+
+#include <ultimateGNSSParser.h>
+#include <GNSSReplay.h>
+#include <GNSSEpochBatch.h>
+#include <GNSSGeodesy.h>
+
+struct geodesy_output {
+  struct GNSS_enu_reference reference;
+  bool                      referenceSet;
+  bool                      ecef;
+  int8_t                    tier;       // GNSS_DISTANCE_xxx or -1 (ENU/ECEF)
+  double                   *out[3];     // east, north, up (or x, y, z) of the batch
+  uint64_t                  fixes;
+};
+
+
+void help_screen (const char * const progname) {
+  fprintf (stderr, "This tool converts the fixes of the NMEA log file to the local east-north-up frame (or ECEF) in batches.\n");
+  fprintf (stderr, "Program usage: %s [options sequence] log_file\n\n", progname);
+  fprintf (stderr, "Program options:\n");
+  fprintf (stderr, "\t\t-r\t\tthe origin of ENU: latitude,longitude,height above the ellipsoid [deg,deg,m] (the first fix by default)\n");
+  fprintf (stderr, "\t\t-e\t\tprint ECEF instead of ENU\n");
+  fprintf (stderr, "\t\t-d\t\tprint the distance and the bearing from the reference: 0 equirectangular, 1 haversine, 2 Vincenty\n");
+  fprintf (stderr, "\t\t-n\t\tthe epochs in the batch (default 1024) or the fixes of the benchmark (default 1000000)\n");
+  fprintf (stderr, "\t\t-b\t\tcompare the vector and the scalar kernels (and the conversions with the long double reference)\n");
+  fprintf (stderr, "\t\t-h\t\tprint this help screen\n\n");
+}
+
+
+void batch_callback(const struct GNSS_epoch_batch *paBatch, void *paOutput) {
+  struct geodesy_output *loOutput = (struct geodesy_output *)paOutput;
+  uint32_t i;
+
+  // the first fix with the altitude is the reference when it is not given
+  if (!loOutput->ecef && !loOutput->referenceSet) {
+    for (i = 0; (i < paBatch->count) && (isnan(paBatch->lat[i]) || isnan(paBatch->alt[i])); i++);
+    if (i == paBatch->count) {
+      return;
+    }
+    GNSSGeodesy::setReference(&loOutput->reference, paBatch->lat[i], paBatch->lon[i], paBatch->alt[i] + paBatch->undulation[i]);
+    loOutput->referenceSet = true;
+  }
+
+  if (0 <= loOutput->tier) {
+    GNSSGeodesy::distanceFrom(loOutput->tier, loOutput->reference.lat, loOutput->reference.lon, paBatch->lat, paBatch->lon, paBatch->count,
+                              loOutput->out[0], loOutput->out[1]);
+    for (i = 0; i < paBatch->count; i++) {
+      if (!isnan(loOutput->out[0][i])) {
+        printf("%lld,%0.4lf,%0.6lf\n", (long long)paBatch->timeMs[i], loOutput->out[0][i], loOutput->out[1][i]);
+        loOutput->fixes++;
+      }
+    }
+    return;
+  }
+  if (loOutput->ecef) {
+    GNSSGeodesy::toECEF(paBatch, loOutput->out[0], loOutput->out[1], loOutput->out[2]);
+  } else {
+    GNSSGeodesy::toENU(&loOutput->reference, paBatch, loOutput->out[0], loOutput->out[1], loOutput->out[2]);
+  }
+  for (i = 0; i < paBatch->count; i++) {
+    if (!isnan(loOutput->out[0][i])) {
+      printf("%lld,%0.4lf,%0.4lf,%0.4lf\n", (long long)paBatch->timeMs[i], loOutput->out[0][i], loOutput->out[1][i], loOutput->out[2][i]);
+      loOutput->fixes++;
+    }
+  }
+}
+
+
+double elapsed_ns(const struct timespec *paStart) {
+  struct timespec loNow;
+
+  clock_gettime(CLOCK_MONOTONIC, &loNow);
+  return ((loNow.tv_sec - paStart->tv_sec) * 1e9 + (loNow.tv_nsec - paStart->tv_nsec));
+}
+
+
+// the largest difference (NaN if only one of the values is NaN)
+double max_difference(const double *paA, const double *paB, uint32_t paCount) {
+  double loMax = 0;
+  uint32_t i;
+
+  for (i = 0; i < paCount; i++) {
+    if (isnan(paA[i]) != isnan(paB[i])) {
+      return (NAN);
+    }
+    if (fabs(paA[i] - paB[i]) > loMax) {
+      loMax = fabs(paA[i] - paB[i]);
+    }
+  }
+  return (loMax);
+}
+
+
+// the largest difference of the bearings (0 and 360 are the same direction, e.g. the bearing of the pole)
+double max_bearing_difference(const double *paA, const double *paB, uint32_t paCount) {
+  double loMax = 0;
+  uint32_t i;
+
+  for (i = 0; i < paCount; i++) {
+    if (isnan(paA[i]) != isnan(paB[i])) {
+      return (NAN);
+    }
+    if (fmin(fabs(paA[i] - paB[i]), 360.0 - fabs(paA[i] - paB[i])) > loMax) {
+      loMax = fmin(fabs(paA[i] - paB[i]), 360.0 - fabs(paA[i] - paB[i]));
+    }
+  }
+  return (loMax);
+}
+
+
+// the largest error of ECEF (paENU == NULL) or ENU over the three axes against the long double computation
+double max_error(const struct GNSS_enu_reference *paENU, const double *paLat, const double *paLon, const double *paAlt, uint32_t paCount,
+                 double * const *paOut) {
+  const long double loRad = 3.14159265358979323846264338327950288L / 180.0L;
+  const long double loF   = 1.0L / 298.257223563L;
+  const long double loE2  = loF * (2.0L - loF);
+  long double loN, loSinLat, loX0 = 0, loY0 = 0, loZ0 = 0;
+  long double loECEF[3], loResult[3];
+  double loMax = 0;
+  uint32_t i, j;
+
+  if (NULL != paENU) {
+    loSinLat = sinl(paENU->lat * loRad);
+    loN  = 6378137.0L / sqrtl(1.0L - loE2 * loSinLat * loSinLat);
+    loX0 = (loN + paENU->height) * cosl(paENU->lat * loRad) * cosl(paENU->lon * loRad);
+    loY0 = (loN + paENU->height) * cosl(paENU->lat * loRad) * sinl(paENU->lon * loRad);
+    loZ0 = (loN * (1.0L - loE2) + paENU->height) * loSinLat;
+  }
+  for (i = 0; i < paCount; i++) {
+    loSinLat  = sinl(paLat[i] * loRad);
+    loN       = 6378137.0L / sqrtl(1.0L - loE2 * loSinLat * loSinLat);
+    loECEF[0] = (loN + paAlt[i]) * cosl(paLat[i] * loRad) * cosl(paLon[i] * loRad);
+    loECEF[1] = (loN + paAlt[i]) * cosl(paLat[i] * loRad) * sinl(paLon[i] * loRad);
+    loECEF[2] = (loN * (1.0L - loE2) + paAlt[i]) * loSinLat;
+    if (NULL == paENU) {
+      loResult[0] = loECEF[0];
+      loResult[1] = loECEF[1];
+      loResult[2] = loECEF[2];
+    } else {
+      loECEF[0] -= loX0;
+      loECEF[1] -= loY0;
+      loECEF[2] -= loZ0;
+      loResult[0] = -sinl(paENU->lon * loRad) * loECEF[0] + cosl(paENU->lon * loRad) * loECEF[1];
+      loResult[1] = -sinl(paENU->lat * loRad) * (cosl(paENU->lon * loRad) * loECEF[0] + sinl(paENU->lon * loRad) * loECEF[1]) +
+                    cosl(paENU->lat * loRad) * loECEF[2];
+      loResult[2] = cosl(paENU->lat * loRad) * (cosl(paENU->lon * loRad) * loECEF[0] + sinl(paENU->lon * loRad) * loECEF[1]) +
+                    sinl(paENU->lat * loRad) * loECEF[2];
+    }
+    for (j = 0; j < 3; j++) {
+      if (isnan(paOut[j][i]) && isnan(loResult[j])) {
+        continue; // the fix without the position
+      }
+      if (!isnan(loMax) && !(fabsl(paOut[j][i] - loResult[j]) <= loMax)) {
+        loMax = (double)fabsl(paOut[j][i] - loResult[j]); // NaN (the fix not converted) is kept
+      }
+    }
+  }
+  return (loMax);
+}
+
+
+// the kernel k of the benchmark: ECEF, ENU and the distance with the bearing from the reference in every tier
+void run_kernel(uint32_t paKernel, const struct GNSS_enu_reference *paReference, const double *paLat, const double *paLon, const double *paAlt,
+                uint32_t paCount, double * const *paOut) {
+  if (0 == paKernel) {
+    GNSSGeodesy::toECEF(paLat, paLon, paAlt, NULL, paCount, paOut[0], paOut[1], paOut[2]);
+  } else if (1 == paKernel) {
+    GNSSGeodesy::toENU(paReference, paLat, paLon, paAlt, NULL, paCount, paOut[0], paOut[1], paOut[2]);
+  } else {
+    GNSSGeodesy::distanceFrom(paKernel - 2, paReference->lat, paReference->lon, paLat, paLon, paCount, paOut[0], paOut[1]);
+  }
+}
+
+
+int benchmark(uint32_t paFixes) {
+  const char *loNames[5] = {"ECEF", "ENU", "equirectangular", "haversine", "Vincenty"};
+  // the poles, the dateline, the points next to them and the fixes without the position (NaN, it must stay NaN on both paths)
+  // come first, the random fixes of the whole globe follow
+  const double loEdges[10][2] = {{90.0, 0.0}, {-90.0, 123.0}, {0.0, 180.0}, {0.0, -180.0}, {45.0, 180.0}, {-45.0, -180.0},
+                                 {89.9999999, 179.9999999}, {-89.9999999, -179.9999999}, {NAN, 21.0}, {52.0, NAN}};
+  struct GNSS_enu_reference loReference;
+  double *loLat = (double *)malloc(paFixes * sizeof(double));
+  double *loLon = (double *)malloc(paFixes * sizeof(double));
+  double *loAlt = (double *)malloc(paFixes * sizeof(double));
+  double *loOut[2][3];
+  double loNs[2];
+  struct timespec loStart;
+  uint32_t i, j, k, loRuns = 10;
+  bool loSIMD = GNSSGeodesy::hasSIMD();
+
+  srand(1);
+  for (i = 0; i < paFixes; i++) {
+    loLat[i] = (10 > i) ? loEdges[i][0] : (-90.0 + 180.0 * rand() / (double)RAND_MAX);
+    loLon[i] = (10 > i) ? loEdges[i][1] : (-180.0 + 360.0 * rand() / (double)RAND_MAX);
+    loAlt[i] = -500.0 + 10000.0 * rand() / (double)RAND_MAX;
+  }
+  for (i = 0; i < 2; i++) {
+    for (j = 0; j < 3; j++) {
+      loOut[i][j] = (double *)malloc(paFixes * sizeof(double));
+    }
+  }
+  GNSSGeodesy::setReference(&loReference, 52.5, 21.5, 120.0);
+
+  fprintf(stderr, "%u fixes, the vector kernels %s\r\n", paFixes, loSIMD ? "(AVX2)" : "not available - the scalar code twice");
+  // [0] the vector kernels, [1] the scalar code - k: see run_kernel()
+  for (k = 0; k < 5; k++) {
+    for (i = 0; i < 2; i++) {
+      GNSSGeodesy::setSIMD(0 == i);
+      run_kernel(k, &loReference, loLat, loLon, loAlt, paFixes, loOut[i]); // not timed - the output pages are touched and the code is warm
+      clock_gettime(CLOCK_MONOTONIC, &loStart);
+      for (j = 0; j < loRuns; j++) {
+        run_kernel(k, &loReference, loLat, loLon, loAlt, paFixes, loOut[i]);
+      }
+      loNs[i] = elapsed_ns(&loStart) / loRuns;
+    }
+    if (2 > k) {
+      fprintf(stderr, "  %-16s %8.1lf Mfix/s vector, %8.1lf Mfix/s scalar, the largest error %0.3le m vector, %0.3le m scalar\r\n", loNames[k],
+              paFixes / loNs[0] * 1e3, paFixes / loNs[1] * 1e3,
+              max_error((0 == k) ? NULL : &loReference, loLat, loLon, loAlt, paFixes, loOut[0]),
+              max_error((0 == k) ? NULL : &loReference, loLat, loLon, loAlt, paFixes, loOut[1]));
+    } else {
+      fprintf(stderr, "  %-16s %8.1lf Mfix/s vector, %8.1lf Mfix/s scalar, the largest difference %0.3le m, %0.3le deg\r\n", loNames[k],
+              paFixes / loNs[0] * 1e3, paFixes / loNs[1] * 1e3,
+              max_difference(loOut[0][0], loOut[1][0], paFixes), max_bearing_difference(loOut[0][1], loOut[1][1], paFixes));
+    }
+  }
+  GNSSGeodesy::setSIMD(true);
+
+  for (i = 0; i < 2; i++) {
+    for (j = 0; j < 3; j++) {
+      free(loOut[i][j]);
+    }
+  }
+  free(loLat);
+  free(loLon);
+  free(loAlt);
+  return (0);
+}
+
+
+int main(int argc, char *argv[]) {
+  GNSSReplay loReplay;
+  struct GNSS_epoch_batch loBatch;
+  struct geodesy_output loOutput;
+  double loLat, loLon, loHeight;
+  uint32_t loSize = 0;
+  bool loBenchmark = false;
+  void *loBuffer;
+  int8_t loResult;
+  int c;
+
+  memset(&loOutput, 0, sizeof(loOutput));
+  loOutput.tier = -1;
+  while (-1 != (c = getopt(argc, argv, "r:ed:n:bh"))) {
+    switch (c) {
+      case 'r':
+              if (3 != sscanf(optarg, "%lf,%lf,%lf", &loLat, &loLon, &loHeight)) {
+                fprintf(stderr, "The reference must be given as latitude,longitude,height\r\n");
+                return (1);
+              }
+              GNSSGeodesy::setReference(&loOutput.reference, loLat, loLon, loHeight);
+              loOutput.referenceSet = true;
+              break;
+      case 'e':
+              loOutput.ecef = true;
+              break;
+      case 'd':
+              loOutput.tier = atoi(optarg);
+              if ((GNSS_DISTANCE_EQUIRECTANGULAR > loOutput.tier) || (GNSS_DISTANCE_VINCENTY < loOutput.tier)) {
+                fprintf(stderr, "The tier must be 0 (equirectangular), 1 (haversine) or 2 (Vincenty)\r\n");
+                return (1);
+              }
+              break;
+      case 'n':
+              loSize = atoi(optarg);
+              break;
+      case 'b':
+              loBenchmark = true;
+              break;
+      case 'h':
+      default:
+              help_screen(argv[0]);
+              return (0);
+    }
+  }
+  if (loBenchmark) {
+    return (benchmark((0 < loSize) ? loSize : 1000000));
+  }
+  if (optind >= argc) {
+    help_screen(argv[0]);
+    return (1);
+  }
+  if (0 == loSize) {
+    loSize = 1024;
+  }
+  if (loReplay.open(argv[optind])) {
+    fprintf(stderr, "The log file %s can not be opened\r\n", argv[optind]);
+    return (1);
+  }
+
+  // all the columns in one buffer (only the time, the position, the altitude and the undulation are used here)
+  loBuffer = aligned_alloc(64, GNSSEpochBatch::getBufferSize(loSize));
+  for (c = 0; c < 3; c++) {
+    loOutput.out[c] = (double *)malloc(loSize * sizeof(double));
+  }
+  if ((NULL == loBuffer) || (NULL == loOutput.out[0]) || (NULL == loOutput.out[1]) || (NULL == loOutput.out[2])) {
+    fprintf(stderr, "Not enough memory for the batch of %u epochs\r\n", loSize);
+    return (1);
+  }
+  GNSSEpochBatch::setBuffer(&loBatch, loBuffer, loSize);
+  GNSSEpochBatch loCollector(&loBatch, batch_callback, &loOutput);
+
+  if (0 <= loOutput.tier) {
+    loOutput.ecef = false;
+    printf("time,distance,bearing\n");
+  } else {
+    printf(loOutput.ecef ? "time,x,y,z\n" : "time,east,north,up\n");
+  }
+  loResult = loReplay.run(GNSSEpochBatch::epochSink, &loCollector);
+  loCollector.flush();
+  fprintf(stderr, "%u epochs, %lu fixes converted (%s)\r\n", loReplay.getEpochs(), (unsigned long)loOutput.fixes,
+          GNSSGeodesy::hasSIMD() ? "AVX2" : "scalar");
+  for (c = 0; c < 3; c++) {
+    free(loOutput.out[c]);
+  }
+  free(loBuffer);
+  return ((0 > loResult) ? 1 : 0);
+}
@@ -0,0 +1,191 @@
+/*
+  Receiving the NMEA 0183 data from the network sources (linux environment)
+  By: Kazimierz Wilk
+  License: GNU Lesser General Public License. See license file for more information.
+  
+  This example shows how to receive the NMEA sentences of many receivers connected by the network in the single thread:
+  the serial-to-ethernet bridges and the casters (TCP), the broadcasts or the multicast groups (UDP) and the local
+  relays (unix socket, e.g. GNSS_fanout -u). Every source has its own collector, so the epochs of the receivers are not mixed.
+  The lost connections are set up again automatically.
+  
+  With -f the latest epoch of every source is kept in the fleet store (the lock-free table of the devices) and the snapshot
+  of the whole fleet is printed every given number of seconds - e.g. for the dashboard.
+  
+  The sources:
+    tcp:host:port        e.g. tcp:192.168.1.50:4001 or tcp:localhost:10110 (GNSS_fanout)
+    udp:port[@address]   e.g. udp:10110 or udp:10110@239.1.1.1 (the multicast group)
+    unix:path            e.g. unix:/tmp/gnss.sock
+  
+  Usage: GNSS_net [-b break_ms] [-q] [-f seconds] source [source ...]
+  e.g.:  GNSS_net tcp:localhost:10110 udp:10111
+*/
+
+#include <getopt.h>
+#include <signal.h>
+
+#include <ultimateGNSSParser.h>
+#include <GNSSNetSource.h>
+#include <GNSSFleetStore.h>
+
+
+#define MAX_SOURCES 256
+
+static volatile sig_atomic_t stop = 0;
+static const char *names[MAX_SOURCES];
+static bool quiet = false;
+static GNSSFleetStore fleet(MAX_SOURCES);
+static struct GNSS_fleet_device devices[MAX_SOURCES];
+
+void stop_handler(int paSignal) {
+  (void)paSignal;
+  stop = 1;
+}
+
+
+void help_screen (const char * const progname) {
+  fprintf (stderr, "This tool prints the epochs received from the network sources.\n");
+  fprintf (stderr, "Program usage: %s [options sequence] source [source ...]\n\n", progname);
+  fprintf (stderr, "The sources:\n");
+  fprintf (stderr, "\t\ttcp:host:port\t\tthe TCP server (e.g. the serial-to-ethernet bridge or GNSS_fanout)\n");
+  fprintf (stderr, "\t\tudp:port[@address]\tthe UDP port (the multicast group is joined when its address is given)\n");
+  fprintf (stderr, "\t\tunix:path\t\tthe unix socket (e.g. GNSS_fanout -u)\n\n");
+  fprintf (stderr, "Program options:\n");
+  fprintf (stderr, "\t\t-b\t\tthe break time between the epochs [ms]\n");
+  fprintf (stderr, "\t\t-f\t\tprint the snapshot of the latest epochs of all the sources every given number of seconds\n");
+  fprintf (stderr, "\t\t-q\t\tdon't print the epochs (only the statistics at the end)\n");
+  fprintf (stderr, "\t\t-h\t\tprint this help screen\n\n");
+}
+
+
+void epoch_callback(uint16_t paSource, const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paUserData) {
+  (void)paUserData;
+  GNSSFleetStore::epochCallback(paData, paGSVData, &devices[paSource]);
+  if (quiet) {
+    return;
+  }
+  printf("%-24s %02u:%02u:%02u.%03u  %0.9lf,%0.9lf  quality %c  sats %u  hdop %0.2lf\n", names[paSource],
+         paData->UTC_H, paData->UTC_M, paData->UTC_S, paData->UTC_fract,
+         GNSSCollector::getLatitude(paData), GNSSCollector::getLongitude(paData),
+         (paData->quality ? paData->quality : '-'), paData->sats, paData->hdop);
+}
+
+
+int add_source(GNSSNetSources &paSources, char *paText) {
+  char *loPort;
+  char *loAddress;
+
+  if (!strncmp("tcp:", paText, 4)) {
+    loPort = strrchr(paText + 4, ':');
+    if (NULL == loPort) {
+      return (-1);
+    }
+    *loPort = 0;
+    return (paSources.addTCP(paText + 4, atoi(loPort + 1)));
+  }
+  if (!strncmp("udp:", paText, 4)) {
+    loAddress = strchr(paText + 4, '@');
+    if (NULL != loAddress) {
+      *loAddress = 0;
+      return (paSources.addUDP(atoi(paText + 4), loAddress + 1));
+    }
+    return (paSources.addUDP(atoi(paText + 4)));
+  }
+  if (!strncmp("unix:", paText, 5)) {
+    return (paSources.addUnix(paText + 5));
+  }
+  return (-1);
+}
+
+
+// it prints the latest epoch of every source kept in the fleet store (-f)
+void print_fleet(void) {
+  static struct GNSS_fleet_entry loEntries[MAX_SOURCES];
+  uint32_t loCount = fleet.snapshot(loEntries, MAX_SOURCES);
+  uint32_t i, j;
+  
+  printf("--- %u of %u sources with the epoch\n", loCount, fleet.getDevices());
+  for (i = 0; i < loCount; i++) {
+    const struct GNSS_epoch_record *loRecord = &loEntries[i].record;
+    const char *loName = "?";
+    
+    for (j = 0; j < MAX_SOURCES; j++) {
+      if ((NULL != names[j]) && (GNSSFleetStore::makeKey(names[j]) == loEntries[i].key)) {
+        loName = names[j];
+        break;
+      }
+    }
+    printf("%-24s #%u  %lld  %0.9lf,%0.9lf  quality %u  sats %u  hdop %0.2f\n", loName, loRecord->sequence, (long long)loRecord->timeMs,
+           loRecord->lat / 1e9, loRecord->lon / 1e9, loRecord->quality, loRecord->satsUsed, loRecord->hdop);
+  }
+}
+
+
+int main(int argc, char *argv[]) {
+  GNSSNetSources loSources(MAX_SOURCES);
+  int loBreakMs = -1;
+  uint32_t loFleetMs = 0;
+  uint32_t loPrintedMs = GNSSCollector::getPlatformTimeMs();
+  char loName[128];
+  int loSource;
+  int i, c;
+  
+  while (-1 != (c = getopt(argc, argv, "b:f:qh"))) {
+    switch (c) {
+      case 'b':
+              loBreakMs = atoi(optarg);
+              break;
+      case 'f':
+              loFleetMs = atoi(optarg) * 1000;
+              break;
+      case 'q':
+              quiet = true;
+              break;
+      case 'h':
+      default:
+              help_screen(argv[0]);
+              return (0);
+    }
+  }
+  if (optind >= argc) {
+    help_screen(argv[0]);
+    return (1);
+  }
+  
+  for (i = optind; i < argc; i++) {
+    snprintf(loName, sizeof(loName), "%s", argv[i]);
+    loSource = add_source(loSources, argv[i]);
+    if (0 > loSource) {
+      fprintf(stderr, "The source %s can not be added\r\n", loName);
+      continue;
+    }
+    names[loSource] = strdup(loName);
+    fleet.attach(GNSSFleetStore::makeKey(loName), &devices[loSource]);
+    if (0 <= loBreakMs) {
+      loSources.getCollector(loSource)->setBreakTime(loBreakMs);
+    }
+  }
+  loSources.setEpochCallback(epoch_callback);
+  
+  signal(SIGINT, stop_handler);
+  signal(SIGTERM, stop_handler);
+  
+  while (!stop) {
+    // the short timeout - the break between the epochs is detected without the new bytes too
+    if (0 > loSources.service(5)) {
+      break;
+    }
+    if ((0 != loFleetMs) && ((GNSSCollector::getPlatformTimeMs() - loPrintedMs) >= loFleetMs)) {
+      loPrintedMs = GNSSCollector::getPlatformTimeMs();
+      print_fleet();
+    }
+    fflush(stdout);
+  }
+  
+  for (i = 0; i < MAX_SOURCES; i++) {
+    if (NULL != names[i]) {
+      fprintf(stderr, "%-24s %llu bytes, %u epochs, %u connections\r\n", names[i],
+              (unsigned long long)loSources.getBytes(i), loSources.getEpochs(i), loSources.getConnections(i));
+    }
+  }
+  return (0);
+}
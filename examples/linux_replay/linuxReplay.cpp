@@ -0,0 +1,759 @@
+/*
+  Replaying the recorded NMEA 0183 log files on all the CPU cores (linux environment)
+  By: Kazimierz Wilk
+  License: GNU Lesser General Public License. See license file for more information.
+  
+  This example shows how to reprocess the recorded logs much faster than the receiver has produced them.
+  The log file is mapped into the memory, divided into the chunks at the epoch boundaries and parsed by all the CPU cores.
+  The epochs are separated by the UTC time of the sentences (there are no breaks between the packs of messages in the file)
+  and they are given to the sink in the order of the file.
+  
+  The capture files recorded with the receive timestamps (GNSS_parser -r) are replayed with the -R option
+  through the collector, so the epochs are separated by the breaks between the packs of messages exactly as in the live run.
+  The -V option replays the capture file through collectData() - the blocking method of the live programs - with the virtual clock
+  (GNSS_virtual_clock): the data source callbacks report only the bytes recorded before the virtual time and the sleeps of the break
+  detection only move the virtual time, so the epochs follow the recorded times, not the wall clock, and take no time to wait for.
+  The epochs are the same as collectData() gives in the live run (it waits for the break before every epoch, so the pack which comes
+  sooner than the break time after the previous one is skipped - -R gives every epoch with the continuous break detection of feed()).
+  
+  The flight recorder file (GNSS_parser -f) is dumped with the -F option: the rejected lines are printed to stderr
+  and the raw bytes kept in the ring are written to stdout (e.g. to be replayed as the log file later).
+  
+  The gzip (and zstd, when built with GNSS_ZSTD) compressed logs are detected automatically and decompressed
+  by the separate thread into the bounded ring while this thread parses the lines - there is no need to inflate them to the disk.
+  
+  The -A option stores the log (plain or compressed) in the NMEA archive - the sentences are coded as the differences from the previous
+  sentence of the same type. The archives are replayed like the logs (the sentences are decoded straight into the sliced form)
+  and -X writes the archived log back to stdout byte by byte.
+  
+  The -C option stores the replayed epochs in the columnar store (the separate arrays of the time, position, quality, ...
+  with the min/max statistics of every block) and -Q queries the store: only the time, quality and HDOP columns are read
+  and the blocks outside the -a/-b range are skipped with their statistics.
+  
+  The -T option writes the replayed fixes to the compact track stream (the differences from the predicted position as the varints
+  with the keyframe every minute of 1 Hz fixes) and -D prints the fixes decoded from the track stream.
+  With -S only the fixes needed to keep the track within the given tolerance [m] are written (the tolerance grows with
+  the standard deviations of $xxGST), so the stationary and straight parts of the track take two fixes.
+  
+  The -o option prints every epoch as the JSON line (with the satellites when -g is given), the GeoJSON feature or the CSV record
+  written by the built-in serializers, or writes the binary epoch records (-o bin) for the other processes (e.g. to the pipe).
+  The -B option prints the binary records read in place from the file (or stdin with -B -).
+  The -P option publishes every epoch in the shared memory segment (see GNSS_shared_reader) - e.g. with -R 1 to feed the local
+  readers with the recorded data in the real time.
+  
+  The -E option prints only the changes between the epochs (fix lost/regained, quality, mode, the number of the satellites,
+  HDOP and the $xxGST accuracy crossing the thresholds with the hysteresis) instead of the whole epochs.
+  
+  The -a/-b options replay only the given UTC time range. With -i the time index is built next to the log file (log_file.idx)
+  or loaded if it is there already, so only the part of the file around the range is parsed.
+  
+  Usage: GNSS_replay [-t threads] [-c chunk_KiB] [-g] [-p] [-o json|geojson|csv|bin] [-i] [-a from] [-b to] log_file
+         GNSS_replay -R speed [-g] [-p] [-P segment] capture_file
+         GNSS_replay -V [-g] [-p] capture_file
+         GNSS_replay -F flight_recorder_file > raw_bytes
+         GNSS_replay -A archive_file log_file
+         GNSS_replay -X archive_file > log_file
+         GNSS_replay -C store_file log_file
+         GNSS_replay -Q store_file [-a from] [-b to]
+         GNSS_replay -T track_file [-S tolerance] log_file
+         GNSS_replay -D track_file
+         GNSS_replay -B record_file
+         GNSS_replay -E log_file
+  e.g.:  GNSS_replay -p /var/log/gnss/2024-05-17.nmea
+         GNSS_replay -p /var/log/gnss/2024-05-16.nmea.gz
+         GNSS_replay -i -a 2024-05-17T23:59:00 -b 2024-05-18T00:01:00 -p /var/log/gnss/2024-05-17.nmea
+         GNSS_replay -R 10 -p field_issue.gcap
+*/
+
+#include <getopt.h>
+#include <time.h>
+#include <string>
+
+#include <ultimateGNSSParser.h>
+#include <GNSSReplay.h>
+#include <GNSSCapture.h>
+#include <GNSSFlightRecorder.h>
+#include <GNSSDecompressor.h>
+#include <GNSSArchive.h>
+#include <GNSSColumnStore.h>
+#include <GNSSTrackCodec.h>
+#include <GNSSTrackSimplifier.h>
+#include <GNSSSerializer.h>
+#include <GNSSEpochRecord.h>
+#include <GNSSSharedFix.h>
+#include <GNSSChangeEvents.h>
+#include <math.h>
+
+
+/************************************************************************************************************************
+ ************************************************************************************************************************
+ ********************************************* the sink of the replayed epochs ******************************************
+ ************************************************************************************************************************
+ ************************************************************************************************************************/
+
+struct replay_stats {
+  bool     print;
+  uint32_t fixes;
+  uint32_t GSVSats;
+  GNSSColumnWriter    *columns;     // the epochs are stored in the column store too (-C)
+  GNSSTrackEncoder    *track;       // the epochs are written to the track stream too (-T)
+  GNSSTrackSimplifier *simplifier;  // only the fixes kept by the simplifier are written (-S)
+  FILE                *trackFile;
+  uint64_t             trackBytes;
+  uint32_t             trackFixes;
+  GNSSSharedPublisher *shared;      // the epochs are published in the shared memory segment (-P)
+  GNSSChangeDetector  *changes;     // only the changes between the epochs are printed (-E)
+  char                 format;      // the epochs are printed as JSON ('j'), GeoJSON ('g'), CSV ('c') or binary ('b') records (-o)
+  uint32_t             records;
+  char                 record[64*1024];
+};
+
+// it writes the fix to the track stream (-T)
+void track_callback(const struct GNSS_track_fix *paFix, void *paUserData) {
+  struct replay_stats *loStats = (struct replay_stats *)paUserData;
+  uint8_t loFrame[GNSS_TRACK_MAX_FRAME];
+  uint8_t loLength;
+  
+  if (NULL == loStats->track) {
+    return;
+  }
+  loLength = loStats->track->encode(paFix, loFrame);
+  fwrite(loFrame, 1, loLength, loStats->trackFile);
+  loStats->trackBytes += loLength;
+  loStats->trackFixes++;
+}
+
+// it prints the change event (-E)
+void change_callback(const struct GNSS_change_event *paEvent, void *paUserData) {
+  const struct GNSS_data *loData = paEvent->data;
+  const char *loName;
+  
+  (void)paUserData;
+  switch (paEvent->type) {
+    case GNSS_EVENT_FIX_LOST:      loName = "fix lost";      break;
+    case GNSS_EVENT_FIX_REGAINED:  loName = "fix regained";  break;
+    case GNSS_EVENT_STATUS:        loName = "status";        break;
+    case GNSS_EVENT_QUALITY:       loName = "quality";       break;
+    case GNSS_EVENT_MODE:          loName = "mode";          break;
+    case GNSS_EVENT_SATS_LOW:      loName = "sats low";      break;
+    case GNSS_EVENT_SATS_OK:       loName = "sats ok";       break;
+    case GNSS_EVENT_HDOP_HIGH:     loName = "hdop high";     break;
+    case GNSS_EVENT_HDOP_OK:       loName = "hdop ok";       break;
+    case GNSS_EVENT_ACCURACY_LOW:  loName = "accuracy low";  break;
+    case GNSS_EVENT_ACCURACY_OK:   loName = "accuracy ok";   break;
+    default:                       loName = "moved";         break;
+  }
+  printf("%04u-%02u-%02u %02u:%02u:%02u.%03u  ", loData->year, loData->month, loData->day,
+         loData->UTC_H, loData->UTC_M, loData->UTC_S, loData->UTC_fract);
+  if (0 != paEvent->code) {
+    printf("%-13s  %c -> %c\n", loName, paEvent->previous, paEvent->code);
+  } else if ((GNSS_EVENT_FIX_LOST == paEvent->type) || (GNSS_EVENT_FIX_REGAINED == paEvent->type)) {
+    printf("%s\n", loName);
+  } else {
+    printf("%-13s  %0.2lf\n", loName, paEvent->value);
+  }
+}
+
+int8_t epoch_sink(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paUserData) {
+  struct replay_stats *loStats = (struct replay_stats *)paUserData;
+  uint8_t i, k;
+  
+  if (('0' < paData->quality) || ('A' == paData->pos_status)) {
+    loStats->fixes++;
+  }
+  if (NULL != paGSVData) {
+    for (i = 0; i < paGSVData->recSystems; i++) {
+      if (0 < paGSVData->system[i].msgs) {
+        k = paGSVData->system[i].msgs - 1;
+        loStats->GSVSats += paGSVData->system[i].GSV[k].sats;
+      }
+    }
+  }
+  if (NULL != loStats->columns) {
+    loStats->columns->append(paData);
+  }
+  if (NULL != loStats->shared) {
+    loStats->shared->publish(paData, paGSVData);
+  }
+  if (NULL != loStats->changes) {
+    loStats->changes->update(paData);
+  }
+  if (NULL != loStats->simplifier) {
+    loStats->simplifier->add(paData);
+  } else if ((NULL != loStats->track) && (('0' < paData->quality) || ('A' == paData->pos_status))) {
+    struct GNSS_track_fix loFix;
+    
+    GNSSTrackEncoder::quantize(paData, &loFix);
+    track_callback(&loFix, loStats);
+  }
+  if (0 != loStats->format) {
+    size_t loLength;
+    
+    switch (loStats->format) {
+      case 'j':
+              loLength = GNSSSerializer::toJSON(paData, paGSVData, loStats->record, sizeof(loStats->record));
+              break;
+      case 'g':
+              loLength = GNSSSerializer::toGeoJSON(paData, loStats->record, sizeof(loStats->record));
+              break;
+      case 'b':
+              loLength = GNSSEpochRecord::build(paData, paGSVData, loStats->records++, loStats->record, sizeof(loStats->record));
+              break;
+      default:
+              loLength = GNSSSerializer::toCSV(paData, loStats->record, sizeof(loStats->record));
+              break;
+    }
+    fwrite(loStats->record, 1, loLength, stdout);
+  }
+  if (loStats->print) {
+    printf("%04u-%02u-%02u %02u:%02u:%02u.%03u  %0.11lf%c,%0.11lf%c  alt %0.3lf  quality %c  sats %u\n",
+           paData->year, paData->month, paData->day, paData->UTC_H, paData->UTC_M, paData->UTC_S, paData->UTC_fract,
+           paData->lat, (paData->lat_dir ? paData->lat_dir : '-'), paData->lon, (paData->lon_dir ? paData->lon_dir : '-'),
+           paData->alt, (paData->quality ? paData->quality : '-'), paData->sats);
+  }
+  return (0);
+}
+
+// the collector fed by the capture replay gives the epochs with the epoch callback
+void epoch_callback(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paUserData) {
+  epoch_sink(paData, paGSVData, paUserData);
+}
+
+// it closes the track stream (-T) and prints its size (and the number of the change events with -E)
+void close_outputs(struct replay_stats *paStats) {
+  if (NULL != paStats->changes) {
+    fprintf(stderr, "%u change events in %u epochs\r\n", paStats->changes->getEvents(), paStats->changes->getEpochs());
+  }
+  if (NULL != paStats->simplifier) {
+    paStats->simplifier->flush();
+    fprintf(stderr, "%u of %u fixes kept by the simplifier\r\n", paStats->simplifier->getOutput(), paStats->simplifier->getInput());
+  }
+  if (NULL == paStats->trackFile) {
+    return;
+  }
+  fclose(paStats->trackFile);
+  paStats->trackFile = NULL;
+  fprintf(stderr, "%u fixes written to the track stream in %lu bytes (%0.2lf bytes per fix)\r\n", paStats->trackFixes,
+          (unsigned long)paStats->trackBytes, paStats->trackFixes ? (double)paStats->trackBytes / paStats->trackFixes : 0.0);
+}
+
+// the capture file given to collectData() with the virtual clock (-V) - the data source callbacks have no user data
+struct virtual_source {
+  GNSSCaptureReader         capture;
+  struct GNSS_virtual_clock clock;
+  const char               *data;       // the current record
+  uint32_t                  length;
+  uint32_t                  position;
+  uint32_t                  timeMs;     // the recorded time of the current record
+  bool                      end;
+};
+
+struct virtual_source gVirtual;
+
+// the bytes are available when they have been recorded before the virtual time, -1 (the end of the replay)
+// when the break after the last record has passed, so the last epoch is completed too
+int8_t virtual_available(void) {
+  uint64_t loTimeUs;
+
+  if ((gVirtual.position == gVirtual.length) && !gVirtual.end) {
+    if (1 == gVirtual.capture.next(&gVirtual.data, &gVirtual.length, &loTimeUs)) {
+      gVirtual.position = 0;
+      gVirtual.timeMs   = (uint32_t)(loTimeUs / 1000);
+    } else {
+      gVirtual.end = true;
+    }
+  }
+  if (gVirtual.end) {
+    return (((uint32_t)(gVirtual.clock.nowMs - gVirtual.timeMs) < 1000) ? 0 : -1);
+  }
+  return (((int32_t)(gVirtual.clock.nowMs - gVirtual.timeMs) >= 0) ? 1 : 0);
+}
+
+int8_t virtual_read(void) {
+  return ((int8_t)gVirtual.data[gVirtual.position++]);
+}
+
+// it prints the fixes decoded from the track stream (the damaged frames are skipped up to the next keyframe)
+int print_track(const char *paPath) {
+  GNSSTrackDecoder loDecoder;
+  struct GNSS_track_fix loFix;
+  uint8_t loBuffer[64*1024];
+  size_t loLength = 0;
+  size_t loUsed;
+  size_t loPosition;
+  size_t n;
+  uint32_t loFixes = 0;
+  int8_t loResult;
+  FILE *loFile;
+  
+  if (NULL == (loFile = fopen(paPath, "rb"))) {
+    fprintf(stderr, "The track file %s can not be opened\r\n", paPath);
+    return (1);
+  }
+  while (0 < (n = fread(loBuffer + loLength, 1, sizeof(loBuffer) - loLength, loFile))) {
+    loLength += n;
+    loPosition = 0;
+    while (0 != (loResult = loDecoder.decode(loBuffer + loPosition, loLength - loPosition, &loUsed, &loFix)) || (0 < loUsed)) {
+      loPosition += loUsed;
+      if (1 == loResult) {
+        loFixes++;
+        printf("%lld  %0.9lf,%0.9lf  alt %0.3lf  speed %0.2lf  quality %u\n", (long long)loFix.timeMs, GNSSTrackDecoder::toDegrees(loFix.lat),
+               GNSSTrackDecoder::toDegrees(loFix.lon), loFix.altMm / 1000.0, loFix.speed / 100.0, loFix.quality);
+      }
+      if (0 == loResult) {
+        break;
+      }
+    }
+    memmove(loBuffer, loBuffer + loPosition, loLength - loPosition); // the incomplete frame waits for the next bytes
+    loLength -= loPosition;
+  }
+  fclose(loFile);
+  fprintf(stderr, "%u fixes decoded, %u damaged frames\r\n", loFixes, loDecoder.getDamaged());
+  return (0);
+}
+
+// it prints the binary epoch records (the record sizes are the multiples of 8, so they stay aligned in the buffer and are read in place)
+int print_records(const char *paPath) {
+  uint64_t loBuffer[8*1024];
+  uint8_t *loBytes = (uint8_t *)loBuffer;
+  const struct GNSS_epoch_record *loRecord;
+  const struct GNSS_record_sat *loSats;
+  size_t loLength = 0;
+  size_t loPosition;
+  size_t n;
+  uint32_t loRecords = 0;
+  int32_t loSize = 0;
+  uint16_t i;
+  FILE *loFile;
+  
+  if (NULL == (loFile = strcmp(paPath, "-") ? fopen(paPath, "rb") : stdin)) {
+    fprintf(stderr, "The record file %s can not be opened\r\n", paPath);
+    return (1);
+  }
+  while (0 < (n = fread(loBytes + loLength, 1, sizeof(loBuffer) - loLength, loFile))) {
+    loLength += n;
+    loPosition = 0;
+    while (0 < (loSize = GNSSEpochRecord::check(loBytes + loPosition, loLength - loPosition))) {
+      loRecord = (const struct GNSS_epoch_record *)(loBytes + loPosition);
+      loRecords++;
+      printf("#%u %lld  %0.9lf,%0.9lf  alt %0.3lf  quality %u  sats %u  hdop %0.2f", loRecord->sequence, (long long)loRecord->timeMs,
+             loRecord->lat / 1e9, loRecord->lon / 1e9, loRecord->altMm / 1000.0, loRecord->quality, loRecord->satsUsed, loRecord->hdop);
+      loSats = GNSSEpochRecord::getSats(loRecord);
+      for (i = 0; i < loRecord->sats; i++) {
+        printf("  %c%c%u:%u", loSats[i].talker[0], loSats[i].talker[1], loSats[i].prn, loSats[i].SNR);
+      }
+      printf("\n");
+      loPosition += loSize;
+    }
+    if (0 > loSize) {
+      break;
+    }
+    memmove(loBytes, loBytes + loPosition, loLength - loPosition);
+    loLength -= loPosition;
+  }
+  if (stdin != loFile) {
+    fclose(loFile);
+  }
+  fprintf(stderr, "%u records read\r\n", loRecords);
+  if ((0 > loSize) || (0 < loLength)) {
+    fprintf(stderr, "The record file %s is not correct\r\n", paPath);
+    return (1);
+  }
+  return (0);
+}
+
+// "YYYY-MM-DDTHH:MM:SS[.fff]" to ms since 1970-01-01 (-1 if the format is not correct)
+int64_t parse_utc(const char *paText) {
+  unsigned int loYear, loMonth, loDay, loH, loM;
+  double loS;
+  
+  if (6 != sscanf(paText, "%u-%u-%uT%u:%u:%lf", &loYear, &loMonth, &loDay, &loH, &loM, &loS)) {
+    return (-1);
+  }
+  return (GNSSCollector::getUnixTimeMs(loYear, loMonth, loDay, (loH * 3600 + loM * 60) * 1000 + (uint32_t)(loS * 1000 + 0.5)));
+}
+
+// the statistics of the epochs from the column store (the blocks outside the range are not touched)
+int query_store(const char *paPath, int64_t paFromMs, int64_t paToMs) {
+  GNSSColumnReader loStore;
+  uint64_t loQuality[10];
+  uint64_t loEpochs = 0;
+  uint64_t loScanned = 0;
+  uint64_t loHdopCnt = 0;
+  double loHdopSum = 0;
+  uint64_t b;
+  uint32_t i;
+  
+  if (loStore.open(paPath)) {
+    fprintf(stderr, "The column store %s can not be opened\r\n", paPath);
+    return (1);
+  }
+  memset(loQuality, 0, sizeof(loQuality));
+  for (b = loStore.findBlock(paFromMs); b < loStore.getBlocks(); b++) {
+    const struct GNSS_column_block *loBlock = loStore.getBlock(b);
+    if (loBlock->min[GNSS_COL_TIME] > (double)paToMs) {
+      break;
+    }
+    const int64_t *loTime    = loStore.getTime(b);
+    const uint8_t *loQual    = loStore.getQuality(b);
+    const float   *loHdop    = (const float *)loStore.getColumn(b, GNSS_COL_HDOP);
+    loScanned++;
+    for (i = 0; i < loBlock->count; i++) {
+      if ((loTime[i] < paFromMs) || (loTime[i] > paToMs)) {
+        continue;
+      }
+      loEpochs++;
+      loQuality[(9 < loQual[i]) ? 9 : loQual[i]]++;
+      if (!isnan(loHdop[i])) {
+        loHdopSum += loHdop[i];
+        loHdopCnt++;
+      }
+    }
+  }
+  printf("%lu epochs in the range (%lu of %lu blocks read)\n", (unsigned long)loEpochs, (unsigned long)loScanned, (unsigned long)loStore.getBlocks());
+  for (i = 0; i < 10; i++) {
+    if (loQuality[i]) {
+      printf("  quality %u: %lu\n", i, (unsigned long)loQuality[i]);
+    }
+  }
+  if (loHdopCnt) {
+    printf("  mean HDOP %0.2lf\n", loHdopSum / loHdopCnt);
+  }
+  return (0);
+}
+
+/************************************************************************************************************************
+ ************************************************************************************************************************
+ ************************************************************************************************************************/
+
+void help_screen (const char * const progname) {
+  fprintf (stderr, "This tool parses the recorded NMEA log file on all the CPU cores.\n");
+  fprintf (stderr, "Program usage: %s [options sequence] log_file\n\n", progname);
+  fprintf (stderr, "Program options:\n");
+  fprintf (stderr, "\t\t-t\t\tthe number of the parsing threads (default: the number of the CPUs)\n");
+  fprintf (stderr, "\t\t-c\t\tthe chunk size in KiB (default: 1024)\n");
+  fprintf (stderr, "\t\t-g\t\tcollect the GSV data too\n");
+  fprintf (stderr, "\t\t-p\t\tprint every epoch (to stdout)\n");
+  fprintf (stderr, "\t\t-o\t\tprint every epoch as the JSON line (json), GeoJSON feature (geojson), CSV record (csv) or binary record (bin)\n");
+  fprintf (stderr, "\t\t-E\t\tprint only the changes between the epochs (fix, quality, mode, satellites, HDOP, accuracy)\n");
+  fprintf (stderr, "\t\t-B\t\tprint the binary epoch records from the given file (- for stdin)\n");
+  fprintf (stderr, "\t\t-a\t\treplay the epochs from the given UTC time (YYYY-MM-DDTHH:MM:SS)\n");
+  fprintf (stderr, "\t\t-b\t\treplay the epochs up to the given UTC time (YYYY-MM-DDTHH:MM:SS)\n");
+  fprintf (stderr, "\t\t-i\t\tuse the time index log_file.idx (it is built if it doesn't exist)\n");
+  fprintf (stderr, "\t\t-A\t\tstore the log file in the given NMEA archive file\n");
+  fprintf (stderr, "\t\t-X\t\twrite the log stored in the given NMEA archive file to stdout\n");
+  fprintf (stderr, "\t\t-C\t\tstore the replayed epochs in the given column store file (it is continued if it exists)\n");
+  fprintf (stderr, "\t\t-Q\t\tprint the statistics of the epochs from the given column store file (see -a, -b)\n");
+  fprintf (stderr, "\t\t-T\t\twrite the replayed fixes to the given track stream file\n");
+  fprintf (stderr, "\t\t-S\t\tkeep only the fixes needed for the given tolerance in metres (see -T)\n");
+  fprintf (stderr, "\t\t-D\t\tprint the fixes decoded from the given track stream file\n");
+  fprintf (stderr, "\t\t-P\t\tpublish every epoch in the given shared memory segment (e.g. /gnss0)\n");
+  fprintf (stderr, "\t\t-F\t\tdump the flight recorder file (the rejected lines to stderr, the raw bytes to stdout)\n");
+  fprintf (stderr, "\t\t-R\t\treplay the capture file with the given speed (1 - real time, 10 - ten times faster, 0 - maximum speed)\n");
+  fprintf (stderr, "\t\t-V\t\treplay the capture file through collectData() with the virtual clock\n");
+  fprintf (stderr, "\t\t-h\t\tprint this help screen\n\n");
+}
+
+
+int main(int argc, char *argv[]) {
+  GNSSReplay loReplay;
+  struct replay_stats loStats;
+  struct timespec loStart, loStop;
+  double loSeconds;
+  int8_t loResult;
+  float loCaptureSpeed = -1;
+  int64_t loFromMs = -1;
+  int64_t loToMs = -1;
+  bool loIndex = false;
+  const char *loArchivePath = NULL;
+  const char *loQueryPath = NULL;
+  GNSSColumnWriter loColumns;
+  GNSSTrackEncoder loTrack;
+  GNSSSharedPublisher loShared;
+  GNSSTrackSimplifier loSimplifier(track_callback, &loStats);
+  GNSSChangeDetector loChanges(change_callback);
+  bool loGSV = false;
+  bool loVirtual = false;
+  int c;
+  
+  memset(&loStats, 0, sizeof(loStats));
+  
+  while (-1 != (c = getopt(argc, argv, "t:c:gpo:EB:a:b:iA:X:C:Q:T:S:D:P:R:VF:h"))) {
+    switch (c) {
+      case 't':
+              loReplay.setThreads((uint8_t)atoi(optarg));
+              break;
+      case 'c':
+              loReplay.setChunkSize((size_t)atol(optarg) * 1024);
+              break;
+      case 'g':
+              loReplay.GSVSwitch(true);
+              loGSV = true;
+              break;
+      case 'p':
+              loStats.print = true;
+              break;
+      case 'o':
+              if (!strcmp(optarg, "json") || !strcmp(optarg, "geojson") || !strcmp(optarg, "bin")) {
+                loStats.format = optarg[0];
+              } else if (!strcmp(optarg, "csv")) {
+                loStats.format = 'c';
+                fwrite(loStats.record, 1, GNSSSerializer::CSVHeader(loStats.record, sizeof(loStats.record)), stdout);
+              } else {
+                fprintf(stderr, "The output format %s is not known (json, geojson, csv or bin expected)\r\n", optarg);
+                return (1);
+              }
+              break;
+      case 'E':
+              // the satellites below 6 (back at 8), HDOP above 2 (back at 1.5), the accuracy worse than 1 m (back at 0.5 m) for 3 epochs
+              loChanges.setSatsThreshold(6, 8, 3);
+              loChanges.setHDOPThreshold(2.0, 1.5, 3);
+              loChanges.setAccuracyThreshold(1.0, 0.5, 3);
+              loStats.changes = &loChanges;
+              break;
+      case 'B':
+              return (print_records(optarg));
+      case 'a':
+      case 'b':
+              if (0 > (('a' == c) ? (loFromMs = parse_utc(optarg)) : (loToMs = parse_utc(optarg)))) {
+                fprintf(stderr, "The time %s is not correct (YYYY-MM-DDTHH:MM:SS expected)\r\n", optarg);
+                return (1);
+              }
+              break;
+      case 'i':
+              loIndex = true;
+              break;
+      case 'A':
+              loArchivePath = optarg;
+              break;
+      case 'C':
+              if (loColumns.open(optarg)) {
+                fprintf(stderr, "The column store %s can not be opened\r\n", optarg);
+                return (1);
+              }
+              loStats.columns = &loColumns;
+              break;
+      case 'Q':
+              loQueryPath = optarg;
+              break;
+      case 'T':
+              if (NULL == (loStats.trackFile = fopen(optarg, "wb"))) {
+                fprintf(stderr, "The track file %s can not be created\r\n", optarg);
+                return (1);
+              }
+              loStats.track = &loTrack;
+              break;
+      case 'S':
+              loSimplifier = GNSSTrackSimplifier(track_callback, &loStats, atof(optarg));
+              loSimplifier.setStdDevFactor(1);
+              loStats.simplifier = &loSimplifier;
+              break;
+      case 'D':
+              return (print_track(optarg));
+      case 'X':
+              {
+                GNSSArchiveReader loArchive;
+                char loLine[64*1024];
+                long n;
+                
+                if (loArchive.open(optarg)) {
+                  fprintf(stderr, "The archive file %s can not be opened\r\n", optarg);
+                  return (1);
+                }
+                while (0 < (n = loArchive.readLine(loLine, sizeof(loLine)))) {
+                  fwrite(loLine, 1, n, stdout);
+                }
+                if (0 > n) {
+                  fprintf(stderr, "The archive file %s is damaged\r\n", optarg);
+                }
+                return ((0 > n) ? 1 : 0);
+              }
+      case 'P':
+              if (loShared.open(optarg)) {
+                fprintf(stderr, "The shared memory segment %s can not be created\r\n", optarg);
+                return (1);
+              }
+              loStats.shared = &loShared;
+              break;
+      case 'R':
+              loCaptureSpeed = atof(optarg);
+              if (0 > loCaptureSpeed) {
+                loCaptureSpeed = 0;
+              }
+              break;
+      case 'V':
+              loVirtual = true;
+              break;
+      case 'F':
+              if (GNSSFlightRecorder::dumpMarkers(optarg, stderr) || GNSSFlightRecorder::dumpRaw(optarg, stdout)) {
+                fprintf(stderr, "The flight recorder file %s can not be dumped\r\n", optarg);
+                return (1);
+              }
+              return (0);
+      case 'h':
+      default:
+              help_screen(argv[0]);
+              return (0);
+    }
+  }
+  if (NULL != loQueryPath) {
+    return (query_store(loQueryPath, (0 <= loFromMs) ? loFromMs : INT64_MIN, (0 <= loToMs) ? loToMs : INT64_MAX));
+  }
+  if (optind >= argc) {
+    help_screen(argv[0]);
+    return (1);
+  }
+  
+  if (loVirtual) {
+    GNSSCollector loCollector(virtual_available, virtual_read);
+    uint32_t loStartMs;
+    uint32_t loEpochs = 0;
+    
+    if (gVirtual.capture.open(argv[optind])) {
+      fprintf(stderr, "The capture file %s can not be replayed\r\n", argv[optind]);
+      return (1);
+    }
+    loCollector.GSVSwitch(loGSV);
+    loCollector.setBreakTime(35); // the same value as the recording program uses
+    loCollector.setEpochCallback(epoch_callback, &loStats);
+    loCollector.setClock(GNSS_virtual_clock::now, GNSS_virtual_clock::sleep, &gVirtual.clock);
+    // the virtual time starts at the first record (the recorded times are counted from the capture start)
+    virtual_available();
+    gVirtual.clock.nowMs = gVirtual.timeMs;
+    loStartMs = gVirtual.timeMs;
+    clock_gettime(CLOCK_MONOTONIC, &loStart);
+    while (0 == loCollector.collectData(false, false)) {
+      loEpochs++;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &loStop);
+    close_outputs(&loStats);
+    fprintf(stderr, "%u epochs (%u with the fix) in %0.3lf s of the recorded time replayed in %0.3lf s\r\n", loEpochs, loStats.fixes,
+            (gVirtual.clock.nowMs - loStartMs) / 1000.0, (loStop.tv_sec - loStart.tv_sec) + (loStop.tv_nsec - loStart.tv_nsec) / 1e9);
+    return (0);
+  }
+  
+  if (0 <= loCaptureSpeed) {
+    GNSSCaptureReader loCapture;
+    GNSSCollector loCollector(NULL, NULL);
+    int32_t loEpochs;
+    
+    if (loCapture.open(argv[optind])) {
+      fprintf(stderr, "The capture file %s can not be replayed\r\n", argv[optind]);
+      return (1);
+    }
+    loCollector.GSVSwitch(loGSV);
+    loCollector.setBreakTime(35); // the same value as the recording program uses
+    loCollector.setEpochCallback(epoch_callback, &loStats);
+    loEpochs = loCapture.replay(&loCollector, loCaptureSpeed);
+    close_outputs(&loStats);
+    fprintf(stderr, "%d epochs (%u with the fix) replayed\r\n", loEpochs, loStats.fixes);
+    return ((0 > loEpochs) ? 1 : 0);
+  }
+  
+  if (NULL != loArchivePath) {
+    GNSSDecompressor loSource;
+    GNSSArchiveWriter loArchive;
+    char loBuffer[64*1024];
+    long n;
+    
+    if (loSource.open(argv[optind]) || loArchive.open(loArchivePath)) {
+      fprintf(stderr, "The log file %s can not be archived in %s\r\n", argv[optind], loArchivePath);
+      return (1);
+    }
+    while (0 < (n = loSource.read(loBuffer, sizeof(loBuffer)))) {
+      if (loArchive.write(loBuffer, n)) {
+        break;
+      }
+    }
+    if ((0 != n) || loArchive.close()) {
+      fprintf(stderr, "The log file %s can not be archived in %s\r\n", argv[optind], loArchivePath);
+      return (1);
+    }
+    fprintf(stderr, "%lu lines (%lu stored literally), %0.1lf MB archived in %0.1lf MB\r\n", (unsigned long)loArchive.getLines(),
+            (unsigned long)loArchive.getLiterals(), loArchive.getInputBytes() / 1e6, loArchive.getOutputBytes() / 1e6);
+    return (0);
+  }
+  
+  if (GNSSArchiveReader::isArchive(argv[optind])) {
+    GNSSArchiveReader loArchive;
+    GNSSCollector loCollector(NULL, NULL);
+    GNSSEpochSplitter loSplitter(&loCollector, epoch_sink, &loStats);
+    const struct NMEA_fields *loSlices;
+    int8_t loRead;
+    
+    if (loArchive.open(argv[optind])) {
+      fprintf(stderr, "The archive file %s can not be replayed\r\n", argv[optind]);
+      return (1);
+    }
+    loCollector.GSVSwitch(loGSV);
+    clock_gettime(CLOCK_MONOTONIC, &loStart);
+    loResult = 0;
+    while ((0 == loResult) && (1 == (loRead = loArchive.readSlices(&loSlices)))) {
+      loResult = (0 > loSplitter.putSlices(loSlices)) ? 1 : 0;
+    }
+    if (0 == loResult) {
+      loSplitter.flush();
+      loResult = (0 > loRead) ? -2 : 0;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &loStop);
+    loSeconds = (loStop.tv_sec - loStart.tv_sec) + (loStop.tv_nsec - loStart.tv_nsec) / 1e9;
+    close_outputs(&loStats);
+    fprintf(stderr, "result %d: %u epochs (%u with the fix), %lu lines rejected\r\n%0.3lf s\r\n", loResult, loSplitter.getEpochs(), loStats.fixes,
+            (unsigned long)loArchive.getSkipped(), loSeconds);
+    return ((0 > loResult) ? 1 : 0);
+  }
+  
+  if (GNSS_LOG_PLAIN != GNSSDecompressor::detect(argv[optind])) {
+    GNSSDecompressor loSource;
+    GNSSCollector loCollector(NULL, NULL);
+    GNSSEpochSplitter loSplitter(&loCollector, epoch_sink, &loStats);
+    
+    if (loIndex || (0 <= loFromMs) || (0 <= loToMs)) {
+      fprintf(stderr, "The time index and range need the uncompressed log file\r\n");
+      return (1);
+    }
+    if (loSource.open(argv[optind])) {
+      fprintf(stderr, "The compressed log file %s can not be replayed\r\n", argv[optind]);
+      return (1);
+    }
+    loCollector.GSVSwitch(loGSV);
+    clock_gettime(CLOCK_MONOTONIC, &loStart);
+    loResult = loSource.run(&loSplitter);
+    clock_gettime(CLOCK_MONOTONIC, &loStop);
+    loSeconds = (loStop.tv_sec - loStart.tv_sec) + (loStop.tv_nsec - loStart.tv_nsec) / 1e9;
+    close_outputs(&loStats);
+    
+    fprintf(stderr, "result %d: %u epochs (%u with the fix), %u lines rejected\r\n", loResult, loSplitter.getEpochs(), loStats.fixes, loSplitter.getRejected());
+    fprintf(stderr, "%0.1lf MB (%0.1lf MB compressed) parsed in %0.3lf s (%0.1lf MB/s)\r\n", loSource.getOutputBytes() / 1e6, loSource.getInputBytes() / 1e6,
+            loSeconds, loSource.getOutputBytes() / 1e6 / loSeconds);
+    return ((0 > loResult) ? 1 : 0);
+  }
+  
+  if (loReplay.open(argv[optind])) {
+    fprintf(stderr, "The log file %s can not be replayed\r\n", argv[optind]);
+    return (1);
+  }
+  
+  clock_gettime(CLOCK_MONOTONIC, &loStart);
+  if (loIndex) {
+    std::string loIndexPath = std::string(argv[optind]) + ".idx";
+    if (loReplay.loadIndex(loIndexPath.c_str()) && loReplay.buildIndex(loIndexPath.c_str())) {
+      fprintf(stderr, "The index %s can not be written - the whole file is parsed\r\n", loIndexPath.c_str());
+    }
+  }
+  if ((0 <= loFromMs) || (0 <= loToMs)) {
+    loResult = loReplay.runRange((0 <= loFromMs) ? loFromMs : 0, (0 <= loToMs) ? loToMs : INT64_MAX, epoch_sink, &loStats);
+  } else {
+    loResult = loReplay.run(epoch_sink, &loStats);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &loStop);
+  loSeconds = (loStop.tv_sec - loStart.tv_sec) + (loStop.tv_nsec - loStart.tv_nsec) / 1e9;
+  close_outputs(&loStats);
+  
+  fprintf(stderr, "result %d: %u epochs (%u with the fix), %u lines rejected", loResult, loReplay.getEpochs(), loStats.fixes, loReplay.getRejected());
+  if (loStats.GSVSats) {
+    fprintf(stderr, ", %u satellites in view", loStats.GSVSats);
+  }
+  fprintf(stderr, "\r\n%0.1lf MB parsed in %0.3lf s (%0.1lf MB/s)\r\n", loReplay.getSize() / 1e6, loSeconds, loReplay.getSize() / 1e6 / loSeconds);
+  return ((0 > loResult) ? 1 : 0);
+}
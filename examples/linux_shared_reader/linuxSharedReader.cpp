@@ -0,0 +1,111 @@
+/*
+  Reading the last epoch published in the shared memory (linux environment)
+  By: Kazimierz Wilk
+  License: GNU Lesser General Public License. See license file for more information.
+  
+  This example shows how the local processes take the current position without opening the serial port:
+  GNSS_parser -S /gnss0 (or GNSS_replay -P /gnss0) publishes every epoch in the shared memory segment
+  and any number of the readers copy the last epoch record from there - the publisher never waits for them.
+  
+  The reader polls the sequence number of the segment (the single load) and prints the epoch when it changes.
+  With -b it measures the time of the single read of the whole record.
+  
+  Usage: GNSS_shared_reader [-n epochs] [-b] segment
+  e.g.:  GNSS_shared_reader /gnss0
+*/
+
+#include <getopt.h>
+#include <time.h>
+
+#include <ultimateGNSSParser.h>
+#include <GNSSEpochRecord.h>
+#include <GNSSSharedFix.h>
+
+
+void help_screen (const char * const progname) {
+  fprintf (stderr, "This tool prints the epochs published in the shared memory segment by GNSS_parser -S or GNSS_replay -P.\n");
+  fprintf (stderr, "Program usage: %s [options sequence] segment\n\n", progname);
+  fprintf (stderr, "Program options:\n");
+  fprintf (stderr, "\t\t-n\t\tstop after the given number of the epochs\n");
+  fprintf (stderr, "\t\t-b\t\tmeasure the time of the single read\n");
+  fprintf (stderr, "\t\t-h\t\tprint this help screen\n\n");
+}
+
+
+int main(int argc, char *argv[]) {
+  GNSSSharedReader loReader;
+  uint64_t loRecord[GNSS_RECORD_MAX_SIZE / 8];
+  const struct GNSS_epoch_record *loEpoch = (const struct GNSS_epoch_record *)loRecord;
+  uint64_t loSequence;
+  uint64_t loLast = 0;
+  uint32_t loLimit = 0;
+  uint32_t loPrinted = 0;
+  bool loBenchmark = false;
+  int32_t loSize;
+  int c;
+  
+  while (-1 != (c = getopt(argc, argv, "n:bh"))) {
+    switch (c) {
+      case 'n':
+              loLimit = atoi(optarg);
+              break;
+      case 'b':
+              loBenchmark = true;
+              break;
+      case 'h':
+      default:
+              help_screen(argv[0]);
+              return (0);
+    }
+  }
+  if (optind >= argc) {
+    help_screen(argv[0]);
+    return (1);
+  }
+  if (loReader.open(argv[optind])) {
+    fprintf(stderr, "The shared memory segment %s can not be opened (is the publisher running?)\r\n", argv[optind]);
+    return (1);
+  }
+  
+  if (loBenchmark) {
+    struct timespec loStart, loStop;
+    uint32_t loReads = 10000000;
+    uint32_t loFailed = 0;
+    uint32_t i;
+    
+    clock_gettime(CLOCK_MONOTONIC, &loStart);
+    for (i = 0; i < loReads; i++) {
+      if (0 >= loReader.read(loRecord, sizeof(loRecord), &loSequence)) {
+        loFailed++;
+      }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &loStop);
+    fprintf(stderr, "%u reads (%u without the record): %0.1lf ns per read\r\n", loReads, loFailed,
+            ((loStop.tv_sec - loStart.tv_sec) * 1e9 + (loStop.tv_nsec - loStart.tv_nsec)) / loReads);
+    return (0);
+  }
+  
+  while ((0 == loLimit) || (loPrinted < loLimit)) {
+    if (loReader.getSequence() == loLast) {
+      if (!loReader.isPublisherAlive()) {
+        fprintf(stderr, "The publisher has stopped\r\n");
+        break;
+      }
+      usleep(1000);
+      continue;
+    }
+    loSize = loReader.read(loRecord, sizeof(loRecord), &loSequence);
+    if (0 >= loSize) {
+      continue;
+    }
+    if ((0 != loLast) && (loSequence != (loLast + 1))) {
+      printf("  (%lu epochs skipped)\n", (unsigned long)(loSequence - loLast - 1));
+    }
+    loLast = loSequence;
+    loPrinted++;
+    printf("#%u %lld  %0.9lf,%0.9lf  alt %0.3lf  quality %u  sats %u/%u  hdop %0.2f\n", loEpoch->sequence, (long long)loEpoch->timeMs,
+           loEpoch->lat / 1e9, loEpoch->lon / 1e9, loEpoch->altMm / 1000.0, loEpoch->quality, loEpoch->satsUsed, loEpoch->sats, loEpoch->hdop);
+    fflush(stdout);
+  }
+  return (0);
+}
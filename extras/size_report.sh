@@ -0,0 +1,63 @@
+#!/bin/sh
+#
+#  This file is a part of the ultimateGNSSParser library.
+#  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+#  License: GNU Lesser General Public License. See license file for more information.
+#
+#  The flash/SRAM size report of the example sketches in the default and in the minimal footprint build mode.
+#  It needs the arduino-cli tool with the cores installed for the given boards, e.g.:
+#    arduino-cli core install arduino:avr arduino:samd
+#
+#  usage: extras/size_report.sh [FQBN ...]        (default: arduino:avr:uno arduino:samd:mkrzero)
+#
+#  The extra build flags (e.g. the capacity limits) can be given with the EXTRA_FLAGS variable:
+#    EXTRA_FLAGS="-DGNSS_MAXGSVSYSTEMSTORAGE=2 -DGNSS_MAXGSVMESSAGES=3" extras/size_report.sh arduino:avr:uno
+#
+#  The sketches which can not be compiled for the given board (e.g. no Serial2 on UNO) are reported as "n/a".
+#  The output (markdown) is meant to be committed as it is, e.g.:
+#    extras/size_report.sh > extras/size_report.md
+
+LIBDIR=$(cd "$(dirname "$0")/.." && pwd)
+BOARDS=${*:-"arduino:avr:uno arduino:samd:mkrzero"}
+BUILDDIR=${TMPDIR:-/tmp}/ultimateGNSSParser_size_report
+
+if ! command -v arduino-cli >/dev/null 2>&1; then
+  echo "arduino-cli is not available - see https://arduino.github.io/arduino-cli/" >&2
+  exit 1
+fi
+
+# prints "<flash> <SRAM>" for single sketch compilation or "n/a n/a" if the compilation failed
+sketch_size () {
+  out=$(arduino-cli compile --fqbn "$1" --library "$LIBDIR" --build-path "$BUILDDIR" \
+        --build-property "compiler.cpp.extra_flags=$3 $EXTRA_FLAGS" "$2" 2>/dev/null)
+  if [ $? -ne 0 ]; then
+    echo "n/a n/a"
+    return
+  fi
+  flash=$(echo "$out" | sed -n 's/^Sketch uses \([0-9]*\) bytes.*/\1/p')
+  sram=$(echo "$out"  | sed -n 's/^Global variables use \([0-9]*\) bytes.*/\1/p')
+  echo "${flash:-n/a} ${sram:-n/a}"
+}
+
+# the tool and the cores versions go with the table, so the committed numbers can be reproduced
+echo "Measured $(date -u +%Y-%m-%d) with $(arduino-cli version | head -n 1)"
+echo
+arduino-cli core list | sed 's/^/    /'
+echo
+echo "Extra flags: ${EXTRA_FLAGS:-none}"
+echo
+echo "| board | sketch | flash (default) | SRAM (default) | flash (minimal) | SRAM (minimal) |"
+echo "|-------|--------|-----------------|----------------|-----------------|----------------|"
+
+for board in $BOARDS; do
+  for sketch in "$LIBDIR"/examples/*/*.ino; do
+    sketchdir=$(dirname "$sketch")
+    rm -rf "$BUILDDIR"
+    set -- $(sketch_size "$board" "$sketchdir" "")
+    dflash=$1; dsram=$2
+    rm -rf "$BUILDDIR"
+    set -- $(sketch_size "$board" "$sketchdir" "-DGNSS_MINIMAL_FOOTPRINT")
+    echo "| $board | $(basename "$sketchdir") | $dflash | $dsram | $1 | $2 |"
+  done
+done
+rm -rf "$BUILDDIR"
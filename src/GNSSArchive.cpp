@@ -0,0 +1,815 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "GNSSArchive.h"
+
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define GNSS_ARCHIVE_BUFFER_SIZE (64*1024)
+#define GNSS_ARCHIVE_HEADER_SIZE 8
+
+static const char GNSS_ARCHIVE_MAGIC[7] = {'G', 'N', 'S', 'S', 'A', 'R', 'C'};
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ **************************************************** the varint and the numeric field coding  *****************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+// it returns the number of the bytes written (10 bytes at most)
+static inline uint8_t put_varint(uint8_t *paBuffer, uint64_t paValue) {
+  uint8_t i = 0;
+
+  while (0x80 <= paValue) {
+    paBuffer[i++] = (uint8_t)(paValue | 0x80);
+    paValue >>= 7;
+  }
+  paBuffer[i++] = (uint8_t)paValue;
+  return (i);
+}
+
+// it returns the number of the bytes read or 0 if the varint is damaged or cut by the end of the buffer
+static inline uint8_t get_varint(const uint8_t *paBuffer, size_t paSize, uint64_t *paValue) {
+  uint64_t loValue = 0;
+  uint8_t i;
+
+  for (i = 0; (i < paSize) && (i < 10); i++) {
+    loValue |= ((uint64_t)(paBuffer[i] & 0x7F)) << (7 * i);
+    if (0 == (paBuffer[i] & 0x80)) {
+      *paValue = loValue;
+      return (i + 1);
+    }
+  }
+  return (0);
+}
+
+// the format of the numeric field: [-]<int digits>[.<frac digits>]
+struct number_format {
+  uint8_t intDigits;
+  uint8_t fracDigits;
+  bool    dot;
+};
+
+// the digits of the field as the single integer (e.g. "-4916.4512" is -49164512) - returns false if the field is not the number
+static bool parse_number(const char *paField, int64_t *paValue, struct number_format *paFormat) {
+  bool loNegative = false;
+  int64_t loValue = 0;
+  uint8_t loDigits = 0;
+
+  paFormat->intDigits  = 0;
+  paFormat->fracDigits = 0;
+  paFormat->dot        = false;
+  if ('-' == *paField) {
+    loNegative = true;
+    paField++;
+  }
+  for (; *paField; paField++) {
+    if (('0' <= *paField) && ('9' >= *paField)) {
+      if (18 <= loDigits++) {
+        return (false); // int64_t overflow
+      }
+      loValue = loValue * 10 + (*paField - '0');
+      if (paFormat->dot) {
+        paFormat->fracDigits++;
+      } else {
+        paFormat->intDigits++;
+      }
+    } else if (('.' == *paField) && (!paFormat->dot)) {
+      paFormat->dot = true;
+    } else {
+      return (false);
+    }
+  }
+  if (0 == loDigits) {
+    return (false);
+  }
+  *paValue = loNegative ? -loValue : loValue;
+  return (true);
+}
+
+// the number in the given format (the integer part is padded with zeros to the number of the digits of the format)
+// it returns the length of the string (terminated with 0) - the format is updated to the string (more integer digits may be written)
+static uint8_t format_number(int64_t paValue, struct number_format *paFormat, char *paField) {
+  char loDigits[24];
+  uint8_t loCnt = 0;
+  uint8_t loLength = 0;
+  uint64_t loAbs = (0 > paValue) ? (uint64_t)(-paValue) : (uint64_t)paValue;
+
+  do {
+    loDigits[loCnt++] = '0' + (loAbs % 10);
+    loAbs /= 10;
+  } while (0 < loAbs);
+  while (loCnt < (paFormat->intDigits + paFormat->fracDigits)) {
+    loDigits[loCnt++] = '0';
+  }
+  if (0 > paValue) {
+    paField[loLength++] = '-';
+  }
+  paFormat->intDigits = loCnt - paFormat->fracDigits;
+  while (loCnt > paFormat->fracDigits) {
+    paField[loLength++] = loDigits[--loCnt];
+  }
+  if (paFormat->dot) {
+    paField[loLength++] = '.';
+  }
+  while (0 < loCnt) {
+    paField[loLength++] = loDigits[--loCnt];
+  }
+  paField[loLength] = 0;
+  return (loLength);
+}
+
+static inline uint64_t zigzag(int64_t paValue) {
+  return ((((uint64_t)paValue) << 1) ^ (uint64_t)(paValue >> 63));
+}
+
+static inline int64_t unzigzag(uint64_t paValue) {
+  return ((int64_t)(paValue >> 1) ^ -(int64_t)(paValue & 1));
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ *************************************************************** the archive writer  ***************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+GNSSArchiveWriter::GNSSArchiveWriter(void) {
+  atFd           = -1;
+  atBuffer       = NULL;
+  atUsed         = 0;
+  atLine         = NULL;
+  atLineLength   = 0;
+  atLineCapacity = 0;
+  atTypes        = NULL;
+  atTypesCnt     = 0;
+  atLines        = 0;
+  atLiterals     = 0;
+  atInputBytes   = 0;
+  atOutputBytes  = 0;
+}
+
+
+GNSSArchiveWriter::~GNSSArchiveWriter(void) {
+  this->close();
+}
+
+
+int8_t GNSSArchiveWriter::open(const char *paPath) {
+  this->close();
+  if (NULL == paPath) {
+    return (-1);
+  }
+  this->atBuffer = (uint8_t *)malloc(GNSS_ARCHIVE_BUFFER_SIZE);
+  this->atTypes  = (struct NMEA_fields *)malloc(GNSS_ARCHIVE_MAX_TYPES * sizeof(struct NMEA_fields));
+  if ((NULL == this->atBuffer) || (NULL == this->atTypes)) {
+    SETCOLORRED DBG("Insufficient RAM space for the archive buffers\r\n"); NOCOLOR
+    this->close();
+    return (-1);
+  }
+  this->atFd = ::open(paPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (0 > this->atFd) {
+    SETCOLORRED DBG("The archive file can not be created\r\n"); NOCOLOR
+    this->close();
+    return (-1);
+  }
+  memcpy(this->atBuffer, GNSS_ARCHIVE_MAGIC, sizeof(GNSS_ARCHIVE_MAGIC));
+  this->atBuffer[7]   = GNSS_ARCHIVE_VERSION;
+  this->atUsed        = GNSS_ARCHIVE_HEADER_SIZE;
+  this->atLineLength  = 0;
+  this->atTypesCnt    = 0;
+  this->atLines       = 0;
+  this->atLiterals    = 0;
+  this->atInputBytes  = 0;
+  this->atOutputBytes = GNSS_ARCHIVE_HEADER_SIZE;
+  return (0);
+}
+
+
+int8_t GNSSArchiveWriter::close(void) {
+  int8_t loResult = 0;
+
+  if (0 <= this->atFd) {
+    if (0 < this->atLineLength) { // the last line without "\n"
+      loResult = this->put_line(this->atLine, this->atLineLength);
+      this->atLineLength = 0;
+    }
+    if (this->write_buffer()) {
+      loResult = -1;
+    }
+    if (::close(this->atFd)) {
+      loResult = -1;
+    }
+    this->atFd = -1;
+  }
+  free(this->atBuffer);
+  free(this->atLine);
+  free(this->atTypes);
+  this->atBuffer       = NULL;
+  this->atLine         = NULL;
+  this->atLineCapacity = 0;
+  this->atTypes        = NULL;
+  return (loResult);
+}
+
+
+int8_t GNSSArchiveWriter::write_buffer(void) {
+  size_t loWritten = 0;
+  ssize_t n;
+
+  while (loWritten < this->atUsed) {
+    n = ::write(this->atFd, this->atBuffer + loWritten, this->atUsed - loWritten);
+    if (0 > n) {
+      if (EINTR == errno) {
+        continue;
+      }
+      SETCOLORRED DBG("The archive file write error\r\n"); NOCOLOR
+      return (-1);
+    }
+    loWritten += n;
+  }
+  this->atUsed = 0;
+  return (0);
+}
+
+
+// it makes sure there is the space for the record of the given size in the buffer
+int8_t GNSSArchiveWriter::reserve(size_t paLength) {
+  if (GNSS_ARCHIVE_BUFFER_SIZE < (this->atUsed + paLength)) {
+    return (this->write_buffer());
+  }
+  return (0);
+}
+
+
+int8_t GNSSArchiveWriter::put_literal(const char *paLine, size_t paLength) {
+  uint8_t loHeader[11];
+  uint8_t loHeaderLength;
+
+  loHeader[0]    = 0;
+  loHeaderLength = 1 + put_varint(loHeader + 1, paLength);
+  if (this->reserve(loHeaderLength)) {
+    return (-1);
+  }
+  memcpy(this->atBuffer + this->atUsed, loHeader, loHeaderLength);
+  this->atUsed += loHeaderLength;
+  this->atOutputBytes += loHeaderLength + paLength;
+  this->atLiterals++;
+
+  // the long literal lines are written in pieces
+  while (0 < paLength) {
+    size_t n = GNSS_ARCHIVE_BUFFER_SIZE - this->atUsed;
+    if (0 == n) {
+      if (this->write_buffer()) {
+        return (-1);
+      }
+      continue;
+    }
+    if (n > paLength) {
+      n = paLength;
+    }
+    memcpy(this->atBuffer + this->atUsed, paLine, n);
+    this->atUsed += n;
+    paLine += n;
+    paLength -= n;
+  }
+  return (0);
+}
+
+
+int8_t GNSSArchiveWriter::put_line(const char *paLine, size_t paLength) {
+  char loLine[MAXMESSAGELENGTH];
+  struct NMEA_fields loSlices;
+  struct NMEA_fields *loLast;
+  struct number_format loFormat, loLastFormat;
+  char loNumber[24];
+  int64_t loValue, loLastValue;
+  uint64_t loMask = 0;
+  size_t loBodyLength;
+  size_t loUsed;
+  uint8_t loEnding;
+  uint8_t loType;
+  uint8_t loChSum = 0;
+  uint8_t i;
+
+  this->atLines++;
+  if ((2 <= paLength) && ('\r' == paLine[paLength-2]) && ('\n' == paLine[paLength-1])) {
+    loEnding = 0;
+    loBodyLength = paLength - 2;
+  } else if ((1 <= paLength) && ('\n' == paLine[paLength-1])) {
+    loEnding = 1;
+    loBodyLength = paLength - 1;
+  } else {
+    loEnding = 2;
+    loBodyLength = paLength;
+  }
+
+  // only the sentence which is decoded exactly is coded: "$<fields separated with ','>*<HH - upper case>" without the other '*' and 0 bytes
+  if (  ((MAXMESSAGELENGTH - 3) < loBodyLength) || (11 > loBodyLength) || ('$' != paLine[0]) || ('*' != paLine[loBodyLength-3])
+     || (memchr(paLine, '*', loBodyLength-3)) || (memchr(paLine, 0, loBodyLength)) ) {
+    return (this->put_literal(paLine, paLength));
+  }
+  for (i = 1; i < (loBodyLength - 3); i++) {
+    loChSum ^= (uint8_t)paLine[i];
+  }
+  if ((HEX_DIGITS[loChSum >> 4] != paLine[loBodyLength-2]) || (HEX_DIGITS[loChSum & 0x0F] != paLine[loBodyLength-1])) {
+    return (this->put_literal(paLine, paLength));
+  }
+  memcpy(loLine, paLine, loBodyLength);
+  memcpy(loLine + loBodyLength, "\r\n", 3);
+  if ((GNSSCollector::check_and_slice_NMEA_message(loLine, &loSlices)) || (GNSS_ARCHIVE_MAX_FIELDS < loSlices.cnt)) {
+    return (this->put_literal(paLine, paLength));
+  }
+
+  // the previous sentence of the type
+  for (loType = 0; loType < this->atTypesCnt; loType++) {
+    if (!strcmp(GNSSCollector::get_field(&this->atTypes[loType], 0), GNSSCollector::get_field(&loSlices, 0))) {
+      break;
+    }
+  }
+  if (this->reserve(2 * MAXMESSAGELENGTH + 11 * GNSS_ARCHIVE_MAX_FIELDS + 32)) { // the worst case record with the type definition
+    return (-1);
+  }
+  loUsed = this->atUsed;
+  if (loType == this->atTypesCnt) {
+    if (GNSS_ARCHIVE_MAX_TYPES == this->atTypesCnt) {
+      return (this->put_literal(paLine, paLength));
+    }
+    const char *loHeader = GNSSCollector::get_field(&loSlices, 0);
+    this->atBuffer[this->atUsed++] = 1;
+    this->atUsed += put_varint(this->atBuffer + this->atUsed, strlen(loHeader));
+    memcpy(this->atBuffer + this->atUsed, loHeader, strlen(loHeader));
+    this->atUsed += strlen(loHeader);
+    this->atTypes[loType].cnt = 0;
+    this->atTypesCnt++;
+  }
+  loLast = &this->atTypes[loType];
+
+  this->atUsed += put_varint(this->atBuffer + this->atUsed, 2 + loType);
+  if (loSlices.cnt != loLast->cnt) {
+    this->atBuffer[this->atUsed++] = loEnding | 4;
+    this->atBuffer[this->atUsed++] = loSlices.cnt;
+  } else {
+    this->atBuffer[this->atUsed++] = loEnding;
+  }
+  for (i = 1; i < loSlices.cnt; i++) {
+    if ((i >= loLast->cnt) || (strcmp(GNSSCollector::get_field(&loSlices, i), GNSSCollector::get_field(loLast, i)))) {
+      loMask |= ((uint64_t)1) << (i - 1);
+    }
+  }
+  this->atUsed += put_varint(this->atBuffer + this->atUsed, loMask);
+
+  for (i = 1; i < loSlices.cnt; i++) {
+    if (0 == (loMask & (((uint64_t)1) << (i - 1)))) {
+      continue;
+    }
+    const char *loField = GNSSCollector::get_field(&loSlices, i);
+    size_t loFieldLength = strlen(loField);
+    if (0 == loFieldLength) {
+      this->atBuffer[this->atUsed++] = 0;
+      continue;
+    }
+    // the difference from the previous value is stored if the value written in the previous format is the same string
+    if (  (i < loLast->cnt) && (parse_number(GNSSCollector::get_field(loLast, i), &loLastValue, &loLastFormat))
+       && (parse_number(loField, &loValue, &loFormat)) && (format_number(loValue, &loLastFormat, loNumber) == loFieldLength)
+       && (!strcmp(loNumber, loField)) ) {
+      this->atBuffer[this->atUsed++] = 1;
+      this->atUsed += put_varint(this->atBuffer + this->atUsed, zigzag(loValue - loLastValue));
+      continue;
+    }
+    this->atUsed += put_varint(this->atBuffer + this->atUsed, 2 + loFieldLength);
+    memcpy(this->atBuffer + this->atUsed, loField, loFieldLength);
+    this->atUsed += loFieldLength;
+  }
+
+  memcpy(loLast, &loSlices, sizeof(loSlices));
+  this->atOutputBytes += this->atUsed - loUsed;
+  return (0);
+}
+
+
+int8_t GNSSArchiveWriter::write(const char *paData, size_t paLength) {
+  const char *loLineEnd;
+  size_t n;
+
+  if ((0 > this->atFd) || (NULL == paData)) {
+    return (-1);
+  }
+  this->atInputBytes += paLength;
+  while (0 < paLength) {
+    loLineEnd = (const char *)memchr(paData, '\n', paLength);
+    n = (NULL == loLineEnd) ? paLength : (size_t)(loLineEnd - paData + 1);
+
+    if ((NULL != loLineEnd) && (0 == this->atLineLength)) {
+      if (this->put_line(paData, n)) { // the whole line is given
+        return (-1);
+      }
+    } else {
+      if ((this->atLineLength + n) > this->atLineCapacity) {
+        size_t loCapacity = 2 * (this->atLineLength + n);
+        char *loLine = (char *)realloc(this->atLine, (loCapacity < 256) ? 256 : loCapacity);
+        if (NULL == loLine) {
+          SETCOLORRED DBG("Insufficient RAM space for the archived line\r\n"); NOCOLOR
+          return (-1);
+        }
+        this->atLine         = loLine;
+        this->atLineCapacity = (loCapacity < 256) ? 256 : loCapacity;
+      }
+      memcpy(this->atLine + this->atLineLength, paData, n);
+      this->atLineLength += n;
+      if (NULL != loLineEnd) {
+        if (this->put_line(this->atLine, this->atLineLength)) {
+          return (-1);
+        }
+        this->atLineLength = 0;
+      }
+    }
+    paData   += n;
+    paLength -= n;
+  }
+  return (0);
+}
+
+
+void GNSSArchiveWriter::rawCallback(const char *paData, uint16_t paLength, void *paWriter) {
+  if (NULL != paWriter) {
+    ((GNSSArchiveWriter *)paWriter)->write(paData, paLength);
+  }
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ *************************************************************** the archive reader  ***************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+// the decoding state of the single sentence type
+struct archive_type {
+  struct NMEA_fields   slices[2];                        // the last decoded sentence and the place for the next one
+  NMEA_index_t         length[2];                        // the position of the 0 terminating the last field
+  NMEA_index_t         headerLength;
+  uint8_t              current;                          // the index of the last decoded sentence
+  uint64_t             numeric;                          // bit i-1: the value and the format of the field i are cached below
+  int64_t              value[GNSS_ARCHIVE_MAX_FIELDS];
+  struct number_format format[GNSS_ARCHIVE_MAX_FIELDS];
+};
+
+
+GNSSArchiveReader::GNSSArchiveReader(void) {
+  atMap      = NULL;
+  atSize     = 0;
+  atPosition = 0;
+  atTypes    = NULL;
+  atTypesCnt = 0;
+  atSkipped  = 0;
+}
+
+
+GNSSArchiveReader::~GNSSArchiveReader(void) {
+  this->close();
+}
+
+
+bool GNSSArchiveReader::isArchive(const char *paPath) {
+  char loHeader[GNSS_ARCHIVE_HEADER_SIZE];
+  bool loResult = false;
+  FILE *loFile;
+
+  if ((NULL != paPath) && (NULL != (loFile = fopen(paPath, "rb")))) {
+    loResult = (1 == fread(loHeader, sizeof(loHeader), 1, loFile)) && (!memcmp(loHeader, GNSS_ARCHIVE_MAGIC, sizeof(GNSS_ARCHIVE_MAGIC)));
+    fclose(loFile);
+  }
+  return (loResult);
+}
+
+
+int8_t GNSSArchiveReader::open(const char *paPath) {
+  struct stat loStat;
+  int loFd;
+  void *loMap;
+
+  this->close();
+  if (NULL == paPath) {
+    return (-1);
+  }
+  loFd = ::open(paPath, O_RDONLY);
+  if (0 > loFd) {
+    SETCOLORRED DBG("The archive file can not be opened\r\n"); NOCOLOR
+    return (-1);
+  }
+  if ((0 != fstat(loFd, &loStat)) || (GNSS_ARCHIVE_HEADER_SIZE > loStat.st_size)) {
+    SETCOLORRED DBG("The archive file is too short\r\n"); NOCOLOR
+    ::close(loFd);
+    return (-1);
+  }
+  loMap = mmap(NULL, (size_t)loStat.st_size, PROT_READ, MAP_PRIVATE, loFd, 0);
+  ::close(loFd);
+  if (MAP_FAILED == loMap) {
+    SETCOLORRED DBG("The archive file can not be mapped into the memory\r\n"); NOCOLOR
+    return (-1);
+  }
+  this->atMap  = (const uint8_t *)loMap;
+  this->atSize = (size_t)loStat.st_size;
+
+  if ((memcmp(this->atMap, GNSS_ARCHIVE_MAGIC, sizeof(GNSS_ARCHIVE_MAGIC))) || (GNSS_ARCHIVE_VERSION != this->atMap[7])) {
+    SETCOLORRED DBG("The file is not the archive file or its version is not supported\r\n"); NOCOLOR
+    this->close();
+    return (-1);
+  }
+  this->atTypes = new struct archive_type[GNSS_ARCHIVE_MAX_TYPES];
+  if (NULL == this->atTypes) {
+    SETCOLORRED DBG("Insufficient RAM space for the archive reader\r\n"); NOCOLOR
+    this->close();
+    return (-1);
+  }
+  madvise(loMap, this->atSize, MADV_SEQUENTIAL);
+  this->rewind();
+  return (0);
+}
+
+
+void GNSSArchiveReader::close(void) {
+  if (NULL != this->atMap) {
+    munmap((void *)this->atMap, this->atSize);
+    this->atMap  = NULL;
+    this->atSize = 0;
+  }
+  delete [] this->atTypes;
+  this->atTypes = NULL;
+}
+
+
+void GNSSArchiveReader::rewind(void) {
+  this->atPosition = GNSS_ARCHIVE_HEADER_SIZE;
+  this->atTypesCnt = 0;
+  this->atSkipped  = 0;
+}
+
+
+// it returns 1 if the record is decoded, 0 at the end of the archive or -1 if the archive is damaged
+int8_t GNSSArchiveReader::next_record(int16_t *paType, const char **paLiteral, size_t *paLength, uint8_t *paEnding) {
+  struct archive_type *loType;
+  struct NMEA_fields *loLast;
+  struct NMEA_fields *loNext;
+  const uint8_t *loMap = this->atMap;
+  size_t loPosition = this->atPosition;
+  size_t loLength;
+  uint64_t loTag;
+  uint64_t loMask;
+  uint64_t loValue;
+  uint64_t loWord;
+  uint64_t loXor = 0;
+  uint8_t loFlags;
+  uint8_t loChSum;
+  uint8_t n, i;
+  NMEA_index_t loUsed;
+  NMEA_index_t loLastEnd;
+
+// the varint at the current position (the record is damaged if it is cut)
+#define ARCHIVE_VARINT(value) { n = get_varint(loMap + loPosition, this->atSize - loPosition, &(value)); if (0 == n) return (-1); loPosition += n; }
+
+  if (NULL == loMap) {
+    return (-1);
+  }
+  while (true) {
+    if (loPosition >= this->atSize) {
+      this->atPosition = loPosition;
+      return (0);
+    }
+    ARCHIVE_VARINT(loTag);
+    if (0 == loTag) { // the literal line
+      ARCHIVE_VARINT(loValue);
+      if (loValue > (this->atSize - loPosition)) {
+        return (-1);
+      }
+      *paType    = -1;
+      *paLiteral = (const char *)loMap + loPosition;
+      *paLength  = (size_t)loValue;
+      this->atPosition = loPosition + (size_t)loValue;
+      return (1);
+    }
+    if (1 != loTag) {
+      break;
+    }
+    // the new sentence type - the header is written to both the sentences of the type
+    ARCHIVE_VARINT(loValue);
+    if ((GNSS_ARCHIVE_MAX_TYPES == this->atTypesCnt) || (loValue > (this->atSize - loPosition)) || ((MAXMESSAGELENGTH - 8) <= loValue)) {
+      return (-1);
+    }
+    loType = &this->atTypes[this->atTypesCnt++];
+    for (i = 0; i < 2; i++) {
+      memcpy(loType->slices[i].message, loMap + loPosition, (size_t)loValue);
+      loType->slices[i].message[loValue] = 0;
+      loType->slices[i].field_index[0] = 0;
+      loType->slices[i].cnt = 0;
+      loType->length[i] = (NMEA_index_t)loValue;
+    }
+    loType->headerLength = (NMEA_index_t)loValue;
+    loType->current      = 0;
+    loType->numeric      = 0;
+    loPosition += (size_t)loValue;
+  }
+
+  // the sentence of the known type
+  if ((loTag - 2) >= this->atTypesCnt) {
+    return (-1);
+  }
+  loType    = &this->atTypes[loTag - 2];
+  loLast    = &loType->slices[loType->current];
+  loNext    = &loType->slices[loType->current ^ 1];
+  loLastEnd = loType->length[loType->current];
+  if (loPosition >= this->atSize) {
+    return (-1);
+  }
+  loFlags = loMap[loPosition++];
+  loNext->cnt = loLast->cnt;
+  if (loFlags & 4) {
+    if (loPosition >= this->atSize) {
+      return (-1);
+    }
+    loNext->cnt = loMap[loPosition++];
+  }
+  if ((3 <= (loFlags & 3)) || (0 == loNext->cnt) || (GNSS_ARCHIVE_MAX_FIELDS < loNext->cnt) || (MAXFIELDSINMESSAGE < loNext->cnt)) {
+    return (-1);
+  }
+  ARCHIVE_VARINT(loMask);
+
+  // the header is already there, the fields are taken from the record or from the last sentence of the type
+  loUsed = loType->headerLength;
+  for (i = 1; i < loNext->cnt; i++) {
+    uint64_t loBit = ((uint64_t)1) << (i - 1);
+    const char *loField;
+
+    loUsed++;
+    loNext->field_index[i] = loUsed;
+    if (0 == (loMask & loBit)) { // not changed
+      if (i >= loLast->cnt) {
+        return (-1);
+      }
+      loField  = loLast->message + loLast->field_index[i];
+      loLength = (((i + 1) < loLast->cnt) ? (loLast->field_index[i+1] - 1) : loLastEnd) - loLast->field_index[i];
+    } else {
+      ARCHIVE_VARINT(loValue);
+      if (1 == loValue) { // the difference from the last value
+        ARCHIVE_VARINT(loValue);
+        if (0 == (loType->numeric & loBit)) {
+          if ((i >= loLast->cnt) || (!parse_number(loLast->message + loLast->field_index[i], &loType->value[i], &loType->format[i]))) {
+            return (-1);
+          }
+          loType->numeric |= loBit;
+        }
+        if ((MAXMESSAGELENGTH - 8 - 21) <= loUsed) { // the longest number
+          return (-1);
+        }
+        loType->value[i] += unzigzag(loValue);
+        loUsed += format_number(loType->value[i], &loType->format[i], loNext->message + loUsed);
+        continue;
+      }
+      loType->numeric &= ~loBit;
+      if (0 == loValue) {
+        loField  = "";
+        loLength = 0;
+      } else {
+        loLength = (size_t)(loValue - 2);
+        if (loLength > (this->atSize - loPosition)) {
+          return (-1);
+        }
+        loField = (const char *)loMap + loPosition;
+        loPosition += loLength;
+      }
+    }
+    if ((MAXMESSAGELENGTH - 8) <= (loUsed + loLength)) { // the place for '*', HH, "\r\n" and 0
+      return (-1);
+    }
+    memcpy(loNext->message + loUsed, loField, loLength);
+    loUsed += loLength;
+    loNext->message[loUsed] = 0;
+  }
+  for (; i < GNSS_ARCHIVE_MAX_FIELDS; i++) { // the fields the next sentence doesn't have are not cached
+    loType->numeric &= ~(((uint64_t)1) << (i - 1));
+  }
+
+  // the check sum of the text form (without the initial '$'): the fields are separated with 0 here, so the ',' characters are added
+  // to the sum separately (the even number of them gives 0) - the message is XOR-ed with the 64-bit words
+  for (loLength = 1; (loLength + 8) <= loUsed; loLength += 8) {
+    memcpy(&loWord, loNext->message + loLength, 8);
+    loXor ^= loWord;
+  }
+  loXor ^= loXor >> 32;
+  loXor ^= loXor >> 16;
+  loXor ^= loXor >> 8;
+  loChSum = (uint8_t)loXor;
+  for (; loLength < loUsed; loLength++) {
+    loChSum ^= (uint8_t)loNext->message[loLength];
+  }
+  if (0 == (loNext->cnt & 1)) { // cnt - 1 commas
+    loChSum ^= ',';
+  }
+  loNext->chSum = (int8_t)loChSum;
+  loNext->message[loUsed + 1] = HEX_DIGITS[loChSum >> 4];
+  loNext->message[loUsed + 2] = HEX_DIGITS[loChSum & 0x0F];
+  memcpy(loNext->message + loUsed + 3, "\r\n", 3);
+  loType->length[loType->current ^ 1] = loUsed;
+  loType->current ^= 1;
+
+  *paType   = (int16_t)(loTag - 2);
+  *paEnding = loFlags & 3;
+  this->atPosition = loPosition;
+  return (1);
+#undef ARCHIVE_VARINT
+}
+
+
+long GNSSArchiveReader::readLine(char *paLine, size_t paSize) {
+  const struct archive_type *loType;
+  const struct NMEA_fields *loSlices;
+  const char *loLiteral;
+  size_t loLength;
+  int16_t loTypeIndex;
+  uint8_t loEnding;
+  uint8_t i;
+  int8_t loResult;
+
+  loResult = this->next_record(&loTypeIndex, &loLiteral, &loLength, &loEnding);
+  if (1 != loResult) {
+    return (loResult);
+  }
+  if (0 > loTypeIndex) {
+    if (loLength > paSize) {
+      return (-1);
+    }
+    memcpy(paLine, loLiteral, loLength);
+    return ((long)loLength);
+  }
+
+  // the text form of the sentence: the fields are separated with 0 and the last one is followed by 0 (instead of '*') and the check sum
+  loType   = &this->atTypes[loTypeIndex];
+  loSlices = &loType->slices[loType->current];
+  loLength = loType->length[loType->current] + 3;
+  if ((loLength + 2) > paSize) {
+    return (-1);
+  }
+  memcpy(paLine, loSlices->message, loLength);
+  for (i = 1; i < loSlices->cnt; i++) {
+    paLine[loSlices->field_index[i] - 1] = ',';
+  }
+  paLine[loLength - 3] = '*';
+  if (0 == loEnding) {
+    paLine[loLength++] = '\r';
+  }
+  if (2 > loEnding) {
+    paLine[loLength++] = '\n';
+  }
+  return ((long)loLength);
+}
+
+
+int8_t GNSSArchiveReader::readSlices(const struct NMEA_fields **paSlices) {
+  const char *loLiteral;
+  size_t loLength;
+  int16_t loType;
+  uint8_t loEnding;
+  int8_t loResult;
+
+  while (1 == (loResult = this->next_record(&loType, &loLiteral, &loLength, &loEnding))) {
+    if (0 <= loType) {
+      *paSlices = &this->atTypes[loType].slices[this->atTypes[loType].current];
+      return (1);
+    }
+    if (0 == GNSSEpochSplitter::sliceLine(loLiteral, loLength, &this->atLiteral)) {
+      *paSlices = &this->atLiteral;
+      return (1);
+    }
+    this->atSkipped++;
+  }
+  return (loResult);
+}
+
+#endif // linux
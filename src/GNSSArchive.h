@@ -0,0 +1,147 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef GNSS_ARCHIVE_H
+#define GNSS_ARCHIVE_H
+
+#include "ultimateGNSSParser.h"
+
+// The NMEA archive is available on linux only, the file is compiled to nothing on the other platforms.
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include <stddef.h>
+#include "GNSSReplay.h"
+
+/***************************************************************************************************************************************************
+ ************************************************************** the archive file format ************************************************************
+ ***************************************************************************************************************************************************/
+
+// The header (8 bytes):
+//   "GNSSARC"                  7 bytes  - the magic
+//   version                    1 byte   - GNSS_ARCHIVE_VERSION
+// Then the records follow up to the end of the file (every record is the single line of the log):
+//   tag                        varint   - 0: the literal line, 1: the new sentence type, 2+N: the sentence of the type N
+//   the literal line (tag 0):  varint length + the bytes of the line with its terminator (the lines which can not be coded exactly)
+//   the new type (tag 1):      varint length + the header field (e.g. "$GPGGA") - the types are numbered from 0 in the order of the file
+//   the sentence (tag 2+N):    flags byte - bits 0-1: the terminator (0: "\r\n", 1: "\n", 2: none - the last line), bit 2: the field count follows
+//                              [count byte] - the number of the fields including the header (when it differs from the previous sentence of the type)
+//                              varint mask  - bit i-1 is set when the field i differs from the previous sentence of the type
+//                              the changed fields: varint 0 - the empty field,
+//                                                  varint 1 + zigzag varint - the numeric field as the difference of its digits from the previous value
+//                                                           (e.g. 4916.4512 -> 4916.4519 is +7), the format (digits, decimal point) of the previous value is kept
+//                                                  varint 2+L + L bytes - the literal field
+// The check sum is not stored - it is computed again (upper case hex digits) when the sentence is decoded, so only the sentences
+// with the correct check sum written with the upper case are coded as the sentences (the rest is stored literally - byte-exact anyway).
+#define GNSS_ARCHIVE_VERSION    1
+#define GNSS_ARCHIVE_MAX_TYPES  64   // the sentences of the next types are stored literally
+#define GNSS_ARCHIVE_MAX_FIELDS 65   // the header and 64 fields (the mask is 64 bits)
+
+
+/***************************************************************************************************************************************************
+ ************************************************************** the archive writer *****************************************************************
+ ***************************************************************************************************************************************************/
+
+// The raw log is given with write() in any pieces - the lines are assembled inside. The records are written to the file with the 64 KiB buffer.
+class GNSSArchiveWriter {
+private:
+  int                 atFd;
+  uint8_t            *atBuffer;
+  size_t              atUsed;
+  char               *atLine;        // the line being assembled
+  size_t              atLineLength;
+  size_t              atLineCapacity;
+  struct NMEA_fields *atTypes;       // the previous sentence of every type
+  uint8_t             atTypesCnt;
+  uint64_t            atLines;
+  uint64_t            atLiterals;
+  uint64_t            atInputBytes;
+  uint64_t            atOutputBytes;
+
+  int8_t write_buffer(void);
+  int8_t reserve(size_t paLength);
+  int8_t put_literal(const char *paLine, size_t paLength);
+  int8_t put_line(const char *paLine, size_t paLength);
+
+public:
+  GNSSArchiveWriter(void);
+  ~GNSSArchiveWriter(void);
+
+  // it creates (or truncates) the archive file and writes the header - returns 0 on success, -1 otherwise
+  int8_t open(const char *paPath);
+  // it stores the last (not terminated) line, writes all the records and closes the file - returns 0 on success, -1 on the write error
+  int8_t close(void);
+
+  // it archives the raw bytes of the log - returns 0 on success, -1 on the write error or if the file is not opened
+  int8_t write(const char *paData, size_t paLength);
+
+  // the raw data callback to be given to GNSSCollector::setRawCallback() with the writer as the user data
+  static void rawCallback(const char *paData, uint16_t paLength, void *paWriter);
+
+  inline uint64_t getLines(void)       { return this->atLines; };
+  inline uint64_t getLiterals(void)    { return this->atLiterals; };    // the lines stored literally
+  inline uint64_t getInputBytes(void)  { return this->atInputBytes; };
+  inline uint64_t getOutputBytes(void) { return this->atOutputBytes; };
+};
+
+
+/***************************************************************************************************************************************************
+ ************************************************************** the archive reader *****************************************************************
+ ***************************************************************************************************************************************************/
+
+// The archive file is mapped into the memory. The sentences are decoded straight into the sliced form (struct NMEA_fields),
+// so they can be given to GNSSCollector::parseSentence() or GNSSEpochSplitter::putSlices() without the text being sliced again.
+class GNSSArchiveReader {
+private:
+  const uint8_t       *atMap;
+  size_t               atSize;
+  size_t               atPosition;
+  struct archive_type *atTypes;     // the last sentence of every type (see GNSSArchive.cpp)
+  uint8_t              atTypesCnt;
+  struct NMEA_fields   atLiteral;   // the literal line sliced by readSlices()
+  uint64_t             atSkipped;
+
+  // it decodes the next record: the sentence (*paType is the type) or the literal line (*paType is -1)
+  int8_t next_record(int16_t *paType, const char **paLiteral, size_t *paLength, uint8_t *paEnding);
+
+public:
+  GNSSArchiveReader(void);
+  ~GNSSArchiveReader(void);
+
+  // it maps the archive file into the memory and checks the header - returns 0 on success, -1 otherwise
+  int8_t open(const char *paPath);
+  void   close(void);
+  // it moves back to the first record
+  void   rewind(void);
+
+  // It gives the next line exactly as it has been archived (with its terminator, not terminated with 0).
+  // It returns the length of the line, 0 at the end of the archive or -1 if the archive is damaged or the buffer is too small.
+  long   readLine(char *paLine, size_t paSize);
+  // It gives the next sentence in the sliced form (valid up to the next call). The literal lines are sliced here - the lines which are not
+  // the correct NMEA sentences are skipped (see getSkipped). It returns 1 if the sentence is given, 0 at the end of the archive or -1 if the archive is damaged.
+  int8_t readSlices(const struct NMEA_fields **paSlices);
+
+  inline uint64_t getSkipped(void) { return this->atSkipped; };
+
+  // it returns true if the file starts with the archive header
+  static bool isArchive(const char *paPath);
+};
+
+#endif // linux
+
+#endif
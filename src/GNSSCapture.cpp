@@ -0,0 +1,416 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "GNSSCapture.h"
+
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define GNSS_CAPTURE_BUFFER_SIZE (64*1024)
+
+static const char GNSS_CAPTURE_MAGIC[7] = {'G', 'N', 'S', 'S', 'C', 'A', 'P'};
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ********************************************************* the unsigned LEB128 varint coding  ******************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+// it returns the number of the bytes written (10 bytes at most)
+static inline uint8_t put_varint(uint8_t *paBuffer, uint64_t paValue) {
+  uint8_t i = 0;
+
+  while (0x80 <= paValue) {
+    paBuffer[i++] = (uint8_t)(paValue | 0x80);
+    paValue >>= 7;
+  }
+  paBuffer[i++] = (uint8_t)paValue;
+  return (i);
+}
+
+// it returns the number of the bytes read or 0 if the varint is damaged or cut by the end of the buffer
+static inline uint8_t get_varint(const uint8_t *paBuffer, size_t paSize, uint64_t *paValue) {
+  uint64_t loValue = 0;
+  uint8_t i;
+
+  for (i = 0; (i < paSize) && (i < 10); i++) {
+    loValue |= ((uint64_t)(paBuffer[i] & 0x7F)) << (7 * i);
+    if (0 == (paBuffer[i] & 0x80)) {
+      *paValue = loValue;
+      return (i + 1);
+    }
+  }
+  return (0);
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ *************************************************************** the capture recorder  *************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+GNSSCaptureWriter::GNSSCaptureWriter(void) {
+  atFd            = -1;
+  atBuffer        = NULL;
+  atUsed          = 0;
+  atStartUs       = 0;
+  atLastUs        = 0;
+  atPendingUs     = 0;
+  atPendingLength = 0;
+  atCoalesceUs    = 1000;
+}
+
+
+GNSSCaptureWriter::~GNSSCaptureWriter(void) {
+  this->close();
+}
+
+
+uint64_t GNSSCaptureWriter::getTimeUs(void) {
+  struct timespec loNow;
+  clock_gettime(CLOCK_MONOTONIC, &loNow);
+  return (((uint64_t)loNow.tv_sec) * 1000000 + loNow.tv_nsec / 1000);
+}
+
+
+int8_t GNSSCaptureWriter::open(const char *paPath) {
+  struct timespec loWallTime;
+  uint64_t loWallUs;
+  uint8_t i;
+
+  this->close();
+  if (NULL == paPath) {
+    return (-1);
+  }
+  this->atBuffer = new uint8_t[GNSS_CAPTURE_BUFFER_SIZE];
+  if (NULL == this->atBuffer) {
+    SETCOLORRED DBG("Insufficient RAM space for the capture buffer\r\n"); NOCOLOR
+    return (-1);
+  }
+  this->atFd = ::open(paPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (0 > this->atFd) {
+    SETCOLORRED DBG("The capture file can not be created\r\n"); NOCOLOR
+    delete [] this->atBuffer;
+    this->atBuffer = NULL;
+    return (-1);
+  }
+
+  clock_gettime(CLOCK_REALTIME, &loWallTime);
+  loWallUs = ((uint64_t)loWallTime.tv_sec) * 1000000 + loWallTime.tv_nsec / 1000;
+  memcpy(this->atBuffer, GNSS_CAPTURE_MAGIC, sizeof(GNSS_CAPTURE_MAGIC));
+  this->atBuffer[7] = GNSS_CAPTURE_VERSION;
+  for (i = 0; i < 8; i++) {
+    this->atBuffer[8 + i] = (uint8_t)(loWallUs >> (8 * i));
+  }
+  this->atUsed          = GNSS_CAPTURE_HEADER_SIZE;
+  this->atStartUs       = GNSSCaptureWriter::getTimeUs();
+  this->atLastUs        = 0;
+  this->atPendingLength = 0;
+  return (0);
+}
+
+
+int8_t GNSSCaptureWriter::write_buffer(void) {
+  size_t loWritten = 0;
+  ssize_t n;
+
+  while (loWritten < this->atUsed) {
+    n = ::write(this->atFd, this->atBuffer + loWritten, this->atUsed - loWritten);
+    if (0 > n) {
+      if (EINTR == errno) {
+        continue;
+      }
+      SETCOLORRED DBG("The capture file write error\r\n"); NOCOLOR
+      return (-1);
+    }
+    loWritten += n;
+  }
+  this->atUsed = 0;
+  return (0);
+}
+
+
+int8_t GNSSCaptureWriter::store_pending(void) {
+  if (0 == this->atPendingLength) {
+    return (0);
+  }
+  if ((GNSS_CAPTURE_BUFFER_SIZE - 20) < (this->atUsed + this->atPendingLength)) { // 20 bytes for the two varints
+    if (this->write_buffer()) {
+      return (-1);
+    }
+  }
+  if (this->atPendingUs < this->atLastUs) { // the time given by the caller has gone back
+    this->atPendingUs = this->atLastUs;
+  }
+  this->atUsed += put_varint(this->atBuffer + this->atUsed, this->atPendingUs - this->atLastUs);
+  this->atUsed += put_varint(this->atBuffer + this->atUsed, this->atPendingLength);
+  memcpy(this->atBuffer + this->atUsed, this->atPending, this->atPendingLength);
+  this->atUsed += this->atPendingLength;
+  this->atLastUs = this->atPendingUs;
+  this->atPendingLength = 0;
+  return (0);
+}
+
+
+int8_t GNSSCaptureWriter::write(const char *paData, size_t paLength, uint64_t paTimeUs) {
+  uint64_t loTime;
+  size_t n;
+
+  if ((0 > this->atFd) || (NULL == paData)) {
+    return (-1);
+  }
+  loTime = (paTimeUs > this->atStartUs) ? (paTimeUs - this->atStartUs) : 0;
+
+  while (0 < paLength) {
+    if ((0 < this->atPendingLength)
+       && ((GNSS_CAPTURE_MAX_RECORD == this->atPendingLength) || (loTime < this->atPendingUs) || ((loTime - this->atPendingUs) >= this->atCoalesceUs))) {
+      if (this->store_pending()) {
+        return (-1);
+      }
+    }
+    if (0 == this->atPendingLength) {
+      this->atPendingUs = loTime;
+    }
+    n = GNSS_CAPTURE_MAX_RECORD - this->atPendingLength;
+    if (n > paLength) {
+      n = paLength;
+    }
+    memcpy(this->atPending + this->atPendingLength, paData, n);
+    this->atPendingLength += n;
+    paData   += n;
+    paLength -= n;
+  }
+  return (0);
+}
+
+
+int8_t GNSSCaptureWriter::write(const char *paData, size_t paLength) {
+  return (this->write(paData, paLength, GNSSCaptureWriter::getTimeUs()));
+}
+
+
+int8_t GNSSCaptureWriter::flush(void) {
+  if (0 > this->atFd) {
+    return (-1);
+  }
+  if (this->store_pending()) {
+    return (-1);
+  }
+  return (this->write_buffer());
+}
+
+
+void GNSSCaptureWriter::close(void) {
+  if (0 <= this->atFd) {
+    this->flush();
+    ::close(this->atFd);
+    this->atFd = -1;
+  }
+  if (NULL != this->atBuffer) {
+    delete [] this->atBuffer;
+    this->atBuffer = NULL;
+  }
+}
+
+
+void GNSSCaptureWriter::rawCallback(const char *paData, uint16_t paLength, void *paWriter) {
+  ((GNSSCaptureWriter *)paWriter)->write(paData, paLength);
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ **************************************************************** the capture replay  **************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+GNSSCaptureReader::GNSSCaptureReader(void) {
+  atMap         = NULL;
+  atSize        = 0;
+  atPosition    = 0;
+  atTimeUs      = 0;
+  atStartWallUs = 0;
+}
+
+
+GNSSCaptureReader::~GNSSCaptureReader(void) {
+  this->close();
+}
+
+
+int8_t GNSSCaptureReader::open(const char *paPath) {
+  struct stat loStat;
+  int loFd;
+  void *loMap;
+  uint8_t i;
+
+  this->close();
+  if (NULL == paPath) {
+    return (-1);
+  }
+  loFd = ::open(paPath, O_RDONLY);
+  if (0 > loFd) {
+    SETCOLORRED DBG("The capture file can not be opened\r\n"); NOCOLOR
+    return (-1);
+  }
+  if ((0 != fstat(loFd, &loStat)) || (GNSS_CAPTURE_HEADER_SIZE > loStat.st_size)) {
+    SETCOLORRED DBG("The capture file is too short\r\n"); NOCOLOR
+    ::close(loFd);
+    return (-1);
+  }
+  loMap = mmap(NULL, (size_t)loStat.st_size, PROT_READ, MAP_PRIVATE, loFd, 0);
+  ::close(loFd);
+  if (MAP_FAILED == loMap) {
+    SETCOLORRED DBG("The capture file can not be mapped into the memory\r\n"); NOCOLOR
+    return (-1);
+  }
+  this->atMap  = (const uint8_t *)loMap;
+  this->atSize = (size_t)loStat.st_size;
+
+  if ((memcmp(this->atMap, GNSS_CAPTURE_MAGIC, sizeof(GNSS_CAPTURE_MAGIC))) || (GNSS_CAPTURE_VERSION != this->atMap[7])) {
+    SETCOLORRED DBG("The file is not the capture file or its version is not supported\r\n"); NOCOLOR
+    this->close();
+    return (-1);
+  }
+  this->atStartWallUs = 0;
+  for (i = 0; i < 8; i++) {
+    this->atStartWallUs |= ((uint64_t)this->atMap[8 + i]) << (8 * i);
+  }
+  madvise(loMap, this->atSize, MADV_SEQUENTIAL);
+  this->rewind();
+  return (0);
+}
+
+
+void GNSSCaptureReader::close(void) {
+  if (NULL != this->atMap) {
+    munmap((void *)this->atMap, this->atSize);
+    this->atMap  = NULL;
+    this->atSize = 0;
+  }
+}
+
+
+void GNSSCaptureReader::rewind(void) {
+  this->atPosition = GNSS_CAPTURE_HEADER_SIZE;
+  this->atTimeUs   = 0;
+}
+
+
+int8_t GNSSCaptureReader::next(const char **paData, uint32_t *paLength, uint64_t *paTimeUs) {
+  uint64_t loDelta;
+  uint64_t loLength;
+  uint8_t n;
+
+  if ((NULL == this->atMap) || (NULL == paData) || (NULL == paLength) || (NULL == paTimeUs)) {
+    return (-1);
+  }
+  if (this->atPosition >= this->atSize) {
+    return (0);
+  }
+  n = get_varint(this->atMap + this->atPosition, this->atSize - this->atPosition, &loDelta);
+  if (0 == n) {
+    return (-1);
+  }
+  this->atPosition += n;
+  n = get_varint(this->atMap + this->atPosition, this->atSize - this->atPosition, &loLength);
+  if ((0 == n) || (0 == loLength) || (GNSS_CAPTURE_MAX_RECORD < loLength) || ((this->atSize - this->atPosition - n) < loLength)) {
+    SETCOLORRED DBG("The capture file is damaged\r\n"); NOCOLOR
+    return (-1);
+  }
+  this->atPosition += n;
+  this->atTimeUs   += loDelta;
+
+  *paData   = (const char *)(this->atMap + this->atPosition);
+  *paLength = (uint32_t)loLength;
+  *paTimeUs = this->atTimeUs;
+  this->atPosition += loLength;
+  return (1);
+}
+
+
+int32_t GNSSCaptureReader::replay(GNSSCollector *paCollector, float paSpeed) {
+  struct timespec loStart, loWakeUp;
+  const char *loData;
+  uint32_t loLength;
+  uint64_t loTimeUs;
+  uint64_t loFirstUs = 0;
+  uint64_t loDelayNs;
+  uint32_t loNowMs = 0;
+  int32_t loEpochs = 0;
+  bool loFirst = true;
+  int8_t loResult;
+  int8_t n;
+
+  if (NULL == paCollector) {
+    return (-1);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &loStart);
+
+  while (1 == (loResult = this->next(&loData, &loLength, &loTimeUs))) {
+    if (loFirst) {
+      loFirstUs = loTimeUs;
+      loFirst = false;
+    }
+    if (0 < paSpeed) { // the records are given at the recorded times (divided by the speed)
+      loDelayNs = (uint64_t)((loTimeUs - loFirstUs) * 1000.0 / paSpeed);
+      loWakeUp.tv_sec  = loStart.tv_sec + (time_t)(loDelayNs / 1000000000);
+      loWakeUp.tv_nsec = loStart.tv_nsec + (long)(loDelayNs % 1000000000);
+      if (1000000000 <= loWakeUp.tv_nsec) {
+        loWakeUp.tv_sec  += 1;
+        loWakeUp.tv_nsec -= 1000000000;
+      }
+      while (EINTR == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &loWakeUp, NULL)) {
+        ;
+      }
+    }
+    // the collector gets the recorded time, so the breaks between the packs of messages are the same at any speed
+    loNowMs = (uint32_t)(loTimeUs / 1000);
+    while (0 < loLength) {
+      uint16_t loPart = (0xFFFF < loLength) ? 0xFFFF : (uint16_t)loLength;
+      n = paCollector->feed(loData, loPart, loNowMs);
+      if (0 < n) {
+        loEpochs += n;
+      }
+      loData   += loPart;
+      loLength -= loPart;
+    }
+  }
+  if (0 > loResult) {
+    return (-1);
+  }
+  if (!loFirst) { // the break after the last record completes the last epoch
+    n = paCollector->feed(NULL, 0, loNowMs + paCollector->getBreakTime());
+    if (0 < n) {
+      loEpochs += n;
+    }
+  }
+  return (loEpochs);
+}
+
+#endif // linux
@@ -0,0 +1,134 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef GNSS_CAPTURE_H
+#define GNSS_CAPTURE_H
+
+#include "ultimateGNSSParser.h"
+
+// The capture of the raw receiver traffic with the receive timestamps is available on linux only,
+// the file is compiled to nothing on the other platforms.
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include <stddef.h>
+
+/***************************************************************************************************************************************************
+ ************************************************************** the capture file format ************************************************************
+ ***************************************************************************************************************************************************/
+
+// The header (16 bytes):
+//   "GNSSCAP"                  7 bytes  - the magic
+//   version                    1 byte   - GNSS_CAPTURE_VERSION
+//   start time                 8 bytes  - the wall clock time of the capture start [us since 1970-01-01, little endian]
+// Then the records follow up to the end of the file:
+//   delta time                 varint   - the monotonic time since the previous record [us] (since the capture start for the first one)
+//   length                     varint   - the number of the bytes (greater than 0)
+//   data                       length bytes - the raw bytes received
+// The varint is the unsigned LEB128 (7 bits per byte, the least significant group first, the highest bit set in all but the last byte).
+#define GNSS_CAPTURE_VERSION      1
+#define GNSS_CAPTURE_HEADER_SIZE  16
+#define GNSS_CAPTURE_MAX_RECORD   4096   // the bytes received within the coalescing time are stored as the single record
+
+
+/***************************************************************************************************************************************************
+ ************************************************************** the capture recorder ***************************************************************
+ ***************************************************************************************************************************************************/
+
+// The bytes received within the coalescing time (1 ms by default - the resolution of the break detection) are stored
+// as the single record with the time of the first one, so recording the single bytes (e.g. from collectData()) costs
+// only the clock reading and the copy. The records are written to the file with the 64 KiB buffer.
+class GNSSCaptureWriter {
+private:
+  int       atFd;
+  uint8_t  *atBuffer;         // the records waiting for the write() call
+  size_t    atUsed;
+  uint64_t  atStartUs;        // the monotonic time of the capture start
+  uint64_t  atLastUs;         // the time of the last record stored in the buffer (relative to atStartUs)
+  uint64_t  atPendingUs;      // the time of the first byte of the pending record (relative to atStartUs)
+  uint32_t  atPendingLength;
+  uint32_t  atCoalesceUs;
+  char      atPending[GNSS_CAPTURE_MAX_RECORD];
+
+  int8_t store_pending(void);
+  int8_t write_buffer(void);
+
+public:
+  GNSSCaptureWriter(void);
+  ~GNSSCaptureWriter(void);
+
+  // it creates (or truncates) the capture file and writes the header - returns 0 on success, -1 otherwise
+  int8_t open(const char *paPath);
+  // it writes all the records and closes the file
+  void   close(void);
+
+  // the bytes received within this time are stored as the single record (0 - every call makes the separate record)
+  inline void setCoalesceTime(uint32_t paMicroseconds) { this->atCoalesceUs = paMicroseconds; };
+
+  // it records the bytes received now (CLOCK_MONOTONIC) - returns 0 on success, -1 on the write error or if the file is not opened
+  int8_t write(const char *paData, size_t paLength);
+  // it records the bytes received at the given monotonic time [us] (e.g. the time taken just after the read() call)
+  int8_t write(const char *paData, size_t paLength, uint64_t paTimeUs);
+  // it writes the buffered records to the file
+  int8_t flush(void);
+
+  // the raw data callback to be given to GNSSCollector::setRawCallback() with the writer as the user data
+  static void rawCallback(const char *paData, uint16_t paLength, void *paWriter);
+  // the monotonic time [us]
+  static uint64_t getTimeUs(void);
+};
+
+
+/***************************************************************************************************************************************************
+ ************************************************************** the capture replay *****************************************************************
+ ***************************************************************************************************************************************************/
+
+// The capture file is mapped into the memory. The replay feeds the collector (GNSSCollector::feed) with the recorded bytes
+// and the recorded times, so the collector sees the original gaps between the bytes (and makes the same epochs) at any speed.
+class GNSSCaptureReader {
+private:
+  const uint8_t *atMap;
+  size_t         atSize;
+  size_t         atPosition;
+  uint64_t       atTimeUs;       // the time of the last record read (since the capture start)
+  uint64_t       atStartWallUs;
+
+public:
+  GNSSCaptureReader(void);
+  ~GNSSCaptureReader(void);
+
+  // it maps the capture file into the memory and checks the header - returns 0 on success, -1 otherwise
+  int8_t open(const char *paPath);
+  void   close(void);
+  // it moves back to the first record
+  void   rewind(void);
+
+  // it gives the next record: returns 1 if the record is given, 0 at the end of the file or -1 if the file is damaged
+  int8_t next(const char **paData, uint32_t *paLength, uint64_t *paTimeUs);
+
+  // it feeds the collector with all the records: paSpeed 1.0 is the real time, N is N times faster, 0 is the maximum speed
+  // the epochs are given with the epoch callback of the collector (the sentence callbacks work too)
+  // it returns the number of the epochs completed or -1 if the file is damaged
+  int32_t replay(GNSSCollector *paCollector, float paSpeed);
+
+  inline uint64_t getStartWallTimeUs(void) { return this->atStartWallUs; };
+};
+
+#endif // linux
+
+#endif
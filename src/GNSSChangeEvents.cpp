@@ -0,0 +1,244 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "GNSSChangeEvents.h"
+#include <math.h>
+
+#define CHANGE_EARTH_RADIUS  6371008.8      // the mean radius of the Earth [m]
+#define CHANGE_DEG_TO_RAD    0.017453292519943295
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ************************************************************** the change detector  ***************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+GNSSChangeDetector::GNSSChangeDetector(GNSS_change_callback paCallback, void *paUserData) {
+  atCallback = paCallback;
+  atUserData = paUserData;
+  atMask     = GNSS_EVENT_ALL;
+  atFixHold  = 1;
+  atMoveM    = 0;
+  atEpochs   = 0;
+  atEvents   = 0;
+  set_level(&atSats, 0, 0, 1, true);
+  set_level(&atHDOP, 0, 0, 1, false);
+  set_level(&atAccuracy, 0, 0, 1, false);
+  this->reset();
+}
+
+
+void GNSSChangeDetector::reset(void) {
+  this->atStarted  = false;
+  this->atFix      = false;
+  this->atFixCount = 0;
+  this->atStatus   = 0;
+  this->atQuality  = 0;
+  this->atMode     = 0;
+  this->atAnchored = false;
+  this->atSats.active     = false;
+  this->atSats.count      = 0;
+  this->atHDOP.active     = false;
+  this->atHDOP.count      = 0;
+  this->atAccuracy.active = false;
+  this->atAccuracy.count  = 0;
+}
+
+
+void GNSSChangeDetector::set_level(struct change_level *paLevel, double paThreshold, double paRecovery, uint8_t paHold, bool paBelow) {
+  paLevel->threshold = paThreshold;
+  paLevel->recovery  = paRecovery;
+  paLevel->hold      = (0 < paHold) ? paHold : 1;
+  paLevel->count     = 0;
+  paLevel->active    = false;
+  paLevel->enabled   = (0 != paThreshold);
+  paLevel->below     = paBelow;
+}
+
+
+void GNSSChangeDetector::setSatsThreshold(uint8_t paLow, uint8_t paRecovery, uint8_t paHoldEpochs) {
+  set_level(&this->atSats, paLow, (paRecovery < paLow) ? paLow : paRecovery, paHoldEpochs, true);
+}
+
+
+void GNSSChangeDetector::setHDOPThreshold(double paHigh, double paRecovery, uint8_t paHoldEpochs) {
+  set_level(&this->atHDOP, paHigh, (paRecovery > paHigh) ? paHigh : paRecovery, paHoldEpochs, false);
+}
+
+
+void GNSSChangeDetector::setAccuracyThreshold(double paHighM, double paRecoveryM, uint8_t paHoldEpochs) {
+  set_level(&this->atAccuracy, paHighM, (paRecoveryM > paHighM) ? paHighM : paRecoveryM, paHoldEpochs, false);
+}
+
+
+// it returns 1 when the value has crossed the threshold, -1 when it has returned to the recovery level or 0
+int8_t GNSSChangeDetector::level(struct change_level *paLevel, double paValue) {
+  bool loCrossed;
+
+  if (!paLevel->enabled) {
+    return (0);
+  }
+  if (!paLevel->active) {
+    loCrossed = paLevel->below ? (paValue < paLevel->threshold) : (paValue > paLevel->threshold);
+  } else {
+    loCrossed = paLevel->below ? (paValue >= paLevel->recovery) : (paValue <= paLevel->recovery);
+  }
+  if (!loCrossed) {
+    paLevel->count = 0;
+    return (0);
+  }
+  if (++paLevel->count < paLevel->hold) {
+    return (0);
+  }
+  paLevel->count  = 0;
+  paLevel->active = !paLevel->active;
+  return (paLevel->active ? 1 : -1);
+}
+
+
+uint8_t GNSSChangeDetector::emit(struct GNSS_change_event *paEvent, uint16_t paType) {
+  if (0 == (this->atMask & paType)) {
+    return (0);
+  }
+  paEvent->type = paType;
+  this->atEvents++;
+  if (NULL != this->atCallback) {
+    this->atCallback(paEvent, this->atUserData);
+  }
+  return (1);
+}
+
+
+uint8_t GNSSChangeDetector::update(const struct GNSS_data *paData) {
+  struct GNSS_change_event loEvent;
+  bool loGGA, loPosition, loFix;
+  uint8_t loEvents = 0;
+  int8_t loLevel;
+
+  if (NULL == paData) {
+    return (0);
+  }
+  this->atEpochs++;
+  loEvent.previous = 0;
+  loEvent.code     = 0;
+  loEvent.value    = 0;
+  loEvent.timeMs   = GNSSCollector::getUnixTimeMs(paData);
+  loEvent.data     = paData;
+
+  // the codes (only the ones received in this epoch are compared)
+  loGGA      = (0 < paData->msgs_rcvd[MSG_GGA]);
+  loPosition = (0 < paData->msgs_rcvd[MSG_RMC]) || (0 < paData->msgs_rcvd[MSG_GLL]);
+  if (loPosition && (0 != paData->pos_status) && (paData->pos_status != this->atStatus)) {
+    if (this->atStarted && (0 != this->atStatus)) {
+      loEvent.previous = this->atStatus;
+      loEvent.code     = paData->pos_status;
+      loEvents += this->emit(&loEvent, GNSS_EVENT_STATUS);
+    }
+    this->atStatus = paData->pos_status;
+  }
+  if (loGGA && (0 != paData->quality) && (paData->quality != this->atQuality)) {
+    if (this->atStarted && (0 != this->atQuality)) {
+      loEvent.previous = this->atQuality;
+      loEvent.code     = paData->quality;
+      loEvents += this->emit(&loEvent, GNSS_EVENT_QUALITY);
+    }
+    this->atQuality = paData->quality;
+  }
+  if ((0 < paData->msgs_rcvd[MSG_GSA]) && (0 != paData->mode123) && (paData->mode123 != this->atMode)) {
+    if (this->atStarted && (0 != this->atMode)) {
+      loEvent.previous = this->atMode;
+      loEvent.code     = paData->mode123;
+      loEvents += this->emit(&loEvent, GNSS_EVENT_MODE);
+    }
+    this->atMode = paData->mode123;
+  }
+  loEvent.previous = 0;
+  loEvent.code     = 0;
+
+  // the fix state (the first epoch gives the initial state at once)
+  if (loGGA || loPosition) {
+    loFix = (!loGGA || ('0' < paData->quality)) && (!loPosition || ('A' == paData->pos_status));
+    if (!this->atStarted || ((loFix != this->atFix) && (++this->atFixCount >= this->atFixHold))) {
+      this->atFix      = loFix;
+      this->atFixCount = 0;
+      loEvents += this->emit(&loEvent, loFix ? GNSS_EVENT_FIX_REGAINED : GNSS_EVENT_FIX_LOST);
+    } else if (loFix == this->atFix) {
+      this->atFixCount = 0;
+    }
+    this->atStarted = true;
+  }
+
+  // the thresholds
+  if (loGGA) {
+    loLevel = this->level(&this->atSats, paData->sats);
+    if (0 != loLevel) {
+      loEvent.value = paData->sats;
+      loEvents += this->emit(&loEvent, (0 < loLevel) ? GNSS_EVENT_SATS_LOW : GNSS_EVENT_SATS_OK);
+    }
+  }
+  if (loGGA || (0 < paData->msgs_rcvd[MSG_GSA])) {
+    loLevel = this->level(&this->atHDOP, paData->hdop);
+    if (0 != loLevel) {
+      loEvent.value = paData->hdop;
+      loEvents += this->emit(&loEvent, (0 < loLevel) ? GNSS_EVENT_HDOP_HIGH : GNSS_EVENT_HDOP_OK);
+    }
+  }
+  if (0 < paData->msgs_rcvd[MSG_GST]) {
+    double loStdDev = sqrt((paData->lat_std_dev * paData->lat_std_dev) + (paData->lon_std_dev * paData->lon_std_dev));
+
+    loLevel = this->level(&this->atAccuracy, loStdDev);
+    if (0 != loLevel) {
+      loEvent.value = loStdDev;
+      loEvents += this->emit(&loEvent, (0 < loLevel) ? GNSS_EVENT_ACCURACY_LOW : GNSS_EVENT_ACCURACY_OK);
+    }
+  }
+
+  // the distance from the position of the last GNSS_EVENT_MOVED (the local plane is good enough for the short distances)
+  if ((0 < this->atMoveM) && this->atFix && (0 != paData->lat_dir) && (0 != paData->lon_dir)) {
+    double loLat = GNSSCollector::getLatitude(paData);
+    double loLon = GNSSCollector::getLongitude(paData);
+
+    if (!this->atAnchored) {
+      this->atAnchorLat = loLat;
+      this->atAnchorLon = loLon;
+      this->atAnchored  = true;
+    } else {
+      double loNorth = (loLat - this->atAnchorLat) * CHANGE_DEG_TO_RAD * CHANGE_EARTH_RADIUS;
+      double loEast  = (loLon - this->atAnchorLon) * CHANGE_DEG_TO_RAD * CHANGE_EARTH_RADIUS * cos(loLat * CHANGE_DEG_TO_RAD);
+
+      loEvent.value = sqrt((loNorth * loNorth) + (loEast * loEast));
+      if (loEvent.value >= this->atMoveM) {
+        this->atAnchorLat = loLat;
+        this->atAnchorLon = loLon;
+        loEvents += this->emit(&loEvent, GNSS_EVENT_MOVED);
+      }
+    }
+  }
+  return (loEvents);
+}
+
+
+void GNSSChangeDetector::epochCallback(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paDetector) {
+  (void)paGSVData;
+  if (NULL != paDetector) {
+    ((GNSSChangeDetector *)paDetector)->update(paData);
+  }
+}
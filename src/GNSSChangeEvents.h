@@ -0,0 +1,124 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef GNSS_CHANGE_EVENTS_H
+#define GNSS_CHANGE_EVENTS_H
+
+#include "ultimateGNSSParser.h"
+
+/***************************************************************************************************************************************************
+ ************************************************************** the change events ******************************************************************
+ ***************************************************************************************************************************************************/
+
+// the types of the events (the bits of the mask, see GNSSChangeDetector::setMask)
+#define GNSS_EVENT_FIX_LOST        0x0001   // the position is not valid any more ($xxGGA quality 0 or $xxRMC/$xxGLL status V) or in the first epoch
+#define GNSS_EVENT_FIX_REGAINED    0x0002   // the position is valid again (or valid in the first epoch)
+#define GNSS_EVENT_STATUS          0x0004   // pos_status has changed (code: A or V)
+#define GNSS_EVENT_QUALITY         0x0008   // quality has changed (code: '0' - '9', e.g. RTK float '5' -> fixed '4')
+#define GNSS_EVENT_MODE            0x0010   // mode123 has changed (code: '1' - '3')
+#define GNSS_EVENT_SATS_LOW        0x0020   // the number of the satellites has dropped below the threshold (value: sats)
+#define GNSS_EVENT_SATS_OK         0x0040   // the number of the satellites is back at the recovery level
+#define GNSS_EVENT_HDOP_HIGH       0x0080   // HDOP has risen above the threshold (value: HDOP)
+#define GNSS_EVENT_HDOP_OK         0x0100   // HDOP is back at the recovery level
+#define GNSS_EVENT_ACCURACY_LOW    0x0200   // the horizontal standard deviation of $xxGST has risen above the threshold (value: metres)
+#define GNSS_EVENT_ACCURACY_OK     0x0400   // the horizontal standard deviation is back at the recovery level
+#define GNSS_EVENT_MOVED           0x0800   // the position has moved by the given distance since the last event of this type (value: metres)
+#define GNSS_EVENT_ALL             0x0FFF
+
+struct GNSS_change_event {
+  uint16_t                type;       // GNSS_EVENT_xxx
+  char                    previous;   // the previous and the new code (GNSS_EVENT_STATUS, GNSS_EVENT_QUALITY and GNSS_EVENT_MODE)
+  char                    code;
+  double                  value;      // the value which has crossed the threshold (GNSS_EVENT_SATS_xxx, HDOP_xxx, ACCURACY_xxx and MOVED)
+  int64_t                 timeMs;     // the UTC time of the epoch (see GNSSCollector::getUnixTimeMs)
+  const struct GNSS_data *data;       // the whole epoch (valid only in the callback)
+};
+
+typedef void (*GNSS_change_callback)(const struct GNSS_change_event *paEvent, void *paUserData);
+
+// The detector compares every epoch with the previous one and gives only the changes to the callback - the downstream systems
+// don't have to get the whole epoch every time. The thresholds have the hysteresis: the "low"/"high" event is given when the value
+// crosses the threshold and stays there for the given number of the epochs, the "ok" event when the value reaches the recovery level
+// (also for the given number of the epochs), so the value oscillating around the threshold doesn't give the stream of the events.
+// The values not received in the epoch (e.g. no $xxGST) don't change the state. The fix lost/regained events have the hold too.
+class GNSSChangeDetector {
+private:
+  struct change_level {
+    double  threshold;    // the event is given when the value crosses it
+    double  recovery;     // the event of the return is given when the value reaches it
+    uint8_t hold;         // the number of the epochs the value has to stay there
+    uint8_t count;
+    bool    active;       // the value is beyond the threshold
+    bool    enabled;
+    bool    below;        // the threshold is the minimum (the number of the satellites), not the maximum
+  };
+
+  GNSS_change_callback atCallback;
+  void                *atUserData;
+  uint16_t             atMask;
+  bool                 atStarted;     // the first epoch has been given
+  bool                 atFix;
+  uint8_t              atFixCount;    // the epochs with the changed fix state
+  uint8_t              atFixHold;
+  char                 atStatus;
+  char                 atQuality;
+  char                 atMode;
+  struct change_level  atSats;
+  struct change_level  atHDOP;
+  struct change_level  atAccuracy;
+  double               atMoveM;
+  double               atAnchorLat;   // the position of the last GNSS_EVENT_MOVED
+  double               atAnchorLon;
+  bool                 atAnchored;
+  uint32_t             atEpochs;
+  uint32_t             atEvents;
+
+  uint8_t emit(struct GNSS_change_event *paEvent, uint16_t paType);
+  int8_t  level(struct change_level *paLevel, double paValue);
+  static void set_level(struct change_level *paLevel, double paThreshold, double paRecovery, uint8_t paHold, bool paBelow);
+
+public:
+  GNSSChangeDetector(GNSS_change_callback paCallback, void *paUserData = NULL);
+
+  // GNSS_EVENT_SATS_LOW below paLow satellites, GNSS_EVENT_SATS_OK at paRecovery satellites or more (0 - not checked)
+  void setSatsThreshold(uint8_t paLow, uint8_t paRecovery, uint8_t paHoldEpochs = 1);
+  // GNSS_EVENT_HDOP_HIGH above paHigh, GNSS_EVENT_HDOP_OK at paRecovery or less (0 - not checked)
+  void setHDOPThreshold(double paHigh, double paRecovery, uint8_t paHoldEpochs = 1);
+  // GNSS_EVENT_ACCURACY_LOW when sqrt(lat_std_dev^2 + lon_std_dev^2) is above paHighM, GNSS_EVENT_ACCURACY_OK at paRecoveryM or less
+  void setAccuracyThreshold(double paHighM, double paRecoveryM, uint8_t paHoldEpochs = 1);
+  // GNSS_EVENT_MOVED every paDistanceM metres (0 - not checked)
+  inline void setMoveThreshold(double paDistanceM) { this->atMoveM = paDistanceM; };
+  // the fix lost/regained events are given when the new state stays for the given number of the epochs
+  inline void setFixHold(uint8_t paHoldEpochs) { this->atFixHold = (0 < paHoldEpochs) ? paHoldEpochs : 1; };
+  // only the events of the given types are given (GNSS_EVENT_ALL by default)
+  inline void setMask(uint16_t paMask) { this->atMask = paMask; };
+
+  // it compares the epoch with the previous one - it returns the number of the events given to the callback
+  uint8_t update(const struct GNSS_data *paData);
+  // the state is forgotten - the next epoch is the first one
+  void    reset(void);
+
+  inline uint32_t getEpochs(void) { return this->atEpochs; };
+  inline uint32_t getEvents(void) { return this->atEvents; };
+
+  // the epoch callback (GNSSCollector::setEpochCallback) with the detector as the user data
+  static void epochCallback(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paDetector);
+};
+
+#endif
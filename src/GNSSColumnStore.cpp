@@ -0,0 +1,434 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "GNSSColumnStore.h"
+
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const char GNSS_COLUMN_MAGIC[7] = {'G', 'N', 'S', 'S', 'C', 'O', 'L'};
+static const uint8_t GNSS_COLUMN_SIZES[GNSS_COLUMNS] = {8, 8, 8, 8, 4, 4, 4, 4, 4, 4, 1, 1};
+
+// the columns start after the block header rounded up to the 64 bytes
+#define GNSS_COLUMN_BLOCK_HEADER_SIZE ((sizeof(struct GNSS_column_block) + 63) & ~((size_t)63))
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ *************************************************************** the column layout  ****************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+uint8_t GNSSColumnWriter::getColumnSize(uint8_t paColumn) {
+  return ((GNSS_COLUMNS > paColumn) ? GNSS_COLUMN_SIZES[paColumn] : 0);
+}
+
+
+uint64_t GNSSColumnWriter::getColumnOffset(uint32_t paBlockEpochs, uint8_t paColumn) {
+  uint64_t loOffset = GNSS_COLUMN_BLOCK_HEADER_SIZE;
+  uint8_t i;
+
+  for (i = 0; (i < paColumn) && (i < GNSS_COLUMNS); i++) {
+    loOffset += ((uint64_t)paBlockEpochs) * GNSS_COLUMN_SIZES[i];
+  }
+  return (loOffset);
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ************************************************************ the column store writer  *************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+GNSSColumnWriter::GNSSColumnWriter(void) {
+  atFd          = -1;
+  atBlock       = NULL;
+  atBlockEpochs = 0;
+  atBlockBytes  = 0;
+  atBlockIndex  = 0;
+  atEpochs      = 0;
+  atDirty       = false;
+}
+
+
+GNSSColumnWriter::~GNSSColumnWriter(void) {
+  this->close();
+}
+
+
+// the empty block: no epochs, no statistics
+static void clear_block(uint8_t *paBlock, uint64_t paBlockBytes) {
+  struct GNSS_column_block *loBlock = (struct GNSS_column_block *)paBlock;
+  uint8_t i;
+
+  memset(paBlock, 0, paBlockBytes);
+  for (i = 0; i < GNSS_COLUMNS; i++) {
+    loBlock->min[i] = NAN;
+    loBlock->max[i] = NAN;
+  }
+}
+
+
+int8_t GNSSColumnWriter::open(const char *paPath, uint32_t paBlockEpochs) {
+  struct GNSS_column_header loHeader;
+  struct stat loStat;
+
+  this->close();
+  if ((NULL == paPath) || (0 == paBlockEpochs)) {
+    return (-1);
+  }
+  paBlockEpochs = (paBlockEpochs + 7) & ~((uint32_t)7); // the columns stay aligned to 8 bytes
+  this->atBlockEpochs = paBlockEpochs;
+  this->atBlockBytes  = GNSSColumnWriter::getColumnOffset(paBlockEpochs, GNSS_COLUMNS);
+  this->atBlock = (uint8_t *)malloc(this->atBlockBytes);
+  if (NULL == this->atBlock) {
+    SETCOLORRED DBG("Insufficient RAM space for the column block\r\n"); NOCOLOR
+    return (-1);
+  }
+  this->atFd = ::open(paPath, O_RDWR | O_CREAT, 0644);
+  if ((0 > this->atFd) || (0 != fstat(this->atFd, &loStat))) {
+    SETCOLORRED DBG("The column store can not be opened\r\n"); NOCOLOR
+    this->close();
+    return (-1);
+  }
+  clear_block(this->atBlock, this->atBlockBytes);
+  this->atBlockIndex = 0;
+  this->atEpochs     = 0;
+  this->atDirty      = false;
+
+  if (0 == loStat.st_size) { // the new store
+    return (this->write_header());
+  }
+
+  // the existing store is continued
+  if (  (sizeof(loHeader) != pread(this->atFd, &loHeader, sizeof(loHeader), 0))
+     || (memcmp(loHeader.magic, GNSS_COLUMN_MAGIC, sizeof(GNSS_COLUMN_MAGIC))) || (GNSS_COLUMN_VERSION != loHeader.version)
+     || (GNSS_COLUMNS != loHeader.columns) || (paBlockEpochs != loHeader.blockEpochs) || (this->atBlockBytes != loHeader.blockBytes) ) {
+    SETCOLORRED DBG("The file is not the column store with the same block size\r\n"); NOCOLOR
+    this->close();
+    return (-1);
+  }
+  this->atEpochs     = loHeader.epochs;
+  this->atBlockIndex = loHeader.blocks;
+  if (0 < loHeader.blocks) {
+    if ((ssize_t)this->atBlockBytes != pread(this->atFd, this->atBlock, this->atBlockBytes, GNSS_COLUMN_HEADER_SIZE + (loHeader.blocks - 1) * this->atBlockBytes)) {
+      SETCOLORRED DBG("The column store is truncated\r\n"); NOCOLOR
+      this->close();
+      return (-1);
+    }
+    if (((struct GNSS_column_block *)this->atBlock)->count < this->atBlockEpochs) {
+      this->atBlockIndex--; // the last block is filled further
+    } else {
+      clear_block(this->atBlock, this->atBlockBytes);
+    }
+  }
+  return (0);
+}
+
+
+int8_t GNSSColumnWriter::close(void) {
+  int8_t loResult = 0;
+
+  if (0 <= this->atFd) {
+    loResult = this->flush();
+    if (::close(this->atFd)) {
+      loResult = -1;
+    }
+    this->atFd = -1;
+  }
+  free(this->atBlock);
+  this->atBlock = NULL;
+  return (loResult);
+}
+
+
+int8_t GNSSColumnWriter::write_header(void) {
+  struct GNSS_column_header loHeader;
+  char loSpace[GNSS_COLUMN_HEADER_SIZE];
+
+  memset(loSpace, 0, sizeof(loSpace));
+  memset(&loHeader, 0, sizeof(loHeader));
+  memcpy(loHeader.magic, GNSS_COLUMN_MAGIC, sizeof(GNSS_COLUMN_MAGIC));
+  loHeader.version     = GNSS_COLUMN_VERSION;
+  loHeader.blockEpochs = this->atBlockEpochs;
+  loHeader.columns     = GNSS_COLUMNS;
+  loHeader.blockBytes  = this->atBlockBytes;
+  loHeader.blocks      = this->atBlockIndex + ((0 < ((struct GNSS_column_block *)this->atBlock)->count) ? 1 : 0);
+  loHeader.epochs      = this->atEpochs;
+  memcpy(loSpace, &loHeader, sizeof(loHeader));
+  if (sizeof(loSpace) != pwrite(this->atFd, loSpace, sizeof(loSpace), 0)) {
+    SETCOLORRED DBG("The column store write error\r\n"); NOCOLOR
+    return (-1);
+  }
+  return (0);
+}
+
+
+int8_t GNSSColumnWriter::write_block(void) {
+  uint64_t loWritten = 0;
+  uint64_t loOffset = GNSS_COLUMN_HEADER_SIZE + this->atBlockIndex * this->atBlockBytes;
+  ssize_t n;
+
+  while (loWritten < this->atBlockBytes) {
+    n = pwrite(this->atFd, this->atBlock + loWritten, this->atBlockBytes - loWritten, loOffset + loWritten);
+    if (0 > n) {
+      if (EINTR == errno) {
+        continue;
+      }
+      SETCOLORRED DBG("The column store write error\r\n"); NOCOLOR
+      return (-1);
+    }
+    loWritten += n;
+  }
+  this->atDirty = false;
+  return (0);
+}
+
+
+int8_t GNSSColumnWriter::flush(void) {
+  if (0 > this->atFd) {
+    return (-1);
+  }
+  if ((this->atDirty) && (this->write_block())) {
+    return (-1);
+  }
+  return (this->write_header());
+}
+
+
+// it stores the value of the column and updates the statistics of the block (NaN is not counted)
+static inline void put_value(uint8_t *paBlock, uint32_t paBlockEpochs, uint8_t paColumn, uint32_t paIndex, double paValue, bool paCounted) {
+  struct GNSS_column_block *loBlock = (struct GNSS_column_block *)paBlock;
+  uint8_t *loColumn = paBlock + GNSSColumnWriter::getColumnOffset(paBlockEpochs, paColumn);
+
+  switch (GNSS_COLUMN_SIZES[paColumn]) {
+    case 8:
+      if (GNSS_COL_TIME == paColumn) {
+        ((int64_t *)loColumn)[paIndex] = (int64_t)paValue;
+      } else {
+        ((double *)loColumn)[paIndex] = paValue;
+      }
+      break;
+    case 4:
+      ((float *)loColumn)[paIndex] = (float)paValue;
+      break;
+    default:
+      loColumn[paIndex] = (uint8_t)paValue;
+      break;
+  }
+  if ((!paCounted) || (isnan(paValue))) {
+    return;
+  }
+  if ((isnan(loBlock->min[paColumn])) || (paValue < loBlock->min[paColumn])) {
+    loBlock->min[paColumn] = paValue;
+  }
+  if ((isnan(loBlock->max[paColumn])) || (paValue > loBlock->max[paColumn])) {
+    loBlock->max[paColumn] = paValue;
+  }
+}
+
+
+int8_t GNSSColumnWriter::append(const struct GNSS_data *paData) {
+  struct GNSS_column_block *loBlock = (struct GNSS_column_block *)this->atBlock;
+  uint32_t i;
+  int64_t loTime;
+  bool loGGA, loGSA, loRMC, loVTG, loGST;
+  double loSpeed = NAN;
+
+  if ((0 > this->atFd) || (NULL == paData)) {
+    return (-1);
+  }
+  i      = loBlock->count;
+  loTime = GNSSCollector::getUnixTimeMs(paData);
+  loGGA  = (0 < paData->msgs_rcvd[MSG_GGA]);
+  loGSA  = (0 < paData->msgs_rcvd[MSG_GSA]);
+  loRMC  = (0 < paData->msgs_rcvd[MSG_RMC]);
+  loVTG  = (0 < paData->msgs_rcvd[MSG_VTG]);
+  loGST  = (0 < paData->msgs_rcvd[MSG_GST]);
+  if (loVTG) {
+    loSpeed = paData->speed;
+  } else if (loRMC) {
+    loSpeed = paData->nautical_speed * 1.852;
+  }
+
+  put_value(this->atBlock, this->atBlockEpochs, GNSS_COL_TIME,        i, (double)loTime, (0 <= loTime));
+  put_value(this->atBlock, this->atBlockEpochs, GNSS_COL_LAT,         i, paData->lat_dir ? GNSSCollector::getLatitude(paData) : NAN, true);
+  put_value(this->atBlock, this->atBlockEpochs, GNSS_COL_LON,         i, paData->lon_dir ? GNSSCollector::getLongitude(paData) : NAN, true);
+  put_value(this->atBlock, this->atBlockEpochs, GNSS_COL_ALT,         i, loGGA ? paData->alt : NAN, true);
+  put_value(this->atBlock, this->atBlockEpochs, GNSS_COL_HDOP,        i, (loGGA || loGSA) ? paData->hdop : NAN, true);
+  put_value(this->atBlock, this->atBlockEpochs, GNSS_COL_LAT_STD_DEV, i, loGST ? paData->lat_std_dev : NAN, true);
+  put_value(this->atBlock, this->atBlockEpochs, GNSS_COL_LON_STD_DEV, i, loGST ? paData->lon_std_dev : NAN, true);
+  put_value(this->atBlock, this->atBlockEpochs, GNSS_COL_ALT_STD_DEV, i, loGST ? paData->alt_std_dev : NAN, true);
+  put_value(this->atBlock, this->atBlockEpochs, GNSS_COL_SPEED,       i, loSpeed, true);
+  put_value(this->atBlock, this->atBlockEpochs, GNSS_COL_TRACK,       i, (loRMC || loVTG) ? paData->true_track : NAN, true);
+  put_value(this->atBlock, this->atBlockEpochs, GNSS_COL_QUALITY,     i, (('0' <= paData->quality) && ('9' >= paData->quality)) ? (paData->quality - '0') : 0, true);
+  put_value(this->atBlock, this->atBlockEpochs, GNSS_COL_SATS,        i, paData->sats, true);
+
+  loBlock->count++;
+  this->atEpochs++;
+  this->atDirty = true;
+  if (loBlock->count == this->atBlockEpochs) { // the block is complete
+    if (this->write_block()) {
+      return (-1);
+    }
+    this->atBlockIndex++;
+    clear_block(this->atBlock, this->atBlockBytes);
+    return (this->write_header());
+  }
+  return (0);
+}
+
+
+void GNSSColumnWriter::epochCallback(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paWriter) {
+  (void)paGSVData;
+  if (NULL != paWriter) {
+    ((GNSSColumnWriter *)paWriter)->append(paData);
+  }
+}
+
+
+int8_t GNSSColumnWriter::epochSink(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paWriter) {
+  (void)paGSVData;
+  if (NULL == paWriter) {
+    return (0);
+  }
+  return ((((GNSSColumnWriter *)paWriter)->append(paData)) ? 1 : 0); // the replay is stopped on the write error
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ************************************************************ the column store reader  *************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+GNSSColumnReader::GNSSColumnReader(void) {
+  atMap    = NULL;
+  atSize   = 0;
+  atHeader = NULL;
+  atBlocks = 0;
+}
+
+
+GNSSColumnReader::~GNSSColumnReader(void) {
+  this->close();
+}
+
+
+int8_t GNSSColumnReader::open(const char *paPath) {
+  struct stat loStat;
+  int loFd;
+  void *loMap;
+
+  this->close();
+  if (NULL == paPath) {
+    return (-1);
+  }
+  loFd = ::open(paPath, O_RDONLY);
+  if (0 > loFd) {
+    SETCOLORRED DBG("The column store can not be opened\r\n"); NOCOLOR
+    return (-1);
+  }
+  if ((0 != fstat(loFd, &loStat)) || (GNSS_COLUMN_HEADER_SIZE > loStat.st_size)) {
+    SETCOLORRED DBG("The column store is too short\r\n"); NOCOLOR
+    ::close(loFd);
+    return (-1);
+  }
+  loMap = mmap(NULL, (size_t)loStat.st_size, PROT_READ, MAP_SHARED, loFd, 0);
+  ::close(loFd);
+  if (MAP_FAILED == loMap) {
+    SETCOLORRED DBG("The column store can not be mapped into the memory\r\n"); NOCOLOR
+    return (-1);
+  }
+  this->atMap    = (const uint8_t *)loMap;
+  this->atSize   = (size_t)loStat.st_size;
+  this->atHeader = (const struct GNSS_column_header *)loMap;
+
+  if (  (memcmp(this->atHeader->magic, GNSS_COLUMN_MAGIC, sizeof(GNSS_COLUMN_MAGIC))) || (GNSS_COLUMN_VERSION != this->atHeader->version)
+     || (GNSS_COLUMNS != this->atHeader->columns) || (0 == this->atHeader->blockEpochs)
+     || (GNSSColumnWriter::getColumnOffset(this->atHeader->blockEpochs, GNSS_COLUMNS) != this->atHeader->blockBytes) ) {
+    SETCOLORRED DBG("The file is not the column store or its version is not supported\r\n"); NOCOLOR
+    this->close();
+    return (-1);
+  }
+  // the blocks written after the header (by the writer working now) are not visible
+  this->atBlocks = (this->atSize - GNSS_COLUMN_HEADER_SIZE) / this->atHeader->blockBytes;
+  if (this->atBlocks > this->atHeader->blocks) {
+    this->atBlocks = this->atHeader->blocks;
+  }
+  return (0);
+}
+
+
+void GNSSColumnReader::close(void) {
+  if (NULL != this->atMap) {
+    munmap((void *)this->atMap, this->atSize);
+  }
+  this->atMap    = NULL;
+  this->atSize   = 0;
+  this->atHeader = NULL;
+  this->atBlocks = 0;
+}
+
+
+const struct GNSS_column_block *GNSSColumnReader::getBlock(uint64_t paBlock) {
+  if (paBlock >= this->atBlocks) {
+    return (NULL);
+  }
+  return ((const struct GNSS_column_block *)(this->atMap + GNSS_COLUMN_HEADER_SIZE + paBlock * this->atHeader->blockBytes));
+}
+
+
+const void *GNSSColumnReader::getColumn(uint64_t paBlock, uint8_t paColumn) {
+  if ((paBlock >= this->atBlocks) || (GNSS_COLUMNS <= paColumn)) {
+    return (NULL);
+  }
+  return (this->atMap + GNSS_COLUMN_HEADER_SIZE + paBlock * this->atHeader->blockBytes
+          + GNSSColumnWriter::getColumnOffset(this->atHeader->blockEpochs, paColumn));
+}
+
+
+uint64_t GNSSColumnReader::findBlock(int64_t paFromMs) {
+  uint64_t loLow = 0;
+  uint64_t loHigh = this->atBlocks;
+  uint64_t loMiddle;
+
+  // the first block with the latest epoch not before the given time (the blocks without the date are skipped as the earlier ones)
+  while (loLow < loHigh) {
+    loMiddle = (loLow + loHigh) / 2;
+    double loMax = this->getBlock(loMiddle)->max[GNSS_COL_TIME];
+    if ((isnan(loMax)) || (loMax < (double)paFromMs)) {
+      loLow = loMiddle + 1;
+    } else {
+      loHigh = loMiddle;
+    }
+  }
+  return (loLow);
+}
+
+#endif // linux
@@ -0,0 +1,165 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef GNSS_COLUMN_STORE_H
+#define GNSS_COLUMN_STORE_H
+
+#include "ultimateGNSSParser.h"
+
+// The columnar epoch store is available on linux only (the reader needs mmap), the file is compiled to nothing on the other platforms.
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include <stddef.h>
+
+/***************************************************************************************************************************************************
+ ************************************************************* the column store file format *********************************************************
+ ***************************************************************************************************************************************************/
+
+// The file (native byte order - little endian on the supported platforms):
+//   the header           GNSS_COLUMN_HEADER_SIZE bytes (struct GNSS_column_header)
+//   the blocks           blocks * blockBytes - the block of blockEpochs epochs:
+//                          struct GNSS_column_block   the number of the epochs and the min/max statistics of every column
+//                          the columns                blockEpochs values of every column one after another (see GNSS_COL_xxx)
+// All the blocks have the same size (the last one may be filled partially), so the block N is at
+// GNSS_COLUMN_HEADER_SIZE + N * blockBytes and the column is at the fixed offset inside the block.
+// The missing values (e.g. the standard deviations without $xxGST) are NaN, the time is -1 when the date is not known.
+#define GNSS_COLUMN_VERSION      1
+#define GNSS_COLUMN_HEADER_SIZE  64
+
+// the columns
+#define GNSS_COL_TIME            0    // int64_t  the UTC time [ms since 1970-01-01]
+#define GNSS_COL_LAT             1    // double   the signed latitude [deg]
+#define GNSS_COL_LON             2    // double   the signed longitude [deg]
+#define GNSS_COL_ALT             3    // double   the altitude [m]
+#define GNSS_COL_HDOP            4    // float
+#define GNSS_COL_LAT_STD_DEV     5    // float    [m] ($xxGST)
+#define GNSS_COL_LON_STD_DEV     6    // float    [m] ($xxGST)
+#define GNSS_COL_ALT_STD_DEV     7    // float    [m] ($xxGST)
+#define GNSS_COL_SPEED           8    // float    the speed over ground [km/h]
+#define GNSS_COL_TRACK           9    // float    the true track [deg]
+#define GNSS_COL_QUALITY        10    // uint8_t  the GGA quality (0-9)
+#define GNSS_COL_SATS           11    // uint8_t  the satellites used
+#define GNSS_COLUMNS            12
+
+struct GNSS_column_header {
+  char     magic[7];          // "GNSSCOL"
+  uint8_t  version;           // GNSS_COLUMN_VERSION
+  uint32_t blockEpochs;       // the capacity of the block (the multiple of 8)
+  uint32_t columns;           // GNSS_COLUMNS
+  uint64_t blockBytes;        // the size of the block
+  uint64_t blocks;            // the number of the blocks (including the last one filled partially)
+  uint64_t epochs;            // the number of the epochs
+};
+
+struct GNSS_column_block {
+  uint32_t count;             // the number of the epochs in the block
+  uint32_t reserved;
+  double   min[GNSS_COLUMNS]; // the statistics of the values which are not NaN (the time: the epochs with the known date)
+  double   max[GNSS_COLUMNS]; // (NaN when the block has no such value)
+};
+
+
+/***************************************************************************************************************************************************
+ ************************************************************* the column store writer **************************************************************
+ ***************************************************************************************************************************************************/
+
+// The epochs are appended to the block kept in the RAM, the block is written to its place in the file when it is full
+// and with flush() (the partial block is written again when more epochs are appended). The existing store is continued.
+class GNSSColumnWriter {
+private:
+  int       atFd;
+  uint8_t  *atBlock;          // the current block (struct GNSS_column_block + the columns)
+  uint32_t  atBlockEpochs;
+  uint64_t  atBlockBytes;
+  uint64_t  atBlockIndex;     // the index of the current block in the file
+  uint64_t  atEpochs;
+  bool      atDirty;          // the current block has the epochs not written yet
+
+  int8_t write_block(void);
+  int8_t write_header(void);
+
+public:
+  GNSSColumnWriter(void);
+  ~GNSSColumnWriter(void);
+
+  // It opens the store - the existing file with the same block size is continued, otherwise it is created.
+  // It returns 0 on success or -1 if the file can not be opened or it is not the store with the same block size.
+  int8_t open(const char *paPath, uint32_t paBlockEpochs = 4096);
+  // it writes the current block and closes the file - returns 0 on success, -1 on the write error
+  int8_t close(void);
+
+  // it appends the epoch - returns 0 on success, -1 on the write error or if the file is not opened
+  int8_t append(const struct GNSS_data *paData);
+  // it writes the current block (filled partially) and the header - the readers opened later see all the epochs
+  int8_t flush(void);
+
+  inline uint64_t getEpochs(void) { return this->atEpochs; };
+
+  // the epoch callback (GNSSCollector::setEpochCallback) and the replay sink (GNSSReplay::run) with the writer as the user data
+  static void   epochCallback(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paWriter);
+  static int8_t epochSink(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paWriter);
+
+  // the size of the column value [bytes] and the offset of the column in the block of the given capacity
+  static uint8_t  getColumnSize(uint8_t paColumn);
+  static uint64_t getColumnOffset(uint32_t paBlockEpochs, uint8_t paColumn);
+};
+
+
+/***************************************************************************************************************************************************
+ ************************************************************* the column store reader **************************************************************
+ ***************************************************************************************************************************************************/
+
+// The store is mapped into the memory, the columns are given as the pointers into the mapping (zero-copy), so only the pages
+// of the columns used (and the block headers) are read from the disk. The blocks can be skipped with their statistics.
+class GNSSColumnReader {
+private:
+  const uint8_t                   *atMap;
+  size_t                           atSize;
+  const struct GNSS_column_header *atHeader;
+  uint64_t                         atBlocks;  // the complete blocks within the mapping
+
+public:
+  GNSSColumnReader(void);
+  ~GNSSColumnReader(void);
+
+  // it maps the store into the memory - returns 0 on success or -1 if the file can not be mapped or it is not the column store
+  int8_t open(const char *paPath);
+  void   close(void);
+
+  inline uint64_t getBlocks(void)      { return this->atBlocks; };
+  inline uint32_t getBlockEpochs(void) { return (NULL != this->atHeader) ? this->atHeader->blockEpochs : 0; };
+
+  // the block header with the statistics (NULL if the block doesn't exist)
+  const struct GNSS_column_block *getBlock(uint64_t paBlock);
+  // the values of the column in the block (getBlock(paBlock)->count values) or NULL if the block doesn't exist
+  const void *getColumn(uint64_t paBlock, uint8_t paColumn);
+
+  inline const int64_t *getTime(uint64_t paBlock)    { return (const int64_t *)this->getColumn(paBlock, GNSS_COL_TIME); };
+  inline const double  *getLat(uint64_t paBlock)     { return (const double *)this->getColumn(paBlock, GNSS_COL_LAT); };
+  inline const double  *getLon(uint64_t paBlock)     { return (const double *)this->getColumn(paBlock, GNSS_COL_LON); };
+  inline const double  *getAlt(uint64_t paBlock)     { return (const double *)this->getColumn(paBlock, GNSS_COL_ALT); };
+  inline const uint8_t *getQuality(uint64_t paBlock) { return (const uint8_t *)this->getColumn(paBlock, GNSS_COL_QUALITY); };
+
+  // the first block which may have the epochs at or after the given time (the blocks are chronological) - getBlocks() if there is no such block
+  uint64_t findBlock(int64_t paFromMs);
+};
+
+#endif // linux
+
+#endif
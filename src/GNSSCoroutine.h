@@ -0,0 +1,168 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef GNSS_COROUTINE_H
+#define GNSS_COROUTINE_H
+
+#include "ultimateGNSSParser.h"
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ *********************************************** the C++20 coroutine interface of the GNSSCollector ***********************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+// This header needs the C++20 compiler with the coroutines support (e.g. g++ -std=c++20).
+// The GNSSAsyncCollector wraps the GNSSCollector fed with the non-blocking methods (process(), poll() or feed()) and gives the awaitables:
+//
+//   GNSSTask track(GNSSAsyncCollector &paGNSS) {
+//     while (true) {
+//       const struct GNSS_data *loFix = co_await paGNSS.next<MSG_GGA>(); // resumed right after the $xxGGA sentence is parsed
+//       if (NULL == loFix) co_return;                                       // the waiting has been cancelled
+//       ...
+//       const struct GNSS_data *loEpoch = co_await paGNSS.next_epoch();    // resumed when the whole epoch is collected
+//       ...
+//     }
+//   }
+//
+// The coroutines are resumed directly from the process()/poll()/feed() call (on the thread of your event loop), so one thread
+// can serve any number of receivers without blocking. The returned pointer is valid until the coroutine suspends again
+// (copy the data you need to keep for longer). Any number of coroutines can wait for the same event of the same receiver.
+//
+// The GNSSAsyncCollector takes over the epoch callback and the sentence callbacks of the awaited sentence types of the wrapped collector.
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define GNSS_COROUTINES_AVAILABLE
+#endif
+#endif
+
+#ifdef GNSS_COROUTINES_AVAILABLE
+
+#include <coroutine>
+#include <exception>
+
+// the fire-and-forget coroutine type: it starts immediately and its frame is released when it finishes
+struct GNSSTask {
+  struct promise_type {
+    GNSSTask get_return_object(void) noexcept { return {}; }
+    std::suspend_never initial_suspend(void) noexcept { return {}; }
+    std::suspend_never final_suspend(void) noexcept { return {}; }
+    void return_void(void) noexcept {}
+    void unhandled_exception(void) noexcept { std::terminate(); }
+  };
+};
+
+
+class GNSSAsyncCollector {
+public:
+  // the awaitable of the single event (the epoch or the particular sentence) - it lives in the frame of the waiting coroutine
+  class Awaiter {
+  public:
+    Awaiter(GNSSAsyncCollector *paOwner, uint8_t paEvent) : atOwner(paOwner), atEvent(paEvent), atNext(NULL), atResult(NULL) {}
+    bool await_ready(void) const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> paHandle) noexcept {
+      this->atHandle = paHandle;
+      this->atNext = this->atOwner->atWaiting[this->atEvent];
+      this->atOwner->atWaiting[this->atEvent] = this;
+    }
+    // NULL means the waiting has been cancelled (see GNSSAsyncCollector::cancel)
+    const struct GNSS_data *await_resume(void) const noexcept { return this->atResult; }
+  private:
+    friend class GNSSAsyncCollector;
+    GNSSAsyncCollector     *atOwner;
+    uint8_t                 atEvent;  // MSG_xxx or EPOCH_EVENT
+    Awaiter                *atNext;   // the next coroutine waiting for the same event
+    const struct GNSS_data *atResult;
+    std::coroutine_handle<> atHandle;
+  };
+  
+  explicit GNSSAsyncCollector(GNSSCollector &paCollector) : atCollector(paCollector) {
+    for (uint8_t i = 0; i <= EPOCH_EVENT; i++) {
+      this->atWaiting[i] = NULL;
+    }
+    this->atCollector.setEpochCallback(&GNSSAsyncCollector::epoch_callback, this);
+  }
+  
+  // the waiting coroutines are resumed with NULL result and the callbacks are unsubscribed
+  ~GNSSAsyncCollector(void) {
+    this->cancel();
+    this->atCollector.setEpochCallback(NULL, NULL);
+    for (uint8_t i = 0; i < MSG_MAX; i++) {
+      this->atCollector.setSentenceCallback(i, NULL, NULL);
+    }
+  }
+  
+  GNSSAsyncCollector(const GNSSAsyncCollector &) = delete;
+  GNSSAsyncCollector &operator=(const GNSSAsyncCollector &) = delete;
+  
+  // co_await next_epoch() - waits for the end of the epoch
+  Awaiter next_epoch(void) { return (Awaiter(this, EPOCH_EVENT)); }
+  
+  // co_await next<MSG_GGA>() - waits for the next successfully parsed sentence of the given type (MSG_GSV, MSG_GSA, MSG_RMC, ... MSG_GST)
+  template <uint8_t paMsgType> Awaiter next(void) {
+    static_assert(paMsgType < MSG_MAX, "next<>() needs the MSG_xxx sentence type");
+    this->atCollector.setSentenceCallback(paMsgType, &GNSSAsyncCollector::sentence_callback<paMsgType>, this);
+    return (Awaiter(this, paMsgType));
+  }
+  
+  // resumes all the waiting coroutines with NULL result (e.g. when the receiver has been disconnected)
+  void cancel(void) {
+    for (uint8_t i = 0; i <= EPOCH_EVENT; i++) {
+      this->wake(i, NULL);
+    }
+  }
+  
+  inline GNSSCollector &collector(void) { return (this->atCollector); }
+  
+private:
+  static const uint8_t EPOCH_EVENT = MSG_MAX;
+  
+  GNSSCollector &atCollector;
+  Awaiter       *atWaiting[EPOCH_EVENT + 1]; // the lists of the waiting coroutines by event
+  
+  // the list is detached before resuming, so the coroutines waiting again for the same event are resumed with the next one
+  void wake(uint8_t paEvent, const struct GNSS_data *paData) {
+    Awaiter *loAwaiter = this->atWaiting[paEvent];
+    Awaiter *loNext;
+    
+    this->atWaiting[paEvent] = NULL;
+    while (NULL != loAwaiter) {
+      loNext = loAwaiter->atNext; // the resumed coroutine may release the awaiter
+      loAwaiter->atResult = paData;
+      loAwaiter->atHandle.resume();
+      loAwaiter = loNext;
+    }
+  }
+  
+  static void epoch_callback(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paUserData) {
+    (void)paGSVData;
+    ((GNSSAsyncCollector *)paUserData)->wake(EPOCH_EVENT, paData);
+  }
+  
+  template <uint8_t paMsgType>
+  static void sentence_callback(const struct GNSS_data *paData, const struct NMEA_fields *paSlices, void *paUserData) {
+    (void)paSlices;
+    ((GNSSAsyncCollector *)paUserData)->wake(paMsgType, paData);
+  }
+};
+
+#endif /* GNSS_COROUTINES_AVAILABLE */
+
+#endif /* GNSS_COROUTINE_H */
@@ -0,0 +1,449 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "GNSSDecompressor.h"
+
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include <zlib.h>
+#ifdef GNSS_ZSTD
+#include <zstd.h>
+#endif
+
+#define GNSS_DECOMPRESSOR_INPUT_SIZE (128*1024)
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ************************************************************** the format detection  **************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+int8_t GNSSDecompressor::detect(const char *paPath) {
+  unsigned char loMagic[4] = {0, 0, 0, 0};
+  FILE *loFile;
+  size_t loRead;
+
+  if ((NULL == paPath) || (NULL == (loFile = fopen(paPath, "rb")))) {
+    return (-1);
+  }
+  loRead = fread(loMagic, 1, sizeof(loMagic), loFile);
+  fclose(loFile);
+  if ((2 <= loRead) && (0x1F == loMagic[0]) && (0x8B == loMagic[1])) {
+    return (GNSS_LOG_GZIP);
+  }
+  if ((4 == loRead) && (0x28 == loMagic[0]) && (0xB5 == loMagic[1]) && (0x2F == loMagic[2]) && (0xFD == loMagic[3])) {
+    return (GNSS_LOG_ZSTD);
+  }
+  return (GNSS_LOG_PLAIN);
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ************************************************************* the class constructor  **************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+GNSSDecompressor::GNSSDecompressor(void) {
+  atFile       = NULL;
+  atFormat     = GNSS_LOG_PLAIN;
+  atStream     = NULL;
+  atRing       = NULL;
+  atRingSize   = 0;
+  atHead       = 0;
+  atTail       = 0;
+  atInputBytes = 0;
+  atEnd        = false;
+  atError      = 0;
+  atStop       = false;
+  atRunning    = false;
+  pthread_mutex_init(&atMutex, NULL);
+  pthread_cond_init(&atDataCond, NULL);
+  pthread_cond_init(&atSpaceCond, NULL);
+}
+
+
+GNSSDecompressor::~GNSSDecompressor(void) {
+  this->close();
+  pthread_cond_destroy(&atSpaceCond);
+  pthread_cond_destroy(&atDataCond);
+  pthread_mutex_destroy(&atMutex);
+}
+
+
+int8_t GNSSDecompressor::open(const char *paPath, size_t paRingSize) {
+  int8_t loFormat;
+
+  this->close();
+  loFormat = GNSSDecompressor::detect(paPath);
+  if (0 > loFormat) {
+    SETCOLORRED DBG("The log file can not be opened\r\n"); NOCOLOR
+    return (-1);
+  }
+#ifndef GNSS_ZSTD
+  if (GNSS_LOG_ZSTD == loFormat) {
+    SETCOLORRED DBG("The zstd support is not compiled in (GNSS_ZSTD)\r\n"); NOCOLOR
+    return (-2);
+  }
+#endif
+  if (64*1024 > paRingSize) {
+    paRingSize = 64*1024;
+  }
+  this->atFile = fopen(paPath, "rb");
+  this->atRing = (char *)malloc(paRingSize);
+  if ((NULL == this->atFile) || (NULL == this->atRing)) {
+    SETCOLORRED DBG("The log file can not be opened or there is insufficient RAM space for the ring\r\n"); NOCOLOR
+    this->close();
+    return (-1);
+  }
+  this->atFormat = (uint8_t)loFormat;
+
+  if (GNSS_LOG_GZIP == this->atFormat) {
+    z_stream *loStream = (z_stream *)calloc(1, sizeof(z_stream));
+    if ((NULL == loStream) || (Z_OK != inflateInit2(loStream, 15 + 16))) { // the gzip header is expected
+      free(loStream);
+      this->close();
+      return (-1);
+    }
+    this->atStream = loStream;
+  }
+#ifdef GNSS_ZSTD
+  if (GNSS_LOG_ZSTD == this->atFormat) {
+    ZSTD_DStream *loStream = ZSTD_createDStream();
+    if ((NULL == loStream) || (ZSTD_isError(ZSTD_initDStream(loStream)))) {
+      ZSTD_freeDStream(loStream);
+      this->close();
+      return (-1);
+    }
+    this->atStream = loStream;
+  }
+#endif
+
+  this->atRingSize   = paRingSize;
+  this->atHead       = 0;
+  this->atTail       = 0;
+  this->atInputBytes = 0;
+  this->atEnd        = false;
+  this->atError      = 0;
+  this->atStop       = false;
+  if (pthread_create(&this->atThread, NULL, GNSSDecompressor::producer_entry, this)) {
+    SETCOLORRED DBG("The decompression thread can not be started\r\n"); NOCOLOR
+    this->close();
+    return (-1);
+  }
+  this->atRunning = true;
+  return (0);
+}
+
+
+void GNSSDecompressor::close(void) {
+  if (this->atRunning) {
+    pthread_mutex_lock(&this->atMutex);
+    this->atStop = true;
+    pthread_cond_broadcast(&this->atSpaceCond);
+    pthread_mutex_unlock(&this->atMutex);
+    pthread_join(this->atThread, NULL);
+    this->atRunning = false;
+  }
+  if (NULL != this->atStream) {
+    if (GNSS_LOG_GZIP == this->atFormat) {
+      inflateEnd((z_stream *)this->atStream);
+      free(this->atStream);
+    }
+#ifdef GNSS_ZSTD
+    if (GNSS_LOG_ZSTD == this->atFormat) {
+      ZSTD_freeDStream((ZSTD_DStream *)this->atStream);
+    }
+#endif
+    this->atStream = NULL;
+  }
+  if (NULL != this->atFile) {
+    fclose(this->atFile);
+    this->atFile = NULL;
+  }
+  free(this->atRing);
+  this->atRing     = NULL;
+  this->atRingSize = 0;
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ******************************************************* the ring of the decompressed data  ********************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+// the producer side: it waits for the free space and returns the contiguous free part of the ring (0 when the consumer asked to stop)
+size_t GNSSDecompressor::free_space(char **paSpace) {
+  size_t loFree = 0;
+  size_t loPosition;
+
+  pthread_mutex_lock(&this->atMutex);
+  while ((!this->atStop) && (this->atRingSize == (this->atHead - this->atTail))) {
+    pthread_cond_wait(&this->atSpaceCond, &this->atMutex);
+  }
+  if (!this->atStop) {
+    loPosition = this->atHead % this->atRingSize;
+    loFree     = this->atRingSize - (this->atHead - this->atTail);
+    if (loFree > (this->atRingSize - loPosition)) {
+      loFree = this->atRingSize - loPosition;
+    }
+    *paSpace = this->atRing + loPosition;
+  }
+  pthread_mutex_unlock(&this->atMutex);
+  return (loFree);
+}
+
+
+void GNSSDecompressor::commit(size_t paLength) {
+  if (0 == paLength) {
+    return;
+  }
+  pthread_mutex_lock(&this->atMutex);
+  this->atHead += paLength;
+  pthread_cond_signal(&this->atDataCond);
+  pthread_mutex_unlock(&this->atMutex);
+}
+
+
+// the consumer side: it waits for the data and returns the contiguous part of the ring (0 at the end of the log)
+size_t GNSSDecompressor::acquire(const char **paData) {
+  size_t loAvailable;
+  size_t loPosition;
+
+  pthread_mutex_lock(&this->atMutex);
+  while ((this->atHead == this->atTail) && (!this->atEnd)) {
+    pthread_cond_wait(&this->atDataCond, &this->atMutex);
+  }
+  loPosition  = this->atTail % this->atRingSize;
+  loAvailable = this->atHead - this->atTail;
+  if (loAvailable > (this->atRingSize - loPosition)) {
+    loAvailable = this->atRingSize - loPosition;
+  }
+  *paData = this->atRing + loPosition;
+  pthread_mutex_unlock(&this->atMutex);
+  return (loAvailable);
+}
+
+
+void GNSSDecompressor::release(size_t paLength) {
+  pthread_mutex_lock(&this->atMutex);
+  this->atTail += paLength;
+  pthread_cond_signal(&this->atSpaceCond);
+  pthread_mutex_unlock(&this->atMutex);
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ************************************************************** the producer thread  ***************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+void *GNSSDecompressor::producer_entry(void *paDecompressor) {
+  ((GNSSDecompressor *)paDecompressor)->producer();
+  return (NULL);
+}
+
+
+void GNSSDecompressor::producer(void) {
+  unsigned char *loInput = NULL;
+  size_t loInputLength = 0;
+  size_t loInputPosition = 0;
+  bool loFrameEnd = true;    // the compressed stream may end here (no gzip member or zstd frame has been started)
+  bool loMemberDone = false; // at least one gzip member has been decompressed
+  int8_t loError = 0;
+  char *loSpace;
+  size_t loFree;
+  size_t loRead;
+
+  if (GNSS_LOG_PLAIN != this->atFormat) {
+    loInput = (unsigned char *)malloc(GNSS_DECOMPRESSOR_INPUT_SIZE);
+    if (NULL == loInput) {
+      loError = -2;
+    }
+  }
+
+  while (0 == loError) {
+    loFree = this->free_space(&loSpace);
+    if (0 == loFree) {
+      break; // the consumer asked to stop
+    }
+
+    if (GNSS_LOG_PLAIN == this->atFormat) {
+      loRead = fread(loSpace, 1, loFree, this->atFile);
+      __atomic_store_n(&this->atInputBytes, this->atInputBytes + loRead, __ATOMIC_RELAXED);
+      this->commit(loRead);
+      if (0 == loRead) {
+        break;
+      }
+      continue;
+    }
+
+    if (loInputPosition == loInputLength) {
+      loInputLength   = fread(loInput, 1, GNSS_DECOMPRESSOR_INPUT_SIZE, this->atFile);
+      loInputPosition = 0;
+      __atomic_store_n(&this->atInputBytes, this->atInputBytes + loInputLength, __ATOMIC_RELAXED);
+      if (0 == loInputLength) {
+        if (!loFrameEnd) {
+          SETCOLORRED DBG("The compressed log is truncated\r\n"); NOCOLOR
+          loError = -2;
+        }
+        break;
+      }
+    }
+
+    if (GNSS_LOG_GZIP == this->atFormat) {
+      z_stream *loStream = (z_stream *)this->atStream;
+      int loResult;
+
+      loStream->next_in   = loInput + loInputPosition;
+      loStream->avail_in  = (uInt)(loInputLength - loInputPosition);
+      loStream->next_out  = (Bytef *)loSpace;
+      loStream->avail_out = (uInt)loFree;
+      loResult = inflate(loStream, Z_NO_FLUSH);
+      loInputPosition = loInputLength - loStream->avail_in;
+      this->commit(loFree - loStream->avail_out);
+      if (Z_STREAM_END == loResult) {
+        loFrameEnd   = true;
+        loMemberDone = true;
+        inflateReset(loStream); // the next gzip member may follow
+      } else if ((Z_OK == loResult) || (Z_BUF_ERROR == loResult)) {
+        loFrameEnd = false;
+      } else if (loFrameEnd && loMemberDone) {
+        break; // the garbage (e.g. the zero padding) after the last member is ignored
+      } else {
+        SETCOLORRED DBG("The gzip data is not correct\r\n"); NOCOLOR
+        loError = -2;
+      }
+    }
+#ifdef GNSS_ZSTD
+    if (GNSS_LOG_ZSTD == this->atFormat) {
+      ZSTD_inBuffer  loIn  = {loInput, loInputLength, loInputPosition};
+      ZSTD_outBuffer loOut = {loSpace, loFree, 0};
+      size_t loResult = ZSTD_decompressStream((ZSTD_DStream *)this->atStream, &loOut, &loIn);
+
+      loInputPosition = loIn.pos;
+      this->commit(loOut.pos);
+      if (ZSTD_isError(loResult)) {
+        SETCOLORRED DBG("The zstd data is not correct\r\n"); NOCOLOR
+        loError = -2;
+      } else {
+        loFrameEnd = (0 == loResult); // the next frame may follow
+      }
+    }
+#endif
+  }
+
+  free(loInput);
+  pthread_mutex_lock(&this->atMutex);
+  this->atError = loError;
+  this->atEnd   = true;
+  pthread_cond_broadcast(&this->atDataCond);
+  pthread_mutex_unlock(&this->atMutex);
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ****************************************************************** the consumer  ******************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+long GNSSDecompressor::read(char *paBuffer, size_t paLength) {
+  const char *loData;
+  size_t loAvailable;
+
+  if ((NULL == this->atRing) || (NULL == paBuffer)) {
+    return (-2);
+  }
+  loAvailable = this->acquire(&loData);
+  if (0 == loAvailable) {
+    return (this->atError);
+  }
+  if (loAvailable > paLength) {
+    loAvailable = paLength;
+  }
+  memcpy(paBuffer, loData, loAvailable);
+  this->release(loAvailable);
+  return ((long)loAvailable);
+}
+
+
+int8_t GNSSDecompressor::run(GNSSEpochSplitter *paSplitter) {
+  char loCarry[MAXMESSAGELENGTH];  // the line split by the end of the ring (the longer lines are rejected by the splitter anyway)
+  size_t loCarryLength = 0;
+  bool loCarryOverflow = false;
+  const char *loData;
+  const char *loLineEnd;
+  size_t loAvailable;
+  size_t loPosition;
+  size_t loLength;
+  int8_t loResult;
+
+  if ((NULL == this->atRing) || (NULL == paSplitter)) {
+    return (-2);
+  }
+  while (0 < (loAvailable = this->acquire(&loData))) {
+    for (loPosition = 0; loPosition < loAvailable; loPosition += loLength) {
+      loLineEnd = (const char *)memchr(loData + loPosition, '\n', loAvailable - loPosition);
+      loLength  = (NULL == loLineEnd) ? (loAvailable - loPosition) : (size_t)(loLineEnd - (loData + loPosition) + 1);
+
+      if ((NULL != loLineEnd) && (0 == loCarryLength) && (!loCarryOverflow)) {
+        loResult = paSplitter->putLine(loData + loPosition, loLength); // the whole line is in the ring
+      } else {
+        if ((loCarryLength + loLength) > sizeof(loCarry)) {
+          loCarryOverflow = true;
+        } else {
+          memcpy(loCarry + loCarryLength, loData + loPosition, loLength);
+          loCarryLength += loLength;
+        }
+        if (NULL == loLineEnd) {
+          continue; // the rest of the line is in the next part of the ring
+        }
+        loResult = paSplitter->putLine(loCarry, loCarryOverflow ? sizeof(loCarry) : loCarryLength);
+        loCarryLength   = 0;
+        loCarryOverflow = false;
+      }
+      if (0 > loResult) {
+        this->release(loAvailable);
+        return (1);
+      }
+    }
+    this->release(loAvailable);
+  }
+
+  if ((0 < loCarryLength) || (loCarryOverflow)) { // the last line without "\n"
+    if (0 > paSplitter->putLine(loCarry, loCarryOverflow ? sizeof(loCarry) : loCarryLength)) {
+      return (1);
+    }
+  }
+  if (0 > paSplitter->flush()) {
+    return (1);
+  }
+  return (this->atError);
+}
+
+#endif // linux
@@ -0,0 +1,98 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef GNSS_DECOMPRESSOR_H
+#define GNSS_DECOMPRESSOR_H
+
+#include "ultimateGNSSParser.h"
+
+// The streaming decompression of the compressed logs is available on linux only (it needs zlib and pthreads),
+// the file is compiled to nothing on the other platforms. The zstd archives are supported when GNSS_ZSTD is defined (link with -lzstd).
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include <stddef.h>
+#include <stdio.h>
+#include <pthread.h>
+#include "GNSSReplay.h"
+
+// the format of the log file (detected with the magic bytes)
+#define GNSS_LOG_PLAIN  0
+#define GNSS_LOG_GZIP   1
+#define GNSS_LOG_ZSTD   2
+
+/***************************************************************************************************************************************************
+ ********************************************** the streaming source of the compressed log (gzip, zstd or plain) ***********************************
+ ***************************************************************************************************************************************************/
+
+// The log is decompressed by the producer thread into the bounded ring, the consumer takes the decompressed bytes
+// with read() or directly from the ring with run(), so the RAM usage doesn't depend on the size of the log.
+// The concatenated gzip members (e.g. the rotated logs appended together) are decompressed one after another.
+class GNSSDecompressor {
+private:
+  FILE           *atFile;
+  uint8_t         atFormat;
+  void           *atStream;       // z_stream or ZSTD_DStream
+  char           *atRing;
+  size_t          atRingSize;
+  size_t          atHead;         // the number of the bytes written to the ring (the position is atHead % atRingSize)
+  size_t          atTail;         // the number of the bytes taken from the ring
+  uint64_t        atInputBytes;   // the number of the compressed bytes read from the file
+  bool            atEnd;          // the producer has written the last byte
+  int8_t          atError;        // 0 or -2 when the compressed data is not correct
+  bool            atStop;         // the consumer asked the producer to stop
+  bool            atRunning;      // the producer thread has been started
+  pthread_t       atThread;
+  pthread_mutex_t atMutex;
+  pthread_cond_t  atDataCond;     // the data has been written to the ring (or the end has been reached)
+  pthread_cond_t  atSpaceCond;    // the space has been released in the ring
+
+  void   producer(void);
+  static void *producer_entry(void *paDecompressor);
+  size_t free_space(char **paSpace);
+  void   commit(size_t paLength);
+  size_t acquire(const char **paData);
+  void   release(size_t paLength);
+
+public:
+  GNSSDecompressor(void);
+  ~GNSSDecompressor(void);
+
+  // It opens the log file and starts the producer thread. The format is detected with the magic bytes.
+  // It returns 0 on success, -1 if the file can not be opened or -2 if the format is not supported (zstd without GNSS_ZSTD).
+  int8_t open(const char *paPath, size_t paRingSize = 4*1024*1024);
+  void   close(void);
+
+  // it copies up to paLength decompressed bytes to the buffer - it returns the number of the bytes, 0 at the end of the log or -2 on the error
+  long   read(char *paBuffer, size_t paLength);
+  // It gives every line of the log to the splitter (the lines are taken directly from the ring, only the lines split by the end
+  // of the ring are copied). The last epoch is flushed at the end of the log.
+  // It returns 0 at the end of the log, 1 when the sink asked to stop or -2 when the compressed data is not correct.
+  int8_t run(GNSSEpochSplitter *paSplitter);
+
+  inline uint8_t  getFormat(void)      { return this->atFormat; };
+  inline uint64_t getInputBytes(void)  { return this->atInputBytes; }; // the compressed bytes read so far
+  inline uint64_t getOutputBytes(void) { return this->atTail; };       // the decompressed bytes taken by the consumer so far
+
+  // the format of the given file (GNSS_LOG_PLAIN, GNSS_LOG_GZIP or GNSS_LOG_ZSTD) or -1 if the file can not be read
+  static int8_t detect(const char *paPath);
+};
+
+#endif // linux
+
+#endif
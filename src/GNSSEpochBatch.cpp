@@ -0,0 +1,166 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "GNSSEpochBatch.h"
+#include <math.h>
+
+// the size of the array rounded up to the multiple of 64 bytes (the cache line, the widest vector)
+static size_t batch_array_size(uint32_t paCapacity, size_t paValueSize) {
+  return ((((size_t)paCapacity * paValueSize) + 63) & ~(size_t)63);
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ **************************************************************** the epoch batch  *****************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+GNSSEpochBatch::GNSSEpochBatch(struct GNSS_epoch_batch *paBatch, GNSS_batch_callback paCallback, void *paUserData) {
+  atBatch    = paBatch;
+  atCallback = paCallback;
+  atUserData = paUserData;
+  atEpochs   = 0;
+}
+
+
+int8_t GNSSEpochBatch::append(struct GNSS_epoch_batch *paBatch, const struct GNSS_data *paData) {
+  uint32_t i;
+  bool loGGA, loRMC, loVTG, loGST;
+
+  if ((NULL == paBatch) || (NULL == paData) || (paBatch->count >= paBatch->capacity)) {
+    return (-1);
+  }
+  i     = paBatch->count++;
+  loGGA = (0 < paData->msgs_rcvd[MSG_GGA]);
+  loRMC = (0 < paData->msgs_rcvd[MSG_RMC]);
+  loVTG = (0 < paData->msgs_rcvd[MSG_VTG]);
+  loGST = (0 < paData->msgs_rcvd[MSG_GST]);
+
+  if (NULL != paBatch->timeMs) {
+    paBatch->timeMs[i] = GNSSCollector::getUnixTimeMs(paData);
+  }
+  if (NULL != paBatch->lat) {
+    paBatch->lat[i] = paData->lat_dir ? GNSSCollector::getLatitude(paData) : NAN;
+  }
+  if (NULL != paBatch->lon) {
+    paBatch->lon[i] = paData->lon_dir ? GNSSCollector::getLongitude(paData) : NAN;
+  }
+  if (NULL != paBatch->alt) {
+    paBatch->alt[i] = loGGA ? paData->alt : NAN;
+  }
+  if (NULL != paBatch->undulation) {
+    paBatch->undulation[i] = loGGA ? paData->undulation : NAN;
+  }
+  if (NULL != paBatch->hdop) {
+    paBatch->hdop[i] = (loGGA || (0 < paData->msgs_rcvd[MSG_GSA])) ? (float)paData->hdop : NAN;
+  }
+  if (NULL != paBatch->latStdDev) {
+    paBatch->latStdDev[i] = loGST ? (float)paData->lat_std_dev : NAN;
+  }
+  if (NULL != paBatch->lonStdDev) {
+    paBatch->lonStdDev[i] = loGST ? (float)paData->lon_std_dev : NAN;
+  }
+  if (NULL != paBatch->altStdDev) {
+    paBatch->altStdDev[i] = loGST ? (float)paData->alt_std_dev : NAN;
+  }
+  if (NULL != paBatch->speed) {
+    paBatch->speed[i] = loVTG ? (float)paData->speed : (loRMC ? (float)(paData->nautical_speed * 1.852) : NAN);
+  }
+  if (NULL != paBatch->track) {
+    paBatch->track[i] = (loRMC || loVTG) ? (float)paData->true_track : NAN;
+  }
+  if (NULL != paBatch->quality) {
+    paBatch->quality[i] = (('0' <= paData->quality) && ('9' >= paData->quality)) ? (paData->quality - '0') : 0;
+  }
+  if (NULL != paBatch->sats) {
+    paBatch->sats[i] = paData->sats;
+  }
+  return (0);
+}
+
+
+int8_t GNSSEpochBatch::add(const struct GNSS_data *paData) {
+  if (GNSSEpochBatch::append(this->atBatch, paData)) {
+    return (-1);
+  }
+  this->atEpochs++;
+  if (this->atBatch->count < this->atBatch->capacity) {
+    return (0);
+  }
+  if (NULL != this->atCallback) {
+    this->atCallback(this->atBatch, this->atUserData);
+    this->atBatch->count = 0;
+  }
+  return (1);
+}
+
+
+void GNSSEpochBatch::flush(void) {
+  if ((0 < this->atBatch->count) && (NULL != this->atCallback)) {
+    this->atCallback(this->atBatch, this->atUserData);
+  }
+  this->atBatch->count = 0;
+}
+
+
+void GNSSEpochBatch::epochCallback(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paBatch) {
+  (void)paGSVData;
+  if (NULL != paBatch) {
+    ((GNSSEpochBatch *)paBatch)->add(paData);
+  }
+}
+
+
+int8_t GNSSEpochBatch::epochSink(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paBatch) {
+  (void)paGSVData;
+  if (NULL != paBatch) {
+    ((GNSSEpochBatch *)paBatch)->add(paData);
+  }
+  return (0);
+}
+
+
+size_t GNSSEpochBatch::getBufferSize(uint32_t paCapacity) {
+  return ((4 * batch_array_size(paCapacity, sizeof(double))) + batch_array_size(paCapacity, sizeof(int64_t)) +
+          (6 * batch_array_size(paCapacity, sizeof(float))) + (2 * batch_array_size(paCapacity, sizeof(uint8_t))));
+}
+
+
+void GNSSEpochBatch::setBuffer(struct GNSS_epoch_batch *paBatch, void *paBuffer, uint32_t paCapacity) {
+  uint8_t *loNext = (uint8_t *)paBuffer;
+
+  // the widest values first, so every array stays aligned
+  paBatch->timeMs     = (int64_t *)loNext;  loNext += batch_array_size(paCapacity, sizeof(int64_t));
+  paBatch->lat        = (double *)loNext;   loNext += batch_array_size(paCapacity, sizeof(double));
+  paBatch->lon        = (double *)loNext;   loNext += batch_array_size(paCapacity, sizeof(double));
+  paBatch->alt        = (double *)loNext;   loNext += batch_array_size(paCapacity, sizeof(double));
+  paBatch->undulation = (double *)loNext;   loNext += batch_array_size(paCapacity, sizeof(double));
+  paBatch->hdop       = (float *)loNext;    loNext += batch_array_size(paCapacity, sizeof(float));
+  paBatch->latStdDev  = (float *)loNext;    loNext += batch_array_size(paCapacity, sizeof(float));
+  paBatch->lonStdDev  = (float *)loNext;    loNext += batch_array_size(paCapacity, sizeof(float));
+  paBatch->altStdDev  = (float *)loNext;    loNext += batch_array_size(paCapacity, sizeof(float));
+  paBatch->speed      = (float *)loNext;    loNext += batch_array_size(paCapacity, sizeof(float));
+  paBatch->track      = (float *)loNext;    loNext += batch_array_size(paCapacity, sizeof(float));
+  paBatch->quality    = loNext;             loNext += batch_array_size(paCapacity, sizeof(uint8_t));
+  paBatch->sats       = loNext;
+  paBatch->capacity   = paCapacity;
+  paBatch->count      = 0;
+}
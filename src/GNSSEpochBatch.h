@@ -0,0 +1,86 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef GNSS_EPOCH_BATCH_H
+#define GNSS_EPOCH_BATCH_H
+
+#include "ultimateGNSSParser.h"
+#include <stddef.h>
+
+/***************************************************************************************************************************************************
+ ************************************************************** the epoch batch ********************************************************************
+ ***************************************************************************************************************************************************/
+
+// The epochs collected as the structure of arrays - the caller owns the arrays (capacity values each) and gives only the columns
+// it needs (the NULL arrays are not filled). The downstream filters, conversions and statistics run over the contiguous arrays.
+// The values not received in the epoch are NaN (the time is -1 when the date is not known, the quality and the satellites are 0),
+// the same as in the column store (GNSSColumnStore.h).
+struct GNSS_epoch_batch {
+  uint32_t  capacity;     // the length of every array
+  uint32_t  count;        // the number of the epochs stored
+  int64_t  *timeMs;       // the UTC time [ms since 1970-01-01]
+  double   *lat;          // the signed latitude [deg]
+  double   *lon;          // the signed longitude [deg]
+  double   *alt;          // the altitude above the geoid [m]
+  double   *undulation;   // the geoid separation [m] (alt + undulation is the height above the WGS84 ellipsoid)
+  float    *hdop;
+  float    *latStdDev;    // [m] ($xxGST)
+  float    *lonStdDev;    // [m] ($xxGST)
+  float    *altStdDev;    // [m] ($xxGST)
+  float    *speed;        // the speed over ground [km/h]
+  float    *track;        // the true track [deg]
+  uint8_t  *quality;      // the GGA quality (0-9)
+  uint8_t  *sats;         // the satellites used
+};
+
+// the batch is full (GNSSEpochBatch) - it is emptied when the callback returns
+typedef void (*GNSS_batch_callback)(const struct GNSS_epoch_batch *paBatch, void *paUserData);
+
+class GNSSEpochBatch {
+private:
+  struct GNSS_epoch_batch *atBatch;
+  GNSS_batch_callback      atCallback;
+  void                    *atUserData;
+  uint64_t                 atEpochs;
+
+public:
+  // The epochs are collected into the given batch. When it is full, it is given to the callback and emptied,
+  // without the callback add() returns -1 until the batch is emptied with reset().
+  GNSSEpochBatch(struct GNSS_epoch_batch *paBatch, GNSS_batch_callback paCallback = NULL, void *paUserData = NULL);
+
+  // it appends the epoch - it returns 1 if the batch has become full, 0 if not or -1 if the epoch doesn't fit in
+  int8_t add(const struct GNSS_data *paData);
+  // it gives the batch filled partially to the callback (e.g. at the end of the log) and empties it
+  void   flush(void);
+  inline void reset(void) { this->atBatch->count = 0; };
+  inline uint64_t getEpochs(void) { return this->atEpochs; };
+
+  // the epoch callback (GNSSCollector::setEpochCallback) and the replay sink (GNSSReplay::run) with the batch collector as the user data
+  static void   epochCallback(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paBatch);
+  static int8_t epochSink(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paBatch);
+
+  // it appends the epoch to the batch (without the callbacks) - it returns 0 on success or -1 if the batch is full
+  static int8_t append(struct GNSS_epoch_batch *paBatch, const struct GNSS_data *paData);
+  // The size of the single buffer for all the columns of the batch of the given capacity. setBuffer() points all the columns
+  // into the buffer (every array aligned to 64 bytes - give the buffer aligned to 64 bytes too) and empties the batch.
+  static size_t getBufferSize(uint32_t paCapacity);
+  static void   setBuffer(struct GNSS_epoch_batch *paBatch, void *paBuffer, uint32_t paCapacity);
+};
+
+#endif
@@ -0,0 +1,135 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "GNSSEpochRecord.h"
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ************************************************************ the binary epoch record  *************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+static inline int64_t record_round(double paValue) {
+  return ((int64_t)((0 <= paValue) ? (paValue + 0.5) : (paValue - 0.5)));
+}
+
+
+uint16_t GNSSEpochRecord::build(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, uint32_t paSequence, void *paBuffer, size_t paSize) {
+  struct GNSS_epoch_record *loRecord = (struct GNSS_epoch_record *)paBuffer;
+  struct GNSS_record_sat *loSat;
+  const struct GSV_data_by_systemID *loSystem;
+  const struct GSV_message *loMessage;
+  int16_t loSats;
+  uint16_t loCount = 0;
+  uint8_t i, k, s;
+
+  if ((NULL == paBuffer) || (GNSS_RECORD_CORE_SIZE > paSize)) {
+    return (0);
+  }
+  memset(loRecord, 0, GNSS_RECORD_CORE_SIZE);
+  loRecord->magic[0] = 'G';
+  loRecord->magic[1] = 'E';
+  loRecord->version  = GNSS_RECORD_VERSION;
+  loRecord->sequence = paSequence;
+
+  loRecord->timeMs = GNSSCollector::getUnixTimeMs(paData);
+  if (0 <= loRecord->timeMs) {
+    loRecord->flags |= GNSS_REC_DATE;
+  } else {
+    loRecord->timeMs = ((int64_t)paData->UTC_H * 3600 + (int64_t)paData->UTC_M * 60 + paData->UTC_S) * 1000 + paData->UTC_fract;
+  }
+  if ((0 != paData->lat_dir) && (0 != paData->lon_dir)) {
+    loRecord->flags    |= GNSS_REC_POSITION;
+    loRecord->lat       = record_round(GNSSCollector::getLatitude(paData) * 1e9);
+    loRecord->lon       = record_round(GNSSCollector::getLongitude(paData) * 1e9);
+    loRecord->posStatus = paData->pos_status;
+    loRecord->modeInd   = paData->mode_ind;
+  }
+  if (0 < paData->msgs_rcvd[MSG_GGA]) {
+    loRecord->flags   |= GNSS_REC_ALTITUDE | GNSS_REC_HDOP;
+    loRecord->altMm    = (int32_t)record_round(paData->alt * 1000);
+    loRecord->quality  = (('0' <= paData->quality) && ('9' >= paData->quality)) ? (paData->quality - '0') : 0;
+    loRecord->satsUsed = paData->sats;
+    loRecord->hdop     = (float)paData->hdop;
+  }
+  if (0 < paData->msgs_rcvd[MSG_GSA]) {
+    loRecord->flags  |= GNSS_REC_DOP | GNSS_REC_HDOP;
+    loRecord->hdop    = (float)paData->hdop;
+    loRecord->pdop    = (float)paData->pdop;
+    loRecord->vdop    = (float)paData->vdop;
+    loRecord->fixType = (('1' <= paData->mode123) && ('3' >= paData->mode123)) ? (paData->mode123 - '0') : 0;
+  }
+  if (0 < paData->msgs_rcvd[MSG_VTG]) {
+    loRecord->flags |= GNSS_REC_SPEED;
+    loRecord->speed  = (float)paData->speed;
+    loRecord->track  = (float)paData->true_track;
+  } else if (0 < paData->msgs_rcvd[MSG_RMC]) {
+    loRecord->flags |= GNSS_REC_SPEED;
+    loRecord->speed  = (float)(paData->nautical_speed * 1.852);
+    loRecord->track  = (float)paData->true_track;
+  }
+  if (0 < paData->msgs_rcvd[MSG_GST]) {
+    loRecord->flags  |= GNSS_REC_GST;
+    loRecord->latStd  = (float)paData->lat_std_dev;
+    loRecord->lonStd  = (float)paData->lon_std_dev;
+    loRecord->altStd  = (float)paData->alt_std_dev;
+  }
+
+  if (NULL != paGSVData) {
+    loSat = (struct GNSS_record_sat *)((uint8_t *)paBuffer + GNSS_RECORD_CORE_SIZE);
+    for (i = 0; (i < paGSVData->recSystems) && (i < MAXGSVSYSTEMSTORAGE); i++) {
+      loSystem = &paGSVData->system[i];
+      for (k = 0; (k < loSystem->msgs) && (k < MAXGSVMESSAGES); k++) {
+        loMessage = &loSystem->GSV[k];
+        loSats = (int16_t)loMessage->sats - 4 * ((int16_t)loMessage->msgNo - 1); // the satellites in this message
+        for (s = 0; (s < 4) && (s < loSats) && (GNSS_RECORD_MAX_SATS > loCount); s++) {
+          if ((GNSS_RECORD_CORE_SIZE + (size_t)(loCount + 1) * GNSS_RECORD_SAT_SIZE) > paSize) {
+            return (0);
+          }
+          loSat[loCount].talker[0] = loSystem->talker[0];
+          loSat[loCount].talker[1] = loSystem->talker[1];
+          loSat[loCount].prn       = loMessage->sat[s].prn;
+          loSat[loCount].azimuth   = loMessage->sat[s].azimuth;
+          loSat[loCount].elev      = loMessage->sat[s].elev;
+          loSat[loCount].SNR       = loMessage->sat[s].SNR;
+          loCount++;
+        }
+      }
+    }
+  }
+  loRecord->sats = loCount;
+  loRecord->size = GNSS_RECORD_CORE_SIZE + loCount * GNSS_RECORD_SAT_SIZE;
+  return (loRecord->size);
+}
+
+
+int32_t GNSSEpochRecord::check(const void *paData, size_t paLength) {
+  const struct GNSS_epoch_record *loRecord = (const struct GNSS_epoch_record *)paData;
+
+  if ((NULL == paData) || (8 > paLength)) {
+    return (0);
+  }
+  if (('G' != loRecord->magic[0]) || ('E' != loRecord->magic[1]) || (0 == loRecord->version) ||
+      (loRecord->size < (GNSS_RECORD_CORE_SIZE + (uint32_t)loRecord->sats * GNSS_RECORD_SAT_SIZE))) {
+    return (-1);
+  }
+  return ((paLength < loRecord->size) ? 0 : loRecord->size);
+}
@@ -0,0 +1,114 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef GNSS_EPOCH_RECORD_H
+#define GNSS_EPOCH_RECORD_H
+
+#include "ultimateGNSSParser.h"
+#include <stddef.h>
+
+// The record is read in place with the structures below, so the byte order of the platform has to be the byte order of the record.
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__)
+#error "The binary epoch record needs the little endian platform"
+#endif
+
+/***************************************************************************************************************************************************
+ ************************************************************* the binary epoch record *************************************************************
+ ***************************************************************************************************************************************************/
+
+// The record (little endian, every field at its natural alignment, no padding added by the compiler):
+//   struct GNSS_epoch_record     GNSS_RECORD_CORE_SIZE bytes - the fix, the accuracy and the size of the whole record
+//   struct GNSS_record_sat       sats * GNSS_RECORD_SAT_SIZE bytes - the satellites in view ($xxGSV), when they are given
+// The fields are integers and 4-byte floats only (the double of some MCUs has 4 bytes), the flags tell which values have been
+// received in the epoch (the rest is 0). The new fields are added in place of the reserved bytes or after the satellites with the new
+// version, so the readers of the version 1 can read the newer records (the satellites are found with the size of the core, see getSats()).
+// The size of the record is the multiple of 8, so the records written one after another to the buffer aligned to 8 bytes can be read
+// in place (memcpy() the fields on the platforms without the unaligned access).
+#define GNSS_RECORD_VERSION    1
+#define GNSS_RECORD_CORE_SIZE  80
+#define GNSS_RECORD_SAT_SIZE   8
+#define GNSS_RECORD_MAX_SATS   128
+#define GNSS_RECORD_MAX_SIZE   (GNSS_RECORD_CORE_SIZE + GNSS_RECORD_MAX_SATS * GNSS_RECORD_SAT_SIZE)
+
+// the flags of the values received
+#define GNSS_REC_POSITION      0x01   // lat, lon (the position status and the mode indicator too)
+#define GNSS_REC_ALTITUDE      0x02   // altMm, quality, satsUsed ($xxGGA)
+#define GNSS_REC_DATE          0x04   // timeMs is the time since 1970-01-01 (otherwise it is the time of the day)
+#define GNSS_REC_SPEED         0x08   // speed, track ($xxRMC or $xxVTG)
+#define GNSS_REC_HDOP          0x10   // hdop ($xxGGA or $xxGSA)
+#define GNSS_REC_DOP           0x20   // pdop, vdop, fixType ($xxGSA)
+#define GNSS_REC_GST           0x40   // latStd, lonStd, altStd ($xxGST)
+
+struct GNSS_epoch_record {
+  char     magic[2];      //  0  "GE"
+  uint8_t  version;       //  2  GNSS_RECORD_VERSION
+  uint8_t  flags;         //  3  GNSS_REC_xxx
+  uint16_t size;          //  4  the size of the whole record [bytes]
+  uint16_t sats;          //  6  the number of the satellites after the core
+  int64_t  timeMs;        //  8  the UTC time [ms since 1970-01-01] or [ms of the day] (see GNSS_REC_DATE)
+  int64_t  lat;           // 16  the signed latitude [1e-9 deg]
+  int64_t  lon;           // 24  the signed longitude [1e-9 deg]
+  int32_t  altMm;         // 32  the altitude [mm]
+  float    speed;         // 36  the speed over ground [km/h]
+  float    track;         // 40  the true track [deg]
+  float    hdop;          // 44
+  float    pdop;          // 48
+  float    vdop;          // 52
+  float    latStd;        // 56  the standard deviations [m]
+  float    lonStd;        // 60
+  float    altStd;        // 64
+  uint32_t sequence;      // 68  the number of the record given by the writer (the gaps show the records lost)
+  uint8_t  quality;       // 72  the GGA quality (0-9)
+  uint8_t  satsUsed;      // 73
+  char     posStatus;     // 74  'A', 'V' or 0
+  char     modeInd;       // 75  the mode indicator ('A', 'D', 'E', ...) or 0
+  uint8_t  fixType;       // 76  1: no fix, 2: 2D, 3: 3D ($xxGSA)
+  uint8_t  reserved[3];   // 77
+};
+
+struct GNSS_record_sat {
+  char     talker[2];     //  0  "GP", "GL", "GA", ...
+  uint16_t prn;           //  2
+  uint16_t azimuth;       //  4  [deg]
+  uint8_t  elev;          //  6  [deg]
+  uint8_t  SNR;           //  7  [dB-Hz]
+};
+
+static_assert(sizeof(struct GNSS_epoch_record) == GNSS_RECORD_CORE_SIZE, "the layout of the epoch record is not correct");
+static_assert(sizeof(struct GNSS_record_sat) == GNSS_RECORD_SAT_SIZE, "the layout of the satellite record is not correct");
+
+class GNSSEpochRecord {
+public:
+  // It writes the record of the epoch (with the satellites when paGSVData is given) into the buffer.
+  // It returns the size of the record or 0 if the buffer is too small (GNSS_RECORD_MAX_SIZE is always enough).
+  static uint16_t build(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, uint32_t paSequence, void *paBuffer, size_t paSize);
+
+  // It checks the record at the beginning of the data (e.g. read from the pipe): it returns the size of the record,
+  // 0 if more bytes are needed to have the whole record or -1 if the data is not the record.
+  static int32_t check(const void *paData, size_t paLength);
+  // the record in place (NULL if check() doesn't give the whole record)
+  static inline const struct GNSS_epoch_record *view(const void *paData, size_t paLength) {
+    return ((0 < GNSSEpochRecord::check(paData, paLength)) ? (const struct GNSS_epoch_record *)paData : NULL);
+  };
+  static inline const struct GNSS_record_sat *getSats(const struct GNSS_epoch_record *paRecord) {
+    return ((const struct GNSS_record_sat *)((const uint8_t *)paRecord + GNSS_RECORD_CORE_SIZE));
+  };
+};
+
+#endif
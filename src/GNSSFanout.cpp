@@ -0,0 +1,545 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "GNSSFanout.h"
+
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <errno.h>
+
+static_assert(0 == (GNSS_FANOUT_SENTENCES & (GNSS_FANOUT_SENTENCES - 1)), "GNSS_FANOUT_SENTENCES has to be the power of 2");
+static_assert((4 * GNSS_MAXMESSAGELENGTH) <= GNSS_FANOUT_BUFFER, "GNSS_FANOUT_BUFFER is too small");
+
+#define FANOUT_TAG_TCP    0xFFFF0001ULL   // the epoll tags of the listening sockets (the clients are tagged with their index)
+#define FANOUT_TAG_UNIX   0xFFFF0002ULL
+
+// the last three letters of the sentence header ("$GPGGA,..." - "GGA", "$PUBX,..." - "UBX"), 0 if there is no header
+static uint32_t sentence_type(const char *paText, size_t paLength) {
+  size_t i;
+
+  for (i = 1; (i < paLength) && (i < 16); i++) {
+    if ((',' == paText[i]) || ('*' == paText[i])) {
+      break;
+    }
+  }
+  if (4 > i) {
+    return (0);
+  }
+  return (((uint32_t)(uint8_t)paText[i - 3] << 16) | ((uint32_t)(uint8_t)paText[i - 2] << 8) | (uint8_t)paText[i - 1]);
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ************************************************************ the NMEA fan-out server  *************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+GNSSFanoutServer::GNSSFanoutServer(uint16_t paMaxClients) {
+  atEpoll      = -1;
+  atTCP        = -1;
+  atUnix       = -1;
+  atUnixPath   = NULL;
+  atBuffer     = NULL;
+  atIndex      = NULL;
+  atHead       = 0;
+  atSequence   = 0;
+  atOldest     = 0;
+  atClients    = NULL;
+  atMaxClients = paMaxClients;
+  atClientsCnt = 0;
+  atLost       = 0;
+}
+
+
+GNSSFanoutServer::~GNSSFanoutServer(void) {
+  this->close();
+  free(this->atBuffer);
+  free(this->atIndex);
+  free(this->atClients);
+}
+
+
+int8_t GNSSFanoutServer::init(void) {
+  uint16_t i;
+
+  if (0 <= this->atEpoll) {
+    return (0);
+  }
+  if (NULL == this->atBuffer) {
+    this->atBuffer  = (char *)malloc(GNSS_FANOUT_BUFFER);
+    this->atIndex   = (struct fanout_sentence *)malloc(GNSS_FANOUT_SENTENCES * sizeof(struct fanout_sentence));
+    this->atClients = (struct fanout_client *)malloc(this->atMaxClients * sizeof(struct fanout_client));
+    if ((NULL == this->atBuffer) || (NULL == this->atIndex) || (NULL == this->atClients)) {
+      SETCOLORRED DBG("The fan-out buffers can not be allocated\r\n"); NOCOLOR
+      return (-1);
+    }
+  }
+  for (i = 0; i < this->atMaxClients; i++) {
+    this->atClients[i].fd = -1;
+  }
+  this->atEpoll = epoll_create1(EPOLL_CLOEXEC);
+  if (0 > this->atEpoll) {
+    SETCOLORRED DBG("The epoll instance can not be created\r\n"); NOCOLOR
+    return (-1);
+  }
+  return (0);
+}
+
+
+int8_t GNSSFanoutServer::add_listener(int paFd, uint64_t paTag) {
+  struct epoll_event loEvent;
+
+  if (listen(paFd, 16)) {
+    SETCOLORRED DBG("The socket can not listen\r\n"); NOCOLOR
+    return (-1);
+  }
+  loEvent.events   = EPOLLIN;
+  loEvent.data.u64 = paTag;
+  if (epoll_ctl(this->atEpoll, EPOLL_CTL_ADD, paFd, &loEvent)) {
+    return (-1);
+  }
+  return (0);
+}
+
+
+int8_t GNSSFanoutServer::listenTCP(uint16_t paPort, const char *paAddress) {
+  struct sockaddr_in loAddress;
+  int loOn = 1;
+  int loFd;
+
+  if (this->init() || (0 <= this->atTCP)) {
+    return (-1);
+  }
+  memset(&loAddress, 0, sizeof(loAddress));
+  loAddress.sin_family = AF_INET;
+  loAddress.sin_port   = htons(paPort);
+  if (1 != inet_pton(AF_INET, paAddress, &loAddress.sin_addr)) {
+    SETCOLORRED DBG("The address is not correct\r\n"); NOCOLOR
+    return (-1);
+  }
+  loFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (0 > loFd) {
+    return (-1);
+  }
+  setsockopt(loFd, SOL_SOCKET, SO_REUSEADDR, &loOn, sizeof(loOn));
+  if (bind(loFd, (struct sockaddr *)&loAddress, sizeof(loAddress))) {
+    SETCOLORRED DBG("The TCP port can not be bound\r\n"); NOCOLOR
+    ::close(loFd);
+    return (-1);
+  }
+  if (this->add_listener(loFd, FANOUT_TAG_TCP)) {
+    ::close(loFd);
+    return (-1);
+  }
+  this->atTCP = loFd;
+  return (0);
+}
+
+
+int8_t GNSSFanoutServer::listenUnix(const char *paPath) {
+  struct sockaddr_un loAddress;
+  int loFd;
+
+  if (this->init() || (0 <= this->atUnix)) {
+    return (-1);
+  }
+  if (sizeof(loAddress.sun_path) <= strlen(paPath)) {
+    SETCOLORRED DBG("The unix socket path is too long\r\n"); NOCOLOR
+    return (-1);
+  }
+  memset(&loAddress, 0, sizeof(loAddress));
+  loAddress.sun_family = AF_UNIX;
+  strcpy(loAddress.sun_path, paPath);
+  loFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (0 > loFd) {
+    return (-1);
+  }
+  unlink(paPath);
+  if (bind(loFd, (struct sockaddr *)&loAddress, sizeof(loAddress))) {
+    SETCOLORRED DBG("The unix socket can not be bound\r\n"); NOCOLOR
+    ::close(loFd);
+    return (-1);
+  }
+  if (this->add_listener(loFd, FANOUT_TAG_UNIX)) {
+    ::close(loFd);
+    unlink(paPath);
+    return (-1);
+  }
+  this->atUnix     = loFd;
+  this->atUnixPath = strdup(paPath);
+  return (0);
+}
+
+
+void GNSSFanoutServer::close(void) {
+  uint16_t i;
+
+  if (NULL != this->atClients) {
+    for (i = 0; i < this->atMaxClients; i++) {
+      if (0 <= this->atClients[i].fd) {
+        this->drop_client(&this->atClients[i]);
+      }
+    }
+  }
+  if (0 <= this->atTCP) {
+    ::close(this->atTCP);
+    this->atTCP = -1;
+  }
+  if (0 <= this->atUnix) {
+    ::close(this->atUnix);
+    this->atUnix = -1;
+  }
+  if (NULL != this->atUnixPath) {
+    unlink(this->atUnixPath);
+    free(this->atUnixPath);
+    this->atUnixPath = NULL;
+  }
+  if (0 <= this->atEpoll) {
+    ::close(this->atEpoll);
+    this->atEpoll = -1;
+  }
+}
+
+
+void GNSSFanoutServer::accept_clients(int paListener) {
+  struct fanout_client *loClient;
+  struct epoll_event loEvent;
+  int loOn = 1;
+  uint16_t i;
+  int loFd;
+
+  while (0 <= (loFd = accept4(paListener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC))) {
+    for (i = 0; i < this->atMaxClients; i++) {
+      if (0 > this->atClients[i].fd) {
+        break;
+      }
+    }
+    if (i == this->atMaxClients) {
+      ::close(loFd); // there is no room for the next client
+      continue;
+    }
+    if (paListener == this->atTCP) {
+      setsockopt(loFd, IPPROTO_TCP, TCP_NODELAY, &loOn, sizeof(loOn));
+    }
+    loEvent.events   = EPOLLIN;
+    loEvent.data.u64 = i;
+    if (epoll_ctl(this->atEpoll, EPOLL_CTL_ADD, loFd, &loEvent)) {
+      ::close(loFd);
+      continue;
+    }
+    // the new client gets the sentences relayed from now on
+    loClient = &this->atClients[i];
+    loClient->fd            = loFd;
+    loClient->next          = this->atSequence;
+    loClient->restLength    = 0;
+    loClient->blocked       = false;
+    loClient->filters       = 0;
+    loClient->commandLength = 0;
+    loClient->lost          = 0;
+    this->atClientsCnt++;
+  }
+}
+
+
+void GNSSFanoutServer::drop_client(struct fanout_client *paClient) {
+  if (paClient->next < this->atOldest) {
+    this->atLost += this->atOldest - paClient->next;
+  }
+  epoll_ctl(this->atEpoll, EPOLL_CTL_DEL, paClient->fd, NULL);
+  ::close(paClient->fd);
+  paClient->fd = -1;
+  this->atClientsCnt--;
+}
+
+
+void GNSSFanoutServer::set_blocked(struct fanout_client *paClient, bool paBlocked) {
+  struct epoll_event loEvent;
+
+  if (paClient->blocked == paBlocked) {
+    return;
+  }
+  paClient->blocked = paBlocked;
+  loEvent.events    = paBlocked ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+  loEvent.data.u64  = (uint64_t)(paClient - this->atClients);
+  epoll_ctl(this->atEpoll, EPOLL_CTL_MOD, paClient->fd, &loEvent);
+}
+
+
+void GNSSFanoutServer::read_commands(struct fanout_client *paClient) {
+  char loData[256];
+  const char *loItem;
+  ssize_t loRead;
+  ssize_t i;
+
+  while (0 < (loRead = recv(paClient->fd, loData, sizeof(loData), MSG_DONTWAIT))) {
+    for (i = 0; i < loRead; i++) {
+      if ('\n' != loData[i]) {
+        if ((sizeof(paClient->command) - 1) > paClient->commandLength) {
+          paClient->command[paClient->commandLength++] = loData[i];
+        }
+        continue;
+      }
+      while ((0 < paClient->commandLength) && ('\r' == paClient->command[paClient->commandLength - 1])) {
+        paClient->commandLength--;
+      }
+      paClient->command[paClient->commandLength] = 0;
+      paClient->commandLength = 0;
+      if (strncmp(paClient->command, "FILTER", 6)) {
+        continue; // the unknown commands are ignored
+      }
+      // "FILTER GGA,RMC" - the list of the types, "FILTER" or "FILTER *" - all the sentences
+      paClient->filters = 0;
+      loItem = paClient->command + 6;
+      while (0 != *loItem) {
+        const char *loEnd = loItem;
+
+        while ((0 != *loEnd) && (',' != *loEnd) && (' ' != *loEnd)) {
+          loEnd++;
+        }
+        if ((3 <= (loEnd - loItem)) && (GNSS_FANOUT_FILTERS > paClient->filters)) {
+          paClient->filter[paClient->filters++] = sentence_type(loEnd - 4, 4);
+        }
+        loItem = (0 != *loEnd) ? (loEnd + 1) : loEnd;
+      }
+    }
+  }
+  if ((0 == loRead) || ((0 > loRead) && (EAGAIN != errno) && (EWOULDBLOCK != errno) && (EINTR != errno))) {
+    this->drop_client(paClient); // the client has closed the connection
+  }
+}
+
+
+bool GNSSFanoutServer::matches(const struct fanout_client *paClient, uint32_t paType) {
+  uint8_t i;
+
+  if (0 == paClient->filters) {
+    return (true);
+  }
+  for (i = 0; i < paClient->filters; i++) {
+    if (paType == paClient->filter[i]) {
+      return (true);
+    }
+  }
+  return (false);
+}
+
+
+void GNSSFanoutServer::relay(const char *paLine, size_t paLength) {
+  struct fanout_sentence *loSentence;
+  uint64_t loStart;
+
+  if ((NULL == this->atBuffer) || (0 == paLength) || (GNSS_MAXMESSAGELENGTH < paLength)) {
+    return;
+  }
+  // the sentence is never divided by the end of the buffer, so it is sent as the single piece
+  loStart = this->atHead;
+  if ((GNSS_FANOUT_BUFFER - (loStart % GNSS_FANOUT_BUFFER)) < paLength) {
+    loStart += GNSS_FANOUT_BUFFER - (loStart % GNSS_FANOUT_BUFFER);
+  }
+  memcpy(this->atBuffer + (loStart % GNSS_FANOUT_BUFFER), paLine, paLength);
+  this->atHead = loStart + paLength;
+
+  loSentence = &this->atIndex[this->atSequence & (GNSS_FANOUT_SENTENCES - 1)];
+  loSentence->offset = loStart;
+  loSentence->length = (uint16_t)paLength;
+  loSentence->type   = sentence_type(paLine, paLength);
+  this->atSequence++;
+
+  // the sentences overwritten (their bytes or their index entries) are not available any more
+  while ((this->atOldest < this->atSequence) &&
+         (((this->atSequence - this->atOldest) > GNSS_FANOUT_SENTENCES) ||
+          ((this->atIndex[this->atOldest & (GNSS_FANOUT_SENTENCES - 1)].offset + GNSS_FANOUT_BUFFER) < this->atHead))) {
+    this->atOldest++;
+  }
+}
+
+
+void GNSSFanoutServer::send_client(struct fanout_client *paClient) {
+  const struct fanout_sentence *loSentence;
+  struct iovec loIov[GNSS_FANOUT_IOV];
+  struct msghdr loMessage;
+  const char *loData;
+  uint64_t loSequence;
+  ssize_t loSent;
+  int loCount;
+
+  if (paClient->next < this->atOldest) { // the client has been too slow - it continues with the oldest sentence available
+    paClient->lost += this->atOldest - paClient->next;
+    this->atLost   += this->atOldest - paClient->next;
+    paClient->next  = this->atOldest;
+  }
+  while ((0 != paClient->restLength) || (paClient->next < this->atSequence)) {
+    // the sentences of the client are gathered straight from the shared buffer (the neighbouring ones as the single piece)
+    loCount = 0;
+    if (0 != paClient->restLength) {
+      loIov[0].iov_base = paClient->rest;
+      loIov[0].iov_len  = paClient->restLength;
+      loCount++;
+    }
+    for (loSequence = paClient->next; (loSequence < this->atSequence) && (GNSS_FANOUT_IOV > loCount); loSequence++) {
+      loSentence = &this->atIndex[loSequence & (GNSS_FANOUT_SENTENCES - 1)];
+      if (!this->matches(paClient, loSentence->type)) {
+        continue;
+      }
+      loData = this->atBuffer + (loSentence->offset % GNSS_FANOUT_BUFFER);
+      if ((0 < loCount) && (((char *)loIov[loCount - 1].iov_base + loIov[loCount - 1].iov_len) == loData)) {
+        loIov[loCount - 1].iov_len += loSentence->length;
+      } else {
+        loIov[loCount].iov_base = (void *)loData;
+        loIov[loCount].iov_len  = loSentence->length;
+        loCount++;
+      }
+    }
+    if (0 == loCount) {
+      paClient->next = this->atSequence; // nothing for this client
+      break;
+    }
+
+    memset(&loMessage, 0, sizeof(loMessage));
+    loMessage.msg_iov    = loIov;
+    loMessage.msg_iovlen = loCount;
+    loSent = sendmsg(paClient->fd, &loMessage, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (0 > loSent) {
+      if ((EAGAIN == errno) || (EWOULDBLOCK == errno)) {
+        this->set_blocked(paClient, true);
+      } else if (EINTR != errno) {
+        this->drop_client(paClient);
+      }
+      return;
+    }
+
+    // the sentences sent are walked again in the same way (the filter skips the same ones)
+    if (0 != paClient->restLength) {
+      if ((size_t)loSent < paClient->restLength) {
+        memmove(paClient->rest, paClient->rest + loSent, paClient->restLength - loSent);
+        paClient->restLength -= (uint16_t)loSent;
+        this->set_blocked(paClient, true);
+        return;
+      }
+      loSent -= paClient->restLength;
+      paClient->restLength = 0;
+    }
+    while (paClient->next < loSequence) {
+      loSentence = &this->atIndex[paClient->next & (GNSS_FANOUT_SENTENCES - 1)];
+      if (this->matches(paClient, loSentence->type)) {
+        if ((size_t)loSent < loSentence->length) {
+          if (0 < loSent) {
+            paClient->restLength = loSentence->length - (uint16_t)loSent;
+            memcpy(paClient->rest, this->atBuffer + (loSentence->offset % GNSS_FANOUT_BUFFER) + loSent, paClient->restLength);
+            paClient->next++;
+          }
+          break;
+        }
+        loSent -= loSentence->length;
+      }
+      paClient->next++;
+    }
+    if ((0 != paClient->restLength) || (paClient->next < loSequence)) {
+      this->set_blocked(paClient, true); // the socket buffer is full - the rest waits for EPOLLOUT
+      return;
+    }
+  }
+  this->set_blocked(paClient, false);
+}
+
+
+void GNSSFanoutServer::flush(void) {
+  struct fanout_client *loClient;
+  uint16_t i;
+
+  if (NULL == this->atClients) {
+    return;
+  }
+  for (i = 0; i < this->atMaxClients; i++) {
+    loClient = &this->atClients[i];
+    if ((0 <= loClient->fd) && !loClient->blocked && ((0 != loClient->restLength) || (loClient->next < this->atSequence))) {
+      this->send_client(loClient);
+    }
+  }
+}
+
+
+int GNSSFanoutServer::service(int paTimeoutMs) {
+  struct epoll_event loEvents[32];
+  struct fanout_client *loClient;
+  int loCount;
+  int i;
+
+  if (0 > this->atEpoll) {
+    return (-1);
+  }
+  loCount = epoll_wait(this->atEpoll, loEvents, 32, paTimeoutMs);
+  if (0 > loCount) {
+    return ((EINTR == errno) ? 0 : -1);
+  }
+  for (i = 0; i < loCount; i++) {
+    if (FANOUT_TAG_TCP == loEvents[i].data.u64) {
+      this->accept_clients(this->atTCP);
+      continue;
+    }
+    if (FANOUT_TAG_UNIX == loEvents[i].data.u64) {
+      this->accept_clients(this->atUnix);
+      continue;
+    }
+    loClient = &this->atClients[loEvents[i].data.u64];
+    if (0 > loClient->fd) {
+      continue; // it has been dropped by the previous event
+    }
+    if (loEvents[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+      this->read_commands(loClient);
+    }
+    if ((0 <= loClient->fd) && (loEvents[i].events & EPOLLOUT)) {
+      this->send_client(loClient);
+    }
+  }
+  this->flush();
+  return (loCount);
+}
+
+
+bool GNSSFanoutServer::isPending(void) {
+  uint16_t i;
+
+  if (NULL == this->atClients) {
+    return (false);
+  }
+  for (i = 0; i < this->atMaxClients; i++) {
+    if ((0 <= this->atClients[i].fd) && ((0 != this->atClients[i].restLength) || (this->atClients[i].next < this->atSequence))) {
+      return (true);
+    }
+  }
+  return (false);
+}
+
+
+void GNSSFanoutServer::lineCallback(const char *paLine, int8_t paStatus, void *paServer) {
+  if ((LINE_VALID == paStatus) && (NULL != paServer)) {
+    ((GNSSFanoutServer *)paServer)->relay(paLine, strlen(paLine));
+  }
+}
+
+#endif // linux
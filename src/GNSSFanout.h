@@ -0,0 +1,129 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef GNSS_FANOUT_H
+#define GNSS_FANOUT_H
+
+#include "ultimateGNSSParser.h"
+
+// The NMEA fan-out server is available on linux only (epoll), the file is compiled to nothing on the other platforms.
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include <stddef.h>
+
+#ifndef GNSS_FANOUT_BUFFER
+#define GNSS_FANOUT_BUFFER     (1024*1024)  // the shared buffer of the sentences relayed [bytes]
+#endif
+#ifndef GNSS_FANOUT_SENTENCES
+#define GNSS_FANOUT_SENTENCES  16384        // the index of the sentences in the shared buffer (the power of 2)
+#endif
+#define GNSS_FANOUT_FILTERS    16           // the maximum number of the sentence types in the filter of the client
+#define GNSS_FANOUT_IOV        64           // the maximum number of the buffers given to the single sendmsg() call
+
+/***************************************************************************************************************************************************
+ ************************************************************** the NMEA fan-out server ************************************************************
+ ***************************************************************************************************************************************************/
+
+// The server relays the correct sentences (the lines which passed check_and_slice_NMEA_message() - connect lineCallback to the collector)
+// to any number of the TCP and unix socket clients. Every sentence is copied once to the shared buffer, the clients are sent the parts
+// of the shared buffer with sendmsg() (the sentences of the filtered clients are gathered into the single call too). The sockets are
+// non-blocking: the client which can not take the data at once is served again when epoll reports it writable, the parsing never waits
+// for it (only the rest of the sentence sent partly is copied to the client). The client slower than the shared buffer loses the oldest
+// sentences (see getLost()) - it is not disconnected.
+//
+// The client can send the commands (the lines terminated with '\n'):
+//   FILTER GGA,RMC    only the given sentence types are sent (the last three letters of the header, so "GGA" is $GPGGA, $GNGGA, ...)
+//   FILTER            all the sentences are sent (the default)
+class GNSSFanoutServer {
+private:
+  struct fanout_sentence {
+    uint64_t offset;      // the position in the shared buffer (counted from the start of the server)
+    uint32_t type;        // the last three letters of the header
+    uint16_t length;
+  };
+  struct fanout_client {
+    int      fd;
+    uint64_t next;        // the number of the next sentence to be sent
+    char     rest[GNSS_MAXMESSAGELENGTH]; // the rest of the sentence sent partly (the shared buffer may overwrite it meanwhile)
+    uint16_t restLength;
+    bool     blocked;     // the socket is full - it waits for EPOLLOUT
+    uint8_t  filters;
+    uint32_t filter[GNSS_FANOUT_FILTERS];
+    char     command[64];
+    uint8_t  commandLength;
+    uint64_t lost;        // the sentences the client has been too slow for
+  };
+
+  int                     atEpoll;
+  int                     atTCP;
+  int                     atUnix;
+  char                   *atUnixPath;
+  char                   *atBuffer;
+  struct fanout_sentence *atIndex;
+  uint64_t                atHead;       // the bytes written to the shared buffer
+  uint64_t                atSequence;   // the sentences written to the shared buffer
+  uint64_t                atOldest;     // the oldest sentence still in the shared buffer
+  struct fanout_client   *atClients;
+  uint16_t                atMaxClients;
+  uint16_t                atClientsCnt;
+  uint64_t                atLost;
+
+  int8_t init(void);
+  int8_t add_listener(int paFd, uint64_t paTag);
+  void   accept_clients(int paListener);
+  void   drop_client(struct fanout_client *paClient);
+  void   read_commands(struct fanout_client *paClient);
+  void   send_client(struct fanout_client *paClient);
+  void   set_blocked(struct fanout_client *paClient, bool paBlocked);
+  bool   matches(const struct fanout_client *paClient, uint32_t paType);
+
+public:
+  GNSSFanoutServer(uint16_t paMaxClients = 64);
+  ~GNSSFanoutServer(void);
+
+  // They start listening on the TCP port (the loopback address by default) or on the unix socket (the existing socket file is replaced).
+  // Both can be used at once. They return 0 on success or -1 if the socket can not be created.
+  int8_t listenTCP(uint16_t paPort, const char *paAddress = "127.0.0.1");
+  int8_t listenUnix(const char *paPath);
+  // it disconnects all the clients and closes the listening sockets
+  void   close(void);
+
+  // it stores the sentence in the shared buffer (it is sent with the next flush() or service() call)
+  void   relay(const char *paLine, size_t paLength);
+  // it sends the sentences relayed to all the clients which can take them now (call it after feeding the collector with the bytes read)
+  void   flush(void);
+  // It accepts the clients, reads their commands and serves the clients waiting for the socket space. It waits up to paTimeoutMs
+  // for the events (0 - it doesn't wait). It returns the number of the events handled or -1 on the error.
+  int    service(int paTimeoutMs);
+  // the epoll descriptor - it is readable when service() has some work (for the external event loop)
+  inline int getFd(void) { return this->atEpoll; };
+
+  inline uint16_t getClients(void)  { return this->atClientsCnt; };
+  inline uint64_t getRelayed(void)  { return this->atSequence; };
+  inline uint64_t getLost(void)     { return this->atLost; };    // the sentences lost by the slow clients (all of them)
+  // it returns true if some client waits for the socket space
+  bool   isPending(void);
+
+  // the line callback (GNSSCollector::setLineCallback) with the server as the user data - only the correct sentences are relayed
+  static void lineCallback(const char *paLine, int8_t paStatus, void *paServer);
+};
+
+#endif // linux
+
+#endif
@@ -0,0 +1,282 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "GNSSFleetStore.h"
+
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include <sched.h>
+
+#define FLEET_READ_RETRIES  1000
+
+static uint32_t  gFleetThreads = 0;   // the number of the writer threads so far (they take the update counters in turn)
+static __thread int32_t tFleetCounter = -1;
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ **************************************************************** the fleet store  *****************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+GNSSFleetStore::GNSSFleetStore(uint32_t paMaxDevices) {
+  uint32_t loSlots = 2;
+
+  while ((loSlots < (2 * (uint64_t)paMaxDevices)) && (loSlots < 0x80000000UL)) {
+    loSlots <<= 1;
+  }
+  atSlots      = (struct fleet_slot *)aligned_alloc(64, loSlots * sizeof(struct fleet_slot));
+  atMask       = loSlots - 1;
+  atMaxDevices = paMaxDevices;
+  atDevices    = 0;
+  atCounters   = (struct fleet_counter *)aligned_alloc(64, GNSS_FLEET_COUNTERS * sizeof(struct fleet_counter));
+  if ((NULL == atSlots) || (NULL == atCounters)) {
+    SETCOLORRED DBG("The fleet store can not be allocated\r\n"); NOCOLOR
+    free(atSlots);
+    free(atCounters);
+    atSlots      = NULL;
+    atCounters   = NULL;
+    atMaxDevices = 0;
+    return;
+  }
+  memset(atSlots, 0, loSlots * sizeof(struct fleet_slot));
+  memset(atCounters, 0, GNSS_FLEET_COUNTERS * sizeof(struct fleet_counter));
+}
+
+
+GNSSFleetStore::~GNSSFleetStore(void) {
+  free(this->atSlots);
+  free(this->atCounters);
+}
+
+
+uint32_t GNSSFleetStore::home(uint64_t paKey) {
+  return ((uint32_t)((paKey * 0x9E3779B97F4A7C15ULL) >> 32) & this->atMask);
+}
+
+
+int32_t GNSSFleetStore::find(uint64_t paKey) {
+  uint64_t loKey;
+  uint32_t loSlot;
+  uint32_t i;
+
+  if ((0 == paKey) || (NULL == this->atSlots)) {
+    return (-1);
+  }
+  loSlot = this->home(paKey);
+  for (i = 0; i <= this->atMask; i++) {
+    loKey = __atomic_load_n(&this->atSlots[loSlot].key, __ATOMIC_ACQUIRE);
+    if (paKey == loKey) {
+      return ((int32_t)loSlot);
+    }
+    if (0 == loKey) {
+      return (-1); // the keys are never removed, so the device would be here
+    }
+    loSlot = (loSlot + 1) & this->atMask;
+  }
+  return (-1);
+}
+
+
+int32_t GNSSFleetStore::insert(uint64_t paKey) {
+  uint64_t loKey;
+  uint32_t loSlot;
+  uint32_t i;
+
+  if ((0 == paKey) || (NULL == this->atSlots)) {
+    return (-1);
+  }
+  loSlot = this->home(paKey);
+  for (i = 0; i <= this->atMask; i++) {
+    loKey = __atomic_load_n(&this->atSlots[loSlot].key, __ATOMIC_ACQUIRE);
+    if (paKey == loKey) {
+      return ((int32_t)loSlot);
+    }
+    if (0 == loKey) {
+      // the place is reserved first, so the table is never filled over the half (the probes stay short)
+      if (__atomic_fetch_add(&this->atDevices, 1, __ATOMIC_RELAXED) >= this->atMaxDevices) {
+        __atomic_fetch_sub(&this->atDevices, 1, __ATOMIC_RELAXED);
+        return (-1);
+      }
+      if (__atomic_compare_exchange_n(&this->atSlots[loSlot].key, &loKey, paKey, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        return ((int32_t)loSlot);
+      }
+      // the slot has been claimed by the other thread just now - maybe for the same device
+      __atomic_fetch_sub(&this->atDevices, 1, __ATOMIC_RELAXED);
+      if (paKey == loKey) {
+        return ((int32_t)loSlot);
+      }
+    }
+    loSlot = (loSlot + 1) & this->atMask;
+  }
+  return (-1);
+}
+
+
+void GNSSFleetStore::updateSlot(uint32_t paSlot, const struct GNSS_data *paData) {
+  struct fleet_slot *loSlot = &this->atSlots[paSlot & this->atMask];
+  uint64_t loRecord[GNSS_RECORD_CORE_SIZE / 8];
+  uint64_t loSequence;
+  uint8_t i;
+
+  // the device has the single writer (its collector), so nobody else changes the counter - the record is built before the odd window
+  loSequence = __atomic_load_n(&loSlot->sequence, __ATOMIC_RELAXED);
+  GNSSEpochRecord::build(paData, NULL, (uint32_t)(loSequence / 2) + 1, loRecord, sizeof(loRecord));
+  __atomic_store_n(&loSlot->sequence, loSequence + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  for (i = 0; i < (GNSS_RECORD_CORE_SIZE / 8); i++) {
+    __atomic_store_n(&loSlot->record[i], loRecord[i], __ATOMIC_RELAXED);
+  }
+  __atomic_store_n(&loSlot->sequence, loSequence + 2, __ATOMIC_RELEASE);
+
+  // the counter of this thread - its cache line stays with the writer until getGeneration() reads it
+  if (0 > tFleetCounter) {
+    tFleetCounter = (int32_t)(__atomic_fetch_add(&gFleetThreads, 1, __ATOMIC_RELAXED) % GNSS_FLEET_COUNTERS);
+  }
+  __atomic_fetch_add(&this->atCounters[tFleetCounter].updates, 1, __ATOMIC_RELEASE);
+}
+
+
+int8_t GNSSFleetStore::update(uint64_t paKey, const struct GNSS_data *paData) {
+  int32_t loSlot = this->insert(paKey);
+
+  if (0 > loSlot) {
+    return (-1);
+  }
+  this->updateSlot((uint32_t)loSlot, paData);
+  return (0);
+}
+
+
+bool GNSSFleetStore::read_slot(const struct fleet_slot *paSlot, struct GNSS_epoch_record *paRecord) {
+  uint64_t *loRecord = (uint64_t *)paRecord;
+  uint64_t loBefore;
+  uint16_t loTry;
+  uint8_t i;
+
+  for (loTry = 0; loTry < FLEET_READ_RETRIES; loTry++) {
+    loBefore = __atomic_load_n(&paSlot->sequence, __ATOMIC_ACQUIRE);
+    if (0 == loBefore) {
+      return (false); // the device has no epoch yet
+    }
+    if (0 == (loBefore & 1)) {
+      for (i = 0; i < (GNSS_RECORD_CORE_SIZE / 8); i++) {
+        loRecord[i] = __atomic_load_n(&paSlot->record[i], __ATOMIC_RELAXED);
+      }
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (loBefore == __atomic_load_n(&paSlot->sequence, __ATOMIC_RELAXED)) {
+        return (true);
+      }
+    }
+    if (63 == (loTry & 63)) {
+      sched_yield(); // the writer may have been preempted on this CPU
+    }
+  }
+  return (false);
+}
+
+
+int8_t GNSSFleetStore::read(uint64_t paKey, struct GNSS_epoch_record *paRecord) {
+  int32_t loSlot = this->find(paKey);
+
+  if (0 > loSlot) {
+    return (0);
+  }
+  return (this->read_slot(&this->atSlots[loSlot], paRecord) ? 1 : 0);
+}
+
+
+uint32_t GNSSFleetStore::snapshot(struct GNSS_fleet_entry *paEntries, uint32_t paMaxEntries) {
+  uint32_t loEntries = 0;
+  uint64_t loKey;
+  uint32_t i;
+
+  if (NULL == this->atSlots) {
+    return (0);
+  }
+  for (i = 0; (i <= this->atMask) && (loEntries < paMaxEntries); i++) {
+    loKey = __atomic_load_n(&this->atSlots[i].key, __ATOMIC_ACQUIRE);
+    if ((0 != loKey) && this->read_slot(&this->atSlots[i], &paEntries[loEntries].record)) {
+      paEntries[loEntries].key = loKey;
+      loEntries++;
+    }
+  }
+  return (loEntries);
+}
+
+
+void GNSSFleetStore::clear(void) {
+  if (NULL == this->atSlots) {
+    return;
+  }
+  memset(this->atSlots, 0, (this->atMask + 1) * sizeof(struct fleet_slot));
+  this->atDevices = 0;
+  __atomic_fetch_add(&this->atCounters[0].updates, 1, __ATOMIC_RELEASE); // the generation changes (the counters are not cleared)
+}
+
+
+uint64_t GNSSFleetStore::getGeneration(void) {
+  uint64_t loSum = 0;
+  uint32_t i;
+
+  if (NULL == this->atCounters) {
+    return (0);
+  }
+  // the counters never go back, so the sum changes whenever anything has changed
+  for (i = 0; i < GNSS_FLEET_COUNTERS; i++) {
+    loSum += __atomic_load_n(&this->atCounters[i].updates, __ATOMIC_ACQUIRE);
+  }
+  return (loSum);
+}
+
+
+uint64_t GNSSFleetStore::makeKey(const char *paName) {
+  uint64_t loHash = 0xCBF29CE484222325ULL; // FNV-1a
+
+  while (0 != *paName) {
+    loHash ^= (uint8_t)*paName++;
+    loHash *= 0x100000001B3ULL;
+  }
+  return ((0 != loHash) ? loHash : 1);
+}
+
+
+int8_t GNSSFleetStore::attach(uint64_t paKey, struct GNSS_fleet_device *paDevice) {
+  int32_t loSlot = this->insert(paKey);
+
+  if (0 > loSlot) {
+    return (-1);
+  }
+  paDevice->store = this;
+  paDevice->slot  = (uint32_t)loSlot;
+  return (0);
+}
+
+
+void GNSSFleetStore::epochCallback(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paDevice) {
+  struct GNSS_fleet_device *loDevice = (struct GNSS_fleet_device *)paDevice;
+
+  (void)paGSVData;
+  if ((NULL != loDevice) && (NULL != loDevice->store)) {
+    loDevice->store->updateSlot(loDevice->slot, paData);
+  }
+}
+
+#endif // linux
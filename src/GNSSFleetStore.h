@@ -0,0 +1,120 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef GNSS_FLEET_STORE_H
+#define GNSS_FLEET_STORE_H
+
+#include "ultimateGNSSParser.h"
+
+// The fleet store is available on linux only (the host aggregating many receivers), the file is compiled to nothing on the other platforms.
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include <stddef.h>
+#include "GNSSEpochRecord.h"
+
+// the number of the update counters of getGeneration() - every writer thread takes its own one (the threads share them above this number)
+#ifndef GNSS_FLEET_COUNTERS
+  #define GNSS_FLEET_COUNTERS 16
+#endif
+
+/***************************************************************************************************************************************************
+ ************************************************************** the fleet store ********************************************************************
+ ***************************************************************************************************************************************************/
+
+// The table of the latest epoch of every device: the slots (128 bytes, aligned to the cache lines, so the devices updated by different
+// threads don't share the lines) are allocated once for the given number of the devices and found by the hash of the device key.
+// The slot of the new device is claimed with the compare-and-swap of its key, the epoch (the binary epoch record without the satellites,
+// see GNSSEpochRecord.h) is written under the seqlock of the slot - the updates never take the lock and the readers never block them.
+// Every device has the single writer (its collector): the updates of the different devices may come from any threads, but the updates
+// of one device must not run concurrently (the seqlock counter is stored, not exchanged). The updates are counted for getGeneration()
+// in GNSS_FLEET_COUNTERS counters on the separate cache lines, one per writer thread, so there is no counter shared by all the writers.
+// The reader gets the consistent copy of every device (it is taken again if the device was being updated just then). The snapshot
+// of the whole fleet is not the single moment - every device is given as it was when its slot was read.
+// The devices are never removed (clear() everything when no thread uses the store).
+
+// the device in the snapshot
+struct GNSS_fleet_entry {
+  uint64_t                 key;
+  struct GNSS_epoch_record record;     // record.sequence is the number of the updates of the device
+};
+
+// the device attached to the collector (see GNSSFleetStore::attach, epochCallback)
+struct GNSS_fleet_device {
+  class GNSSFleetStore *store;
+  uint32_t              slot;
+};
+
+class GNSSFleetStore {
+private:
+  struct alignas(64) fleet_slot {
+    uint64_t key;                                       // 0 - the slot is free
+    uint64_t sequence;                                  // the seqlock counter (odd while the record is being written, 2 per update)
+    uint64_t record[GNSS_RECORD_CORE_SIZE / 8];
+    uint8_t  reserved[128 - 16 - GNSS_RECORD_CORE_SIZE];
+  };
+  struct alignas(64) fleet_counter {
+    uint64_t updates;                                   // written by its writer thread only (unless there are more threads)
+    uint8_t  reserved[64 - 8];
+  };
+
+  struct fleet_slot *atSlots;
+  uint32_t           atMask;          // the number of the slots - 1 (the power of 2, at least twice the number of the devices)
+  uint32_t           atMaxDevices;
+  uint32_t           atDevices;
+  struct fleet_counter *atCounters;   // GNSS_FLEET_COUNTERS
+
+  uint32_t home(uint64_t paKey);
+  bool     read_slot(const struct fleet_slot *paSlot, struct GNSS_epoch_record *paRecord);
+
+public:
+  GNSSFleetStore(uint32_t paMaxDevices = 1024);
+  ~GNSSFleetStore(void);
+
+  // They give the slot of the device (insert() adds the device if it is not there yet) or -1 (not found, the store is full, the key is 0).
+  // The slot of the device never changes, so it can be found once and used for the updates (see attach()).
+  int32_t  find(uint64_t paKey);
+  int32_t  insert(uint64_t paKey);
+
+  // it stores the epoch as the latest one of the device (it returns -1 if the device can not be added) - one writer per device at a time
+  int8_t   update(uint64_t paKey, const struct GNSS_data *paData);
+  void     updateSlot(uint32_t paSlot, const struct GNSS_data *paData);
+  // It copies the latest epoch of the device. It returns 1 on success or 0 if the device is not known or has no epoch yet.
+  int8_t   read(uint64_t paKey, struct GNSS_epoch_record *paRecord);
+  // it copies the latest epochs of up to paMaxEntries devices (every one consistent) - it returns the number of the entries written
+  uint32_t snapshot(struct GNSS_fleet_entry *paEntries, uint32_t paMaxEntries);
+  // it forgets all the devices (no other thread may use the store meanwhile)
+  void     clear(void);
+
+  inline uint32_t getDevices(void)    { return __atomic_load_n(&this->atDevices, __ATOMIC_RELAXED); };
+  inline uint32_t getMaxDevices(void) { return this->atMaxDevices; };
+  // It changes with every update - the dashboard can skip the snapshot when it has not changed. It sums GNSS_FLEET_COUNTERS counters
+  // (16 cache lines, independent of the number of the devices) instead of reading the slots.
+  uint64_t getGeneration(void);
+
+  // the key of the device name (e.g. the serial number or the address of the source), never 0
+  static uint64_t makeKey(const char *paName);
+  // it adds the device and fills the structure for epochCallback (0 on success, -1 if the device can not be added)
+  int8_t   attach(uint64_t paKey, struct GNSS_fleet_device *paDevice);
+  // the epoch callback (GNSSCollector::setEpochCallback) with struct GNSS_fleet_device as the user data
+  static void epochCallback(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paDevice);
+};
+
+#endif // linux
+
+#endif
@@ -0,0 +1,373 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "GNSSFlightRecorder.h"
+
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const char GNSS_FLIGHT_MAGIC[8] = {'G', 'N', 'S', 'S', 'F', 'L', 'T', 0};
+
+static inline uint64_t flight_wall_time_us(void) {
+  struct timespec loNow;
+  clock_gettime(CLOCK_REALTIME, &loNow);
+  return (((uint64_t)loNow.tv_sec) * 1000000 + loNow.tv_nsec / 1000);
+}
+
+static inline size_t flight_file_size(uint64_t paDataSize, uint32_t paMarkersMax) {
+  return (GNSS_FLIGHT_HEADER_SIZE + (size_t)paDataSize + (size_t)paMarkersMax * sizeof(struct GNSS_flight_marker));
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ********************************************************* the flight recorder - the hot path  *****************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+GNSSFlightRecorder::GNSSFlightRecorder(void) {
+  atMap     = NULL;
+  atMapSize = 0;
+  atHeader  = NULL;
+  atData    = NULL;
+  atMarkers = NULL;
+}
+
+
+GNSSFlightRecorder::~GNSSFlightRecorder(void) {
+  this->close();
+}
+
+
+void GNSSFlightRecorder::record(const char *paData, size_t paLength) {
+  uint64_t loWritten;
+  size_t loSize;
+  size_t loPosition;
+  size_t loFirst;
+
+  if ((NULL == this->atHeader) || (NULL == paData) || (0 == paLength)) {
+    return;
+  }
+  loSize    = (size_t)this->atHeader->dataSize;
+  loWritten = this->atHeader->written;
+  if (paLength > loSize) { // only the last bytes fit the ring
+    paData    += paLength - loSize;
+    loWritten += paLength - loSize;
+    paLength   = loSize;
+  }
+  loPosition = (size_t)(loWritten % loSize);
+  loFirst = loSize - loPosition;
+  if (loFirst > paLength) {
+    loFirst = paLength;
+  }
+  memcpy(this->atData + loPosition, paData, loFirst);
+  if (loFirst < paLength) {
+    memcpy(this->atData, paData + loFirst, paLength - loFirst);
+  }
+  // the counter is updated after the data, so the dumping process never sees the bytes not written yet
+  __atomic_store_n(&this->atHeader->written, loWritten + paLength, __ATOMIC_RELEASE);
+}
+
+
+void GNSSFlightRecorder::mark(const char *paLine, int8_t paStatus) {
+  struct GNSS_flight_marker *loMarker;
+  uint64_t loWritten;
+  uint64_t loIndex;
+  size_t loLength;
+
+  if ((NULL == this->atHeader) || (NULL == paLine) || (LINE_VALID == paStatus)) {
+    return;
+  }
+  loLength  = strlen(paLine);
+  loWritten = this->atHeader->written;
+  loIndex   = this->atHeader->markersWritten;
+  loMarker  = &this->atMarkers[loIndex % this->atHeader->markersMax];
+  // the odd stamp first - the dumping process doesn't take the marker being overwritten for the old one or the new one
+  __atomic_store_n(&loMarker->sequence, 2 * loIndex + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  __atomic_store_n(&loMarker->offset, (loWritten > loLength) ? (loWritten - loLength) : 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&loMarker->wallUs, flight_wall_time_us(), __ATOMIC_RELAXED);
+  __atomic_store_n(&loMarker->length, (uint16_t)loLength, __ATOMIC_RELAXED);
+  __atomic_store_n(&loMarker->status, paStatus, __ATOMIC_RELAXED);
+  __atomic_store_n(&loMarker->sequence, 2 * loIndex + 2, __ATOMIC_RELEASE);
+  __atomic_store_n(&this->atHeader->markersWritten, loIndex + 1, __ATOMIC_RELEASE);
+}
+
+
+void GNSSFlightRecorder::rawCallback(const char *paData, uint16_t paLength, void *paRecorder) {
+  ((GNSSFlightRecorder *)paRecorder)->record(paData, paLength);
+}
+
+
+void GNSSFlightRecorder::lineCallback(const char *paLine, int8_t paStatus, void *paRecorder) {
+  ((GNSSFlightRecorder *)paRecorder)->mark(paLine, paStatus);
+}
+
+
+void GNSSFlightRecorder::attach(GNSSCollector *paCollector) {
+  if (NULL == paCollector) {
+    return;
+  }
+  paCollector->setRawCallback(GNSSFlightRecorder::rawCallback, this);
+  paCollector->setLineCallback(GNSSFlightRecorder::lineCallback, this);
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ********************************************************* the flight recorder file management  ****************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+int8_t GNSSFlightRecorder::open(const char *paPath, size_t paDataSize, uint32_t paMarkersMax) {
+  struct stat loStat;
+  size_t loFileSize;
+  bool loContinue = false;
+  void *loMap;
+  int loFd;
+
+  this->close();
+  if ((NULL == paPath) || (0 == paDataSize) || (0 == paMarkersMax)) {
+    return (-1);
+  }
+  loFileSize = flight_file_size(paDataSize, paMarkersMax);
+
+  loFd = ::open(paPath, O_RDWR | O_CREAT, 0644);
+  if (0 > loFd) {
+    SETCOLORRED DBG("The flight recorder file can not be opened\r\n"); NOCOLOR
+    return (-1);
+  }
+  if ((0 == fstat(loFd, &loStat)) && ((size_t)loStat.st_size == loFileSize)) {
+    loContinue = true; // the header is checked below
+  } else if ((0 != ftruncate(loFd, 0)) || (0 != ftruncate(loFd, (off_t)loFileSize))) {
+    SETCOLORRED DBG("The flight recorder file can not be resized\r\n"); NOCOLOR
+    ::close(loFd);
+    return (-1);
+  }
+  loMap = mmap(NULL, loFileSize, PROT_READ | PROT_WRITE, MAP_SHARED, loFd, 0);
+  ::close(loFd);
+  if (MAP_FAILED == loMap) {
+    SETCOLORRED DBG("The flight recorder file can not be mapped into the memory\r\n"); NOCOLOR
+    return (-1);
+  }
+  this->atMap     = (uint8_t *)loMap;
+  this->atMapSize = loFileSize;
+  this->atHeader  = (struct GNSS_flight_header *)loMap;
+  this->atData    = this->atMap + GNSS_FLIGHT_HEADER_SIZE;
+  this->atMarkers = (struct GNSS_flight_marker *)(this->atData + paDataSize);
+
+  if (  (loContinue)
+     && (0 == memcmp(this->atHeader->magic, GNSS_FLIGHT_MAGIC, sizeof(GNSS_FLIGHT_MAGIC)))
+     && (GNSS_FLIGHT_VERSION == this->atHeader->version)
+     && (paDataSize == this->atHeader->dataSize)
+     && (paMarkersMax == this->atHeader->markersMax) ) {
+    return (0); // the recording is continued
+  }
+  memset(this->atMap, 0, loFileSize);
+  memcpy(this->atHeader->magic, GNSS_FLIGHT_MAGIC, sizeof(GNSS_FLIGHT_MAGIC));
+  this->atHeader->version       = GNSS_FLIGHT_VERSION;
+  this->atHeader->markersMax    = paMarkersMax;
+  this->atHeader->dataSize      = paDataSize;
+  this->atHeader->createdWallUs = flight_wall_time_us();
+  return (0);
+}
+
+
+void GNSSFlightRecorder::close(void) {
+  if (NULL != this->atMap) {
+    munmap(this->atMap, this->atMapSize); // the data is written to the file by the kernel (no msync is needed for the post-mortem)
+    this->atMap     = NULL;
+    this->atMapSize = 0;
+    this->atHeader  = NULL;
+    this->atData    = NULL;
+    this->atMarkers = NULL;
+  }
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ************************************************************* the post-mortem dump  ****************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+// it maps the recorder file (read only) and checks its header - returns NULL if the file is not correct
+static const uint8_t *flight_map(const char *paPath, size_t *paSize) {
+  const struct GNSS_flight_header *loHeader;
+  struct stat loStat;
+  void *loMap;
+  int loFd;
+
+  loFd = open(paPath, O_RDONLY);
+  if (0 > loFd) {
+    return (NULL);
+  }
+  if ((0 != fstat(loFd, &loStat)) || (GNSS_FLIGHT_HEADER_SIZE > loStat.st_size)) {
+    close(loFd);
+    return (NULL);
+  }
+  loMap = mmap(NULL, (size_t)loStat.st_size, PROT_READ, MAP_SHARED, loFd, 0);
+  close(loFd);
+  if (MAP_FAILED == loMap) {
+    return (NULL);
+  }
+  loHeader = (const struct GNSS_flight_header *)loMap;
+  if (  (memcmp(loHeader->magic, GNSS_FLIGHT_MAGIC, sizeof(GNSS_FLIGHT_MAGIC)))
+     || (GNSS_FLIGHT_VERSION != loHeader->version)
+     || (0 == loHeader->dataSize) || (0 == loHeader->markersMax)
+     || (flight_file_size(loHeader->dataSize, loHeader->markersMax) != (size_t)loStat.st_size) ) {
+    SETCOLORRED DBG("The file is not the flight recorder file or its version is not supported\r\n"); NOCOLOR
+    munmap(loMap, (size_t)loStat.st_size);
+    return (NULL);
+  }
+  *paSize = (size_t)loStat.st_size;
+  return ((const uint8_t *)loMap);
+}
+
+
+int8_t GNSSFlightRecorder::dumpRaw(const char *paPath, FILE *paOut) {
+  const struct GNSS_flight_header *loHeader;
+  const uint8_t *loMap;
+  const uint8_t *loData;
+  uint64_t loWritten;
+  size_t loSize;
+  size_t loPosition;
+
+  if ((NULL == paPath) || (NULL == paOut) || (NULL == (loMap = flight_map(paPath, &loSize)))) {
+    return (-1);
+  }
+  loHeader  = (const struct GNSS_flight_header *)loMap;
+  loData    = loMap + GNSS_FLIGHT_HEADER_SIZE;
+  loWritten = __atomic_load_n(&loHeader->written, __ATOMIC_ACQUIRE);
+
+  if (loWritten <= loHeader->dataSize) {
+    fwrite(loData, 1, (size_t)loWritten, paOut);
+  } else { // the ring has been filled - the oldest byte is at the current position
+    loPosition = (size_t)(loWritten % loHeader->dataSize);
+    fwrite(loData + loPosition, 1, (size_t)loHeader->dataSize - loPosition, paOut);
+    fwrite(loData, 1, loPosition, paOut);
+  }
+  munmap((void *)loMap, loSize);
+  return (0);
+}
+
+
+int8_t GNSSFlightRecorder::dumpMarkers(const char *paPath, FILE *paOut) {
+  const struct GNSS_flight_header *loHeader;
+  const struct GNSS_flight_marker *loMarkers;
+  const uint8_t *loMap;
+  const uint8_t *loData;
+  uint64_t loWritten;
+  uint64_t loMarkersWritten;
+  uint64_t loFirst;
+  uint64_t loSkipped = 0;
+  uint64_t k;
+  size_t loSize;
+  uint8_t *loLine;
+  uint16_t i;
+  char loTime[32];
+  time_t loSeconds;
+  struct tm loTm;
+
+  if ((NULL == paPath) || (NULL == paOut) || (NULL == (loMap = flight_map(paPath, &loSize)))) {
+    return (-1);
+  }
+  loLine = (uint8_t *)malloc(UINT16_MAX); // the copy of the line (the marker length is 16 bits)
+  if (NULL == loLine) {
+    munmap((void *)loMap, loSize);
+    return (-1);
+  }
+  loHeader         = (const struct GNSS_flight_header *)loMap;
+  loData           = loMap + GNSS_FLIGHT_HEADER_SIZE;
+  loMarkers        = (const struct GNSS_flight_marker *)(loData + loHeader->dataSize);
+  loWritten        = __atomic_load_n(&loHeader->written, __ATOMIC_ACQUIRE);
+  loMarkersWritten = __atomic_load_n(&loHeader->markersWritten, __ATOMIC_ACQUIRE);
+  loFirst          = (loMarkersWritten > loHeader->markersMax) ? (loMarkersWritten - loHeader->markersMax) : 0;
+
+  fprintf(paOut, "%llu bytes recorded (the last %llu kept), %llu lines rejected (the last %llu kept)\r\n",
+          (unsigned long long)loWritten, (unsigned long long)((loWritten < loHeader->dataSize) ? loWritten : loHeader->dataSize),
+          (unsigned long long)loMarkersWritten, (unsigned long long)(loMarkersWritten - loFirst));
+
+  for (k = loFirst; k < loMarkersWritten; k++) {
+    const struct GNSS_flight_marker *loSlot = &loMarkers[k % loHeader->markersMax];
+    struct GNSS_flight_marker loCopy;
+    const struct GNSS_flight_marker *loMarker = &loCopy;
+
+    // the marker is copied and used only if its stamp is the expected one before and after the copy (not overwritten meanwhile)
+    loCopy.sequence = __atomic_load_n(&loSlot->sequence, __ATOMIC_ACQUIRE);
+    loCopy.offset   = __atomic_load_n(&loSlot->offset, __ATOMIC_RELAXED);
+    loCopy.wallUs   = __atomic_load_n(&loSlot->wallUs, __ATOMIC_RELAXED);
+    loCopy.length   = __atomic_load_n(&loSlot->length, __ATOMIC_RELAXED);
+    loCopy.status   = __atomic_load_n(&loSlot->status, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if ((2 * k + 2 != loCopy.sequence) || (loCopy.sequence != __atomic_load_n(&loSlot->sequence, __ATOMIC_RELAXED))) {
+      loSkipped++;
+      continue;
+    }
+
+    loSeconds = (time_t)(loMarker->wallUs / 1000000);
+    gmtime_r(&loSeconds, &loTm);
+    strftime(loTime, sizeof(loTime), "%Y-%m-%d %H:%M:%S", &loTm);
+    fprintf(paOut, "%s.%06u  offset %12llu  %-9s  length %3u  ", loTime, (unsigned int)(loMarker->wallUs % 1000000),
+            (unsigned long long)loMarker->offset,
+            (LINE_CHECKSUM == loMarker->status) ? "checksum" : (LINE_TOO_LONG == loMarker->status) ? "too long" :
+            (LINE_REJECTED == loMarker->status) ? "rejected" : "malformed", loMarker->length);
+
+    // the line is printed if it is still kept in the data ring - it is copied first, the recorder may overwrite it meanwhile
+    if ((loMarker->offset + loHeader->dataSize < loWritten) || (loMarker->offset + loMarker->length > loWritten)) {
+      fprintf(paOut, "(overwritten)\r\n");
+      continue;
+    }
+    for (i = 0; i < loMarker->length; i++) {
+      loLine[i] = loData[(loMarker->offset + i) % loHeader->dataSize];
+    }
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (loMarker->offset + loHeader->dataSize < __atomic_load_n(&loHeader->written, __ATOMIC_RELAXED)) {
+      fprintf(paOut, "(overwritten)\r\n");
+      continue;
+    }
+    for (i = 0; i < loMarker->length; i++) {
+      uint8_t loByte = loLine[i];
+      if ('\r' == loByte) {
+        fprintf(paOut, "\\r");
+      } else if ('\n' == loByte) {
+        fprintf(paOut, "\\n");
+      } else if ((0x20 > loByte) || (0x7E < loByte)) {
+        fprintf(paOut, "\\x%02X", loByte);
+      } else {
+        fputc(loByte, paOut);
+      }
+    }
+    fprintf(paOut, "\r\n");
+  }
+  if (0 < loSkipped) {
+    fprintf(paOut, "%llu markers overwritten by the recorder during the dump were skipped\r\n", (unsigned long long)loSkipped);
+  }
+  free(loLine);
+  munmap((void *)loMap, loSize);
+  return (0);
+}
+
+#endif // linux
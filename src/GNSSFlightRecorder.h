@@ -0,0 +1,104 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef GNSS_FLIGHT_RECORDER_H
+#define GNSS_FLIGHT_RECORDER_H
+
+#include "ultimateGNSSParser.h"
+
+// The flight recorder is available on linux only (it needs the memory-mapped file), the file is compiled to nothing on the other platforms.
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include <stddef.h>
+#include <stdio.h>
+
+/***************************************************************************************************************************************************
+ ************************************************************* the flight recorder file *************************************************************
+ ***************************************************************************************************************************************************/
+
+// The file is mapped into the memory (MAP_SHARED), so the data stays in the page cache when the process crashes
+// and it can be dumped later (e.g. with GNSS_replay -F). The layout (little endian on the supported platforms):
+//   the header           4096 bytes (struct GNSS_flight_header)
+//   the data ring        dataSize bytes - the last dataSize bytes of the raw input
+//   the marker ring      markersMax * struct GNSS_flight_marker - the last rejected lines
+#define GNSS_FLIGHT_VERSION      2
+#define GNSS_FLIGHT_HEADER_SIZE  4096
+
+struct GNSS_flight_header {
+  char     magic[8];          // "GNSSFLT" + '\0'
+  uint32_t version;           // GNSS_FLIGHT_VERSION
+  uint32_t markersMax;        // the capacity of the marker ring
+  uint64_t dataSize;          // the capacity of the data ring [bytes]
+  uint64_t written;           // the number of the bytes written since the file has been created (the ring position is written % dataSize)
+  uint64_t markersWritten;    // the number of the markers written since the file has been created
+  uint64_t createdWallUs;     // the wall clock time of the file creation [us since 1970-01-01]
+};
+
+// Every marker is stamped with its index (the seqlock of the single marker): the dump of the live file skips the marker
+// which is being overwritten (the ring has wrapped) instead of printing its fields mixed up.
+struct GNSS_flight_marker {
+  uint64_t sequence;          // 2 * (the index of the marker + 1) - odd while the marker is being written, 0 - never written
+  uint64_t offset;            // the position of the first byte of the line in the whole input (comparable with GNSS_flight_header::written)
+  uint64_t wallUs;            // the wall clock time of the rejection [us since 1970-01-01]
+  uint16_t length;            // the length of the line
+  int8_t   status;            // LINE_MALFORMED, LINE_CHECKSUM, LINE_TOO_LONG or LINE_REJECTED
+  uint8_t  reserved[5];
+};
+
+
+// The recorder is connected to the collector with the raw data callback and the line callback (see attach()).
+// The cost on the collectData() path is the memcpy of the received bytes - the markers are written for the rejected lines only.
+class GNSSFlightRecorder {
+private:
+  uint8_t                   *atMap;
+  size_t                     atMapSize;
+  struct GNSS_flight_header *atHeader;
+  uint8_t                   *atData;
+  struct GNSS_flight_marker *atMarkers;
+
+public:
+  GNSSFlightRecorder(void);
+  ~GNSSFlightRecorder(void);
+
+  // It opens the recorder file - the file with the same sizes is continued (the history of the previous runs is kept),
+  // otherwise it is created from scratch. It returns 0 on success or -1 if the file can not be created or mapped.
+  int8_t open(const char *paPath, size_t paDataSize = 4*1024*1024, uint32_t paMarkersMax = 4096);
+  void   close(void);
+
+  // it stores the raw bytes (the same as rawCallback)
+  void record(const char *paData, size_t paLength);
+  // it stores the marker of the line with the given status (the line has been received just before)
+  void mark(const char *paLine, int8_t paStatus);
+
+  // the callbacks to be given to GNSSCollector::setRawCallback() and GNSSCollector::setLineCallback() with the recorder as the user data
+  static void rawCallback(const char *paData, uint16_t paLength, void *paRecorder);
+  static void lineCallback(const char *paLine, int8_t paStatus, void *paRecorder);
+  // it sets both the callbacks of the collector
+  void attach(GNSSCollector *paCollector);
+
+  // The post-mortem dump of the recorder file (it may be used by another process while the recorder is working).
+  // dumpRaw() writes the raw bytes kept in the ring (from the oldest one), dumpMarkers() prints the markers of the rejected lines
+  // with the lines themselves (if they are still kept in the data ring). They return 0 on success or -1 if the file is not correct.
+  static int8_t dumpRaw(const char *paPath, FILE *paOut);
+  static int8_t dumpMarkers(const char *paPath, FILE *paOut);
+};
+
+#endif // linux
+
+#endif
@@ -0,0 +1,734 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "GNSSGeodesy.h"
+#include <math.h>
+
+// the AVX2 kernels are built with the target attributes (the rest of the library needs no special compiler options)
+// and used when the CPU has AVX2 and FMA
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(ARDUINO)
+#define GEODESY_AVX2
+#include <immintrin.h>
+#endif
+
+#define GEODESY_DEG_TO_RAD   0.017453292519943295
+#define GEODESY_RAD_TO_DEG   57.29577951308232
+#define GEODESY_WGS84_B      (GNSS_WGS84_A * (1.0 - GNSS_WGS84_F))   // the semi-minor axis [m]
+#define GEODESY_VINCENTY_EPS 1e-12                                   // the convergence of the longitude on the auxiliary sphere [rad]
+#define GEODESY_VINCENTY_MAX 100                                     // the iterations before the points are treated as nearly antipodal
+
+static int8_t gSIMD = -1;    // the vector kernels are used (1) or not (0), -1: the CPU has not been checked yet
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ *************************************************************** the scalar kernels  ***************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+static inline void ecef_fix(double paLat, double paLon, double paHeight, double *paX, double *paY, double *paZ) {
+  double loSinLat = sin(paLat * GEODESY_DEG_TO_RAD);
+  double loCosLat = cos(paLat * GEODESY_DEG_TO_RAD);
+  double loN      = GNSS_WGS84_A / sqrt(1.0 - GNSS_WGS84_E2 * loSinLat * loSinLat);   // the prime vertical radius
+
+  *paX = (loN + paHeight) * loCosLat * cos(paLon * GEODESY_DEG_TO_RAD);
+  *paY = (loN + paHeight) * loCosLat * sin(paLon * GEODESY_DEG_TO_RAD);
+  *paZ = (loN * (1.0 - GNSS_WGS84_E2) + paHeight) * loSinLat;
+}
+
+
+static inline void enu_fix(const struct GNSS_enu_reference *paRef, double paX, double paY, double paZ, double *paEast, double *paNorth, double *paUp) {
+  double loDX = paX - paRef->x;
+  double loDY = paY - paRef->y;
+  double loDZ = paZ - paRef->z;
+  double loT  = paRef->cosLon * loDX + paRef->sinLon * loDY;
+
+  *paEast  = paRef->cosLon * loDY - paRef->sinLon * loDX;
+  *paNorth = paRef->cosLat * loDZ - paRef->sinLat * loT;
+  *paUp    = paRef->cosLat * loT  + paRef->sinLat * loDZ;
+}
+
+
+static inline double height_of(const double *paAlt, const double *paUndulation, uint32_t i) {
+  return (((NULL != paAlt) ? paAlt[i] : 0.0) + ((NULL != paUndulation) ? paUndulation[i] : 0.0));
+}
+
+
+static void ecef_scalar(const double *paLat, const double *paLon, const double *paAlt, const double *paUndulation, uint32_t paCount,
+                        double *paX, double *paY, double *paZ) {
+  uint32_t i;
+
+  for (i = 0; i < paCount; i++) {
+    ecef_fix(paLat[i], paLon[i], height_of(paAlt, paUndulation, i), &paX[i], &paY[i], &paZ[i]);
+  }
+}
+
+
+static void enu_scalar(const struct GNSS_enu_reference *paRef, const double *paLat, const double *paLon, const double *paAlt, const double *paUndulation,
+                       uint32_t paCount, double *paEast, double *paNorth, double *paUp) {
+  double loX, loY, loZ;
+  uint32_t i;
+
+  for (i = 0; i < paCount; i++) {
+    ecef_fix(paLat[i], paLon[i], height_of(paAlt, paUndulation, i), &loX, &loY, &loZ);
+    enu_fix(paRef, loX, loY, loZ, &paEast[i], &paNorth[i], &paUp[i]);
+  }
+}
+
+
+static void ecef_enu_scalar(const struct GNSS_enu_reference *paRef, const double *paX, const double *paY, const double *paZ, uint32_t paCount,
+                            double *paEast, double *paNorth, double *paUp) {
+  uint32_t i;
+
+  for (i = 0; i < paCount; i++) {
+    enu_fix(paRef, paX[i], paY[i], paZ[i], &paEast[i], &paNorth[i], &paUp[i]);
+  }
+}
+
+
+// the longitude difference in [-180, 180] deg
+static inline double wrap_lon(double paDelta) {
+  return (paDelta - 360.0 * round(paDelta / 360.0));
+}
+
+
+static inline double bearing_deg(double paY, double paX) {
+  double loBearing = atan2(paY, paX) * GEODESY_RAD_TO_DEG;
+
+  return ((0.0 > loBearing) ? (loBearing + 360.0) : loBearing);
+}
+
+
+static void equirectangular_fix(double paLat1, double paLon1, double paLat2, double paLon2, double *paDistance, double *paBearing) {
+  double loX = wrap_lon(paLon2 - paLon1) * cos((paLat1 + paLat2) * 0.5 * GEODESY_DEG_TO_RAD);
+  double loY = paLat2 - paLat1;
+
+  *paDistance = GNSS_EARTH_RADIUS * GEODESY_DEG_TO_RAD * sqrt(loX * loX + loY * loY);
+  if (NULL != paBearing) {
+    *paBearing = bearing_deg(loX, loY);
+  }
+}
+
+
+static void haversine_fix(double paLat1, double paLon1, double paLat2, double paLon2, double *paDistance, double *paBearing) {
+  double loSinLat = sin((paLat2 - paLat1) * 0.5 * GEODESY_DEG_TO_RAD);
+  double loSinLon = sin((paLon2 - paLon1) * 0.5 * GEODESY_DEG_TO_RAD);
+  double loCosLat1 = cos(paLat1 * GEODESY_DEG_TO_RAD);
+  double loCosLat2 = cos(paLat2 * GEODESY_DEG_TO_RAD);
+  double loA = loSinLat * loSinLat + loCosLat1 * loCosLat2 * loSinLon * loSinLon;
+
+  loA = (loA > 1.0) ? 1.0 : loA; // not fmin() - the NaN stays NaN
+
+  *paDistance = 2.0 * GNSS_EARTH_RADIUS * atan2(sqrt(loA), sqrt(1.0 - loA));
+  if (NULL != paBearing) {
+    double loDLon = (paLon2 - paLon1) * GEODESY_DEG_TO_RAD;
+    *paBearing = bearing_deg(sin(loDLon) * loCosLat2,
+                             loCosLat1 * sin(paLat2 * GEODESY_DEG_TO_RAD) - sin(paLat1 * GEODESY_DEG_TO_RAD) * loCosLat2 * cos(loDLon));
+  }
+}
+
+
+// the inverse problem of Vincenty (1975) on the WGS84 ellipsoid
+static void vincenty_fix(double paLat1, double paLon1, double paLat2, double paLon2, double *paDistance, double *paBearing) {
+  double loSin1 = sin(paLat1 * GEODESY_DEG_TO_RAD), loCos1 = cos(paLat1 * GEODESY_DEG_TO_RAD);
+  double loSin2 = sin(paLat2 * GEODESY_DEG_TO_RAD), loCos2 = cos(paLat2 * GEODESY_DEG_TO_RAD);
+  double loL = wrap_lon(paLon2 - paLon1) * GEODESY_DEG_TO_RAD;
+  double loLambda = loL, loLast;
+  double loSinU1, loCosU1, loSinU2, loCosU2, loR;
+  double loSinLambda, loCosLambda, loSinSigma, loCosSigma, loSigma, loSinAlpha, loCos2Alpha, loCos2SigmaM, loC;
+  double loU2, loA, loB, loDSigma;
+  uint8_t i = 0;
+
+  // the reduced latitudes: tan(U) = (1 - f) * tan(lat)
+  loR = 1.0 / sqrt(loCos1 * loCos1 + (1.0 - GNSS_WGS84_F) * (1.0 - GNSS_WGS84_F) * loSin1 * loSin1);
+  loSinU1 = (1.0 - GNSS_WGS84_F) * loSin1 * loR;
+  loCosU1 = loCos1 * loR;
+  loR = 1.0 / sqrt(loCos2 * loCos2 + (1.0 - GNSS_WGS84_F) * (1.0 - GNSS_WGS84_F) * loSin2 * loSin2);
+  loSinU2 = (1.0 - GNSS_WGS84_F) * loSin2 * loR;
+  loCosU2 = loCos2 * loR;
+
+  do {
+    loSinLambda  = sin(loLambda);
+    loCosLambda  = cos(loLambda);
+    loR          = loCosU1 * loSinU2 - loSinU1 * loCosU2 * loCosLambda;
+    loSinSigma   = sqrt((loCosU2 * loSinLambda) * (loCosU2 * loSinLambda) + loR * loR);
+    loCosSigma   = loSinU1 * loSinU2 + loCosU1 * loCosU2 * loCosLambda;
+    loSigma      = atan2(loSinSigma, loCosSigma);
+    loSinAlpha   = (0.0 != loSinSigma) ? (loCosU1 * loCosU2 * loSinLambda / loSinSigma) : 0.0;
+    loCos2Alpha  = 1.0 - loSinAlpha * loSinAlpha;
+    loCos2SigmaM = (0.0 != loCos2Alpha) ? (loCosSigma - 2.0 * loSinU1 * loSinU2 / loCos2Alpha) : 0.0;   // the equatorial line
+    loC          = GNSS_WGS84_F / 16.0 * loCos2Alpha * (4.0 + GNSS_WGS84_F * (4.0 - 3.0 * loCos2Alpha));
+    loLast       = loLambda;
+    loLambda     = loL + (1.0 - loC) * GNSS_WGS84_F * loSinAlpha *
+                   (loSigma + loC * loSinSigma * (loCos2SigmaM + loC * loCosSigma * (-1.0 + 2.0 * loCos2SigmaM * loCos2SigmaM)));
+  } while ((fabs(loLambda - loLast) > GEODESY_VINCENTY_EPS) && (++i < GEODESY_VINCENTY_MAX));
+
+  if (fabs(loLambda - loLast) > GEODESY_VINCENTY_EPS) {
+    *paDistance = NAN;
+    if (NULL != paBearing) {
+      *paBearing = NAN;
+    }
+    return;
+  }
+  loU2 = loCos2Alpha * (GNSS_WGS84_A * GNSS_WGS84_A - GEODESY_WGS84_B * GEODESY_WGS84_B) / (GEODESY_WGS84_B * GEODESY_WGS84_B);
+  loA  = 1.0 + loU2 / 16384.0 * (4096.0 + loU2 * (-768.0 + loU2 * (320.0 - 175.0 * loU2)));
+  loB  = loU2 / 1024.0 * (256.0 + loU2 * (-128.0 + loU2 * (74.0 - 47.0 * loU2)));
+  loDSigma = loB * loSinSigma * (loCos2SigmaM + loB / 4.0 * (loCosSigma * (-1.0 + 2.0 * loCos2SigmaM * loCos2SigmaM) -
+                                 loB / 6.0 * loCos2SigmaM * (-3.0 + 4.0 * loSinSigma * loSinSigma) * (-3.0 + 4.0 * loCos2SigmaM * loCos2SigmaM)));
+  *paDistance = GEODESY_WGS84_B * loA * (loSigma - loDSigma);
+  if (NULL != paBearing) {
+    *paBearing = bearing_deg(loCosU2 * loSinLambda, loCosU1 * loSinU2 - loSinU1 * loCosU2 * loCosLambda);
+  }
+}
+
+
+// paFixed: the point 1 is the same for all the points 2 (paLat1[0], paLon1[0])
+static void distance_scalar(uint8_t paTier, const double *paLat1, const double *paLon1, bool paFixed, const double *paLat2, const double *paLon2,
+                            uint32_t paCount, double *paDistance, double *paBearing) {
+  void (*loKernel)(double, double, double, double, double *, double *);
+  uint32_t i, j;
+
+  switch (paTier) {
+    case GNSS_DISTANCE_EQUIRECTANGULAR:
+            loKernel = equirectangular_fix;
+            break;
+    case GNSS_DISTANCE_HAVERSINE:
+            loKernel = haversine_fix;
+            break;
+    default:
+            loKernel = vincenty_fix;
+            break;
+  }
+  for (i = 0; i < paCount; i++) {
+    j = paFixed ? 0 : i;
+    loKernel(paLat1[j], paLon1[j], paLat2[i], paLon2[i], &paDistance[i], (NULL != paBearing) ? &paBearing[i] : NULL);
+  }
+}
+
+
+#ifdef GEODESY_AVX2
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ **************************************************************** the AVX2 kernels  ****************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+#define GEODESY_AVX2_INLINE   static inline __attribute__((target("avx2,fma"), always_inline))
+#define GEODESY_AVX2_FUNCTION static __attribute__((target("avx2,fma")))
+
+// the lanes of the last (partial) vector
+GEODESY_AVX2_INLINE __m256i tail_mask(uint32_t paLeft) {
+  return (_mm256_cmpgt_epi64(_mm256_set1_epi64x(paLeft), _mm256_setr_epi64x(0, 1, 2, 3)));
+}
+
+
+GEODESY_AVX2_INLINE __m256d load4(const double *paArray, uint32_t i, __m256i paMask, bool paFull) {
+  if (NULL == paArray) {
+    return (_mm256_setzero_pd());
+  }
+  return (paFull ? _mm256_loadu_pd(paArray + i) : _mm256_maskload_pd(paArray + i, paMask));
+}
+
+
+GEODESY_AVX2_INLINE void store4(double *paArray, uint32_t i, __m256d paValue, __m256i paMask, bool paFull) {
+  if (paFull) {
+    _mm256_storeu_pd(paArray + i, paValue);
+  } else {
+    _mm256_maskstore_pd(paArray + i, paMask, paValue);
+  }
+}
+
+
+// The sine and the cosine of the angles in degrees. The angle is reduced to [-45, 45] deg exactly in degrees (r = deg - 90 * k),
+// so no precision is lost for any angle, then the polynomials of fdlibm (within ~1 ulp on [-pi/4, pi/4]) are swapped and negated
+// by the quadrant k.
+GEODESY_AVX2_INLINE void sincos4(__m256d paDegrees, __m256d *paSin, __m256d *paCos) {
+  __m256d loK = _mm256_round_pd(_mm256_mul_pd(paDegrees, _mm256_set1_pd(1.0 / 90.0)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m256d loX = _mm256_mul_pd(_mm256_fnmadd_pd(loK, _mm256_set1_pd(90.0), paDegrees), _mm256_set1_pd(GEODESY_DEG_TO_RAD));
+  __m256d loZ = _mm256_mul_pd(loX, loX);
+  __m256d loS, loC;
+  __m256i loQ, loSwap;
+
+  loS = _mm256_fmadd_pd(loZ, _mm256_set1_pd(1.58969099521155010221e-10), _mm256_set1_pd(-2.50507602534068634195e-08));
+  loS = _mm256_fmadd_pd(loZ, loS, _mm256_set1_pd(2.75573137070700676789e-06));
+  loS = _mm256_fmadd_pd(loZ, loS, _mm256_set1_pd(-1.98412698298579493134e-04));
+  loS = _mm256_fmadd_pd(loZ, loS, _mm256_set1_pd(8.33333333332248946124e-03));
+  loS = _mm256_fmadd_pd(loZ, loS, _mm256_set1_pd(-1.66666666666666324348e-01));
+  loS = _mm256_fmadd_pd(_mm256_mul_pd(loZ, loX), loS, loX);
+
+  loC = _mm256_fmadd_pd(loZ, _mm256_set1_pd(-1.13596475577881948265e-11), _mm256_set1_pd(2.08757232129817482790e-09));
+  loC = _mm256_fmadd_pd(loZ, loC, _mm256_set1_pd(-2.75573143513906633035e-07));
+  loC = _mm256_fmadd_pd(loZ, loC, _mm256_set1_pd(2.48015872894767294178e-05));
+  loC = _mm256_fmadd_pd(loZ, loC, _mm256_set1_pd(-1.38888888888741095749e-03));
+  loC = _mm256_fmadd_pd(loZ, loC, _mm256_set1_pd(4.16666666666666019037e-02));
+  loC = _mm256_fmadd_pd(_mm256_mul_pd(loZ, loZ), loC, _mm256_fnmadd_pd(_mm256_set1_pd(0.5), loZ, _mm256_set1_pd(1.0)));
+
+  // k = 1: (cos, -sin), k = 2: (-sin, -cos), k = 3: (-cos, sin)
+  loQ    = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(loK));
+  loSwap = _mm256_cmpeq_epi64(_mm256_and_si256(loQ, _mm256_set1_epi64x(1)), _mm256_set1_epi64x(1));
+  *paSin = _mm256_blendv_pd(loS, loC, _mm256_castsi256_pd(loSwap));
+  *paCos = _mm256_blendv_pd(loC, loS, _mm256_castsi256_pd(loSwap));
+  *paSin = _mm256_xor_pd(*paSin, _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_and_si256(loQ, _mm256_set1_epi64x(2)), 62)));
+  *paCos = _mm256_xor_pd(*paCos, _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_and_si256(_mm256_add_epi64(loQ, _mm256_set1_epi64x(1)),
+                                                                                        _mm256_set1_epi64x(2)), 62)));
+}
+
+
+GEODESY_AVX2_INLINE void ecef4(__m256d paLat, __m256d paLon, __m256d paHeight, __m256d *paX, __m256d *paY, __m256d *paZ) {
+  __m256d loSinLat, loCosLat, loSinLon, loCosLon, loN, loR;
+
+  sincos4(paLat, &loSinLat, &loCosLat);
+  sincos4(paLon, &loSinLon, &loCosLon);
+  loN = _mm256_fnmadd_pd(_mm256_mul_pd(_mm256_set1_pd(GNSS_WGS84_E2), loSinLat), loSinLat, _mm256_set1_pd(1.0));
+  loN = _mm256_div_pd(_mm256_set1_pd(GNSS_WGS84_A), _mm256_sqrt_pd(loN));
+  loR = _mm256_mul_pd(_mm256_add_pd(loN, paHeight), loCosLat);
+  *paX = _mm256_mul_pd(loR, loCosLon);
+  *paY = _mm256_mul_pd(loR, loSinLon);
+  *paZ = _mm256_mul_pd(_mm256_fmadd_pd(loN, _mm256_set1_pd(1.0 - GNSS_WGS84_E2), paHeight), loSinLat);
+}
+
+
+GEODESY_AVX2_INLINE void enu4(const struct GNSS_enu_reference *paRef, __m256d paX, __m256d paY, __m256d paZ,
+                              __m256d *paEast, __m256d *paNorth, __m256d *paUp) {
+  __m256d loDX = _mm256_sub_pd(paX, _mm256_set1_pd(paRef->x));
+  __m256d loDY = _mm256_sub_pd(paY, _mm256_set1_pd(paRef->y));
+  __m256d loDZ = _mm256_sub_pd(paZ, _mm256_set1_pd(paRef->z));
+  __m256d loSinLat = _mm256_set1_pd(paRef->sinLat);
+  __m256d loCosLat = _mm256_set1_pd(paRef->cosLat);
+  __m256d loSinLon = _mm256_set1_pd(paRef->sinLon);
+  __m256d loCosLon = _mm256_set1_pd(paRef->cosLon);
+  __m256d loT      = _mm256_fmadd_pd(loCosLon, loDX, _mm256_mul_pd(loSinLon, loDY));
+
+  *paEast  = _mm256_fnmadd_pd(loSinLon, loDX, _mm256_mul_pd(loCosLon, loDY));
+  *paNorth = _mm256_fnmadd_pd(loSinLat, loT, _mm256_mul_pd(loCosLat, loDZ));
+  *paUp    = _mm256_fmadd_pd(loCosLat, loT, _mm256_mul_pd(loSinLat, loDZ));
+}
+
+
+GEODESY_AVX2_INLINE void ecef_block(const double *paLat, const double *paLon, const double *paAlt, const double *paUndulation, uint32_t i,
+                                    __m256i paMask, bool paFull, __m256d *paX, __m256d *paY, __m256d *paZ) {
+  __m256d loHeight = _mm256_add_pd(load4(paAlt, i, paMask, paFull), load4(paUndulation, i, paMask, paFull));
+
+  ecef4(load4(paLat, i, paMask, paFull), load4(paLon, i, paMask, paFull), loHeight, paX, paY, paZ);
+}
+
+
+GEODESY_AVX2_FUNCTION void ecef_avx2(const double *paLat, const double *paLon, const double *paAlt, const double *paUndulation, uint32_t paCount,
+                                     double *paX, double *paY, double *paZ) {
+  __m256i loMask = _mm256_set1_epi64x(-1);
+  __m256d loX, loY, loZ;
+  uint32_t i;
+
+  for (i = 0; (i + 4) <= paCount; i += 4) {
+    ecef_block(paLat, paLon, paAlt, paUndulation, i, loMask, true, &loX, &loY, &loZ);
+    store4(paX, i, loX, loMask, true);
+    store4(paY, i, loY, loMask, true);
+    store4(paZ, i, loZ, loMask, true);
+  }
+  if (i < paCount) {
+    loMask = tail_mask(paCount - i);
+    ecef_block(paLat, paLon, paAlt, paUndulation, i, loMask, false, &loX, &loY, &loZ);
+    store4(paX, i, loX, loMask, false);
+    store4(paY, i, loY, loMask, false);
+    store4(paZ, i, loZ, loMask, false);
+  }
+}
+
+
+GEODESY_AVX2_FUNCTION void enu_avx2(const struct GNSS_enu_reference *paRef, const double *paLat, const double *paLon, const double *paAlt,
+                                    const double *paUndulation, uint32_t paCount, double *paEast, double *paNorth, double *paUp) {
+  __m256i loMask = _mm256_set1_epi64x(-1);
+  __m256d loX, loY, loZ;
+  uint32_t i;
+
+  for (i = 0; (i + 4) <= paCount; i += 4) {
+    ecef_block(paLat, paLon, paAlt, paUndulation, i, loMask, true, &loX, &loY, &loZ);
+    enu4(paRef, loX, loY, loZ, &loX, &loY, &loZ);
+    store4(paEast, i, loX, loMask, true);
+    store4(paNorth, i, loY, loMask, true);
+    store4(paUp, i, loZ, loMask, true);
+  }
+  if (i < paCount) {
+    loMask = tail_mask(paCount - i);
+    ecef_block(paLat, paLon, paAlt, paUndulation, i, loMask, false, &loX, &loY, &loZ);
+    enu4(paRef, loX, loY, loZ, &loX, &loY, &loZ);
+    store4(paEast, i, loX, loMask, false);
+    store4(paNorth, i, loY, loMask, false);
+    store4(paUp, i, loZ, loMask, false);
+  }
+}
+
+
+GEODESY_AVX2_FUNCTION void ecef_enu_avx2(const struct GNSS_enu_reference *paRef, const double *paX, const double *paY, const double *paZ, uint32_t paCount,
+                                         double *paEast, double *paNorth, double *paUp) {
+  __m256i loMask = _mm256_set1_epi64x(-1);
+  __m256d loE, loN, loU;
+  uint32_t i;
+
+  for (i = 0; (i + 4) <= paCount; i += 4) {
+    enu4(paRef, _mm256_loadu_pd(paX + i), _mm256_loadu_pd(paY + i), _mm256_loadu_pd(paZ + i), &loE, &loN, &loU);
+    store4(paEast, i, loE, loMask, true);
+    store4(paNorth, i, loN, loMask, true);
+    store4(paUp, i, loU, loMask, true);
+  }
+  if (i < paCount) {
+    loMask = tail_mask(paCount - i);
+    enu4(paRef, load4(paX, i, loMask, false), load4(paY, i, loMask, false), load4(paZ, i, loMask, false), &loE, &loN, &loU);
+    store4(paEast, i, loE, loMask, false);
+    store4(paNorth, i, loN, loMask, false);
+    store4(paUp, i, loU, loMask, false);
+  }
+}
+
+// atan2 of the vectors: atan() of the ratio in [0, 1] with the rational approximation of Cephes (within ~1 ulp),
+// put into the quadrant by the signs (atan2(0, 0) is 0, NaN in either gives NaN)
+GEODESY_AVX2_INLINE __m256d atan2_4(__m256d paY, __m256d paX) {
+  __m256d loSign = _mm256_set1_pd(-0.0);
+  __m256d loAY   = _mm256_andnot_pd(loSign, paY);
+  __m256d loAX   = _mm256_andnot_pd(loSign, paX);
+  __m256d loMax  = _mm256_max_pd(loAY, loAX);
+  __m256d loT    = _mm256_div_pd(_mm256_min_pd(loAY, loAX), loMax);
+  __m256d loBig, loZ, loP, loQ, loR;
+
+  loT   = _mm256_blendv_pd(loT, _mm256_setzero_pd(), _mm256_cmp_pd(loMax, _mm256_setzero_pd(), _CMP_EQ_OQ));
+  loBig = _mm256_cmp_pd(loT, _mm256_set1_pd(0.66), _CMP_GT_OQ);
+  loT   = _mm256_blendv_pd(loT, _mm256_div_pd(_mm256_sub_pd(loT, _mm256_set1_pd(1.0)), _mm256_add_pd(loT, _mm256_set1_pd(1.0))), loBig);
+  loZ   = _mm256_mul_pd(loT, loT);
+  loP   = _mm256_fmadd_pd(loZ, _mm256_set1_pd(-8.750608600031904122785e-01), _mm256_set1_pd(-1.615753718733365076637e+01));
+  loP   = _mm256_fmadd_pd(loZ, loP, _mm256_set1_pd(-7.500855792314704667340e+01));
+  loP   = _mm256_fmadd_pd(loZ, loP, _mm256_set1_pd(-1.228866684490136173410e+02));
+  loP   = _mm256_fmadd_pd(loZ, loP, _mm256_set1_pd(-6.485021904942025371773e+01));
+  loQ   = _mm256_add_pd(loZ, _mm256_set1_pd(2.485846490142306297962e+01));
+  loQ   = _mm256_fmadd_pd(loZ, loQ, _mm256_set1_pd(1.650270098316988542046e+02));
+  loQ   = _mm256_fmadd_pd(loZ, loQ, _mm256_set1_pd(4.328810604912902668951e+02));
+  loQ   = _mm256_fmadd_pd(loZ, loQ, _mm256_set1_pd(4.853903996359136964868e+02));
+  loQ   = _mm256_fmadd_pd(loZ, loQ, _mm256_set1_pd(1.945506571482613964425e+02));
+  loR   = _mm256_fmadd_pd(_mm256_mul_pd(loT, loZ), _mm256_div_pd(loP, loQ), loT);
+  loR   = _mm256_add_pd(loR, _mm256_and_pd(loBig, _mm256_set1_pd(M_PI_4)));
+  loR   = _mm256_blendv_pd(loR, _mm256_sub_pd(_mm256_set1_pd(M_PI_2), loR), _mm256_cmp_pd(loAY, loAX, _CMP_GT_OQ));
+  loR   = _mm256_blendv_pd(loR, _mm256_sub_pd(_mm256_set1_pd(M_PI), loR), _mm256_cmp_pd(paX, _mm256_setzero_pd(), _CMP_LT_OQ));
+  loR   = _mm256_or_pd(loR, _mm256_and_pd(loSign, paY));
+  // max/min above drop the NaN lanes, so they are set back to NaN (all the bits set)
+  return (_mm256_or_pd(loR, _mm256_cmp_pd(paY, paX, _CMP_UNORD_Q)));
+}
+
+
+GEODESY_AVX2_INLINE __m256d bearing4(__m256d paY, __m256d paX) {
+  __m256d loBearing = _mm256_mul_pd(atan2_4(paY, paX), _mm256_set1_pd(GEODESY_RAD_TO_DEG));
+
+  return (_mm256_add_pd(loBearing, _mm256_and_pd(_mm256_cmp_pd(loBearing, _mm256_setzero_pd(), _CMP_LT_OQ), _mm256_set1_pd(360.0))));
+}
+
+
+GEODESY_AVX2_INLINE __m256d wrap_lon4(__m256d paDelta) {
+  __m256d loTurns = _mm256_round_pd(_mm256_mul_pd(paDelta, _mm256_set1_pd(1.0 / 360.0)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+
+  return (_mm256_fnmadd_pd(loTurns, _mm256_set1_pd(360.0), paDelta));
+}
+
+
+GEODESY_AVX2_INLINE void equirectangular4(__m256d paLat1, __m256d paLon1, __m256d paLat2, __m256d paLon2, __m256d *paDistance, __m256d *paBearing,
+                                          bool paWithBearing) {
+  __m256d loSin, loCos, loX, loY;
+
+  sincos4(_mm256_mul_pd(_mm256_add_pd(paLat1, paLat2), _mm256_set1_pd(0.5)), &loSin, &loCos);
+  loX = _mm256_mul_pd(wrap_lon4(_mm256_sub_pd(paLon2, paLon1)), loCos);
+  loY = _mm256_sub_pd(paLat2, paLat1);
+  *paDistance = _mm256_mul_pd(_mm256_set1_pd(GNSS_EARTH_RADIUS * GEODESY_DEG_TO_RAD), _mm256_sqrt_pd(_mm256_fmadd_pd(loX, loX, _mm256_mul_pd(loY, loY))));
+  if (paWithBearing) {
+    *paBearing = bearing4(loX, loY);
+  }
+}
+
+
+GEODESY_AVX2_INLINE void haversine4(__m256d paLat1, __m256d paLon1, __m256d paLat2, __m256d paLon2, __m256d *paDistance, __m256d *paBearing,
+                                    bool paWithBearing) {
+  __m256d loHalf = _mm256_set1_pd(0.5);
+  __m256d loSinLat, loCosLat, loSinLon, loCosLon, loSin1, loCos1, loSin2, loCos2, loA;
+
+  sincos4(_mm256_mul_pd(_mm256_sub_pd(paLat2, paLat1), loHalf), &loSinLat, &loCosLat);
+  sincos4(_mm256_mul_pd(_mm256_sub_pd(paLon2, paLon1), loHalf), &loSinLon, &loCosLon);
+  sincos4(paLat1, &loSin1, &loCos1);
+  sincos4(paLat2, &loSin2, &loCos2);
+  loA = _mm256_fmadd_pd(_mm256_mul_pd(loCos1, loCos2), _mm256_mul_pd(loSinLon, loSinLon), _mm256_mul_pd(loSinLat, loSinLat));
+  loA = _mm256_blendv_pd(loA, _mm256_set1_pd(1.0), _mm256_cmp_pd(loA, _mm256_set1_pd(1.0), _CMP_GT_OQ)); // min_pd would turn NaN into 1
+  *paDistance = _mm256_mul_pd(_mm256_set1_pd(2.0 * GNSS_EARTH_RADIUS),
+                              atan2_4(_mm256_sqrt_pd(loA), _mm256_sqrt_pd(_mm256_sub_pd(_mm256_set1_pd(1.0), loA))));
+  if (paWithBearing) {
+    // the sine and the cosine of the longitude difference from its half
+    __m256d loSinDLon = _mm256_mul_pd(_mm256_set1_pd(2.0), _mm256_mul_pd(loSinLon, loCosLon));
+    __m256d loCosDLon = _mm256_fnmadd_pd(_mm256_set1_pd(2.0), _mm256_mul_pd(loSinLon, loSinLon), _mm256_set1_pd(1.0));
+    *paBearing = bearing4(_mm256_mul_pd(loSinDLon, loCos2), _mm256_fnmadd_pd(_mm256_mul_pd(loSin1, loCos2), loCosDLon, _mm256_mul_pd(loCos1, loSin2)));
+  }
+}
+
+
+// the reduced latitude: tan(U) = (1 - f) * tan(lat)
+GEODESY_AVX2_INLINE void reduced4(__m256d paLat, __m256d *paSinU, __m256d *paCosU) {
+  __m256d loSin, loCos, loR;
+
+  sincos4(paLat, &loSin, &loCos);
+  loSin = _mm256_mul_pd(loSin, _mm256_set1_pd(1.0 - GNSS_WGS84_F));
+  loR   = _mm256_div_pd(_mm256_set1_pd(1.0), _mm256_sqrt_pd(_mm256_fmadd_pd(loCos, loCos, _mm256_mul_pd(loSin, loSin))));
+  *paSinU = _mm256_mul_pd(loSin, loR);
+  *paCosU = _mm256_mul_pd(loCos, loR);
+}
+
+
+// Vincenty as vincenty_fix() - all the 4 lanes are iterated until the last one converges (the converged lanes stay
+// at the same longitude), the lanes which haven't converged after GEODESY_VINCENTY_MAX iterations are NaN
+GEODESY_AVX2_INLINE void vincenty4(__m256d paLat1, __m256d paLon1, __m256d paLat2, __m256d paLon2, __m256d *paDistance, __m256d *paBearing,
+                                   bool paWithBearing) {
+  __m256d loOne = _mm256_set1_pd(1.0);
+  __m256d loF   = _mm256_set1_pd(GNSS_WGS84_F);
+  __m256d loZero = _mm256_setzero_pd();
+  __m256d loSinU1, loCosU1, loSinU2, loCosU2, loL, loLambda, loLast, loR, loS;
+  __m256d loSinLambda, loCosLambda, loSinSigma, loCosSigma, loSigma, loSinAlpha, loCos2Alpha, loCos2SigmaM, loC;
+  __m256d loU2, loA, loB, loDSigma, loT, loOpen;
+  uint8_t i = 0;
+
+  reduced4(paLat1, &loSinU1, &loCosU1);
+  reduced4(paLat2, &loSinU2, &loCosU2);
+  loL = _mm256_mul_pd(wrap_lon4(_mm256_sub_pd(paLon2, paLon1)), _mm256_set1_pd(GEODESY_DEG_TO_RAD));
+  loLambda = loL;
+  loS = _mm256_mul_pd(loSinU1, loSinU2);
+  loT = _mm256_mul_pd(loCosU1, loCosU2);
+
+  do {
+    sincos4(_mm256_mul_pd(loLambda, _mm256_set1_pd(GEODESY_RAD_TO_DEG)), &loSinLambda, &loCosLambda);
+    loR          = _mm256_fnmadd_pd(_mm256_mul_pd(loSinU1, loCosU2), loCosLambda, _mm256_mul_pd(loCosU1, loSinU2));
+    loSinSigma   = _mm256_mul_pd(loCosU2, loSinLambda);
+    loSinSigma   = _mm256_sqrt_pd(_mm256_fmadd_pd(loSinSigma, loSinSigma, _mm256_mul_pd(loR, loR)));
+    loCosSigma   = _mm256_fmadd_pd(loT, loCosLambda, loS);
+    loSigma      = atan2_4(loSinSigma, loCosSigma);
+    // the coincident points: sin(sigma) = 0 -> sin(alpha) = 0
+    loSinAlpha   = _mm256_div_pd(_mm256_mul_pd(loT, loSinLambda), _mm256_blendv_pd(loSinSigma, loOne, _mm256_cmp_pd(loSinSigma, loZero, _CMP_EQ_OQ)));
+    loCos2Alpha  = _mm256_fnmadd_pd(loSinAlpha, loSinAlpha, loOne);
+    // the equatorial line: cos^2(alpha) = 0 -> cos(2 sigma_m) = 0
+    loCos2SigmaM = _mm256_fnmadd_pd(_mm256_set1_pd(2.0), _mm256_div_pd(loS, _mm256_blendv_pd(loCos2Alpha, loOne, _mm256_cmp_pd(loCos2Alpha, loZero, _CMP_EQ_OQ))),
+                                    loCosSigma);
+    loCos2SigmaM = _mm256_andnot_pd(_mm256_cmp_pd(loCos2Alpha, loZero, _CMP_EQ_OQ), loCos2SigmaM);
+    loC          = _mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(GNSS_WGS84_F / 16.0), loCos2Alpha),
+                                 _mm256_fmadd_pd(loF, _mm256_fnmadd_pd(_mm256_set1_pd(3.0), loCos2Alpha, _mm256_set1_pd(4.0)), _mm256_set1_pd(4.0)));
+    loLast       = loLambda;
+    loR          = _mm256_fmadd_pd(_mm256_mul_pd(_mm256_set1_pd(2.0), loCos2SigmaM), loCos2SigmaM, _mm256_set1_pd(-1.0));
+    loR          = _mm256_fmadd_pd(_mm256_mul_pd(loC, loCosSigma), loR, loCos2SigmaM);
+    loR          = _mm256_fmadd_pd(_mm256_mul_pd(loC, loSinSigma), loR, loSigma);
+    loLambda     = _mm256_fmadd_pd(_mm256_mul_pd(_mm256_mul_pd(_mm256_sub_pd(loOne, loC), loF), loSinAlpha), loR, loL);
+    loOpen       = _mm256_cmp_pd(_mm256_andnot_pd(_mm256_set1_pd(-0.0), _mm256_sub_pd(loLambda, loLast)), _mm256_set1_pd(GEODESY_VINCENTY_EPS), _CMP_GT_OQ);
+  } while (_mm256_movemask_pd(loOpen) && (++i < GEODESY_VINCENTY_MAX));
+
+  loU2 = _mm256_mul_pd(loCos2Alpha, _mm256_set1_pd((GNSS_WGS84_A * GNSS_WGS84_A - GEODESY_WGS84_B * GEODESY_WGS84_B) / (GEODESY_WGS84_B * GEODESY_WGS84_B)));
+  loA  = _mm256_fmadd_pd(loU2, _mm256_set1_pd(-175.0), _mm256_set1_pd(320.0));
+  loA  = _mm256_fmadd_pd(loU2, loA, _mm256_set1_pd(-768.0));
+  loA  = _mm256_fmadd_pd(loU2, loA, _mm256_set1_pd(4096.0));
+  loA  = _mm256_fmadd_pd(_mm256_mul_pd(loU2, _mm256_set1_pd(1.0 / 16384.0)), loA, loOne);
+  loB  = _mm256_fmadd_pd(loU2, _mm256_set1_pd(-47.0), _mm256_set1_pd(74.0));
+  loB  = _mm256_fmadd_pd(loU2, loB, _mm256_set1_pd(-128.0));
+  loB  = _mm256_fmadd_pd(loU2, loB, _mm256_set1_pd(256.0));
+  loB  = _mm256_mul_pd(_mm256_mul_pd(loU2, _mm256_set1_pd(1.0 / 1024.0)), loB);
+  loR  = _mm256_fmadd_pd(_mm256_mul_pd(_mm256_set1_pd(2.0), loCos2SigmaM), loCos2SigmaM, _mm256_set1_pd(-1.0));          // -1 + 2 cos^2(2 sigma_m)
+  loT  = _mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(loB, _mm256_set1_pd(1.0 / 6.0)), loCos2SigmaM),
+                       _mm256_mul_pd(_mm256_fmadd_pd(_mm256_set1_pd(4.0), _mm256_mul_pd(loSinSigma, loSinSigma), _mm256_set1_pd(-3.0)),
+                                     _mm256_fmadd_pd(_mm256_set1_pd(4.0), _mm256_mul_pd(loCos2SigmaM, loCos2SigmaM), _mm256_set1_pd(-3.0))));
+  loDSigma = _mm256_fmadd_pd(_mm256_mul_pd(loB, _mm256_set1_pd(0.25)), _mm256_fmsub_pd(loCosSigma, loR, loT), loCos2SigmaM);
+  loDSigma = _mm256_mul_pd(_mm256_mul_pd(loB, loSinSigma), loDSigma);
+  *paDistance = _mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(GEODESY_WGS84_B), loA), _mm256_sub_pd(loSigma, loDSigma));
+  *paDistance = _mm256_blendv_pd(*paDistance, _mm256_set1_pd(NAN), loOpen);
+  if (paWithBearing) {
+    *paBearing = bearing4(_mm256_mul_pd(loCosU2, loSinLambda),
+                          _mm256_fnmadd_pd(_mm256_mul_pd(loSinU1, loCosU2), loCosLambda, _mm256_mul_pd(loCosU1, loSinU2)));
+    *paBearing = _mm256_blendv_pd(*paBearing, _mm256_set1_pd(NAN), loOpen);
+  }
+}
+
+
+GEODESY_AVX2_INLINE void distance_block(uint8_t paTier, const double *paLat1, const double *paLon1, bool paFixed, const double *paLat2, const double *paLon2,
+                                        uint32_t i, __m256i paMask, bool paFull, double *paDistance, double *paBearing) {
+  __m256d loLat1 = paFixed ? _mm256_set1_pd(*paLat1) : load4(paLat1, i, paMask, paFull);
+  __m256d loLon1 = paFixed ? _mm256_set1_pd(*paLon1) : load4(paLon1, i, paMask, paFull);
+  __m256d loLat2 = load4(paLat2, i, paMask, paFull);
+  __m256d loLon2 = load4(paLon2, i, paMask, paFull);
+  __m256d loDistance, loBearing = _mm256_setzero_pd();
+
+  switch (paTier) {
+    case GNSS_DISTANCE_EQUIRECTANGULAR:
+            equirectangular4(loLat1, loLon1, loLat2, loLon2, &loDistance, &loBearing, NULL != paBearing);
+            break;
+    case GNSS_DISTANCE_HAVERSINE:
+            haversine4(loLat1, loLon1, loLat2, loLon2, &loDistance, &loBearing, NULL != paBearing);
+            break;
+    default:
+            vincenty4(loLat1, loLon1, loLat2, loLon2, &loDistance, &loBearing, NULL != paBearing);
+            break;
+  }
+  store4(paDistance, i, loDistance, paMask, paFull);
+  if (NULL != paBearing) {
+    store4(paBearing, i, loBearing, paMask, paFull);
+  }
+}
+
+
+GEODESY_AVX2_FUNCTION void distance_avx2(uint8_t paTier, const double *paLat1, const double *paLon1, bool paFixed, const double *paLat2, const double *paLon2,
+                                         uint32_t paCount, double *paDistance, double *paBearing) {
+  __m256i loMask = _mm256_set1_epi64x(-1);
+  uint32_t i;
+
+  for (i = 0; (i + 4) <= paCount; i += 4) {
+    distance_block(paTier, paLat1, paLon1, paFixed, paLat2, paLon2, i, loMask, true, paDistance, paBearing);
+  }
+  if (i < paCount) {
+    distance_block(paTier, paLat1, paLon1, paFixed, paLat2, paLon2, i, tail_mask(paCount - i), false, paDistance, paBearing);
+  }
+}
+#endif // GEODESY_AVX2
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ****************************************************************** the geodesy  *******************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+bool GNSSGeodesy::hasSIMD(void) {
+#ifdef GEODESY_AVX2
+  if (0 > gSIMD) {
+    __builtin_cpu_init();
+    gSIMD = (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) ? 1 : 0;
+  }
+  return (1 == gSIMD);
+#else
+  return (false);
+#endif
+}
+
+
+void GNSSGeodesy::setSIMD(bool paEnabled) {
+  gSIMD = paEnabled ? -1 : 0;   // enabled only if the CPU has it
+}
+
+
+void GNSSGeodesy::toECEF(const double *paLat, const double *paLon, const double *paAlt, const double *paUndulation, uint32_t paCount,
+                         double *paX, double *paY, double *paZ) {
+#ifdef GEODESY_AVX2
+  if (GNSSGeodesy::hasSIMD()) {
+    ecef_avx2(paLat, paLon, paAlt, paUndulation, paCount, paX, paY, paZ);
+    return;
+  }
+#endif
+  ecef_scalar(paLat, paLon, paAlt, paUndulation, paCount, paX, paY, paZ);
+}
+
+
+void GNSSGeodesy::toENU(const struct GNSS_enu_reference *paReference, const double *paLat, const double *paLon, const double *paAlt,
+                        const double *paUndulation, uint32_t paCount, double *paEast, double *paNorth, double *paUp) {
+#ifdef GEODESY_AVX2
+  if (GNSSGeodesy::hasSIMD()) {
+    enu_avx2(paReference, paLat, paLon, paAlt, paUndulation, paCount, paEast, paNorth, paUp);
+    return;
+  }
+#endif
+  enu_scalar(paReference, paLat, paLon, paAlt, paUndulation, paCount, paEast, paNorth, paUp);
+}
+
+
+void GNSSGeodesy::ecefToENU(const struct GNSS_enu_reference *paReference, const double *paX, const double *paY, const double *paZ, uint32_t paCount,
+                            double *paEast, double *paNorth, double *paUp) {
+#ifdef GEODESY_AVX2
+  if (GNSSGeodesy::hasSIMD()) {
+    ecef_enu_avx2(paReference, paX, paY, paZ, paCount, paEast, paNorth, paUp);
+    return;
+  }
+#endif
+  ecef_enu_scalar(paReference, paX, paY, paZ, paCount, paEast, paNorth, paUp);
+}
+
+
+void GNSSGeodesy::toECEF(const struct GNSS_epoch_batch *paBatch, double *paX, double *paY, double *paZ) {
+  if ((NULL != paBatch->lat) && (NULL != paBatch->lon)) {
+    GNSSGeodesy::toECEF(paBatch->lat, paBatch->lon, paBatch->alt, paBatch->undulation, paBatch->count, paX, paY, paZ);
+  }
+}
+
+
+void GNSSGeodesy::toENU(const struct GNSS_enu_reference *paReference, const struct GNSS_epoch_batch *paBatch, double *paEast, double *paNorth, double *paUp) {
+  if ((NULL != paBatch->lat) && (NULL != paBatch->lon)) {
+    GNSSGeodesy::toENU(paReference, paBatch->lat, paBatch->lon, paBatch->alt, paBatch->undulation, paBatch->count, paEast, paNorth, paUp);
+  }
+}
+
+
+int8_t GNSSGeodesy::toECEF(const struct GNSS_data *paData, double *paX, double *paY, double *paZ) {
+  if ((0 == paData->lat_dir) || (0 == paData->lon_dir)) {
+    return (-1);
+  }
+  ecef_fix(GNSSCollector::getLatitude(paData), GNSSCollector::getLongitude(paData),
+           (0 < paData->msgs_rcvd[MSG_GGA]) ? (paData->alt + paData->undulation) : 0.0, paX, paY, paZ);
+  return (0);
+}
+
+
+void GNSSGeodesy::setReference(struct GNSS_enu_reference *paReference, double paLat, double paLon, double paHeight) {
+  paReference->lat    = paLat;
+  paReference->lon    = paLon;
+  paReference->height = paHeight;
+  paReference->sinLat = sin(paLat * GEODESY_DEG_TO_RAD);
+  paReference->cosLat = cos(paLat * GEODESY_DEG_TO_RAD);
+  paReference->sinLon = sin(paLon * GEODESY_DEG_TO_RAD);
+  paReference->cosLon = cos(paLon * GEODESY_DEG_TO_RAD);
+  ecef_fix(paLat, paLon, paHeight, &paReference->x, &paReference->y, &paReference->z);
+}
+
+
+int8_t GNSSGeodesy::setReference(struct GNSS_enu_reference *paReference, const struct GNSS_data *paData) {
+  if ((0 == paData->lat_dir) || (0 == paData->lon_dir)) {
+    return (-1);
+  }
+  GNSSGeodesy::setReference(paReference, GNSSCollector::getLatitude(paData), GNSSCollector::getLongitude(paData),
+                            (0 < paData->msgs_rcvd[MSG_GGA]) ? (paData->alt + paData->undulation) : 0.0);
+  return (0);
+}
+
+
+void GNSSGeodesy::distance(uint8_t paTier, const double *paLat1, const double *paLon1, const double *paLat2, const double *paLon2, uint32_t paCount,
+                           double *paDistance, double *paBearing) {
+#ifdef GEODESY_AVX2
+  if (GNSSGeodesy::hasSIMD()) {
+    distance_avx2(paTier, paLat1, paLon1, false, paLat2, paLon2, paCount, paDistance, paBearing);
+    return;
+  }
+#endif
+  distance_scalar(paTier, paLat1, paLon1, false, paLat2, paLon2, paCount, paDistance, paBearing);
+}
+
+
+void GNSSGeodesy::distanceFrom(uint8_t paTier, double paLat, double paLon, const double *paLat2, const double *paLon2, uint32_t paCount,
+                               double *paDistance, double *paBearing) {
+#ifdef GEODESY_AVX2
+  if (GNSSGeodesy::hasSIMD()) {
+    distance_avx2(paTier, &paLat, &paLon, true, paLat2, paLon2, paCount, paDistance, paBearing);
+    return;
+  }
+#endif
+  distance_scalar(paTier, &paLat, &paLon, true, paLat2, paLon2, paCount, paDistance, paBearing);
+}
@@ -0,0 +1,97 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef GNSS_GEODESY_H
+#define GNSS_GEODESY_H
+
+#include "ultimateGNSSParser.h"
+#include "GNSSEpochBatch.h"
+
+/***************************************************************************************************************************************************
+ ************************************************************** the geodesy ************************************************************************
+ ***************************************************************************************************************************************************/
+
+// WGS84
+#define GNSS_WGS84_A    6378137.0                 // the semi-major axis [m]
+#define GNSS_WGS84_F    (1.0 / 298.257223563)     // the flattening
+#define GNSS_WGS84_E2   (GNSS_WGS84_F * (2.0 - GNSS_WGS84_F))
+#define GNSS_EARTH_RADIUS 6371008.8               // the mean radius [m] (the spherical tiers)
+
+// the accuracy tiers of the distance and the bearing (GNSSGeodesy::distance)
+#define GNSS_DISTANCE_EQUIRECTANGULAR   0   // the plane around the points - the fastest, for the short distances away from the poles
+#define GNSS_DISTANCE_HAVERSINE         1   // the great circle of the sphere (up to 0.5 % off the ellipsoid)
+#define GNSS_DISTANCE_VINCENTY          2   // the geodesic of the WGS84 ellipsoid (within 1 mm, iterative - NaN for the nearly antipodal points)
+
+// The origin of the local east-north-up frame (see GNSSGeodesy::setReference). The height is above the WGS84 ellipsoid.
+struct GNSS_enu_reference {
+  double lat;       // [deg]
+  double lon;       // [deg]
+  double height;    // [m]
+  double x;         // the origin in ECEF [m]
+  double y;
+  double z;
+  double sinLat;
+  double cosLat;
+  double sinLon;
+  double cosLon;
+};
+
+// The conversions of the arrays of the fixes from the geodetic coordinates (the signed degrees and the altitude with the geoid separation
+// as given by $xxGGA, so the height above the ellipsoid is alt + undulation) to ECEF and to the local ENU frame, and the distances
+// and the bearings between the fixes. The kernels take 4 fixes
+// at once with AVX2 and FMA when the CPU has them (x86 with GCC or clang, checked once at run time), the scalar code otherwise.
+// The conversions of both are within a few nm of the long double reference over the whole globe (well below the mm of RTK). The distances
+// of the vector and the scalar code differ by up to ~6 um (Vincenty, the summed rounding of the iterations; ~3 um haversine, 10 nm
+// equirectangular), far below the error of the tier itself. The NaN values (the fields not received) give NaN.
+// The undulation and the altitude arrays may be NULL (0 is used). The output arrays may not overlap the input arrays.
+// Note that the double type on some MCUs (e.g. Arduino UNO) has 4 bytes, so the results are not that precise there.
+class GNSSGeodesy {
+public:
+  static void toECEF(const double *paLat, const double *paLon, const double *paAlt, const double *paUndulation, uint32_t paCount,
+                     double *paX, double *paY, double *paZ);
+  static void toENU(const struct GNSS_enu_reference *paReference, const double *paLat, const double *paLon, const double *paAlt,
+                    const double *paUndulation, uint32_t paCount, double *paEast, double *paNorth, double *paUp);
+  static void ecefToENU(const struct GNSS_enu_reference *paReference, const double *paX, const double *paY, const double *paZ, uint32_t paCount,
+                        double *paEast, double *paNorth, double *paUp);
+
+  // the columns of the batch (see GNSSEpochBatch.h) - the outputs have paBatch->count values
+  static void toECEF(const struct GNSS_epoch_batch *paBatch, double *paX, double *paY, double *paZ);
+  static void toENU(const struct GNSS_enu_reference *paReference, const struct GNSS_epoch_batch *paBatch, double *paEast, double *paNorth, double *paUp);
+
+  // The distance [m] and the initial bearing [deg, 0 - 360] from the points 1 to the points 2 (paCount pairs) or from the single point
+  // to every point 2 (e.g. the geofence or the depot against the whole fleet - call it for every reference point). The bearing
+  // may be NULL (it is not computed then). The tier is GNSS_DISTANCE_xxx.
+  static void distance(uint8_t paTier, const double *paLat1, const double *paLon1, const double *paLat2, const double *paLon2, uint32_t paCount,
+                       double *paDistance, double *paBearing);
+  static void distanceFrom(uint8_t paTier, double paLat, double paLon, const double *paLat2, const double *paLon2, uint32_t paCount,
+                           double *paDistance, double *paBearing);
+
+  // the single epoch - it returns 0 on success or -1 if the position is not known (the height is 0 without $xxGGA)
+  static int8_t toECEF(const struct GNSS_data *paData, double *paX, double *paY, double *paZ);
+
+  static void   setReference(struct GNSS_enu_reference *paReference, double paLat, double paLon, double paHeight);
+  // the reference at the position of the epoch - it returns 0 on success or -1 if the position is not known
+  static int8_t setReference(struct GNSS_enu_reference *paReference, const struct GNSS_data *paData);
+
+  // true if the vector kernels are used, setSIMD(false) forces the scalar code (e.g. to compare the results or the speed)
+  static bool hasSIMD(void);
+  static void setSIMD(bool paEnabled);
+};
+
+#endif
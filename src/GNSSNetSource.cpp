@@ -0,0 +1,446 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "GNSSNetSource.h"
+
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include <sys/epoll.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <errno.h>
+
+#define NET_TCP    1
+#define NET_UDP    2
+#define NET_UNIX   3
+
+#define NET_FEED_SIZE  32768   // the bytes given to the single feed() call (its length is 16 bits)
+
+static_assert((GNSS_NET_DATAGRAMS * GNSS_NET_DATAGRAM_SIZE) <= GNSS_NET_READ_SIZE, "the datagrams don't fit in the read buffer");
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ********************************************************** the network sources of NMEA  ***********************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+GNSSNetSources::GNSSNetSources(uint16_t paMaxSources) {
+  uint16_t i;
+
+  atMaxSources            = paMaxSources;
+  atReconnectMs           = 1000;
+  atEpochCallback         = NULL;
+  atEpochCallbackUserData = NULL;
+  atEpoll                 = epoll_create1(EPOLL_CLOEXEC);
+  atBuffer                = (char *)malloc(GNSS_NET_READ_SIZE);
+  atSources               = (struct net_source *)calloc(paMaxSources, sizeof(struct net_source));
+  if ((0 > atEpoll) || (NULL == atBuffer) || (NULL == atSources)) {
+    SETCOLORRED DBG("The network sources can not be set up\r\n"); NOCOLOR
+    atMaxSources = 0;
+    return;
+  }
+  for (i = 0; i < paMaxSources; i++) {
+    atSources[i].state = GNSS_NET_IDLE;
+    atSources[i].fd    = -1;
+    atSources[i].owner = this;
+  }
+}
+
+
+GNSSNetSources::~GNSSNetSources(void) {
+  uint16_t i;
+
+  for (i = 0; i < this->atMaxSources; i++) {
+    this->remove(i);
+  }
+  if (0 <= this->atEpoll) {
+    close(this->atEpoll);
+  }
+  free(this->atBuffer);
+  free(this->atSources);
+}
+
+
+int GNSSNetSources::add_source(uint8_t paType, const struct sockaddr *paAddress, socklen_t paLength, const char *paRequest) {
+  struct net_source *loSource;
+  uint16_t i;
+
+  for (i = 0; i < this->atMaxSources; i++) {
+    if (GNSS_NET_IDLE == this->atSources[i].state) {
+      break;
+    }
+  }
+  if (i == this->atMaxSources) {
+    SETCOLORRED DBG("There is no room for the next network source\r\n"); NOCOLOR
+    return (-1);
+  }
+  loSource = &this->atSources[i];
+  loSource->type          = paType;
+  loSource->fd            = -1;
+  memcpy(&loSource->address, paAddress, paLength);
+  loSource->addressLength = paLength;
+  loSource->request       = (NULL != paRequest) ? strdup(paRequest) : NULL;
+  loSource->retryMs       = 0;
+  loSource->collector     = new GNSSCollector(NULL, NULL); // the bytes are given with feed(), so no data source callbacks are needed
+  loSource->bytes         = 0;
+  loSource->epochs        = 0;
+  loSource->connections   = 0;
+  if (NULL != this->atEpochCallback) {
+    loSource->collector->setEpochCallback(GNSSNetSources::epoch_trampoline, loSource);
+  }
+  loSource->state         = GNSS_NET_WAITING; // the first connection attempt is made by the next service() call
+  return (i);
+}
+
+
+int GNSSNetSources::addTCP(const char *paHost, uint16_t paPort, const char *paRequest) {
+  struct addrinfo loHints;
+  struct addrinfo *loResult;
+  char loPort[8];
+  int loSource;
+
+  memset(&loHints, 0, sizeof(loHints));
+  loHints.ai_family   = AF_UNSPEC;
+  loHints.ai_socktype = SOCK_STREAM;
+  snprintf(loPort, sizeof(loPort), "%u", paPort);
+  if (getaddrinfo(paHost, loPort, &loHints, &loResult)) {
+    SETCOLORRED DBG("The host name can not be resolved\r\n"); NOCOLOR
+    return (-1);
+  }
+  loSource = this->add_source(NET_TCP, loResult->ai_addr, loResult->ai_addrlen, paRequest);
+  freeaddrinfo(loResult);
+  return (loSource);
+}
+
+
+int GNSSNetSources::addUnix(const char *paPath) {
+  struct sockaddr_un loAddress;
+
+  if (sizeof(loAddress.sun_path) <= strlen(paPath)) {
+    SETCOLORRED DBG("The unix socket path is too long\r\n"); NOCOLOR
+    return (-1);
+  }
+  memset(&loAddress, 0, sizeof(loAddress));
+  loAddress.sun_family = AF_UNIX;
+  strcpy(loAddress.sun_path, paPath);
+  return (this->add_source(NET_UNIX, (struct sockaddr *)&loAddress, sizeof(loAddress), NULL));
+}
+
+
+int GNSSNetSources::addUDP(uint16_t paPort, const char *paAddress) {
+  struct sockaddr_in loAddress;
+  struct ip_mreq loGroup;
+  struct epoll_event loEvent;
+  struct net_source *loSource;
+  bool loMulticast;
+  int loOn = 1;
+  int loIndex;
+  int loFd;
+
+  memset(&loAddress, 0, sizeof(loAddress));
+  loAddress.sin_family = AF_INET;
+  loAddress.sin_port   = htons(paPort);
+  if (1 != inet_pton(AF_INET, paAddress, &loAddress.sin_addr)) {
+    SETCOLORRED DBG("The address is not correct\r\n"); NOCOLOR
+    return (-1);
+  }
+  loMulticast = IN_MULTICAST(ntohl(loAddress.sin_addr.s_addr));
+  loGroup.imr_multiaddr        = loAddress.sin_addr;
+  loGroup.imr_interface.s_addr = htonl(INADDR_ANY);
+  if (loMulticast) {
+    loAddress.sin_addr.s_addr = htonl(INADDR_ANY);
+  }
+
+  loFd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (0 > loFd) {
+    return (-1);
+  }
+  // the other programs can listen to the same broadcasts
+  setsockopt(loFd, SOL_SOCKET, SO_REUSEADDR, &loOn, sizeof(loOn));
+  if (bind(loFd, (struct sockaddr *)&loAddress, sizeof(loAddress))) {
+    SETCOLORRED DBG("The UDP port can not be bound\r\n"); NOCOLOR
+    close(loFd);
+    return (-1);
+  }
+  if (loMulticast && setsockopt(loFd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &loGroup, sizeof(loGroup))) {
+    SETCOLORRED DBG("The multicast group can not be joined\r\n"); NOCOLOR
+    close(loFd);
+    return (-1);
+  }
+
+  loIndex = this->add_source(NET_UDP, (struct sockaddr *)&loAddress, sizeof(loAddress), NULL);
+  if (0 > loIndex) {
+    close(loFd);
+    return (-1);
+  }
+  loSource = &this->atSources[loIndex];
+  loEvent.events   = EPOLLIN;
+  loEvent.data.u64 = loIndex;
+  if (epoll_ctl(this->atEpoll, EPOLL_CTL_ADD, loFd, &loEvent)) {
+    close(loFd);
+    this->remove(loIndex);
+    return (-1);
+  }
+  loSource->fd    = loFd;
+  loSource->state = GNSS_NET_RECEIVING;
+  loSource->connections++;
+  return (loIndex);
+}
+
+
+void GNSSNetSources::remove(uint16_t paSource) {
+  struct net_source *loSource;
+
+  if ((paSource >= this->atMaxSources) || (GNSS_NET_IDLE == this->atSources[paSource].state)) {
+    return;
+  }
+  loSource = &this->atSources[paSource];
+  if (0 <= loSource->fd) {
+    close(loSource->fd); // it is removed from epoll too
+    loSource->fd = -1;
+  }
+  free(loSource->request);
+  loSource->request = NULL;
+  delete loSource->collector;
+  loSource->collector = NULL;
+  loSource->state = GNSS_NET_IDLE;
+}
+
+
+void GNSSNetSources::start(struct net_source *paSource, uint32_t paNowMs) {
+  struct epoll_event loEvent;
+
+  paSource->fd = socket(paSource->address.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (0 > paSource->fd) {
+    this->lost(paSource, paNowMs);
+    return;
+  }
+  loEvent.events   = EPOLLOUT;
+  loEvent.data.u64 = (uint64_t)(paSource - this->atSources);
+  if (epoll_ctl(this->atEpoll, EPOLL_CTL_ADD, paSource->fd, &loEvent)) {
+    this->lost(paSource, paNowMs);
+    return;
+  }
+  paSource->state = GNSS_NET_CONNECTING;
+  if (0 == connect(paSource->fd, (struct sockaddr *)&paSource->address, paSource->addressLength)) {
+    this->connected(paSource, paNowMs);
+  } else if (EINPROGRESS != errno) {
+    this->lost(paSource, paNowMs); // e.g. the unix socket doesn't exist yet
+  }
+}
+
+
+void GNSSNetSources::connected(struct net_source *paSource, uint32_t paNowMs) {
+  struct epoll_event loEvent;
+  size_t loLength;
+
+  loEvent.events   = EPOLLIN;
+  loEvent.data.u64 = (uint64_t)(paSource - this->atSources);
+  epoll_ctl(this->atEpoll, EPOLL_CTL_MOD, paSource->fd, &loEvent);
+  paSource->state = GNSS_NET_RECEIVING;
+  paSource->connections++;
+  if (NULL != paSource->request) {
+    loLength = strlen(paSource->request);
+    if ((ssize_t)loLength != send(paSource->fd, paSource->request, loLength, MSG_NOSIGNAL)) {
+      this->lost(paSource, paNowMs);
+    }
+  }
+}
+
+
+void GNSSNetSources::lost(struct net_source *paSource, uint32_t paNowMs) {
+  if (0 <= paSource->fd) {
+    close(paSource->fd);
+    paSource->fd = -1;
+  }
+  paSource->state   = GNSS_NET_WAITING;
+  paSource->retryMs = paNowMs + this->atReconnectMs;
+}
+
+
+void GNSSNetSources::read_stream(struct net_source *paSource, uint32_t paNowMs) {
+  ssize_t loRead;
+  ssize_t i;
+  int8_t loEpochs;
+
+  do {
+    loRead = read(paSource->fd, this->atBuffer, GNSS_NET_READ_SIZE);
+    if (0 >= loRead) {
+      if ((0 == loRead) || ((EAGAIN != errno) && (EWOULDBLOCK != errno) && (EINTR != errno))) {
+        this->lost(paSource, paNowMs); // the peer has closed the connection
+      }
+      return;
+    }
+    paSource->bytes += loRead;
+    for (i = 0; i < loRead; i += NET_FEED_SIZE) {
+      loEpochs = paSource->collector->feed(this->atBuffer + i, (uint16_t)(((loRead - i) < NET_FEED_SIZE) ? (loRead - i) : NET_FEED_SIZE), paNowMs);
+      if (0 < loEpochs) {
+        paSource->epochs += loEpochs;
+      }
+    }
+  } while (GNSS_NET_READ_SIZE == loRead); // the rest is read with the next service() call (the other sources are not starved)
+}
+
+
+void GNSSNetSources::read_datagrams(struct net_source *paSource, uint32_t paNowMs) {
+  struct mmsghdr loMessages[GNSS_NET_DATAGRAMS];
+  struct iovec loIov[GNSS_NET_DATAGRAMS];
+  int8_t loEpochs;
+  int loCount;
+  int i;
+
+  memset(loMessages, 0, sizeof(loMessages));
+  for (i = 0; i < GNSS_NET_DATAGRAMS; i++) {
+    loIov[i].iov_base = this->atBuffer + (i * GNSS_NET_DATAGRAM_SIZE);
+    loIov[i].iov_len  = GNSS_NET_DATAGRAM_SIZE;
+    loMessages[i].msg_hdr.msg_iov    = &loIov[i];
+    loMessages[i].msg_hdr.msg_iovlen = 1;
+  }
+  do {
+    loCount = recvmmsg(paSource->fd, loMessages, GNSS_NET_DATAGRAMS, MSG_DONTWAIT, NULL);
+    for (i = 0; i < loCount; i++) {
+      paSource->bytes += loMessages[i].msg_len;
+      loEpochs = paSource->collector->feed((const char *)loIov[i].iov_base, (uint16_t)loMessages[i].msg_len, paNowMs);
+      if (0 < loEpochs) {
+        paSource->epochs += loEpochs;
+      }
+    }
+  } while (GNSS_NET_DATAGRAMS == loCount);
+}
+
+
+int GNSSNetSources::service(int paTimeoutMs) {
+  struct epoll_event loEvents[64];
+  struct net_source *loSource;
+  uint32_t loNowMs;
+  int8_t loEpochs;
+  int loCount;
+  uint16_t i;
+  int j;
+
+  if (0 == this->atMaxSources) {
+    return (-1);
+  }
+  loNowMs = GNSSCollector::getPlatformTimeMs();
+  for (i = 0; i < this->atMaxSources; i++) {
+    loSource = &this->atSources[i];
+    if ((GNSS_NET_WAITING == loSource->state) && (0 <= (int32_t)(loNowMs - loSource->retryMs))) {
+      this->start(loSource, loNowMs);
+    }
+  }
+
+  loCount = epoll_wait(this->atEpoll, loEvents, 64, paTimeoutMs);
+  if (0 > loCount) {
+    return ((EINTR == errno) ? 0 : -1);
+  }
+  loNowMs = GNSSCollector::getPlatformTimeMs();
+  for (j = 0; j < loCount; j++) {
+    loSource = &this->atSources[loEvents[j].data.u64];
+    if (GNSS_NET_CONNECTING == loSource->state) {
+      int loError = 0;
+      socklen_t loLength = sizeof(loError);
+
+      if (getsockopt(loSource->fd, SOL_SOCKET, SO_ERROR, &loError, &loLength) || (0 != loError)) {
+        this->lost(loSource, loNowMs); // refused - it is tried again later
+      } else {
+        this->connected(loSource, loNowMs);
+      }
+      continue;
+    }
+    if (GNSS_NET_RECEIVING != loSource->state) {
+      continue;
+    }
+    if (NET_UDP == loSource->type) {
+      this->read_datagrams(loSource, loNowMs);
+    } else if (loEvents[j].events & EPOLLIN) {
+      this->read_stream(loSource, loNowMs); // it detects the closed connection too
+    } else {
+      this->lost(loSource, loNowMs);
+    }
+  }
+
+  // the break between the epochs is detected without the new bytes too
+  for (i = 0; i < this->atMaxSources; i++) {
+    loSource = &this->atSources[i];
+    if (GNSS_NET_IDLE != loSource->state) {
+      loEpochs = loSource->collector->feed(NULL, 0, loNowMs);
+      if (0 < loEpochs) {
+        loSource->epochs += loEpochs;
+      }
+    }
+  }
+  return (loCount);
+}
+
+
+GNSSCollector *GNSSNetSources::getCollector(uint16_t paSource) {
+  if (paSource >= this->atMaxSources) {
+    return (NULL);
+  }
+  return (this->atSources[paSource].collector);
+}
+
+
+void GNSSNetSources::setEpochCallback(GNSS_source_epoch_callback paCallback, void *paUserData) {
+  uint16_t i;
+
+  this->atEpochCallback         = paCallback;
+  this->atEpochCallbackUserData = paUserData;
+  for (i = 0; i < this->atMaxSources; i++) {
+    if (NULL != this->atSources[i].collector) {
+      this->atSources[i].collector->setEpochCallback((NULL != paCallback) ? GNSSNetSources::epoch_trampoline : NULL, &this->atSources[i]);
+    }
+  }
+}
+
+
+void GNSSNetSources::epoch_trampoline(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paSource) {
+  struct net_source *loSource = (struct net_source *)paSource;
+  GNSSNetSources *loOwner = loSource->owner;
+
+  if (NULL != loOwner->atEpochCallback) {
+    loOwner->atEpochCallback((uint16_t)(loSource - loOwner->atSources), paData, paGSVData, loOwner->atEpochCallbackUserData);
+  }
+}
+
+
+uint8_t GNSSNetSources::getState(uint16_t paSource) {
+  return ((paSource < this->atMaxSources) ? this->atSources[paSource].state : GNSS_NET_IDLE);
+}
+
+
+uint64_t GNSSNetSources::getBytes(uint16_t paSource) {
+  return ((paSource < this->atMaxSources) ? this->atSources[paSource].bytes : 0);
+}
+
+
+uint32_t GNSSNetSources::getEpochs(uint16_t paSource) {
+  return ((paSource < this->atMaxSources) ? this->atSources[paSource].epochs : 0);
+}
+
+
+uint32_t GNSSNetSources::getConnections(uint16_t paSource) {
+  return ((paSource < this->atMaxSources) ? this->atSources[paSource].connections : 0);
+}
+
+#endif // linux
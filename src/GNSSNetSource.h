@@ -0,0 +1,121 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef GNSS_NET_SOURCE_H
+#define GNSS_NET_SOURCE_H
+
+#include "ultimateGNSSParser.h"
+
+// The network sources are available on linux only (epoll), the file is compiled to nothing on the other platforms.
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include <sys/socket.h>
+
+#define GNSS_NET_READ_SIZE     (64*1024)    // the bytes read from the stream socket at once
+#define GNSS_NET_DATAGRAMS     16           // the datagrams received from the UDP socket at once (recvmmsg)
+#define GNSS_NET_DATAGRAM_SIZE 2048         // the maximum size of the single datagram
+
+// the state of the source
+const uint8_t GNSS_NET_IDLE       = 0;  // the slot is not used
+const uint8_t GNSS_NET_CONNECTING = 1;  // the connection is being set up
+const uint8_t GNSS_NET_RECEIVING  = 2;  // connected (TCP, unix socket) or bound (UDP)
+const uint8_t GNSS_NET_WAITING    = 3;  // the connection has been lost - it is set up again after the reconnect delay
+
+// the epoch of the given source (see GNSSCollector::setEpochCallback)
+typedef void (*GNSS_source_epoch_callback)(uint16_t paSource, const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paUserData);
+
+/***************************************************************************************************************************************************
+ ************************************************************** the network sources of NMEA ********************************************************
+ ***************************************************************************************************************************************************/
+
+// The sources deliver the bytes received from the sockets to their own collectors (so every source has its own epoch state):
+//   TCP       - the serial-to-ethernet bridges, the NTRIP-like casters (the request is sent after every connection), GNSS_fanout
+//   UDP       - the broadcasts (or the multicast group) on the given port; every datagram is the part of the byte stream of the single receiver
+//   unix      - the local stream socket (e.g. GNSS_fanout -u)
+// The single epoll loop serves all of them: service() reads all the bytes available (the datagrams with recvmmsg) and gives them to
+// GNSSCollector::feed() in bulk. The lost TCP and unix socket connections are set up again after the reconnect delay.
+class GNSSNetSources {
+private:
+  struct net_source {
+    uint8_t                  type;
+    uint8_t                  state;
+    int                      fd;
+    struct sockaddr_storage  address;
+    socklen_t                addressLength;
+    char                    *request;       // sent after every connection (TCP)
+    uint32_t                 retryMs;       // the time of the next connection attempt (GNSS_NET_WAITING)
+    GNSSCollector           *collector;
+    GNSSNetSources          *owner;
+    uint64_t                 bytes;
+    uint32_t                 epochs;
+    uint32_t                 connections;
+  };
+
+  int                         atEpoll;
+  struct net_source          *atSources;
+  uint16_t                    atMaxSources;
+  char                       *atBuffer;
+  uint32_t                    atReconnectMs;
+  GNSS_source_epoch_callback  atEpochCallback;
+  void                       *atEpochCallbackUserData;
+
+  int     add_source(uint8_t paType, const struct sockaddr *paAddress, socklen_t paLength, const char *paRequest);
+  void    start(struct net_source *paSource, uint32_t paNowMs);
+  void    lost(struct net_source *paSource, uint32_t paNowMs);
+  void    connected(struct net_source *paSource, uint32_t paNowMs);
+  void    read_stream(struct net_source *paSource, uint32_t paNowMs);
+  void    read_datagrams(struct net_source *paSource, uint32_t paNowMs);
+  static void epoch_trampoline(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paSource);
+
+public:
+  GNSSNetSources(uint16_t paMaxSources = 64);
+  ~GNSSNetSources(void);
+
+  // They add the source and return its number (0 ... paMaxSources - 1) or -1 on the error (the address can not be resolved,
+  // the UDP port can not be bound, there is no room). The TCP and unix socket sources connect in the background (see service()).
+  // The multicast group given as the UDP address is joined.
+  int     addTCP(const char *paHost, uint16_t paPort, const char *paRequest = NULL);
+  int     addUDP(uint16_t paPort, const char *paAddress = "0.0.0.0");
+  int     addUnix(const char *paPath);
+  // it closes the source (the number can be given to the next source added)
+  void    remove(uint16_t paSource);
+
+  // It waits up to paTimeoutMs for the data, reads all the bytes available and feeds the collectors of the sources, detects the breaks
+  // between the epochs and sets up the connections lost. It returns the number of the sources served or -1 on the error.
+  // Call it at least once per the break time of the collectors (use the short timeout).
+  int     service(int paTimeoutMs);
+  // the epoll descriptor - it is readable when service() has some data to read (for the external event loop)
+  inline int getFd(void) { return this->atEpoll; };
+
+  // the collector of the source - set its parsers, callbacks or break time as usual (they are not changed by the sources)
+  GNSSCollector *getCollector(uint16_t paSource);
+  // the epochs of all the sources with the number of the source (it replaces the epoch callbacks of the collectors)
+  void    setEpochCallback(GNSS_source_epoch_callback paCallback, void *paUserData = NULL);
+  // the delay of the next connection attempt after the connection is lost or refused (1000 ms by default)
+  inline void setReconnectDelay(uint32_t paDelayMs) { this->atReconnectMs = paDelayMs; };
+
+  uint8_t  getState(uint16_t paSource);
+  uint64_t getBytes(uint16_t paSource);
+  uint32_t getEpochs(uint16_t paSource);
+  uint32_t getConnections(uint16_t paSource);
+};
+
+#endif // linux
+
+#endif
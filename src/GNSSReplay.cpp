@@ -0,0 +1,847 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "GNSSReplay.h"
+
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ****************************************************** the UTC time of the single sliced sentence  ***********************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+int32_t getSentenceTimeMs(const struct NMEA_fields *paSlices) {
+  const char *loHeader;
+  const char *loTime;
+  uint8_t loField;
+  uint8_t i;
+  int32_t loMs;
+  int32_t loScale;
+
+  if ((NULL == paSlices) || (2 > paSlices->cnt)) {
+    return (-1);
+  }
+  loHeader = GNSSCollector::get_field(paSlices, 0);
+  if (6 != strlen(loHeader)) { // $xxXXX
+    return (-1);
+  }
+  loHeader += 3;
+
+  if (  (!strcmp(loHeader, "RMC")) || (!strcmp(loHeader, "GGA")) || (!strcmp(loHeader, "GBS"))
+     || (!strcmp(loHeader, "GST")) || (!strcmp(loHeader, "GNS")) || (!strcmp(loHeader, "ZDA")) ) {
+    loField = 1;
+  } else if (!strcmp(loHeader, "GLL")) {
+    loField = 5;
+  } else {
+    return (-1);
+  }
+  if (loField >= paSlices->cnt) {
+    return (-1);
+  }
+
+  loTime = GNSSCollector::get_field(paSlices, loField); // hhmmss.fff
+  for (i = 0; i < 6; i++) {
+    if (('0' > loTime[i]) || ('9' < loTime[i])) {
+      return (-1);
+    }
+  }
+  loMs  = ((loTime[0]-'0')*10 + (loTime[1]-'0')) * 3600000;
+  loMs += ((loTime[2]-'0')*10 + (loTime[3]-'0')) * 60000;
+  loMs += ((loTime[4]-'0')*10 + (loTime[5]-'0')) * 1000;
+  if ('.' == loTime[6]) {
+    loScale = 100;
+    for (i = 7; ('0' <= loTime[i]) && ('9' >= loTime[i]) && (0 < loScale); i++) {
+      loMs += (loTime[i]-'0') * loScale;
+      loScale /= 10;
+    }
+  }
+  return (loMs);
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ************************************************************* the UTC epoch splitter  *************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+GNSSEpochSplitter::GNSSEpochSplitter(GNSSCollector *paCollector, GNSS_epoch_sink paSink, void *paUserData) {
+  atCollector    = paCollector;
+  atSink         = paSink;
+  atSinkUserData = paUserData;
+  atEpochTime    = -1;
+  atHaveData     = false;
+  atEpochs       = 0;
+  atRejected     = 0;
+}
+
+
+int8_t GNSSEpochSplitter::sliceLine(const char *paLine, size_t paLength, struct NMEA_fields *paSlices) {
+  char loLine[MAXMESSAGELENGTH];
+
+  if (NULL == paLine) {
+    return (-1);
+  }
+  // the line is terminated with "\r\n" here, because some loggers store the sentences with "\n" only
+  while ((0 < paLength) && (('\n' == paLine[paLength-1]) || ('\r' == paLine[paLength-1]))) {
+    paLength--;
+  }
+  if ((MAXMESSAGELENGTH-3) < paLength) { // the 3 bytes space is needed for \r\n\0 terminating the string
+    return (-1);
+  }
+  memcpy(loLine, paLine, paLength);
+  loLine[paLength]   = '\r';
+  loLine[paLength+1] = '\n';
+  loLine[paLength+2] = 0;
+  return (GNSSCollector::check_and_slice_NMEA_message(loLine, paSlices));
+}
+
+
+void GNSSEpochSplitter::reset(void) {
+  this->atEpochTime = -1;
+  this->atHaveData  = false;
+  if (NULL != this->atCollector) {
+    this->atCollector->clearData();
+  }
+}
+
+
+int8_t GNSSEpochSplitter::flush(void) {
+  int8_t loStop = 0;
+
+  if (!this->atHaveData) {
+    return (0);
+  }
+  this->atHaveData = false;
+  this->atEpochs++;
+  if (NULL != this->atSink) {
+    loStop = this->atSink(this->atCollector->getGNSSData(), this->atCollector->getGSVData(), this->atSinkUserData);
+  }
+  this->atCollector->clearData();
+  return (loStop ? -1 : 1);
+}
+
+
+int8_t GNSSEpochSplitter::putLine(const char *paLine, size_t paLength) {
+  struct NMEA_fields loSlices;
+
+  if (NULL == this->atCollector) {
+    return (0);
+  }
+  if (GNSSEpochSplitter::sliceLine(paLine, paLength, &loSlices)) {
+    this->atRejected++;
+    return (0);
+  }
+  return (this->putSlices(&loSlices));
+}
+
+
+int8_t GNSSEpochSplitter::putSlices(const struct NMEA_fields *paSlices) {
+  int32_t loTime;
+  int8_t loResult = 0;
+
+  if ((NULL == this->atCollector) || (NULL == paSlices)) {
+    return (0);
+  }
+  loTime = getSentenceTimeMs(paSlices);
+  if (0 <= loTime) {
+    if (loTime != this->atEpochTime) { // the new epoch starts with this sentence
+      loResult = this->flush();
+      if (0 > loResult) {
+        return (loResult);
+      }
+    }
+    this->atEpochTime = loTime;
+  }
+
+  if (this->atCollector->parseSentence(paSlices)) {
+    this->atHaveData = true;
+  }
+  return (loResult);
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************** the memory-mapped log replay on all the CPU cores  ******************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+// the single chunk of the log file and the epochs parsed from it (waiting for the sink)
+struct replay_chunk {
+  size_t              begin;
+  size_t              end;
+  struct GNSS_data   *epochs;
+  struct GSV_manager *GSVData;   // NULL when the GSV data is not collected
+  uint32_t            cnt;
+  uint32_t            capacity;
+  uint32_t            rejected;
+  bool                failed;    // no RAM space for the epochs
+  bool                done;
+};
+
+
+GNSSReplay::GNSSReplay(void) {
+  atMap       = NULL;
+  atSize      = 0;
+  atThreads   = 0;
+  atChunkSize = 1024*1024;
+  atGSV       = false;
+  atEpochs    = 0;
+  atRejected  = 0;
+  atChunks    = NULL;
+  atChunksCnt = 0;
+  atIndex     = NULL;
+  atIndexCnt  = 0;
+}
+
+
+GNSSReplay::~GNSSReplay(void) {
+  this->close();
+}
+
+
+int8_t GNSSReplay::open(const char *paPath) {
+  struct stat loStat;
+  int loFd;
+  void *loMap;
+
+  this->close();
+  if (NULL == paPath) {
+    return (-1);
+  }
+  loFd = ::open(paPath, O_RDONLY);
+  if (0 > loFd) {
+    SETCOLORRED DBG("The log file can not be opened\r\n"); NOCOLOR
+    return (-1);
+  }
+  if ((0 != fstat(loFd, &loStat)) || (0 == loStat.st_size)) {
+    SETCOLORRED DBG("The log file is empty or its size is unknown\r\n"); NOCOLOR
+    ::close(loFd);
+    return (-1);
+  }
+  loMap = mmap(NULL, (size_t)loStat.st_size, PROT_READ, MAP_PRIVATE, loFd, 0);
+  ::close(loFd); // the mapping stays valid after closing the descriptor
+  if (MAP_FAILED == loMap) {
+    SETCOLORRED DBG("The log file can not be mapped into the memory\r\n"); NOCOLOR
+    return (-1);
+  }
+  madvise(loMap, (size_t)loStat.st_size, MADV_WILLNEED);
+  this->atMap  = (const char *)loMap;
+  this->atSize = (size_t)loStat.st_size;
+  return (0);
+}
+
+
+void GNSSReplay::close(void) {
+  free(this->atIndex); // the index belongs to the closed file
+  this->atIndex    = NULL;
+  this->atIndexCnt = 0;
+  if (NULL != this->atMap) {
+    munmap((void *)this->atMap, this->atSize);
+    this->atMap  = NULL;
+    this->atSize = 0;
+  }
+}
+
+
+void GNSSReplay::setChunkSize(size_t paBytes) {
+  if (4096 > paBytes) {
+    DBG("The chunk size shall be at least 4096 bytes\r\n");
+    return;
+  }
+  this->atChunkSize = paBytes;
+}
+
+
+// The position of the first line starting the new epoch at or after the given position (the same rule as GNSSEpochSplitter uses):
+// the first sentence with the time is found and then the first sentence with the different time - the chunks can be parsed
+// separately, because every epoch is placed in the single chunk.
+size_t GNSSReplay::next_epoch_start(size_t paPosition) {
+  struct NMEA_fields loSlices;
+  const char *loLineEnd;
+  int32_t loFirstTime = -1;
+  int32_t loTime;
+  size_t loLine;
+
+  // the beginning of the next line
+  loLineEnd = (const char *)memchr(this->atMap + paPosition, '\n', this->atSize - paPosition);
+  if (NULL == loLineEnd) {
+    return (this->atSize);
+  }
+  loLine = (loLineEnd - this->atMap) + 1;
+
+  while (loLine < this->atSize) {
+    loLineEnd = (const char *)memchr(this->atMap + loLine, '\n', this->atSize - loLine);
+    size_t loLength = (NULL == loLineEnd) ? (this->atSize - loLine) : (size_t)(loLineEnd - (this->atMap + loLine) + 1);
+
+    if (0 == GNSSEpochSplitter::sliceLine(this->atMap + loLine, loLength, &loSlices)) {
+      loTime = getSentenceTimeMs(&loSlices);
+      if (0 <= loTime) {
+        if (0 > loFirstTime) {
+          loFirstTime = loTime;
+        } else if (loTime != loFirstTime) {
+          return (loLine);
+        }
+      }
+    }
+    loLine += loLength;
+  }
+  return (this->atSize);
+}
+
+
+int8_t GNSSReplay::chunk_sink(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paChunk) {
+  struct replay_chunk *loChunk = (struct replay_chunk *)paChunk;
+
+  if (loChunk->cnt == loChunk->capacity) {
+    uint32_t loCapacity = (0 == loChunk->capacity) ? 256 : (loChunk->capacity * 2);
+    struct GNSS_data *loEpochs = (struct GNSS_data *)realloc(loChunk->epochs, loCapacity * sizeof(struct GNSS_data));
+    if (NULL == loEpochs) {
+      loChunk->failed = true;
+      return (-1);
+    }
+    loChunk->epochs = loEpochs;
+    if (NULL != paGSVData) {
+      struct GSV_manager *loGSVData = (struct GSV_manager *)realloc(loChunk->GSVData, loCapacity * sizeof(struct GSV_manager));
+      if (NULL == loGSVData) {
+        loChunk->failed = true;
+        return (-1);
+      }
+      loChunk->GSVData = loGSVData;
+    }
+    loChunk->capacity = loCapacity;
+  }
+  loChunk->epochs[loChunk->cnt] = *paData;
+  if (NULL != paGSVData) {
+    loChunk->GSVData[loChunk->cnt] = *paGSVData;
+  }
+  loChunk->cnt++;
+  return (0);
+}
+
+
+void GNSSReplay::worker(void) {
+  GNSSCollector loCollector(NULL, NULL);
+  uint32_t loIndex;
+
+  if (this->atGSV) {
+    loCollector.GSVSwitch(true);
+  }
+
+  while (1) {
+    pthread_mutex_lock(&this->atMutex);
+    while ((!this->atStop) && (this->atNextChunk < this->atChunksCnt) && (this->atNextChunk >= (this->atSunkChunks + this->atMaxAhead))) {
+      pthread_cond_wait(&this->atWorkCond, &this->atMutex);
+    }
+    if ((this->atStop) || (this->atNextChunk >= this->atChunksCnt)) {
+      pthread_mutex_unlock(&this->atMutex);
+      break;
+    }
+    loIndex = this->atNextChunk++;
+    pthread_mutex_unlock(&this->atMutex);
+
+    struct replay_chunk *loChunk = &this->atChunks[loIndex];
+    GNSSEpochSplitter loSplitter(&loCollector, GNSSReplay::chunk_sink, loChunk);
+    size_t loLine = loChunk->begin;
+
+    loSplitter.reset();
+    while (loLine < loChunk->end) {
+      const char *loLineEnd = (const char *)memchr(this->atMap + loLine, '\n', loChunk->end - loLine);
+      size_t loLength = (NULL == loLineEnd) ? (loChunk->end - loLine) : (size_t)(loLineEnd - (this->atMap + loLine) + 1);
+      if (0 > loSplitter.putLine(this->atMap + loLine, loLength)) {
+        break; // no RAM space
+      }
+      loLine += loLength;
+    }
+    loSplitter.flush();
+    loChunk->rejected = loSplitter.getRejected();
+
+    pthread_mutex_lock(&this->atMutex);
+    loChunk->done = true;
+    pthread_cond_broadcast(&this->atDoneCond);
+    pthread_mutex_unlock(&this->atMutex);
+  }
+}
+
+
+void *GNSSReplay::worker_entry(void *paReplay) {
+  ((GNSSReplay *)paReplay)->worker();
+  return (NULL);
+}
+
+
+int8_t GNSSReplay::run(GNSS_epoch_sink paSink, void *paUserData) {
+  this->atEpochs   = 0;
+  this->atRejected = 0;
+  if (NULL == this->atMap) {
+    DBG("The log file has to be opened before the replay\r\n");
+    return (-1);
+  }
+  return (this->run_slice(0, this->atSize, paSink, paUserData));
+}
+
+
+// it parses the part of the file [paBegin, paEnd) - both the positions shall be the beginnings of the epochs
+int8_t GNSSReplay::run_slice(size_t paBegin, size_t paEnd, GNSS_epoch_sink paSink, void *paUserData) {
+  pthread_t *loThreads;
+  uint32_t loThreadsCnt;
+  uint32_t loStarted;
+  uint32_t i, k;
+  size_t loPosition;
+  int8_t loResult = 0;
+
+  // the chunks are aligned to the beginning of the epochs
+  this->atChunksCnt = (uint32_t)((paEnd - paBegin) / this->atChunkSize) + 1;
+  this->atChunks = (struct replay_chunk *)calloc(this->atChunksCnt, sizeof(struct replay_chunk));
+  if (NULL == this->atChunks) {
+    return (-2);
+  }
+  loPosition = paBegin;
+  for (k = 0; k < this->atChunksCnt; k++) {
+    this->atChunks[k].begin = loPosition;
+    if ((k + 1) < this->atChunksCnt) {
+      size_t loSplit = paBegin + (k + 1) * this->atChunkSize;
+      loPosition = (loSplit <= loPosition) ? loPosition : this->next_epoch_start(loSplit);
+      if (loPosition > paEnd) {
+        loPosition = paEnd;
+      }
+    } else {
+      loPosition = paEnd;
+    }
+    this->atChunks[k].end = loPosition;
+  }
+
+  loThreadsCnt = this->atThreads;
+  if (0 == loThreadsCnt) {
+    long loCPUs = sysconf(_SC_NPROCESSORS_ONLN);
+    loThreadsCnt = (0 < loCPUs) ? (uint32_t)loCPUs : 1;
+  }
+  if (loThreadsCnt > this->atChunksCnt) {
+    loThreadsCnt = this->atChunksCnt;
+  }
+  loThreads = (pthread_t *)calloc(loThreadsCnt, sizeof(pthread_t));
+  if (NULL == loThreads) {
+    free(this->atChunks);
+    this->atChunks = NULL;
+    return (-2);
+  }
+
+  this->atNextChunk  = 0;
+  this->atSunkChunks = 0;
+  this->atMaxAhead   = 2 * loThreadsCnt;
+  this->atStop       = false;
+  pthread_mutex_init(&this->atMutex, NULL);
+  pthread_cond_init(&this->atWorkCond, NULL);
+  pthread_cond_init(&this->atDoneCond, NULL);
+
+  for (loStarted = 0; loStarted < loThreadsCnt; loStarted++) {
+    if (0 != pthread_create(&loThreads[loStarted], NULL, GNSSReplay::worker_entry, this)) {
+      break;
+    }
+  }
+  if (0 == loStarted) {
+    loResult = -2;
+    this->atStop = true;
+  }
+
+  // the chunks are given to the sink in the order of the file
+  for (k = 0; (k < this->atChunksCnt) && (!this->atStop); k++) {
+    struct replay_chunk *loChunk = &this->atChunks[k];
+
+    pthread_mutex_lock(&this->atMutex);
+    while (!loChunk->done) {
+      pthread_cond_wait(&this->atDoneCond, &this->atMutex);
+    }
+    pthread_mutex_unlock(&this->atMutex);
+
+    if (loChunk->failed) {
+      SETCOLORRED DBG("Insufficient RAM space for the replayed epochs\r\n"); NOCOLOR
+      loResult = -2;
+    }
+    for (i = 0; (i < loChunk->cnt) && (0 == loResult); i++) {
+      this->atEpochs++;
+      if ((NULL != paSink) && paSink(&loChunk->epochs[i], (NULL != loChunk->GSVData) ? &loChunk->GSVData[i] : NULL, paUserData)) {
+        loResult = 1;
+      }
+    }
+    this->atRejected += loChunk->rejected;
+    free(loChunk->epochs);
+    free(loChunk->GSVData);
+    loChunk->epochs  = NULL;
+    loChunk->GSVData = NULL;
+
+    pthread_mutex_lock(&this->atMutex);
+    this->atSunkChunks = k + 1;
+    if (0 != loResult) {
+      this->atStop = true;
+    }
+    pthread_cond_broadcast(&this->atWorkCond);
+    pthread_mutex_unlock(&this->atMutex);
+  }
+
+  for (i = 0; i < loStarted; i++) {
+    pthread_join(loThreads[i], NULL);
+  }
+  for (k = 0; k < this->atChunksCnt; k++) { // the chunks parsed after the stop
+    free(this->atChunks[k].epochs);
+    free(this->atChunks[k].GSVData);
+  }
+  pthread_cond_destroy(&this->atDoneCond);
+  pthread_cond_destroy(&this->atWorkCond);
+  pthread_mutex_destroy(&this->atMutex);
+  free(loThreads);
+  free(this->atChunks);
+  this->atChunks    = NULL;
+  this->atChunksCnt = 0;
+  return (loResult);
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ******************************************************** the UTC time index of the log file  ******************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+static const char GNSS_INDEX_MAGIC[7] = {'G', 'N', 'S', 'S', 'I', 'D', 'X'};
+
+// the day (since 1970-01-01) given with the $xxRMC (ddmmyy) or $xxZDA (dd, mm, yyyy) sentence or -1 if the date is not given
+static int32_t sentence_date_days(const struct NMEA_fields *paSlices) {
+  const char *loHeader = GNSSCollector::get_field(paSlices, 0) + 3;
+  const char *loDate;
+  int64_t loMs = -1;
+
+  if ((!strcmp(loHeader, "RMC")) && (9 < paSlices->cnt)) {
+    loDate = GNSSCollector::get_field(paSlices, 9);
+    if (6 == strlen(loDate)) {
+      loMs = GNSSCollector::getUnixTimeMs(2000 + (loDate[4]-'0')*10 + (loDate[5]-'0'), (loDate[2]-'0')*10 + (loDate[3]-'0'), (loDate[0]-'0')*10 + (loDate[1]-'0'), 0);
+    }
+  } else if ((!strcmp(loHeader, "ZDA")) && (4 < paSlices->cnt)) {
+    loMs = GNSSCollector::getUnixTimeMs(atoi(GNSSCollector::get_field(paSlices, 4)), atoi(GNSSCollector::get_field(paSlices, 3)), atoi(GNSSCollector::get_field(paSlices, 2)), 0);
+  }
+  return ((0 > loMs) ? -1 : (int32_t)(loMs / 86400000));
+}
+
+
+// FNV-1a of the first and the last block of the log file - the log rewritten to the same size is not taken for the indexed one
+uint64_t GNSSReplay::log_hash(void) {
+  uint64_t loHash = 0xCBF29CE484222325ULL;
+  size_t loFirst = (this->atSize < GNSS_INDEX_HASH_BLOCK) ? this->atSize : GNSS_INDEX_HASH_BLOCK;
+  size_t loLast  = (this->atSize < (2 * GNSS_INDEX_HASH_BLOCK)) ? loFirst : (this->atSize - GNSS_INDEX_HASH_BLOCK);
+  size_t i;
+
+  for (i = 0; i < this->atSize; i = (i + 1 == loFirst) ? loLast : (i + 1)) {
+    loHash ^= (uint8_t)this->atMap[i];
+    loHash *= 0x100000001B3ULL;
+  }
+  return (loHash);
+}
+
+
+int8_t GNSSReplay::buildIndex(const char *paIndexPath, uint32_t paEvery) {
+  struct GNSS_index_header loHeader;
+  struct NMEA_fields loSlices;
+  const char *loLineEnd;
+  uint64_t loCapacity = 0;
+  uint64_t loEpochsCnt = 0;
+  size_t loLine = 0;
+  size_t loLength;
+  int32_t loDays = -1;      // the current date [days since 1970-01-01]
+  int32_t loEpochTime = -1; // the time of the current epoch [ms of the day]
+  int32_t loTime;
+  int32_t loSentenceDays;
+  FILE *loFile;
+
+  if (NULL == this->atMap) {
+    DBG("The log file has to be opened before the index is built\r\n");
+    return (-1);
+  }
+  if (0 == paEvery) {
+    paEvery = 1;
+  }
+  free(this->atIndex);
+  this->atIndex    = NULL;
+  this->atIndexCnt = 0;
+
+  for (loLine = 0; loLine < this->atSize; loLine += loLength) {
+    loLineEnd = (const char *)memchr(this->atMap + loLine, '\n', this->atSize - loLine);
+    loLength  = (NULL == loLineEnd) ? (this->atSize - loLine) : (size_t)(loLineEnd - (this->atMap + loLine) + 1);
+
+    // only the sentences with the time or date are sliced
+    if ((7 > loLength) || ('$' != this->atMap[loLine])) {
+      continue;
+    }
+    const char *loType = this->atMap + loLine + 3;
+    if (  (strncmp(loType, "RMC", 3)) && (strncmp(loType, "GGA", 3)) && (strncmp(loType, "GLL", 3)) && (strncmp(loType, "GBS", 3))
+       && (strncmp(loType, "GST", 3)) && (strncmp(loType, "GNS", 3)) && (strncmp(loType, "ZDA", 3)) ) {
+      continue;
+    }
+    if (GNSSEpochSplitter::sliceLine(this->atMap + loLine, loLength, &loSlices)) {
+      continue;
+    }
+    loTime = getSentenceTimeMs(&loSlices);
+    if (0 > loTime) {
+      continue;
+    }
+    loSentenceDays = sentence_date_days(&loSlices);
+
+    if (loTime == loEpochTime) { // the subsequent sentence of the current epoch
+      if (0 <= loSentenceDays) {
+        loDays = loSentenceDays;
+      }
+      continue;
+    }
+
+    // the first sentence of the new epoch
+    if (0 <= loSentenceDays) {
+      loDays = loSentenceDays;
+    } else if ((0 <= loDays) && (0 <= loEpochTime) && ((loTime + 43200000) < loEpochTime)) { // the midnight (the time went back by more than 12 hours)
+      loDays++;
+    }
+    loEpochTime = loTime;
+    if (0 > loDays) {
+      continue; // the date is not known yet
+    }
+    if (0 == (loEpochsCnt++ % paEvery)) {
+      int64_t loUnixMs = ((int64_t)loDays) * 86400000 + loTime;
+      if ((0 < this->atIndexCnt) && (loUnixMs < this->atIndex[this->atIndexCnt - 1].unixMs)) {
+        continue; // the log is not chronological here - the index has to stay sorted
+      }
+      if (this->atIndexCnt == loCapacity) {
+        loCapacity = (0 == loCapacity) ? 1024 : (loCapacity * 2);
+        struct GNSS_index_entry *loIndex = (struct GNSS_index_entry *)realloc(this->atIndex, loCapacity * sizeof(struct GNSS_index_entry));
+        if (NULL == loIndex) {
+          SETCOLORRED DBG("Insufficient RAM space for the index\r\n"); NOCOLOR
+          free(this->atIndex);
+          this->atIndex    = NULL;
+          this->atIndexCnt = 0;
+          return (-2);
+        }
+        this->atIndex = loIndex;
+      }
+      this->atIndex[this->atIndexCnt].unixMs = loUnixMs;
+      this->atIndex[this->atIndexCnt].offset = loLine;
+      this->atIndexCnt++;
+    }
+  }
+
+  if (NULL == paIndexPath) {
+    return (0); // the index is used only in the memory
+  }
+  memset(&loHeader, 0, sizeof(loHeader));
+  memcpy(loHeader.magic, GNSS_INDEX_MAGIC, sizeof(GNSS_INDEX_MAGIC));
+  loHeader.version = GNSS_INDEX_VERSION;
+  loHeader.every   = paEvery;
+  loHeader.logSize = this->atSize;
+  loHeader.count   = this->atIndexCnt;
+  loHeader.logHash = this->log_hash();
+  loFile = fopen(paIndexPath, "wb");
+  if (NULL == loFile) {
+    SETCOLORRED DBG("The index file can not be created\r\n"); NOCOLOR
+    return (-2);
+  }
+  if (  (1 != fwrite(&loHeader, sizeof(loHeader), 1, loFile))
+     || (this->atIndexCnt != fwrite(this->atIndex, sizeof(struct GNSS_index_entry), this->atIndexCnt, loFile)) ) {
+    SETCOLORRED DBG("The index file can not be written\r\n"); NOCOLOR
+    fclose(loFile);
+    return (-2);
+  }
+  return ((0 == fclose(loFile)) ? 0 : -2);
+}
+
+
+int8_t GNSSReplay::loadIndex(const char *paIndexPath) {
+  struct GNSS_index_header loHeader;
+  uint64_t i;
+  FILE *loFile;
+
+  free(this->atIndex);
+  this->atIndex    = NULL;
+  this->atIndexCnt = 0;
+  if ((NULL == this->atMap) || (NULL == paIndexPath) || (NULL == (loFile = fopen(paIndexPath, "rb")))) {
+    return (-1);
+  }
+  if (  (1 != fread(&loHeader, sizeof(loHeader), 1, loFile))
+     || (memcmp(loHeader.magic, GNSS_INDEX_MAGIC, sizeof(GNSS_INDEX_MAGIC)))
+     || (GNSS_INDEX_VERSION != loHeader.version)
+     || (this->atSize != loHeader.logSize)
+     || (this->log_hash() != loHeader.logHash)
+     || (loHeader.count > (loHeader.logSize / 2)) ) { // every entry is the separate line
+    DBG("The index file is not correct or it belongs to the different log file\r\n");
+    fclose(loFile);
+    return (-1);
+  }
+  if (0 < loHeader.count) {
+    this->atIndex = (struct GNSS_index_entry *)malloc(loHeader.count * sizeof(struct GNSS_index_entry));
+    if ((NULL == this->atIndex) || (loHeader.count != fread(this->atIndex, sizeof(struct GNSS_index_entry), loHeader.count, loFile))) {
+      free(this->atIndex);
+      this->atIndex = NULL;
+      fclose(loFile);
+      return (-1);
+    }
+  }
+  fclose(loFile);
+  // the entries are trusted by runRange() - the positions have to be within the log file and both the times and the positions sorted
+  for (i = 0; i < loHeader.count; i++) {
+    if (  (this->atIndex[i].offset > this->atSize)
+       || ((0 < i) && ((this->atIndex[i].offset < this->atIndex[i - 1].offset) || (this->atIndex[i].unixMs < this->atIndex[i - 1].unixMs))) ) {
+      DBG("The index file is damaged\r\n");
+      free(this->atIndex);
+      this->atIndex = NULL;
+      return (-1);
+    }
+  }
+  this->atIndexCnt = loHeader.count;
+  return (0);
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ******************************************************** the replay of the UTC time range  ********************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+// the state of the range filter - the epochs are given in the order of the file, so the date can be followed as with the index
+struct replay_range {
+  int64_t         fromMs;
+  int64_t         toMs;
+  GNSS_epoch_sink sink;
+  void           *userData;
+  int32_t         days;        // the current date [days since 1970-01-01] (-1 - unknown)
+  int32_t         lastTime;    // the time of the day of the last epoch [ms] (-1 - unknown)
+  bool            inRange;     // the last epoch with the time was inside the range
+  bool            finished;    // the epoch after the range has been found
+};
+
+
+int8_t GNSSReplay::range_sink(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paRange) {
+  struct replay_range *loRange = (struct replay_range *)paRange;
+  int64_t loUnixMs;
+  int32_t loTime;
+
+  if (paData->msgs_rcvd[MSG_RMC] || paData->msgs_rcvd[MSG_GGA] || paData->msgs_rcvd[MSG_GLL] || paData->msgs_rcvd[MSG_GBS] || paData->msgs_rcvd[MSG_GST]) {
+    loTime   = ((int32_t)paData->UTC_H * 3600 + (int32_t)paData->UTC_M * 60 + paData->UTC_S) * 1000 + paData->UTC_fract;
+    loUnixMs = GNSSCollector::getUnixTimeMs(paData);
+    if (0 <= loUnixMs) {
+      loRange->days = (int32_t)(loUnixMs / 86400000);
+    } else if ((0 <= loRange->days) && (0 <= loRange->lastTime) && ((loTime + 43200000) < loRange->lastTime)) { // the midnight
+      loRange->days++;
+    }
+    loRange->lastTime = loTime;
+    if (0 > loRange->days) {
+      return (0); // the date is not known yet
+    }
+    loUnixMs = ((int64_t)loRange->days) * 86400000 + loTime;
+    if (loUnixMs > loRange->toMs) {
+      loRange->finished = true;
+      return (1);
+    }
+    loRange->inRange = (loUnixMs >= loRange->fromMs);
+  }
+  if (!loRange->inRange) {
+    return (0);
+  }
+  return ((NULL != loRange->sink) ? loRange->sink(paData, paGSVData, loRange->userData) : 0);
+}
+
+
+int8_t GNSSReplay::runRange(int64_t paFromMs, int64_t paToMs, GNSS_epoch_sink paSink, void *paUserData) {
+  struct replay_range loRange;
+  size_t loBegin = 0;
+  size_t loEnd;
+  uint64_t loLow, loHigh, loMiddle;
+  int8_t loResult;
+
+  this->atEpochs   = 0;
+  this->atRejected = 0;
+  if (NULL == this->atMap) {
+    DBG("The log file has to be opened before the replay\r\n");
+    return (-1);
+  }
+  loEnd = this->atSize;
+
+  memset(&loRange, 0, sizeof(loRange));
+  loRange.fromMs   = paFromMs;
+  loRange.toMs     = paToMs;
+  loRange.sink     = paSink;
+  loRange.userData = paUserData;
+  loRange.days     = -1;
+  loRange.lastTime = -1;
+
+  if (0 < this->atIndexCnt) {
+    // the last entry not later than the beginning of the range
+    loLow  = 0;
+    loHigh = this->atIndexCnt;
+    while (loLow < loHigh) {
+      loMiddle = (loLow + loHigh) / 2;
+      if (this->atIndex[loMiddle].unixMs <= paFromMs) {
+        loLow = loMiddle + 1;
+      } else {
+        loHigh = loMiddle;
+      }
+    }
+    if (0 < loLow) {
+      loBegin = (size_t)this->atIndex[loLow - 1].offset;
+      // the date of the first epoch is known from the index even if the epoch has no $xxRMC sentence
+      loRange.days     = (int32_t)(this->atIndex[loLow - 1].unixMs / 86400000);
+      loRange.lastTime = (int32_t)(this->atIndex[loLow - 1].unixMs % 86400000);
+    }
+    // the first entry later than the end of the range
+    loHigh = this->atIndexCnt;
+    while (loLow < loHigh) {
+      loMiddle = (loLow + loHigh) / 2;
+      if (this->atIndex[loMiddle].unixMs <= paToMs) {
+        loLow = loMiddle + 1;
+      } else {
+        loHigh = loMiddle;
+      }
+    }
+    if (loLow < this->atIndexCnt) {
+      loEnd = (size_t)this->atIndex[loLow].offset;
+    }
+  }
+
+  // the slice never leaves the mapping (loadIndex() has checked the entries already)
+  if (loEnd > this->atSize) {
+    loEnd = this->atSize;
+  }
+  if (loBegin > loEnd) {
+    loBegin = loEnd;
+  }
+  loResult = this->run_slice(loBegin, loEnd, GNSSReplay::range_sink, &loRange);
+  if ((1 == loResult) && (loRange.finished)) {
+    loResult = 0; // the range has been replayed - the sink didn't ask to stop
+  }
+  return (loResult);
+}
+
+#endif // linux
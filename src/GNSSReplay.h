@@ -0,0 +1,188 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef GNSS_REPLAY_H
+#define GNSS_REPLAY_H
+
+#include "ultimateGNSSParser.h"
+
+// The replay of the recorded NMEA logs is available on linux only (it needs mmap and pthreads),
+// the file is compiled to nothing on the other platforms.
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include <stddef.h>
+#include <pthread.h>
+
+// The sink receives the collected epochs (in the order of the log file).
+// paGSVData is NULL when the GSV data is not collected. Return the non-zero value to stop the replay.
+typedef int8_t (*GNSS_epoch_sink)(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paUserData);
+
+// the UTC time of the sliced sentence ($xxRMC, $xxGGA, $xxGLL, $xxGBS, $xxGST, $xxGNS, $xxZDA) in milliseconds of the day
+// it returns -1 when the sentence has no time field or the time field is empty (e.g. no fix yet)
+int32_t getSentenceTimeMs(const struct NMEA_fields *paSlices);
+
+
+/***************************************************************************************************************************************************
+ ****************************************** the epoch splitter - the epochs are separated by the UTC time of the sentences **************************
+ ***************************************************************************************************************************************************/
+
+// The recorded log has no break time between the packs of messages, so the epoch is closed just before the sentence
+// with the new UTC time is parsed. The sentences without the time field (e.g. $xxGSA, $xxGSV, $xxVTG) belong to the epoch
+// of the last sentence with the time field.
+class GNSSEpochSplitter {
+private:
+  GNSSCollector   *atCollector;
+  GNSS_epoch_sink  atSink;
+  void            *atSinkUserData;
+  int32_t          atEpochTime;    // the UTC time of the current epoch [ms of the day] (-1 - not known yet)
+  bool             atHaveData;     // at least one sentence of the current epoch has been collected
+  uint32_t         atEpochs;       // the number of the epochs given to the sink
+  uint32_t         atRejected;     // the number of the lines rejected (incorrect format, check sum or too long)
+
+public:
+  // the collector is used only with its line level methods (it may be created with NULL callbacks)
+  GNSSEpochSplitter(GNSSCollector *paCollector, GNSS_epoch_sink paSink, void *paUserData);
+
+  // the single line of the log - it may be terminated with "\r\n", "\n" or not terminated at all
+  // it returns 1 when the previous epoch has been closed by this line, 0 otherwise or -1 when the sink asked to stop
+  int8_t putLine(const char *paLine, size_t paLength);
+  // the sentence sliced already (e.g. decoded from the archive, see GNSSArchive.h) - the same return values as putLine()
+  int8_t putSlices(const struct NMEA_fields *paSlices);
+  // it closes the last epoch (call it at the end of the log) - it returns 1 if the epoch has been closed, 0 otherwise or -1 (stop)
+  int8_t flush(void);
+  // it forgets the current epoch (the collected data is cleared, the counters are kept)
+  void   reset(void);
+
+  inline uint32_t getEpochs(void)   { return this->atEpochs; };
+  inline uint32_t getRejected(void) { return this->atRejected; };
+
+  // it slices the single line the same way as putLine() does it - returns 0 on success (see GNSSCollector::check_and_slice_NMEA_message)
+  static int8_t sliceLine(const char *paLine, size_t paLength, struct NMEA_fields *paSlices);
+};
+
+
+/***************************************************************************************************************************************************
+ ****************************************************** the UTC time index of the log file (the sidecar file) **********************************
+ ***************************************************************************************************************************************************/
+
+// The index file (native byte order - little endian on the supported platforms):
+//   the header             struct GNSS_index_header
+//   the entries            count * struct GNSS_index_entry - the time and the position of every K-th epoch (sorted by the time)
+// The log file has to be chronological (as it is written by the receiver). The date of the epochs is taken from the $xxRMC sentences,
+// the midnight without the $xxRMC sentence is detected by the time of the day going back. The epochs before the first date are not indexed.
+// The index is used only for the log file of the same size and the same hash of its first and last block, and only if its entries
+// are sorted by the time and the position and don't point beyond the log file (the stale or damaged index is rejected).
+#define GNSS_INDEX_VERSION 2
+#define GNSS_INDEX_HASH_BLOCK 4096    // the bytes at both ends of the log file covered by logHash
+
+struct GNSS_index_header {
+  char     magic[7];        // "GNSSIDX"
+  uint8_t  version;         // GNSS_INDEX_VERSION
+  uint32_t every;           // the entry is written for every K-th epoch
+  uint32_t reserved;
+  uint64_t logSize;         // the size of the indexed log file (the index is not used for the different size)
+  uint64_t count;           // the number of the entries
+  uint64_t logHash;         // FNV-1a of the first and the last GNSS_INDEX_HASH_BLOCK bytes of the log file
+};
+
+struct GNSS_index_entry {
+  int64_t  unixMs;          // the UTC time of the epoch [ms since 1970-01-01]
+  uint64_t offset;          // the position of the first line of the epoch in the log file
+};
+
+
+/***************************************************************************************************************************************************
+ ************************************************ the replay of the memory-mapped log file on all the CPU cores ************************************
+ ***************************************************************************************************************************************************/
+
+// The log file is divided into the chunks (see setChunkSize) at the sentences starting the new epoch,
+// so every chunk can be parsed by the separate thread with its own collector. The epochs of the chunks are given to the sink
+// in the order of the log file from the thread calling run(). Only a few chunks wait for the sink at once (two per thread),
+// so the memory usage doesn't depend on the file size.
+class GNSSReplay {
+private:
+  const char *atMap;        // the memory-mapped log file
+  size_t      atSize;
+  uint8_t     atThreads;    // 0 - the number of the online CPUs
+  size_t      atChunkSize;
+  bool        atGSV;
+  uint32_t    atEpochs;
+  uint32_t    atRejected;
+
+  // the state shared by the worker threads during run():
+  struct replay_chunk *atChunks;
+  uint32_t        atChunksCnt;
+  uint32_t        atNextChunk;   // the next chunk to be parsed
+  uint32_t        atSunkChunks;  // the number of the chunks given to the sink already
+  uint32_t        atMaxAhead;    // the maximum number of the chunks parsed before they are given to the sink
+  bool            atStop;
+  pthread_mutex_t atMutex;
+  pthread_cond_t  atWorkCond;    // the chunk can be taken by the worker
+  pthread_cond_t  atDoneCond;    // the chunk has been parsed
+
+  // the UTC time index (NULL if not loaded)
+  struct GNSS_index_entry *atIndex;
+  uint64_t                 atIndexCnt;
+
+  size_t next_epoch_start(size_t paPosition);
+  uint64_t log_hash(void);
+  int8_t run_slice(size_t paBegin, size_t paEnd, GNSS_epoch_sink paSink, void *paUserData);
+  static int8_t range_sink(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paRange);
+  void   worker(void);
+  static void *worker_entry(void *paReplay);
+  static int8_t chunk_sink(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paChunk);
+
+public:
+  GNSSReplay(void);
+  ~GNSSReplay(void);
+
+  // it maps the log file into the memory - returns 0 on success, -1 if the file can not be opened or mapped
+  int8_t open(const char *paPath);
+  void   close(void);
+
+  // the number of the parsing threads (0 - the number of the online CPUs, the default)
+  inline void setThreads(uint8_t paThreads) { this->atThreads = paThreads; };
+  // the size of the single chunk in bytes (1 MiB by default) - it is the unit of the work for the single thread
+  void setChunkSize(size_t paBytes);
+  // the GSV data is not collected by default (it takes ~5 KB for every epoch waiting for the sink)
+  inline void GSVSwitch(bool turnOn) { this->atGSV = turnOn; };
+
+  // it parses the whole file and gives every epoch to the sink
+  // it returns 0 on success, 1 when the sink asked to stop, -1 when the file is not opened or -2 when the resources can not be allocated
+  int8_t run(GNSS_epoch_sink paSink, void *paUserData);
+
+  // It builds the UTC time index of the opened log file (one entry for every paEvery epochs) and writes it to the given file.
+  // The index is kept loaded for runRange(). It returns 0 on success, -1 when the log file is not opened or -2 when the index can not be written.
+  int8_t buildIndex(const char *paIndexPath, uint32_t paEvery = 100);
+  // it loads the index built before - returns 0 on success or -1 when the index is not correct or it belongs to the different log file
+  int8_t loadIndex(const char *paIndexPath);
+
+  // It gives the sink only the epochs from the given UTC time range [ms since 1970-01-01, both ends included].
+  // With the index loaded only the slice of the file around the range is parsed, without the index the whole file is parsed.
+  // It returns the same values as run().
+  int8_t runRange(int64_t paFromMs, int64_t paToMs, GNSS_epoch_sink paSink, void *paUserData);
+
+  inline uint32_t getEpochs(void)   { return this->atEpochs; };   // the epochs parsed by the last run() or runRange()
+  inline uint32_t getRejected(void) { return this->atRejected; }; // the lines rejected by the last run()
+  inline size_t   getSize(void)     { return this->atSize; };
+};
+
+#endif // linux
+
+#endif
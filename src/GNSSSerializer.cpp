@@ -0,0 +1,414 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "GNSSSerializer.h"
+#include <math.h>
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ************************************************************* the number formatting  **************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+static const char serial_digits[201] =
+  "0001020304050607080910111213141516171819202122232425262728293031323334353637383940414243444546474849"
+  "5051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+static const uint64_t serial_pow10[13] = {1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+                                          1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL};
+
+// it writes the unsigned value with at least paWidth digits (leading zeros) - two digits at once from the back
+static uint8_t put_uint(uint64_t paValue, uint8_t paWidth, char *paBuffer) {
+  char loDigits[20];
+  uint8_t loLength = 0;
+  uint8_t k;
+
+  while (100 <= paValue) {
+    k = (uint8_t)(paValue % 100) * 2;
+    paValue /= 100;
+    loDigits[19 - loLength++] = serial_digits[k + 1];
+    loDigits[19 - loLength++] = serial_digits[k];
+  }
+  if (10 <= paValue) {
+    k = (uint8_t)paValue * 2;
+    loDigits[19 - loLength++] = serial_digits[k + 1];
+    loDigits[19 - loLength++] = serial_digits[k];
+  } else {
+    loDigits[19 - loLength++] = (char)('0' + paValue);
+  }
+  while (loLength < paWidth) {
+    loDigits[19 - loLength++] = '0';
+  }
+  memcpy(paBuffer, loDigits + 20 - loLength, loLength);
+  return (loLength);
+}
+
+
+uint8_t GNSSSerializer::formatInt(int64_t paValue, char *paBuffer) {
+  if (0 > paValue) {
+    paBuffer[0] = '-';
+    return (1 + put_uint((uint64_t)0 - (uint64_t)paValue, 1, paBuffer + 1));
+  }
+  return (put_uint((uint64_t)paValue, 1, paBuffer));
+}
+
+
+uint8_t GNSSSerializer::formatFixed(double paValue, uint8_t paDecimals, char *paBuffer) {
+  uint64_t loScaled;
+  uint8_t loLength = 0;
+  double loAbs;
+
+  if ((12 < paDecimals) || isnan(paValue)) {
+    return (0);
+  }
+  loAbs = (0 > paValue) ? -paValue : paValue;
+  if ((loAbs * (double)serial_pow10[paDecimals]) >= 9.2e18) { // the infinity too
+    return (0);
+  }
+  loScaled = (uint64_t)(loAbs * (double)serial_pow10[paDecimals] + 0.5);
+  if ((0 > paValue) && (0 < loScaled)) {
+    paBuffer[loLength++] = '-';
+  }
+  loLength += put_uint(loScaled / serial_pow10[paDecimals], 1, paBuffer + loLength);
+  if (0 < paDecimals) {
+    paBuffer[loLength++] = '.';
+    loLength += put_uint(loScaled % serial_pow10[paDecimals], paDecimals, paBuffer + loLength);
+  }
+  return (loLength);
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ *************************************************************** the record writer  ****************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+// the record being written - the overflow is checked once per field (every field is shorter than GNSS_SERIAL_NUMBER_MAX + the name)
+struct serial_record {
+  char *pos;
+  char *end;    // the last byte of the buffer is kept for the 0 byte
+  bool  full;
+};
+
+static inline bool serial_reserve(struct serial_record *paRecord, size_t paLength) {
+  if (paRecord->full || ((size_t)(paRecord->end - paRecord->pos) < paLength)) {
+    paRecord->full = true;
+    return (false);
+  }
+  return (true);
+}
+
+static inline void put_text(struct serial_record *paRecord, const char *paText, size_t paLength) {
+  if (serial_reserve(paRecord, paLength)) {
+    memcpy(paRecord->pos, paText, paLength);
+    paRecord->pos += paLength;
+  }
+}
+
+#define PUT_LITERAL(record, text) put_text((record), (text), sizeof(text) - 1)
+
+static inline void put_char(struct serial_record *paRecord, char paChar) {
+  if (serial_reserve(paRecord, 1)) {
+    *paRecord->pos++ = paChar;
+  }
+}
+
+// the number or paNull (null of JSON, the empty field of CSV) if the value is not given
+static inline void put_fixed(struct serial_record *paRecord, bool paGiven, double paValue, uint8_t paDecimals, const char *paNull) {
+  uint8_t loLength = 0;
+
+  if (serial_reserve(paRecord, GNSS_SERIAL_NUMBER_MAX)) {
+    if (paGiven) {
+      loLength = GNSSSerializer::formatFixed(paValue, paDecimals, paRecord->pos);
+    }
+    if (0 == loLength) {
+      loLength = (uint8_t)strlen(paNull);
+      memcpy(paRecord->pos, paNull, loLength);
+    }
+    paRecord->pos += loLength;
+  }
+}
+
+static inline void put_int(struct serial_record *paRecord, int64_t paValue) {
+  if (serial_reserve(paRecord, GNSS_SERIAL_NUMBER_MAX)) {
+    paRecord->pos += GNSSSerializer::formatInt(paValue, paRecord->pos);
+  }
+}
+
+// "2024-05-17T23:59:00.000Z" or "23:59:00.000" when the date is not known (with the quotes if paQuoted)
+static void put_time(struct serial_record *paRecord, const struct GNSS_data *paData, bool paQuoted) {
+  char *p;
+
+  if (!serial_reserve(paRecord, 26)) {
+    return;
+  }
+  p = paRecord->pos;
+  if (paQuoted) {
+    *p++ = '"';
+  }
+  if (0 < paData->year) {
+    p += put_uint(paData->year, 4, p);
+    *p++ = '-';
+    p += put_uint(paData->month, 2, p);
+    *p++ = '-';
+    p += put_uint(paData->day, 2, p);
+    *p++ = 'T';
+  }
+  p += put_uint(paData->UTC_H, 2, p);
+  *p++ = ':';
+  p += put_uint(paData->UTC_M, 2, p);
+  *p++ = ':';
+  p += put_uint(paData->UTC_S, 2, p);
+  *p++ = '.';
+  p += put_uint(paData->UTC_fract % 1000, 3, p);
+  if (0 < paData->year) {
+    *p++ = 'Z';
+  }
+  if (paQuoted) {
+    *p++ = '"';
+  }
+  paRecord->pos = p;
+}
+
+static size_t serial_finish(struct serial_record *paRecord, char *paBuffer) {
+  put_char(paRecord, '\n');
+  if (paRecord->full) {
+    if (NULL != paBuffer) {
+      paBuffer[0] = 0;
+    }
+    return (0);
+  }
+  *paRecord->pos = 0;
+  return ((size_t)(paRecord->pos - paBuffer));
+}
+
+static inline void serial_start(struct serial_record *paRecord, char *paBuffer, size_t paSize) {
+  paRecord->pos  = paBuffer;
+  paRecord->end  = paBuffer + ((0 < paSize) ? (paSize - 1) : 0);
+  paRecord->full = (NULL == paBuffer) || (0 == paSize);
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ************************************************************ the values of the epoch  *************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+// the epoch values shared by all the formats
+struct serial_values {
+  bool   position;
+  double lat;
+  double lon;
+  bool   GGA;
+  bool   hdop;
+  bool   speed;
+  double speedKmh;
+  bool   track;
+  bool   GST;
+};
+
+static void get_values(const struct GNSS_data *paData, struct serial_values *paValues) {
+  paValues->position = (0 != paData->lat_dir) && (0 != paData->lon_dir);
+  paValues->lat      = GNSSCollector::getLatitude(paData);
+  paValues->lon      = GNSSCollector::getLongitude(paData);
+  paValues->GGA      = (0 < paData->msgs_rcvd[MSG_GGA]);
+  paValues->hdop     = paValues->GGA || (0 < paData->msgs_rcvd[MSG_GSA]);
+  paValues->speed    = true;
+  if (0 < paData->msgs_rcvd[MSG_VTG]) {
+    paValues->speedKmh = paData->speed;
+  } else if (0 < paData->msgs_rcvd[MSG_RMC]) {
+    paValues->speedKmh = paData->nautical_speed * 1.852;
+  } else {
+    paValues->speed = false;
+  }
+  paValues->track    = (0 < paData->msgs_rcvd[MSG_RMC]) || (0 < paData->msgs_rcvd[MSG_VTG]);
+  paValues->GST      = (0 < paData->msgs_rcvd[MSG_GST]);
+}
+
+// the members of the JSON object after the position (JSON and GeoJSON properties)
+static void put_json_members(struct serial_record *paRecord, const struct GNSS_data *paData, const struct serial_values *paValues) {
+  PUT_LITERAL(paRecord, ",\"quality\":");
+  if (paValues->GGA && ('0' <= paData->quality) && ('9' >= paData->quality)) {
+    put_char(paRecord, paData->quality);
+  } else {
+    PUT_LITERAL(paRecord, "null");
+  }
+  PUT_LITERAL(paRecord, ",\"sats\":");
+  if (paValues->GGA) {
+    put_int(paRecord, paData->sats);
+  } else {
+    PUT_LITERAL(paRecord, "null");
+  }
+  PUT_LITERAL(paRecord, ",\"hdop\":");
+  put_fixed(paRecord, paValues->hdop, paData->hdop, 2, "null");
+  PUT_LITERAL(paRecord, ",\"speed\":");
+  put_fixed(paRecord, paValues->speed, paValues->speedKmh, 2, "null");
+  PUT_LITERAL(paRecord, ",\"track\":");
+  put_fixed(paRecord, paValues->track, paData->true_track, 2, "null");
+  if (paValues->GST) {
+    PUT_LITERAL(paRecord, ",\"std\":[");
+    put_fixed(paRecord, true, paData->lat_std_dev, 3, "null");
+    put_char(paRecord, ',');
+    put_fixed(paRecord, true, paData->lon_std_dev, 3, "null");
+    put_char(paRecord, ',');
+    put_fixed(paRecord, true, paData->alt_std_dev, 3, "null");
+    put_char(paRecord, ']');
+  }
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ **************************************************************** the serializers  *****************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+size_t GNSSSerializer::toJSON(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, char *paBuffer, size_t paSize) {
+  struct serial_record loRecord;
+  struct serial_values loValues;
+  const struct GSV_data_by_systemID *loSystem;
+  const struct GSV_message *loMessage;
+  bool loFirst = true;
+  int16_t loSats;
+  uint8_t i, k, s;
+
+  serial_start(&loRecord, paBuffer, paSize);
+  get_values(paData, &loValues);
+  PUT_LITERAL(&loRecord, "{\"time\":");
+  put_time(&loRecord, paData, true);
+  PUT_LITERAL(&loRecord, ",\"lat\":");
+  put_fixed(&loRecord, loValues.position, loValues.lat, 9, "null");
+  PUT_LITERAL(&loRecord, ",\"lon\":");
+  put_fixed(&loRecord, loValues.position, loValues.lon, 9, "null");
+  PUT_LITERAL(&loRecord, ",\"alt\":");
+  put_fixed(&loRecord, loValues.GGA, paData->alt, 3, "null");
+  put_json_members(&loRecord, paData, &loValues);
+
+  if (NULL != paGSVData) {
+    PUT_LITERAL(&loRecord, ",\"sv\":[");
+    for (i = 0; (i < paGSVData->recSystems) && (i < MAXGSVSYSTEMSTORAGE); i++) {
+      loSystem = &paGSVData->system[i];
+      for (k = 0; (k < loSystem->msgs) && (k < MAXGSVMESSAGES); k++) {
+        loMessage = &loSystem->GSV[k];
+        loSats = (int16_t)loMessage->sats - 4 * ((int16_t)loMessage->msgNo - 1); // the satellites in this message
+        for (s = 0; (s < 4) && (s < loSats); s++) {
+          if (!loFirst) {
+            put_char(&loRecord, ',');
+          }
+          loFirst = false;
+          PUT_LITERAL(&loRecord, "{\"talker\":\"");
+          put_text(&loRecord, loSystem->talker, 2);
+          PUT_LITERAL(&loRecord, "\",\"prn\":");
+          put_int(&loRecord, loMessage->sat[s].prn);
+          PUT_LITERAL(&loRecord, ",\"elev\":");
+          put_int(&loRecord, loMessage->sat[s].elev);
+          PUT_LITERAL(&loRecord, ",\"azimuth\":");
+          put_int(&loRecord, loMessage->sat[s].azimuth);
+          PUT_LITERAL(&loRecord, ",\"snr\":");
+          put_int(&loRecord, loMessage->sat[s].SNR);
+          put_char(&loRecord, '}');
+        }
+      }
+    }
+    put_char(&loRecord, ']');
+  }
+  put_char(&loRecord, '}');
+  return (serial_finish(&loRecord, paBuffer));
+}
+
+
+size_t GNSSSerializer::toGeoJSON(const struct GNSS_data *paData, char *paBuffer, size_t paSize) {
+  struct serial_record loRecord;
+  struct serial_values loValues;
+
+  serial_start(&loRecord, paBuffer, paSize);
+  get_values(paData, &loValues);
+  PUT_LITERAL(&loRecord, "{\"type\":\"Feature\",\"geometry\":");
+  if (loValues.position) {
+    PUT_LITERAL(&loRecord, "{\"type\":\"Point\",\"coordinates\":[");
+    put_fixed(&loRecord, true, loValues.lon, 9, "null");
+    put_char(&loRecord, ',');
+    put_fixed(&loRecord, true, loValues.lat, 9, "null");
+    if (loValues.GGA) {
+      put_char(&loRecord, ',');
+      put_fixed(&loRecord, true, paData->alt, 3, "null");
+    }
+    PUT_LITERAL(&loRecord, "]}");
+  } else {
+    PUT_LITERAL(&loRecord, "null");
+  }
+  PUT_LITERAL(&loRecord, ",\"properties\":{\"time\":");
+  put_time(&loRecord, paData, true);
+  put_json_members(&loRecord, paData, &loValues);
+  PUT_LITERAL(&loRecord, "}}");
+  return (serial_finish(&loRecord, paBuffer));
+}
+
+
+size_t GNSSSerializer::toCSV(const struct GNSS_data *paData, char *paBuffer, size_t paSize) {
+  struct serial_record loRecord;
+  struct serial_values loValues;
+
+  serial_start(&loRecord, paBuffer, paSize);
+  get_values(paData, &loValues);
+  put_time(&loRecord, paData, false);
+  put_char(&loRecord, ',');
+  put_fixed(&loRecord, loValues.position, loValues.lat, 9, "");
+  put_char(&loRecord, ',');
+  put_fixed(&loRecord, loValues.position, loValues.lon, 9, "");
+  put_char(&loRecord, ',');
+  put_fixed(&loRecord, loValues.GGA, paData->alt, 3, "");
+  put_char(&loRecord, ',');
+  if (loValues.GGA && ('0' <= paData->quality) && ('9' >= paData->quality)) {
+    put_char(&loRecord, paData->quality);
+  }
+  put_char(&loRecord, ',');
+  if (loValues.GGA) {
+    put_int(&loRecord, paData->sats);
+  }
+  put_char(&loRecord, ',');
+  put_fixed(&loRecord, loValues.hdop, paData->hdop, 2, "");
+  put_char(&loRecord, ',');
+  put_fixed(&loRecord, loValues.speed, loValues.speedKmh, 2, "");
+  put_char(&loRecord, ',');
+  put_fixed(&loRecord, loValues.track, paData->true_track, 2, "");
+  put_char(&loRecord, ',');
+  put_fixed(&loRecord, loValues.GST, paData->lat_std_dev, 3, "");
+  put_char(&loRecord, ',');
+  put_fixed(&loRecord, loValues.GST, paData->lon_std_dev, 3, "");
+  put_char(&loRecord, ',');
+  put_fixed(&loRecord, loValues.GST, paData->alt_std_dev, 3, "");
+  return (serial_finish(&loRecord, paBuffer));
+}
+
+
+size_t GNSSSerializer::CSVHeader(char *paBuffer, size_t paSize) {
+  struct serial_record loRecord;
+
+  serial_start(&loRecord, paBuffer, paSize);
+  PUT_LITERAL(&loRecord, "time,lat,lon,alt,quality,sats,hdop,speed,track,lat_std_dev,lon_std_dev,alt_std_dev");
+  return (serial_finish(&loRecord, paBuffer));
+}
@@ -0,0 +1,59 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef GNSS_SERIALIZER_H
+#define GNSS_SERIALIZER_H
+
+#include "ultimateGNSSParser.h"
+#include <stddef.h>
+
+// the buffer big enough for the single epoch without the satellites (JSON, GeoJSON or CSV)
+#define GNSS_SERIAL_EPOCH_MAX   384
+// the maximum length of the number given by formatFixed() and formatInt()
+#define GNSS_SERIAL_NUMBER_MAX  24
+
+/***************************************************************************************************************************************************
+ ************************************************************** the epoch serializers **************************************************************
+ ***************************************************************************************************************************************************/
+
+// The serializers write the single epoch as one record (terminated with '\n' and the 0 byte) into the buffer of the caller,
+// so the record can be given to write()/send() at once. The numbers are formatted with the integer arithmetic (the fixed number
+// of decimals, no stdio, no locale), nothing is allocated. The values which have not been received in the epoch are null
+// (the empty fields of CSV): the position without the direction, the altitude without $xxGGA, the speed without $xxVTG/$xxRMC, ...
+//   JSON:    {"time":"2024-05-17T23:59:00.000Z","lat":50.000000000,"lon":19.000000000,"alt":100.000,"quality":1,"sats":12,"hdop":0.90,
+//             "speed":1.20,"track":45.00,"std":[0.012,0.011,0.020],"sv":[{"talker":"GP","prn":5,"elev":40,"azimuth":120,"snr":43},...]}
+//            ("sv" only when the GSV data is given, the time without the date is "23:59:00.000")
+//   GeoJSON: {"type":"Feature","geometry":{"type":"Point","coordinates":[19.000000000,50.000000000,100.000]},"properties":{"time":...}}
+//   CSV:     time,lat,lon,alt,quality,sats,hdop,speed,track,lat_std_dev,lon_std_dev,alt_std_dev (see CSVHeader())
+// The latitude and the longitude are signed [deg] with 9 decimals, the altitude [m], the speed [km/h], the standard deviations [m] ($xxGST).
+// They return the length of the record (without the 0 byte) or 0 if the buffer is too small.
+class GNSSSerializer {
+public:
+  static size_t toJSON(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, char *paBuffer, size_t paSize);
+  static size_t toGeoJSON(const struct GNSS_data *paData, char *paBuffer, size_t paSize);
+  static size_t toCSV(const struct GNSS_data *paData, char *paBuffer, size_t paSize);
+  static size_t CSVHeader(char *paBuffer, size_t paSize);
+
+  // They write the number (not terminated) and return its length. formatFixed() returns 0 for NaN, infinity
+  // and the values which do not fit 64 bits with the given number of decimals (up to 12).
+  static uint8_t formatFixed(double paValue, uint8_t paDecimals, char *paBuffer);
+  static uint8_t formatInt(int64_t paValue, char *paBuffer);
+};
+
+#endif
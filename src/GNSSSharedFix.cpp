@@ -0,0 +1,254 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "GNSSSharedFix.h"
+
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <sched.h>
+
+static_assert(64  == offsetof(struct GNSS_shared_segment, sequence), "the layout of the shared segment is not correct");
+static_assert(128 == offsetof(struct GNSS_shared_segment, record), "the layout of the shared segment is not correct");
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ********************************************************** the shared memory publisher  ***********************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+GNSSSharedPublisher::GNSSSharedPublisher(void) {
+  atSegment   = NULL;
+  atName      = NULL;
+  atPublished = 0;
+}
+
+
+GNSSSharedPublisher::~GNSSSharedPublisher(void) {
+  this->close();
+}
+
+
+int8_t GNSSSharedPublisher::open(const char *paName, mode_t paMode) {
+  void *loMap;
+  int loFd;
+
+  this->close();
+  loFd = shm_open(paName, O_RDWR | O_CREAT, paMode);
+  if (0 > loFd) {
+    SETCOLORRED DBG("The shared memory segment can not be created\r\n"); NOCOLOR
+    return (-1);
+  }
+  if (ftruncate(loFd, sizeof(struct GNSS_shared_segment))) {
+    SETCOLORRED DBG("The size of the shared memory segment can not be set\r\n"); NOCOLOR
+    ::close(loFd);
+    return (-1);
+  }
+  loMap = mmap(NULL, sizeof(struct GNSS_shared_segment), PROT_READ | PROT_WRITE, MAP_SHARED, loFd, 0);
+  ::close(loFd);
+  if (MAP_FAILED == loMap) {
+    SETCOLORRED DBG("The shared memory segment can not be mapped\r\n"); NOCOLOR
+    return (-1);
+  }
+  this->atSegment = (struct GNSS_shared_segment *)loMap;
+  this->atName    = strdup(paName);
+
+  // the readers check the magic, so the rest is set up first (the record of the previous publisher is not valid any more)
+  __atomic_store_n(&this->atSegment->magic[0], 0, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  this->atSegment->version   = GNSS_SHARED_VERSION;
+  this->atSegment->slotSize  = GNSS_RECORD_MAX_SIZE;
+  this->atSegment->publisher = (int32_t)getpid();
+  __atomic_store_n(&this->atSegment->length, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&this->atSegment->sequence, 0, __ATOMIC_RELAXED);
+  memcpy(this->atSegment->magic + 1, "NSSSHM", 6);
+  __atomic_store_n(&this->atSegment->magic[0], 'G', __ATOMIC_RELEASE);
+  this->atPublished = 0;
+  return (0);
+}
+
+
+void GNSSSharedPublisher::close(bool paUnlink) {
+  if (NULL != this->atSegment) {
+    munmap(this->atSegment, sizeof(struct GNSS_shared_segment));
+    this->atSegment = NULL;
+  }
+  if (NULL != this->atName) {
+    if (paUnlink) {
+      shm_unlink(this->atName);
+    }
+    free(this->atName);
+    this->atName = NULL;
+  }
+}
+
+
+int8_t GNSSSharedPublisher::publish(const struct GNSS_data *paData, const struct GSV_manager *paGSVData) {
+  struct GNSS_shared_segment *loSegment = this->atSegment;
+  uint64_t loSequence;
+  uint16_t loLength;
+  uint16_t i;
+
+  if (NULL == loSegment) {
+    return (-1);
+  }
+  loLength = GNSSEpochRecord::build(paData, paGSVData, this->atPublished, this->atRecord, sizeof(this->atRecord));
+
+  // the seqlock: the odd counter is visible before the record is touched, the even one after the whole record has been written
+  loSequence = __atomic_load_n(&loSegment->sequence, __ATOMIC_RELAXED);
+  __atomic_store_n(&loSegment->sequence, loSequence + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  __atomic_store_n(&loSegment->length, loLength, __ATOMIC_RELAXED);
+  for (i = 0; i < (loLength / 8); i++) {
+    __atomic_store_n(&loSegment->record[i], this->atRecord[i], __ATOMIC_RELAXED);
+  }
+  __atomic_store_n(&loSegment->sequence, loSequence + 2, __ATOMIC_RELEASE);
+  this->atPublished++;
+  return (0);
+}
+
+
+void GNSSSharedPublisher::epochCallback(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paPublisher) {
+  if (NULL != paPublisher) {
+    ((GNSSSharedPublisher *)paPublisher)->publish(paData, paGSVData);
+  }
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ************************************************************ the shared memory reader  ************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+GNSSSharedReader::GNSSSharedReader(void) {
+  atSegment = NULL;
+}
+
+
+GNSSSharedReader::~GNSSSharedReader(void) {
+  this->close();
+}
+
+
+int8_t GNSSSharedReader::open(const char *paName) {
+  void *loMap;
+  struct stat loStat;
+  int loFd;
+
+  this->close();
+  loFd = shm_open(paName, O_RDONLY, 0);
+  if (0 > loFd) {
+    return (-1);
+  }
+  if (fstat(loFd, &loStat) || ((size_t)loStat.st_size < sizeof(struct GNSS_shared_segment))) {
+    ::close(loFd);
+    return (-1);
+  }
+  loMap = mmap(NULL, sizeof(struct GNSS_shared_segment), PROT_READ, MAP_SHARED, loFd, 0);
+  ::close(loFd);
+  if (MAP_FAILED == loMap) {
+    return (-1);
+  }
+  this->atSegment = (const struct GNSS_shared_segment *)loMap;
+  if (('G' != __atomic_load_n(&this->atSegment->magic[0], __ATOMIC_ACQUIRE)) || memcmp(this->atSegment->magic, "GNSSSHM", 7) ||
+      (GNSS_SHARED_VERSION != this->atSegment->version) || (GNSS_RECORD_MAX_SIZE != this->atSegment->slotSize)) {
+    this->close();
+    return (-1);
+  }
+  return (0);
+}
+
+
+void GNSSSharedReader::close(void) {
+  if (NULL != this->atSegment) {
+    munmap((void *)this->atSegment, sizeof(struct GNSS_shared_segment));
+    this->atSegment = NULL;
+  }
+}
+
+
+int32_t GNSSSharedReader::read(void *paBuffer, size_t paSize, uint64_t *paSequence, uint16_t paRetries) {
+  const struct GNSS_shared_segment *loSegment = this->atSegment;
+  uint64_t *loBuffer = (uint64_t *)paBuffer;
+  uint64_t loBefore, loAfter, loLength;
+  uint16_t loTry;
+  uint16_t i;
+
+  if (NULL == loSegment) {
+    return (-1);
+  }
+  for (loTry = 0; loTry < paRetries; loTry++) {
+    loBefore = __atomic_load_n(&loSegment->sequence, __ATOMIC_ACQUIRE);
+    if (0 == loBefore) {
+      return (0);
+    }
+    if (loBefore & 1) { // the publisher is writing just now
+      if (63 == (loTry & 63)) {
+        sched_yield(); // the publisher may have been preempted on this CPU
+      }
+      continue;
+    }
+    loLength = __atomic_load_n(&loSegment->length, __ATOMIC_RELAXED);
+    if ((GNSS_RECORD_MAX_SIZE < loLength) || (paSize < loLength)) {
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (loBefore != __atomic_load_n(&loSegment->sequence, __ATOMIC_RELAXED)) {
+        continue; // the length has been read in the middle of the update
+      }
+      return (-1);
+    }
+    for (i = 0; i < (loLength / 8); i++) {
+      loBuffer[i] = __atomic_load_n(&loSegment->record[i], __ATOMIC_RELAXED);
+    }
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    loAfter = __atomic_load_n(&loSegment->sequence, __ATOMIC_RELAXED);
+    if (loBefore == loAfter) {
+      if (NULL != paSequence) {
+        *paSequence = loBefore / 2;
+      }
+      return ((int32_t)loLength);
+    }
+  }
+  return (-1);
+}
+
+
+uint64_t GNSSSharedReader::getSequence(void) {
+  if (NULL == this->atSegment) {
+    return (0);
+  }
+  return (__atomic_load_n(&this->atSegment->sequence, __ATOMIC_ACQUIRE) / 2);
+}
+
+
+bool GNSSSharedReader::isPublisherAlive(void) {
+  if (NULL == this->atSegment) {
+    return (false);
+  }
+  return ((0 == kill(this->atSegment->publisher, 0)) || (EPERM == errno));
+}
+
+#endif // linux
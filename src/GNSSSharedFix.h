@@ -0,0 +1,115 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef GNSS_SHARED_FIX_H
+#define GNSS_SHARED_FIX_H
+
+#include "ultimateGNSSParser.h"
+
+// The shared memory publisher is available on linux only (POSIX shared memory), the file is compiled to nothing on the other platforms.
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include <stddef.h>
+#include <sys/types.h>
+#include "GNSSEpochRecord.h"
+
+/***************************************************************************************************************************************************
+ ************************************************************ the shared memory segment ************************************************************
+ ***************************************************************************************************************************************************/
+
+// The segment (shm_open(name), mapped by the publisher for writing and by the readers for reading only):
+//   the header            64 bytes - the magic, the version, the size of the record slot and the process ID of the publisher
+//   the sequence          64 bytes - the seqlock counter (odd while the record is being written, the number of the epochs published * 2)
+//                                    and the size of the record
+//   the record            the binary epoch record (see GNSSEpochRecord.h) of the last epoch published
+// The publisher never waits for the readers. The reader copies the record and checks that the counter has not changed in the meantime,
+// so it takes the copy again only if the publisher has been writing just then (the record is written in ~100 ns once per epoch).
+#define GNSS_SHARED_VERSION  1
+
+struct GNSS_shared_segment {
+  char     magic[7];      // "GNSSSHM"
+  uint8_t  version;       // GNSS_SHARED_VERSION
+  uint32_t slotSize;      // GNSS_RECORD_MAX_SIZE
+  int32_t  publisher;     // the process ID of the publisher
+  uint8_t  reserved[48];
+  uint64_t sequence;      // 64: the seqlock counter
+  uint64_t length;        // 72: the size of the record (written under the seqlock)
+  uint8_t  reserved2[48];
+  uint64_t record[GNSS_RECORD_MAX_SIZE / 8]; // 128: struct GNSS_epoch_record + the satellites
+};
+
+
+/***************************************************************************************************************************************************
+ ************************************************************* the shared memory publisher **********************************************************
+ ***************************************************************************************************************************************************/
+
+class GNSSSharedPublisher {
+private:
+  struct GNSS_shared_segment *atSegment;
+  char                       *atName;
+  uint64_t                    atRecord[GNSS_RECORD_MAX_SIZE / 8];   // the record is built here and copied under the seqlock
+  uint32_t                    atPublished;
+
+public:
+  GNSSSharedPublisher(void);
+  ~GNSSSharedPublisher(void);
+
+  // It creates the segment (e.g. "/gnss0") or takes the existing one over. It returns 0 on success or -1 if the segment can not be created.
+  int8_t open(const char *paName, mode_t paMode = 0644);
+  // it unmaps the segment, the segment is removed if paUnlink is true (the readers mapped already keep the last record)
+  void   close(bool paUnlink = true);
+
+  // it publishes the epoch (with the satellites when paGSVData is given) - returns 0 on success, -1 if the segment is not opened
+  int8_t publish(const struct GNSS_data *paData, const struct GSV_manager *paGSVData = NULL);
+  inline uint32_t getPublished(void) { return this->atPublished; };
+
+  // the epoch callback (GNSSCollector::setEpochCallback) with the publisher as the user data
+  static void epochCallback(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paPublisher);
+};
+
+
+/***************************************************************************************************************************************************
+ ************************************************************** the shared memory reader ***********************************************************
+ ***************************************************************************************************************************************************/
+
+class GNSSSharedReader {
+private:
+  const struct GNSS_shared_segment *atSegment;
+
+public:
+  GNSSSharedReader(void);
+  ~GNSSSharedReader(void);
+
+  // it maps the segment for reading - returns 0 on success or -1 if the segment doesn't exist or it is not the fix segment
+  int8_t open(const char *paName);
+  void   close(void);
+
+  // It copies the last record to the buffer (GNSS_RECORD_MAX_SIZE bytes aligned to 8 bytes is always enough) and gives its sequence number
+  // (the number of the epochs published). It returns the size of the record, 0 if nothing has been published yet or -1 if the buffer
+  // is too small or the publisher has been writing during all the paRetries tries.
+  int32_t read(void *paBuffer, size_t paSize, uint64_t *paSequence = NULL, uint16_t paRetries = 1000);
+  // the number of the epochs published - it is cheap, so it can be polled to find out that the new epoch is there
+  uint64_t getSequence(void);
+  // it returns true if the publisher process is running
+  bool    isPublisherAlive(void);
+};
+
+#endif // linux
+
+#endif
@@ -0,0 +1,327 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "GNSSTrackCodec.h"
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ *********************************************************** the varint and crc8 coding  ***********************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+static inline uint8_t track_put_varint(uint8_t *paBuffer, uint64_t paValue) {
+  uint8_t i = 0;
+
+  while (0x80 <= paValue) {
+    paBuffer[i++] = (uint8_t)(paValue | 0x80);
+    paValue >>= 7;
+  }
+  paBuffer[i++] = (uint8_t)paValue;
+  return (i);
+}
+
+// it returns the number of the bytes read, 0 if the varint is cut by the end of the data or -1 if it is longer than 10 bytes
+static inline int8_t track_get_varint(const uint8_t *paBuffer, size_t paSize, uint64_t *paValue) {
+  uint64_t loValue = 0;
+  uint8_t i;
+
+  for (i = 0; i < 10; i++) {
+    if (i >= paSize) {
+      return (0);
+    }
+    loValue |= ((uint64_t)(paBuffer[i] & 0x7F)) << (7 * i);
+    if (0 == (paBuffer[i] & 0x80)) {
+      *paValue = loValue;
+      return (i + 1);
+    }
+  }
+  return (-1);
+}
+
+static inline uint64_t track_zigzag(int64_t paValue) {
+  return ((((uint64_t)paValue) << 1) ^ (uint64_t)(paValue >> 63));
+}
+
+static inline int64_t track_unzigzag(uint64_t paValue) {
+  return ((int64_t)(paValue >> 1) ^ -(int64_t)(paValue & 1));
+}
+
+// CRC-8 (polynomial 0x07, initial value 0xFF) - the frames are short, so the table is not needed
+static uint8_t track_crc8(const uint8_t *paData, uint8_t paLength) {
+  uint8_t loCrc = 0xFF;
+  uint8_t i, k;
+
+  for (i = 0; i < paLength; i++) {
+    loCrc ^= paData[i];
+    for (k = 0; k < 8; k++) {
+      loCrc = (loCrc & 0x80) ? (uint8_t)((loCrc << 1) ^ 0x07) : (uint8_t)(loCrc << 1);
+    }
+  }
+  return (loCrc);
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ *************************************************************** the track encoder  ****************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+GNSSTrackEncoder::GNSSTrackEncoder(uint16_t paKeyframeInterval) {
+  memset(&atLast, 0, sizeof(atLast));
+  memset(&atChange, 0, sizeof(atChange));
+  atInterval   = (0 == paKeyframeInterval) ? 1 : paKeyframeInterval;
+  atSinceKey   = 0;
+  atKeyPending = true;
+}
+
+
+void GNSSTrackEncoder::quantize(const struct GNSS_data *paData, struct GNSS_track_fix *paFix) {
+  double loValue;
+
+  memset(paFix, 0, sizeof(*paFix));
+  paFix->timeMs = GNSSCollector::getUnixTimeMs(paData);
+  if (0 > paFix->timeMs) { // the date is not known
+    paFix->timeMs = ((int64_t)paData->UTC_H * 3600 + (int64_t)paData->UTC_M * 60 + paData->UTC_S) * 1000 + paData->UTC_fract;
+  }
+  loValue      = GNSSCollector::getLatitude(paData) * 1e9;
+  paFix->lat   = (int64_t)((0 <= loValue) ? (loValue + 0.5) : (loValue - 0.5));
+  loValue      = GNSSCollector::getLongitude(paData) * 1e9;
+  paFix->lon   = (int64_t)((0 <= loValue) ? (loValue + 0.5) : (loValue - 0.5));
+  loValue      = paData->alt * 1000;
+  paFix->altMm = (int64_t)((0 <= loValue) ? (loValue + 0.5) : (loValue - 0.5));
+  if (0 < paData->msgs_rcvd[MSG_VTG]) {
+    loValue = paData->speed;
+  } else {
+    loValue = paData->nautical_speed * 1.852;
+  }
+  paFix->speed   = (0 < loValue) ? (uint32_t)(loValue * 100 + 0.5) : 0;
+  paFix->quality = (('0' <= paData->quality) && ('9' >= paData->quality)) ? (paData->quality - '0') : 0;
+}
+
+
+uint8_t GNSSTrackEncoder::encode(const struct GNSS_data *paData, uint8_t *paBuffer) {
+  struct GNSS_track_fix loFix;
+
+  GNSSTrackEncoder::quantize(paData, &loFix);
+  return (this->encode(&loFix, paBuffer));
+}
+
+
+uint8_t GNSSTrackEncoder::encode(const struct GNSS_track_fix *paFix, uint8_t *paBuffer) {
+  struct GNSS_track_fix loChange;
+  int64_t loResidual;
+  uint8_t loLength;
+
+  if (this->atKeyPending || (this->atSinceKey >= (this->atInterval - 1))) {
+    paBuffer[0] = 'G';
+    paBuffer[1] = 'T';
+    paBuffer[2] = GNSS_TRACK_VERSION;
+    loLength = 3;
+    loLength += track_put_varint(paBuffer + loLength, track_zigzag(paFix->timeMs));
+    loLength += track_put_varint(paBuffer + loLength, track_zigzag(paFix->lat));
+    loLength += track_put_varint(paBuffer + loLength, track_zigzag(paFix->lon));
+    loLength += track_put_varint(paBuffer + loLength, track_zigzag(paFix->altMm));
+    loLength += track_put_varint(paBuffer + loLength, paFix->speed);
+    paBuffer[loLength++] = paFix->quality;
+    memset(&this->atChange, 0, sizeof(this->atChange)); // the decoder starts here without the previous change
+    this->atSinceKey   = 0;
+    this->atKeyPending = false;
+  } else {
+    paBuffer[0] = 0;
+    loLength = 1;
+    loChange.timeMs = paFix->timeMs - this->atLast.timeMs;
+    loChange.lat    = paFix->lat    - this->atLast.lat;
+    loChange.lon    = paFix->lon    - this->atLast.lon;
+    loChange.altMm  = paFix->altMm  - this->atLast.altMm;
+
+// the difference from the prediction (it is not written when the prediction is exact)
+#define TRACK_RESIDUAL(residual, bit) { loResidual = (residual); if (0 != loResidual) { paBuffer[0] |= (bit); loLength += track_put_varint(paBuffer + loLength, track_zigzag(loResidual)); } }
+    TRACK_RESIDUAL(loChange.timeMs - this->atChange.timeMs, GNSS_TRACK_TIME);
+    TRACK_RESIDUAL(loChange.lat    - this->atChange.lat,    GNSS_TRACK_LAT);
+    TRACK_RESIDUAL(loChange.lon    - this->atChange.lon,    GNSS_TRACK_LON);
+    TRACK_RESIDUAL(loChange.altMm  - this->atChange.altMm,  GNSS_TRACK_ALT);
+    TRACK_RESIDUAL((int64_t)paFix->speed - (int64_t)this->atLast.speed, GNSS_TRACK_SPEED);
+#undef TRACK_RESIDUAL
+    if (paFix->quality != this->atLast.quality) {
+      paBuffer[0] |= GNSS_TRACK_QUALITY;
+      paBuffer[loLength++] = paFix->quality;
+    }
+    this->atChange.timeMs = loChange.timeMs;
+    this->atChange.lat    = loChange.lat;
+    this->atChange.lon    = loChange.lon;
+    this->atChange.altMm  = loChange.altMm;
+    this->atSinceKey++;
+  }
+  paBuffer[loLength] = track_crc8(paBuffer, loLength);
+  loLength++;
+  memcpy(&this->atLast, paFix, sizeof(this->atLast));
+  return (loLength);
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ *************************************************************** the track decoder  ****************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+GNSSTrackDecoder::GNSSTrackDecoder(void) {
+  memset(&atLast, 0, sizeof(atLast));
+  memset(&atChange, 0, sizeof(atChange));
+  atSynced  = false;
+  atDamaged = 0;
+}
+
+
+// it parses the frame at the beginning of the data: returns its size, 0 if more bytes are needed or -1 if the frame is damaged
+static int8_t parse_frame(const uint8_t *paData, size_t paLength, uint64_t *paValues, uint8_t *paMask) {
+  uint8_t loLength;
+  int8_t n;
+  uint8_t i;
+
+  if (0 == paLength) {
+    return (0);
+  }
+  if ('G' == paData[0]) { // the keyframe
+    if (3 > paLength) {
+      return (0);
+    }
+    if (('T' != paData[1]) || (GNSS_TRACK_VERSION != paData[2])) {
+      return (-1);
+    }
+    *paMask  = 0xFF;
+    loLength = 3;
+    for (i = 0; i < 5; i++) {
+      n = track_get_varint(paData + loLength, paLength - loLength, &paValues[i]);
+      if (0 >= n) {
+        return (n);
+      }
+      loLength += n;
+    }
+    if (loLength >= paLength) {
+      return (0);
+    }
+    paValues[5] = paData[loLength++];
+  } else if (0x40 > paData[0]) { // the delta frame
+    *paMask  = paData[0];
+    loLength = 1;
+    for (i = 0; i < 5; i++) {
+      paValues[i] = 0;
+      if (*paMask & (1 << i)) {
+        n = track_get_varint(paData + loLength, paLength - loLength, &paValues[i]);
+        if (0 >= n) {
+          return (n);
+        }
+        loLength += n;
+      }
+    }
+    if (*paMask & GNSS_TRACK_QUALITY) {
+      if (loLength >= paLength) {
+        return (0);
+      }
+      paValues[5] = paData[loLength++];
+    }
+  } else {
+    return (-1);
+  }
+  if (loLength >= paLength) {
+    return (0);
+  }
+  if (track_crc8(paData, loLength) != paData[loLength]) {
+    return (-1);
+  }
+  return ((int8_t)(loLength + 1));
+}
+
+
+int8_t GNSSTrackDecoder::decode(const uint8_t *paData, size_t paLength, size_t *paUsed, struct GNSS_track_fix *paFix) {
+  uint64_t loValues[6];
+  uint8_t loMask = 0;
+  size_t loSkipped = 0;
+  int8_t loSize;
+
+  *paUsed = 0;
+  if (NULL == paData) {
+    return (-1);
+  }
+
+  if (!this->atSynced) {
+    // the bytes up to the first correct keyframe are skipped
+    while (loSkipped < paLength) {
+      if ('G' == paData[loSkipped]) {
+        loSize = parse_frame(paData + loSkipped, paLength - loSkipped, loValues, &loMask);
+        if (0 == loSize) {
+          *paUsed = loSkipped; // the keyframe is not complete yet
+          return (0);
+        }
+        if (0 < loSize) {
+          break;
+        }
+      }
+      loSkipped++;
+    }
+    if (loSkipped >= paLength) {
+      *paUsed = loSkipped;
+      return (0);
+    }
+  } else {
+    loSize = parse_frame(paData, paLength, loValues, &loMask);
+    if (0 == loSize) {
+      return (0);
+    }
+    if (0 > loSize) {
+      this->atDamaged++;
+      this->atSynced = false;
+      *paUsed = 1;
+      return (-1);
+    }
+  }
+
+  if (0xFF == loMask) { // the keyframe
+    this->atLast.timeMs  = track_unzigzag(loValues[0]);
+    this->atLast.lat     = track_unzigzag(loValues[1]);
+    this->atLast.lon     = track_unzigzag(loValues[2]);
+    this->atLast.altMm   = track_unzigzag(loValues[3]);
+    this->atLast.speed   = (uint32_t)loValues[4];
+    this->atLast.quality = (uint8_t)loValues[5];
+    memset(&this->atChange, 0, sizeof(this->atChange));
+    this->atSynced = true;
+  } else {
+    this->atChange.timeMs += track_unzigzag(loValues[0]);
+    this->atChange.lat    += track_unzigzag(loValues[1]);
+    this->atChange.lon    += track_unzigzag(loValues[2]);
+    this->atChange.altMm  += track_unzigzag(loValues[3]);
+    this->atLast.timeMs   += this->atChange.timeMs;
+    this->atLast.lat      += this->atChange.lat;
+    this->atLast.lon      += this->atChange.lon;
+    this->atLast.altMm    += this->atChange.altMm;
+    this->atLast.speed     = (uint32_t)((int64_t)this->atLast.speed + track_unzigzag(loValues[4]));
+    if (loMask & GNSS_TRACK_QUALITY) {
+      this->atLast.quality = (uint8_t)loValues[5];
+    }
+  }
+  memcpy(paFix, &this->atLast, sizeof(this->atLast));
+  *paUsed = loSkipped + (size_t)loSize;
+  return (1);
+}
@@ -0,0 +1,114 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef GNSS_TRACK_CODEC_H
+#define GNSS_TRACK_CODEC_H
+
+#include "ultimateGNSSParser.h"
+
+/***************************************************************************************************************************************************
+ ************************************************************** the track stream format ************************************************************
+ ***************************************************************************************************************************************************/
+
+// The stream of the frames - one frame for every fix:
+//   the keyframe:    'G' 'T' version(1 byte) + the varint values of the fix + crc8
+//                    (the time, the latitude, the longitude and the altitude are zigzag coded, the speed is unsigned, the quality is the single byte)
+//   the delta frame: the mask byte (0x00 - 0x3F, bit N: the value N is given) + the zigzag varint values given + crc8
+//                    the time, the position and the altitude are given as the difference from the linear prediction (the previous value
+//                    plus the previous change), the speed as the difference from the previous speed and the quality as the new value,
+//                    so the fix moving with the constant velocity takes 2 bytes
+// The crc8 (polynomial 0x07, initial value 0xFF) covers the whole frame. The decoder starts (or resumes after the damaged frame) at the keyframe.
+// The precision: 1e-9 deg (~0.1 mm) of the position, 1 mm of the altitude, 0.01 km/h of the speed. Note that the double type
+// on some MCUs (e.g. Arduino UNO) has 4 bytes, so the position is not that precise there.
+#define GNSS_TRACK_VERSION    1
+#define GNSS_TRACK_MAX_FRAME  56    // the maximum size of the single frame [bytes]
+
+// the values of the delta frame mask
+#define GNSS_TRACK_TIME       0x01
+#define GNSS_TRACK_LAT        0x02
+#define GNSS_TRACK_LON        0x04
+#define GNSS_TRACK_ALT        0x08
+#define GNSS_TRACK_SPEED      0x10
+#define GNSS_TRACK_QUALITY    0x20
+
+// the fix in the integer units of the stream
+struct GNSS_track_fix {
+  int64_t  timeMs;    // the UTC time [ms since 1970-01-01] or [ms of the day] when the date is not known
+  int64_t  lat;       // the signed latitude [1e-9 deg]
+  int64_t  lon;       // the signed longitude [1e-9 deg]
+  int64_t  altMm;     // the altitude [mm]
+  uint32_t speed;     // the speed over ground [0.01 km/h]
+  uint8_t  quality;   // the GGA quality (0-9)
+};
+
+
+/***************************************************************************************************************************************************
+ ************************************************************** the track encoder ******************************************************************
+ ***************************************************************************************************************************************************/
+
+class GNSSTrackEncoder {
+private:
+  struct GNSS_track_fix atLast;       // the last fix encoded
+  struct GNSS_track_fix atChange;     // the change of the last fix (the prediction of the next change)
+  uint16_t              atInterval;   // the keyframe is written every atInterval fixes
+  uint16_t              atSinceKey;   // the number of the delta frames since the last keyframe
+  bool                  atKeyPending;
+
+public:
+  // the keyframe is written every paKeyframeInterval fixes (1 - every fix is the keyframe)
+  GNSSTrackEncoder(uint16_t paKeyframeInterval = 60);
+
+  // it writes the frame of the fix to the buffer (GNSS_TRACK_MAX_FRAME bytes at least) - it returns the size of the frame
+  uint8_t encode(const struct GNSS_track_fix *paFix, uint8_t *paBuffer);
+  uint8_t encode(const struct GNSS_data *paData, uint8_t *paBuffer);
+  // the next fix is written as the keyframe (e.g. when the new receiver connects to the uplink)
+  inline void forceKeyframe(void) { this->atKeyPending = true; };
+
+  // the epoch data in the units of the stream (the fields not received are 0)
+  static void quantize(const struct GNSS_data *paData, struct GNSS_track_fix *paFix);
+};
+
+
+/***************************************************************************************************************************************************
+ ************************************************************** the track decoder ******************************************************************
+ ***************************************************************************************************************************************************/
+
+class GNSSTrackDecoder {
+private:
+  struct GNSS_track_fix atLast;
+  struct GNSS_track_fix atChange;
+  bool                  atSynced;     // the keyframe has been decoded (the delta frames can be decoded)
+  uint32_t              atDamaged;
+
+public:
+  GNSSTrackDecoder(void);
+
+  // It decodes the next frame from the given bytes. *paUsed is the number of the bytes consumed (the frame or the bytes skipped).
+  // It returns 1 if the fix is decoded, 0 if more bytes are needed (the incomplete frame is not consumed) or -1 if the frame is damaged
+  // (the bytes are skipped up to the next keyframe).
+  int8_t decode(const uint8_t *paData, size_t paLength, size_t *paUsed, struct GNSS_track_fix *paFix);
+  // it forgets the state - the next fix is decoded from the keyframe
+  inline void reset(void) { this->atSynced = false; };
+  inline uint32_t getDamaged(void) { return this->atDamaged; };
+
+  // the value of the stream in degrees
+  static inline double toDegrees(int64_t paValue) { return ((double)paValue / 1e9); };
+};
+
+#endif
@@ -0,0 +1,144 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "GNSSTrackSimplifier.h"
+#include <math.h>
+
+#define SIMPLIFY_METRES_PER_DEG  111194.93   // the mean Earth radius (6371008.8 m) * PI / 180
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ********************************************************* the streaming track simplifier  *********************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+GNSSTrackSimplifier::GNSSTrackSimplifier(GNSS_track_callback paCallback, void *paUserData, float paToleranceM, uint8_t paMaxPoints) {
+  atCallback     = paCallback;
+  atUserData     = paUserData;
+  memset(&atAnchor, 0, sizeof(atAnchor));
+  atAnchored     = false;
+  atMetresPerLat = 0;
+  atMetresPerLon = 0;
+  atCount        = 0;
+  atMaxPoints    = ((0 == paMaxPoints) || (GNSS_SIMPLIFY_WINDOW < paMaxPoints)) ? GNSS_SIMPLIFY_WINDOW : paMaxPoints;
+  atTolerance    = (0 > paToleranceM) ? 0 : paToleranceM;
+  atStdDevFactor = 0;
+  atMaxDelayMs   = 0;
+  atInput        = 0;
+  atOutput       = 0;
+}
+
+
+void GNSSTrackSimplifier::set_anchor(const struct GNSS_track_fix *paFix) {
+  memcpy(&this->atAnchor, paFix, sizeof(this->atAnchor));
+  this->atAnchored     = true;
+  this->atMetresPerLat = SIMPLIFY_METRES_PER_DEG * 1e-9;
+  this->atMetresPerLon = this->atMetresPerLat * cos(GNSSTrackDecoder::toDegrees(paFix->lat) * M_PI / 180);
+  this->atOutput++;
+  if (NULL != this->atCallback) {
+    this->atCallback(paFix, this->atUserData);
+  }
+}
+
+
+void GNSSTrackSimplifier::put_point(const struct GNSS_track_fix *paFix, float paTolerance) {
+  struct simplify_point *loPoint = &this->atWindow[this->atCount++];
+
+  memcpy(&loPoint->fix, paFix, sizeof(loPoint->fix));
+  loPoint->x         = (double)(paFix->lon - this->atAnchor.lon) * this->atMetresPerLon;
+  loPoint->y         = (double)(paFix->lat - this->atAnchor.lat) * this->atMetresPerLat;
+  loPoint->tolerance = paTolerance;
+}
+
+
+// it checks if all the fixes held back are within their tolerance of the line from the anchor (0, 0) to the point (paX, paY)
+bool GNSSTrackSimplifier::fits(double paX, double paY) {
+  double loLength2 = paX * paX + paY * paY;
+  double loT, loDx, loDy;
+  uint8_t i;
+
+  for (i = 0; i < this->atCount; i++) {
+    loT = (0 < loLength2) ? ((this->atWindow[i].x * paX + this->atWindow[i].y * paY) / loLength2) : 0;
+    loT = (0 > loT) ? 0 : ((1 < loT) ? 1 : loT); // the distance from the segment, not from the whole line
+    loDx = this->atWindow[i].x - loT * paX;
+    loDy = this->atWindow[i].y - loT * paY;
+    if ((loDx * loDx + loDy * loDy) > ((double)this->atWindow[i].tolerance * this->atWindow[i].tolerance)) {
+      return (false);
+    }
+  }
+  return (true);
+}
+
+
+void GNSSTrackSimplifier::add(const struct GNSS_track_fix *paFix, float paToleranceM) {
+  const struct GNSS_track_fix *loLast;
+  bool loBroken;
+
+  this->atInput++;
+  if (!this->atAnchored) {
+    this->set_anchor(paFix);
+    return;
+  }
+
+  if (0 < this->atCount) {
+    loBroken = (this->atCount >= this->atMaxPoints) ||
+               ((0 < this->atMaxDelayMs) && ((paFix->timeMs - this->atAnchor.timeMs) > (int64_t)this->atMaxDelayMs)) ||
+               !this->fits((double)(paFix->lon - this->atAnchor.lon) * this->atMetresPerLon, (double)(paFix->lat - this->atAnchor.lat) * this->atMetresPerLat);
+    if (loBroken) {
+      // the line up to the previous fix was correct - it is kept and the new line starts there
+      loLast = &this->atWindow[this->atCount - 1].fix;
+      this->set_anchor(loLast);
+      this->atCount = 0;
+    }
+  }
+  this->put_point(paFix, paToleranceM);
+}
+
+
+void GNSSTrackSimplifier::add(const struct GNSS_data *paData) {
+  struct GNSS_track_fix loFix;
+  float loTolerance = this->atTolerance;
+
+  if (!(('0' < paData->quality) || ('A' == paData->pos_status))) {
+    return;
+  }
+  if ((0 < this->atStdDevFactor) && (0 < paData->msgs_rcvd[MSG_GST])) {
+    loTolerance += this->atStdDevFactor * sqrt(paData->lat_std_dev * paData->lat_std_dev + paData->lon_std_dev * paData->lon_std_dev);
+  }
+  GNSSTrackEncoder::quantize(paData, &loFix);
+  this->add(&loFix, loTolerance);
+}
+
+
+void GNSSTrackSimplifier::flush(void) {
+  if (0 < this->atCount) {
+    this->set_anchor(&this->atWindow[this->atCount - 1].fix);
+    this->atCount = 0;
+  }
+}
+
+
+void GNSSTrackSimplifier::epochCallback(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paSimplifier) {
+  (void)paGSVData;
+  if (NULL != paSimplifier) {
+    ((GNSSTrackSimplifier *)paSimplifier)->add(paData);
+  }
+}
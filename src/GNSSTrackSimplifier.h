@@ -0,0 +1,96 @@
+/*
+  This file is a part of the ultimateGNSSParser library.
+  Copyright (c) 2024 Kazimierz Wilk. All rights reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef GNSS_TRACK_SIMPLIFIER_H
+#define GNSS_TRACK_SIMPLIFIER_H
+
+#include "ultimateGNSSParser.h"
+#include "GNSSTrackCodec.h"
+
+// the maximum number of the fixes held back by the simplifier (the memory is GNSS_SIMPLIFY_WINDOW * 64 bytes)
+#ifndef GNSS_SIMPLIFY_WINDOW
+#define GNSS_SIMPLIFY_WINDOW 32
+#endif
+
+// the fix kept by the simplifier
+typedef void (*GNSS_track_callback)(const struct GNSS_track_fix *paFix, void *paUserData);
+
+/***************************************************************************************************************************************************
+ ********************************************************* the streaming track simplifier **********************************************************
+ ***************************************************************************************************************************************************/
+
+// The online line simplification (the opening window form of Douglas-Peucker): the last fix given to the callback is the anchor,
+// the next fixes are held back as long as the line from the anchor to the newest fix passes all of them within their tolerance.
+// When the newest fix breaks the line, the fix before it is given to the callback and becomes the new anchor. So the track
+// given to the callback is within the tolerance of every fix dropped, the stationary and straight segments take two fixes only.
+// The memory is fixed and every fix is given to the callback (or dropped) at most paMaxPoints fixes (and setMaxDelay() ms) later.
+// The distances are computed in the local plane of the anchor (the altitude is not checked).
+class GNSSTrackSimplifier {
+private:
+  struct simplify_point {
+    struct GNSS_track_fix fix;
+    double                x;          // [m] east of the anchor
+    double                y;          // [m] north of the anchor
+    float                 tolerance;  // [m]
+  };
+
+  GNSS_track_callback   atCallback;
+  void                 *atUserData;
+  struct GNSS_track_fix atAnchor;
+  bool                  atAnchored;
+  double                atMetresPerLat;   // [m / 1e-9 deg] at the anchor
+  double                atMetresPerLon;
+  struct simplify_point atWindow[GNSS_SIMPLIFY_WINDOW];
+  uint8_t               atCount;
+  uint8_t               atMaxPoints;
+  float                 atTolerance;
+  float                 atStdDevFactor;
+  uint32_t              atMaxDelayMs;
+  uint32_t              atInput;
+  uint32_t              atOutput;
+
+  void set_anchor(const struct GNSS_track_fix *paFix);
+  void put_point(const struct GNSS_track_fix *paFix, float paTolerance);
+  bool fits(double paX, double paY);
+
+public:
+  // the fixes kept are given to the callback, paMaxPoints is the maximum number of the fixes held back (up to GNSS_SIMPLIFY_WINDOW)
+  GNSSTrackSimplifier(GNSS_track_callback paCallback, void *paUserData, float paToleranceM = 2.0, uint8_t paMaxPoints = GNSS_SIMPLIFY_WINDOW);
+
+  // The tolerance of the epoch is paToleranceM + paFactor * sqrt(lat_std_dev^2 + lon_std_dev^2) when $xxGST has been received
+  // (0 - the fixed tolerance), so the noisy fixes are simplified more.
+  inline void setStdDevFactor(float paFactor)  { this->atStdDevFactor = paFactor; };
+  // the fix is not held back longer than paDelayMs after the anchor (0 - no limit)
+  inline void setMaxDelay(uint32_t paDelayMs) { this->atMaxDelayMs = paDelayMs; };
+
+  // it takes the next fix with its tolerance [m]
+  void add(const struct GNSS_track_fix *paFix, float paToleranceM);
+  // it takes the epoch with the tolerance of the simplifier (the epochs without the fix are skipped)
+  void add(const struct GNSS_data *paData);
+  // it gives the last fix held back to the callback (e.g. at the end of the track)
+  void flush(void);
+
+  inline uint32_t getInput(void)  { return this->atInput; };
+  inline uint32_t getOutput(void) { return this->atOutput; };
+
+  // the epoch callback (GNSSCollector::setEpochCallback) with the simplifier as the user data
+  static void epochCallback(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paSimplifier);
+};
+
+#endif
@@ -111,6 +111,45 @@ inline void GNSSCollector::parseTime(const char *paSlice, uint8_t &paHour, uint8
   // paFraction = (uint16_t) ((paSlice - ((double)((uint32_t)paSlice)))*1000); // this doesn't work due to rounding the last digit
 }
 
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ************************************************* the UTC date and time in milliseconds since 1970-01-01 ******************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+int64_t GNSSCollector::getUnixTimeMs(uint16_t paYear, uint8_t paMonth, uint8_t paDay, uint32_t paMsOfDay) {
+  int32_t loYear;
+  int32_t loEra;
+  int32_t loYearOfEra;
+  int32_t loDayOfYear;
+  int32_t loDayOfEra;
+  uint8_t loMonth;
+  
+  if ((1970 > paYear) || (1 > paMonth) || (12 < paMonth) || (1 > paDay) || (31 < paDay)) {
+    return (-1);
+  }
+  // the days since 1970-01-01 in the proleptic Gregorian calendar (the year begins in March here, so the leap day is at its end)
+  loYear      = paYear - ((3 > paMonth) ? 1 : 0);
+  loMonth     = (2 < paMonth) ? (paMonth - 3) : (paMonth + 9);
+  loEra       = loYear / 400;
+  loYearOfEra = loYear - loEra * 400;
+  loDayOfYear = (153 * (int32_t)loMonth + 2) / 5 + paDay - 1;
+  loDayOfEra  = loYearOfEra * 365 + loYearOfEra / 4 - loYearOfEra / 100 + loDayOfYear;
+  
+  return (((int64_t)(loEra * 146097 + loDayOfEra - 719468)) * 86400000 + paMsOfDay);
+}
+
+
+int64_t GNSSCollector::getUnixTimeMs(const struct GNSS_data *paData) {
+  if (NULL == paData) {
+    return (-1);
+  }
+  return (GNSSCollector::getUnixTimeMs(paData->year, paData->month, paData->day,
+          ((uint32_t)paData->UTC_H * 3600 + (uint32_t)paData->UTC_M * 60 + paData->UTC_S) * 1000 + paData->UTC_fract));
+}
+
 /***************************************************************************************************************************************************
  ***************************************************************************************************************************************************
  ***************************************************************************************************************************************************
@@ -125,6 +164,17 @@ GNSSCollector::GNSSCollector(int8_t (*available_check_callback)(void), int8_t (*
   read_callback = read_check_callback;
   atGSVData = NULL;
   atCustomParser = NULL;
+  memset((void*)(this->atSentenceCallbacks), 0, sizeof(this->atSentenceCallbacks));
+  atEpochCallback = NULL;
+  atEpochCallbackUserData = NULL;
+  atStreamState = NULL;
+  atRawCallback = NULL;
+  atRawCallbackUserData = NULL;
+  atLineCallback = NULL;
+  atLineCallbackUserData = NULL;
+  atClockNow = NULL;
+  atClockSleep = NULL;
+  atClockUserData = NULL;
 #ifdef ARDUINO
   atMessagesBreakLength = 2;
 #elif __linux__
@@ -146,6 +196,10 @@ GNSSCollector::~GNSSCollector(void) {
     delete this->atGSVData;
     this->atGSVData = NULL;
   }
+  if (this->atStreamState) {
+    delete this->atStreamState;
+    this->atStreamState = NULL;
+  }
 }
 
 /***************************************************************************************************************************************************
@@ -200,6 +254,44 @@ int8_t GNSSCollector::GSVSwitch(bool turnOn) {
 }
 
 
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ********************************************* the method subscribes the callback for the particular sentence type *********************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+int8_t GNSSCollector::setSentenceCallback(uint8_t paMsgType, GNSS_sentence_callback paCallback, void *paUserData) {
+  if (MSG_MAX <= paMsgType) {
+    DBG("Unknown message type for the sentence callback\r\n");
+    return (-1);
+  }
+  this->atSentenceCallbacks[paMsgType].callback = paCallback;
+  this->atSentenceCallbacks[paMsgType].userData = paUserData;
+  return (0);
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ *************************************** the table of the particular parsers shared by all the instances  ******************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+const struct GNSSCollector::NMEA_parsers_table GNSSCollector::NMEA_p_t[9] GNSS_PROGMEM = {
+                          {"GSV", &GNSSCollector::GSV_parser, MSG_GSV},
+                          {"GSA", &GNSSCollector::GSA_parser, MSG_GSA},
+                          {"RMC", &GNSSCollector::RMC_parser, MSG_RMC},
+                          {"GGA", &GNSSCollector::GGA_parser, MSG_GGA},
+                          {"GLL", &GNSSCollector::GLL_parser, MSG_GLL},
+                          {"VTG", &GNSSCollector::VTG_parser, MSG_VTG},
+                          {"TXT", &GNSSCollector::TXT_parser, MSG_MAX},
+                          {"GBS", &GNSSCollector::GBS_parser, MSG_GBS},
+                          {"GST", &GNSSCollector::GST_parser, MSG_GST}
+                        };
+
 /***************************************************************************************************************************************************
  ***************************************************************************************************************************************************
  ***************************************************************************************************************************************************
@@ -211,11 +303,17 @@ int8_t GNSSCollector::GSVSwitch(bool turnOn) {
 int8_t GNSSCollector::parse_NMEA_fields_for_particular_message(const struct NMEA_fields *paSlices) {
 
   uint8_t i;
-  uint8_t loConstTableSize = sizeof(this->NMEA_p_t)/sizeof(this->NMEA_p_t[0]);
+  uint8_t loConstTableSize = sizeof(GNSSCollector::NMEA_p_t)/sizeof(GNSSCollector::NMEA_p_t[0]);
+  struct NMEA_parsers_table loParser;
   
   for (i=0; i< loConstTableSize;i+=1) {
-    if (!strncmp(GNSSCollector::get_field(paSlices,0)+3, this->NMEA_p_t[i].header,3)) {
-      return ((this->*NMEA_p_t[i].parser_method)(paSlices));
+    GNSS_READ_TABLE(&loParser, &GNSSCollector::NMEA_p_t[i]);
+    if (!strncmp(GNSSCollector::get_field(paSlices,0)+3, loParser.header,3)) {
+      int8_t loResult = (this->*loParser.parser_method)(paSlices);
+      if ((0 == loResult) && (MSG_MAX > loParser.msgType) && (NULL != this->atSentenceCallbacks[loParser.msgType].callback)) {
+        this->atSentenceCallbacks[loParser.msgType].callback(&this->atDataStorage, paSlices, this->atSentenceCallbacks[loParser.msgType].userData);
+      }
+      return (loResult);
     }
   }
   SETCOLORRED
@@ -233,23 +331,47 @@ int8_t GNSSCollector::parse_NMEA_fields_for_particular_message(const struct NMEA
  ***************************************************************************************************************************************************/
 
 
+// the names are used by the pretty-printers only, so they are stripped in the minimal footprint build mode
+#ifndef GNSS_MINIMAL_FOOTPRINT
+#define TALKER_NAME(paTalker, paName, paSystemID) {paTalker, paName, paSystemID}
+#else
+#define TALKER_NAME(paTalker, paName, paSystemID) {paTalker, paSystemID}
+#endif
+
+const struct talkerID_Names talkerNames [TALKER_NAMES_MAX] GNSS_PROGMEM = {
+                       TALKER_NAME("??","    ???", 0), /* some unrecognized message (e.g. Teseo-LIV3F has the $PSTMCPU message)*/
+                       TALKER_NAME("GP","    GPS", 1), /* USA - Global Positioning System */
+                       TALKER_NAME("GL","GLONASS", 2), /* Ru - Глобальная навигационная спутниковая система */
+                       TALKER_NAME("GA","Galileo", 3), /* EU system - more precise than GLONASS or GPS */
+                       TALKER_NAME("BD"," BeiDou", 4), /* BeiDou (BDS); Chinese: 北斗卫星导航系统; pinyin: Běidǒu Wèixīng Dǎoháng Xìtǒng */
+                       TALKER_NAME("GB"," BeiDou", 4), /* BeiDou (BDS); Chinese: 北斗卫星导航系统; pinyin: Běidǒu Wèixīng Dǎoháng Xìtǒng */
+                       TALKER_NAME("QZ","   QZSS", 5), /* QZSS (Quasi-Zenith Satellite System), Japan */ /* QZSS regional GPS augmentation system (Japan) */
+                       TALKER_NAME("GQ","   QZSS", 5), /* QZSS (Quasi-Zenith Satellite System), Japan */
+                       TALKER_NAME("GI","  NavIC", 6), /* Indian Regional Navigation Satellite System (IRNSS) */
+                       TALKER_NAME("PQ","QZSS-QQ", 5), /* QZSS (Quasi-Zenith Satellite System), Japan */  /* QZSS (Quectel Quirk) */
+                       TALKER_NAME("GN","   GNSS", 0) }; /* Multi constellation - has to be at the end of the table due to presentation layer */
+
+
+#ifndef GNSS_MINIMAL_FOOTPRINT
 inline void GNSSCollector::printTalkerName (const char *paTalker, bool paAlign) {
   
   uint8_t loTindex;
   const uint8_t loTalkersNumber = sizeof(talkerNames)/sizeof(talkerNames[0]);
+  struct talkerID_Names loTalker;
   const char *loTalkerFound;
   
   for (loTindex = 0; loTindex < loTalkersNumber; loTindex++ ) {
-    if (! strncmp(talkerNames[loTindex].talker, paTalker, 2)) {
-      loTalkerFound = talkerNames[loTindex].name;
+    GNSS_READ_TABLE(&loTalker, &talkerNames[loTindex]);
+    if (! strncmp(loTalker.talker, paTalker, 2)) {
       break;
     }
   }
   
   if (loTalkersNumber == loTindex) {
-    loTalkerFound = talkerNames[0].name;
+    GNSS_READ_TABLE(&loTalker, &talkerNames[0]);
   }
   
+  loTalkerFound = loTalker.name;
   if (!paAlign) {
     while (' ' == *loTalkerFound)
       loTalkerFound++;
@@ -257,6 +379,7 @@ inline void GNSSCollector::printTalkerName (const char *paTalker, bool paAlign)
   
   DBGV(loTalkerFound);
 }
+#endif
 
 
 
@@ -264,22 +387,20 @@ inline uint8_t GNSSCollector::getSystemIDByTalker(const char *paTalker) {
   
   uint8_t loSindex;
   const uint8_t loTalkersNumber = sizeof(talkerNames)/sizeof(talkerNames[0]);
-  uint8_t loSystemID = 0;
+  struct talkerID_Names loTalker;
   
   for (loSindex = 0; loSindex < loTalkersNumber; loSindex++ ) {
-    if (! strncmp(talkerNames[loSindex].talker, paTalker, 2)) {
-      loSystemID = talkerNames[loSindex].systemID;
-      break;
+    GNSS_READ_TABLE(&loTalker, &talkerNames[loSindex]);
+    if (! strncmp(loTalker.talker, paTalker, 2)) {
+      return (loTalker.systemID);
     }
   }
   
-  if (loTalkersNumber == loSindex) {
-    loSystemID = talkerNames[0].systemID;
-  }
-  
-  return (loSystemID);
+  GNSS_READ_TABLE(&loTalker, &talkerNames[0]);
+  return (loTalker.systemID);
 }
 
+#ifndef GNSS_MINIMAL_FOOTPRINT
 /***************************************************************************************************************************************************
  ***************************************************************************************************************************************************
  ***************************************************************************************************************************************************
@@ -289,7 +410,7 @@ inline uint8_t GNSSCollector::getSystemIDByTalker(const char *paTalker) {
  ***************************************************************************************************************************************************/
 
 /*    0             1            2            3            4            5            6           7            8            9            A            B             C            D           E            F    */
-const char *GNSSsignalIDNames[MAX_SYSTEM_ID + 1][16] = {
+const char GNSSsignalIDNames[MAX_SYSTEM_ID + 1][16][12] GNSS_PROGMEM = {
   {"Undefined",   "Undefined","Undefined", "Undefined", "Undefined",  "Undefined","Undefined", "Undefined", "Undefined", "Undefined", "Undefined", "Undefined", "Undefined", "Undefined", "Undefined", "Undefined"},  // Undefined
   {"All signals", "L1 C/A",   "L1 P(Y)"  ,   "L1 M",     "L2 P(Y)",    "L2C-M",    "L2C-L",      "L5-I",      "L5-Q",    "Reserved",  "Reserved",  "Reserved",   "Reserved", "Reserved",  "Reserved",  "Reserved"},   // GPS
   {"All signals", "L1 C/A",   "L1 P",       "L2 C/A",     "L2 P",     "Reserved", "Reserved",  "Reserved",  "Reserved",  "Reserved",  "Reserved",  "Reserved",   "Reserved", "Reserved",  "Reserved",  "Reserved"},   // GLONASS
@@ -322,7 +443,7 @@ void GNSSCollector::printGSVData(bool paShowDebugInfo = false) {
     
     loSystemID = getSystemIDByTalker(atGSVData->system[s].talker);
     
-    for (m=0; m<9;m++) {
+    for (m=0; m<MAXGSVMESSAGES;m++) {
       if (0 == atGSVData->system[s].GSV[m].msgNo)
         continue;
       DBG("--------------------------------------------------\r\n");
@@ -343,7 +464,7 @@ void GNSSCollector::printGSVData(bool paShowDebugInfo = false) {
       
       DBG("SignalID "); if (255 != atGSVData->system[s].GSV[m].signalID) { SETCOLORGREEN 
                                                                            DBGT(atGSVData->system[s].GSV[m].signalID,HEX); DBG("\t"); 
-                                                                           DBG(GNSSsignalIDNames[loSystemID][atGSVData->system[s].GSV[m].signalID]); 
+                                                                           if (16 > atGSVData->system[s].GSV[m].signalID) DBGP(GNSSsignalIDNames[loSystemID][atGSVData->system[s].GSV[m].signalID]);
                                                                            NOCOLOR
                                                                          } else {SETCOLORRED DBG(" not present"); NOCOLOR}
 
@@ -553,6 +674,7 @@ void GNSSCollector::printGNSSData(bool paShowDebugInfo = false) {
   DBG("\t\tGBS: "); DBGT(this->atDataStorage.msgs_rcvd[MSG_GBS],DEC);
   DBG("\t\tGST: "); DBGT(this->atDataStorage.msgs_rcvd[MSG_GST],DEC); DBG("\r\n");
 }
+#endif /* GNSS_MINIMAL_FOOTPRINT */
 
 
 /***************************************************************************************************************************************************
@@ -627,6 +749,11 @@ int8_t GNSSCollector::GSV_parser(const struct NMEA_fields  *paSlices) {
     }
   }
   
+  if (MAXGSVMESSAGES == GSV_CURR_SYS.msgs) {
+    SETCOLORRED DBG("\tThe data storage space for GSV messages of the current system pack is full. The message is ignored\r\n"); NOCOLOR
+    return(-2);
+  }
+  
   if (atoi(GNSSCollector::get_field(paSlices,2)) != (GSV_CURR_SYS.msgs+1)) {    // field 2 is the message number in the pack for single system pack
     SETCOLORRED DBG("\tAt least one GSV message was omitted from system pack nr "); DBGT(this->atGSVData->recSystems,DEC); DBG(" (");  SETCOLORCYAN GNSSCollector::printTalkerName(GSV_CURR_SYS.talker,false); SETCOLORRED DBG(")\r\n"); NOCOLOR
   }
@@ -1006,6 +1133,123 @@ int8_t GNSSCollector::GLL_parser(const struct NMEA_fields  *paSlices) {
   return(0);
 }
 
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ******* this method checks, slices and parses the single received line (the data is collected only when the paCollect flag is set)  **************
+ ***************************************************************************************************************************************************
+ ***************************************** it returns 1 if the sentence data has been collected, 0 otherwise ***************************************
+ ***************************************************************************************************************************************************/
+
+int8_t GNSSCollector::process_single_line(const char *paLine, bool paCollect, bool paShowReceivedMessage, bool paShowCRNLVisible) {
+  
+  struct NMEA_fields loSlices;
+  
+#ifndef GNSS_MINIMAL_FOOTPRINT
+  if (paShowReceivedMessage) { // this is for debug purpose only
+    NMEA_index_t loFullRowLength; // declared here due to save RAM space on weak CPUs when DEBUG is turned off
+    DBG("The NMEA msg -> ");
+    loFullRowLength = strlen(paLine);
+    if (3 < loFullRowLength) { // the second and third characters is the talkerID sequence to be decoded
+      GNSSCollector::printTalkerName(paLine+1, true);
+    }
+    DBG(" - ("); DBGT((int)loFullRowLength,DEC); DBG("): ");
+    
+    if (paShowCRNLVisible) {
+      char loOneCharacter;
+      for (NMEA_index_t loIT=0; loIT<loFullRowLength;loIT++) {
+        loOneCharacter = paLine[loIT];
+        switch (loOneCharacter) {
+          case '\r':
+            DBG("\\r");
+            break;
+          case '\n':
+            DBG("\\n");
+            break;
+          default:
+            DBGC(loOneCharacter);
+        }
+      }
+      DBG("\r\n");
+    } else {
+      DBGV(paLine);
+    }
+  } // paShowReceivedMessage - for debug purpose only
+#else
+  (void)paShowReceivedMessage;
+  (void)paShowCRNLVisible;
+#endif
+  int8_t loStatus = check_and_slice_NMEA_message(paLine, &loSlices);
+  if (loStatus) {
+    // this is faulty NMEA message - we will not parse them and collect its data
+    if (NULL != this->atLineCallback) {
+      this->atLineCallback(paLine, (-2 == loStatus) ? LINE_CHECKSUM : LINE_MALFORMED, this->atLineCallbackUserData);
+    }
+    return (0);
+  }
+  
+  // this is correctly formatted NMEA message
+  if (!paCollect) {
+    if (NULL != this->atLineCallback) {
+      this->atLineCallback(paLine, LINE_VALID, this->atLineCallbackUserData);
+    }
+    return (0);
+  }
+  
+  if ((NULL != this->atStreamState) && (this->atStreamState->clearPending)) { // the first sentence of the new epoch (non-blocking mode)
+    this->clearData();
+    this->atStreamState->clearPending = false;
+  }
+  
+  loStatus = this->parseSentence(&loSlices);
+  if (NULL != this->atLineCallback) {
+    this->atLineCallback(paLine, loStatus ? LINE_VALID : LINE_REJECTED, this->atLineCallbackUserData);
+  }
+  return (loStatus);
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ************************* this method parses the single sliced sentence with the custom parser or with the particular parser **********************
+ ***************************************************************************************************************************************************
+ ***************************************** it returns 1 if the sentence data has been collected, 0 otherwise ***************************************
+ ***************************************************************************************************************************************************/
+
+int8_t GNSSCollector::parseSentence(const struct NMEA_fields *paSlices) {
+  
+  if (NULL == paSlices) {
+    SETCOLORRED DBG("The sliced NMEA message is not given - NULL pointer\r\n"); NOCOLOR
+    return (0);
+  }
+  
+  int8_t loFlag = 0;
+  if (NULL != atCustomParser) {
+    loFlag = atCustomParser(paSlices);
+  }
+  if (loFlag) {
+  } else if (0 > parse_NMEA_fields_for_particular_message(paSlices)) {
+    DBG("particular message parser returned error code\r\n");
+    return (0);
+  }
+  return (1);
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ******************************************* this method clears the data collected from the previous epoch *****************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+void GNSSCollector::clearData(void) {
+  memset((void *)&(this->atDataStorage), 0, sizeof(this->atDataStorage));
+  if (NULL != this->atGSVData) {
+    memset((void *)this->atGSVData, 0, sizeof(struct GSV_manager));
+  }
+}
+
 /***************************************************************************************************************************************************
  ***************************************************************************************************************************************************
  ***************************************************************************************************************************************************
@@ -1017,21 +1261,21 @@ int8_t GNSSCollector::GLL_parser(const struct NMEA_fields  *paSlices) {
 
 int8_t GNSSCollector::collectData(bool paShowReceivedMessage = false, bool paShowCRNLVisible = true) {
   
-  struct NMEA_fields loSlices;
-  
   bool loSequenceStarted   = false;
   bool loSequenceCompleted = false;
   bool loHaveSomeDataFlag  = false;
   
   char loOneFullRow[MAXMESSAGELENGTH];
-  uint8_t i;
+  NMEA_index_t i;
   int8_t avl_result;
   
-  memset((void *)&(this->atDataStorage), 0, sizeof(this->atDataStorage));
-  if (NULL != this->atGSVData) {
-    memset((void *)this->atGSVData, 0, sizeof(struct GSV_manager));
+  if ((NULL == avl_callback) || (NULL == read_callback)) {
+    DBG("collectData needs the data source callbacks\r\n");
+    return (-7);
   }
   
+  this->clearData();
+  
   i = 0; // we will read every single character of the string and put them to the buffer from the index of 0
   
   while (! loSequenceCompleted) {
@@ -1042,62 +1286,24 @@ int8_t GNSSCollector::collectData(bool paShowReceivedMessage = false, bool paSho
         i=0;
         DBGV(loOneFullRow); DBG("\r\n");
         SETCOLORRED DBG("Received too long NMEA message (or some junk) for processing, so ignored\r\n"); NOCOLOR
+        if (NULL != this->atLineCallback) {
+          this->atLineCallback(loOneFullRow, LINE_TOO_LONG, this->atLineCallbackUserData);
+        }
         continue;
       }
       
       loOneFullRow[i] = (char)read_callback();
+      if (NULL != this->atRawCallback) {
+        this->atRawCallback(&loOneFullRow[i], 1, this->atRawCallbackUserData);
+      }
       
       if ('\n' == loOneFullRow[i++]) {
         loOneFullRow[i] = 0; // terminating the received string
         
         i = 0;  // reading will be continued as a new NMEA message
         
-        if (paShowReceivedMessage) { // this is for debug purpose only
-          uint8_t loFullRowLength; // declared here due to save RAM space on weak CPUs when DEBUG is turned off
-          DBG("The NMEA msg -> ");
-          loFullRowLength = strlen(loOneFullRow);
-          if (3 < loFullRowLength) { // the second and third characters is the talkerID sequence to be decoded
-            GNSSCollector::printTalkerName(loOneFullRow+1, true);
-          }
-          DBG(" - ("); DBGT((int)loFullRowLength,DEC); DBG("): ");
-          
-          if (paShowCRNLVisible) {
-            char loOneCharacter;
-            for (uint8_t loIT=0; loIT<loFullRowLength;loIT++) {
-              loOneCharacter = loOneFullRow[loIT];
-              switch (loOneCharacter) {
-                case '\r':
-                  DBG("\\r");
-                  break;
-                case '\n':
-                  DBG("\\n");
-                  break;
-                default:
-                  DBGC(loOneCharacter);
-              }
-            }
-            DBG("\r\n");
-          } else {
-            DBGV(loOneFullRow);
-          }
-        } // paShowReceivedMessage - for debug purpose only
-        if (check_and_slice_NMEA_message(loOneFullRow, &loSlices)) {
-          // this is faulty NMEA message - we will not parse them and collect its data
-          continue;
-        } else {
-          // this is correctly formatted NMEA message
-          if (loSequenceStarted) {
-            int8_t loFlag = 0;
-            if (NULL != atCustomParser) {
-              loFlag = atCustomParser(&loSlices);
-            }
-            if (loFlag) {
-            } else if (0 > parse_NMEA_fields_for_particular_message(&loSlices)) {
-              DBG("particular message parser returned error code\r\n");
-              continue;
-            }
-            loHaveSomeDataFlag = true;
-          }
+        if (this->process_single_line(loOneFullRow, loSequenceStarted, paShowReceivedMessage, paShowCRNLVisible)) {
+          loHaveSomeDataFlag = true;
         }
       } // '\n' occured
     } // while available callback
@@ -1105,11 +1311,7 @@ int8_t GNSSCollector::collectData(bool paShowReceivedMessage = false, bool paSho
       DBG("collectData timeout\r\n");
       return (-5);
     }
-#ifdef ARDUINO
-    delay(atMessagesBreakLength);
-#elif __linux__
-    usleep(atMessagesBreakLength * 1000);
-#endif
+    this->clock_sleep(atMessagesBreakLength);
     
     if (((int8_t)0) == (avl_result = avl_callback())) {
       
@@ -1134,9 +1336,212 @@ int8_t GNSSCollector::collectData(bool paShowReceivedMessage = false, bool paSho
     }
     
   } // while ! loSequenceCompleted
+  
+  if (NULL != this->atEpochCallback) {
+    this->atEpochCallback(&this->atDataStorage, this->atGSVData, this->atEpochCallbackUserData);
+  }
   return (0);
 } /***** collectData ****/
 
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ *************************************** the non-blocking processing: platform clock, sleep, state and break detection *****************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+uint32_t GNSSCollector::getPlatformTimeMs(void) {
+#ifdef ARDUINO
+  return ((uint32_t)millis());
+#elif __linux__
+  struct timespec loNow;
+  clock_gettime(CLOCK_MONOTONIC, &loNow);
+  return ((uint32_t)(((uint64_t)loNow.tv_sec) * 1000 + loNow.tv_nsec / 1000000));
+#endif
+}
+
+
+void GNSSCollector::clock_sleep(uint32_t paMs) {
+  if (NULL != this->atClockSleep) {
+    this->atClockSleep(paMs, this->atClockUserData);
+    return;
+  }
+#ifdef ARDUINO
+  delay(paMs);
+#elif __linux__
+  usleep(paMs * 1000);
+#endif
+}
+
+
+int8_t GNSSCollector::stream_state_check(uint32_t paNowMs) {
+  if (NULL != this->atStreamState) {
+    return (0);
+  }
+  this->atStreamState = new struct GNSS_stream_state;
+  if (NULL == this->atStreamState) {
+    SETCOLORRED DBG("Insufficient RAM space for the non-blocking processing state\r\n"); NOCOLOR
+    return (-1);
+  }
+  memset((void*)(this->atStreamState), 0, sizeof(*(this->atStreamState)));
+  this->atStreamState->lastByteTime = paNowMs; // we have to wait for the break before the first epoch as collectData() does
+  this->atStreamState->clearPending = true;
+  return (0);
+}
+
+
+// the line which has no space for the next byte is given to the line callback as the junk
+// (before the next byte is given to the raw data callback, so both see the same bytes - as in collectData())
+void GNSSCollector::stream_overflow_check(void) {
+  struct GNSS_stream_state *loState = this->atStreamState;
+  
+  if ((MAXMESSAGELENGTH-3) < loState->lineLength) { // the 3 bytes space is needed for \r\n\0 terminating the string
+    loState->line[loState->lineLength] = 0;
+    loState->lineLength = 0;
+    DBGV(loState->line); DBG("\r\n");
+    SETCOLORRED DBG("Received too long NMEA message (or some junk) for processing, so ignored\r\n"); NOCOLOR
+    if (NULL != this->atLineCallback) {
+      this->atLineCallback(loState->line, LINE_TOO_LONG, this->atLineCallbackUserData);
+    }
+  }
+}
+
+
+// the single byte received at the given time
+void GNSSCollector::stream_byte(char paByte, uint32_t paNowMs) {
+  struct GNSS_stream_state *loState = this->atStreamState;
+  
+  loState->lastByteTime = paNowMs;
+  this->stream_overflow_check();
+  loState->line[loState->lineLength++] = paByte;
+  
+  if ('\n' == paByte) {
+    loState->line[loState->lineLength] = 0; // terminating the received string
+    loState->lineLength = 0;               // reading will be continued as a new NMEA message
+    if (this->process_single_line(loState->line, loState->sequenceStarted, false, false)) {
+      loState->haveData = true;
+    }
+  }
+}
+
+
+// returns 1 if the epoch has been completed by the break at the given time
+int8_t GNSSCollector::stream_break_check(uint32_t paNowMs) {
+  struct GNSS_stream_state *loState = this->atStreamState;
+  
+  if ((uint32_t)(paNowMs - loState->lastByteTime) < this->atMessagesBreakLength) {
+    return (0); // no break yet
+  }
+  
+  // we are in the break between the packs of messages
+  if (!loState->sequenceStarted) { // Now we will start collecting data
+    loState->sequenceStarted = true;
+    return (0);
+  }
+  
+  if (!loState->haveData) { // we still are waiting for the first message of the new pack of messages
+    return (0);
+  }
+  
+  loState->haveData     = false;
+  loState->clearPending = true; // the data stays available until the first sentence of the next epoch
+  if (NULL != this->atEpochCallback) {
+    this->atEpochCallback(&this->atDataStorage, this->atGSVData, this->atEpochCallbackUserData);
+  }
+  return (1);
+}
+
+/***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ********************************* the non-blocking methods - they consume the bytes available and never sleep  ************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************
+ ***************************************************************************************************************************************************/
+
+int8_t GNSSCollector::process(uint32_t paNowMs) {
+  int8_t avl_result;
+  
+  if (this->stream_state_check(paNowMs)) {
+    return (-1);
+  }
+  
+  // the break is checked before reading new bytes, so the data of the completed epoch is still available for the caller
+  if (this->stream_break_check(paNowMs)) {
+    return (1);
+  }
+  
+  if ((NULL == avl_callback) || (NULL == read_callback)) {
+    return (0);
+  }
+  
+  while (((int8_t)0) < (avl_result = avl_callback())) {
+    char loByte = (char)read_callback();
+    if (NULL != this->atRawCallback) {
+      this->stream_overflow_check(); // the junk is marked before this byte is recorded (as with feed())
+      this->atRawCallback(&loByte, 1, this->atRawCallbackUserData);
+    }
+    this->stream_byte(loByte, paNowMs);
+  }
+  
+  if (0 > avl_result) {
+    DBG("process timeout\r\n");
+    return (-5);
+  }
+  return (0);
+}
+
+
+int8_t GNSSCollector::poll(void) {
+  return (this->process(this->getTimeMs()));
+}
+
+
+int8_t GNSSCollector::feed(const char *paData, uint16_t paLength, uint32_t paNowMs) {
+  int8_t loReady;
+  uint16_t i;
+  
+  if (this->stream_state_check(paNowMs)) {
+    return (-1);
+  }
+  
+  // all the bytes have the same time, so the break can be only before them (the epoch callback gets the completed epoch)
+  loReady = this->stream_break_check(paNowMs);
+  
+  if (NULL == paData) {
+    return (loReady);
+  }
+  
+  if (NULL == this->atRawCallback) {
+    for (i = 0; i < paLength; i++) {
+      this->stream_byte(paData[i], paNowMs);
+    }
+    return (loReady);
+  }
+  
+  // the raw data callback gets the bytes up to the end of the line before the line is parsed (as with collectData()),
+  // so the line callback can find the line among the raw bytes
+  uint16_t loStart = 0;
+  for (i = 0; i < paLength; i++) {
+    if ((MAXMESSAGELENGTH-3) < this->atStreamState->lineLength) { // the junk is given to the line callback before this byte is stored
+      if (loStart < i) {
+        this->atRawCallback(paData + loStart, i - loStart, this->atRawCallbackUserData);
+      }
+      loStart = i;
+    }
+    if ('\n' == paData[i]) {
+      this->atRawCallback(paData + loStart, i + 1 - loStart, this->atRawCallbackUserData);
+      loStart = i + 1;
+    }
+    this->stream_byte(paData[i], paNowMs);
+  }
+  if (loStart < paLength) {
+    this->atRawCallback(paData + loStart, paLength - loStart, this->atRawCallbackUserData);
+  }
+  return (loReady);
+}
+
 /***************************************************************************************************************************************************
  ***************************************************************************************************************************************************
  ***************************************************************************************************************************************************
@@ -1148,11 +1553,12 @@ int8_t GNSSCollector::collectData(bool paShowReceivedMessage = false, bool paSho
 
 int8_t GNSSCollector::check_and_slice_NMEA_message(const char *paSingleLine, struct NMEA_fields *paSlices) {
   
-  uint8_t it;
+  NMEA_index_t it;
+  NMEA_index_t loChSumAt; // the index of the '*' character preceding the check sum
   const char *ptrCurrentField;
   char chSumChar;
   char cSum;
-  const uint8_t loLineLength = strlen(paSingleLine);
+  size_t loLineLength;
   
   if (NULL == paSingleLine) {
     SETCOLORRED DBG("The NMEA message is not given - NULL pointer\r\n"); NOCOLOR
@@ -1164,6 +1570,8 @@ int8_t GNSSCollector::check_and_slice_NMEA_message(const char *paSingleLine, str
     return (-1);
   }
   
+  loLineLength = strlen(paSingleLine);
+  
   if (MAXMESSAGELENGTH <= loLineLength) {
     SETCOLORRED DBG("The NMEA message is too long to be processed\r\n"); NOCOLOR
     return (-1);
@@ -1185,46 +1593,42 @@ int8_t GNSSCollector::check_and_slice_NMEA_message(const char *paSingleLine, str
     return (-1);
   }
   
-  memset ((void *)paSlices, 0, sizeof(*paSlices));
+  memset ((void *)paSlices->field_index, 0, sizeof(paSlices->field_index));
+  memcpy (paSlices->message, paSingleLine, loLineLength + 1);
   
-  //  calculating check sum from the string excluding initial '$' and terminating checksum + "\r\n"
+  // single pass over the message (bounded by MAXMESSAGELENGTH):
+  //  - calculating check sum from the string excluding initial '$' and terminating checksum + "\r\n"
+  //  - slicing the message on every ',' character; the last field is terminated with the '*' character preceding the check sum
   paSlices->chSum = 0;
-  for (it = 1; it < (loLineLength-5); it++) { // whole line except initial '$' and terminating "*<2_bytes_of_check_sum>\r\n"
-    paSlices->chSum ^= *(paSingleLine+it);
-  }
-  
-  ptrCurrentField = paSingleLine;
-  paSlices->cnt = 0;
-  while (strchr(ptrCurrentField, ',')) {
-    if (MAXFIELDSINMESSAGE <= paSlices->cnt) {
-      SETCOLORRED DBG("There are too many fields in the NMEA message1\r\n"); NOCOLOR
-      return (-1);
+  paSlices->field_index[0] = 0;
+  paSlices->cnt = 1;
+  loChSumAt = 0;
+  for (it = 0; it < loLineLength; it++) {
+    if ((0 < it) && (it < (loLineLength-5))) { // whole line except initial '$' and terminating "*<2_bytes_of_check_sum>\r\n"
+      paSlices->chSum ^= paSlices->message[it];
+    }
+    if (',' == paSlices->message[it]) {
+      if (MAXFIELDSINMESSAGE <= paSlices->cnt) {
+        SETCOLORRED DBG("There are too many fields in the NMEA message\r\n"); NOCOLOR
+        return (-1);
+      }
+      paSlices->message[it] = 0;
+      paSlices->field_index[paSlices->cnt] = it + 1;
+      paSlices->cnt += 1;
+      loChSumAt = 0; // the check sum is preceded by the first '*' character after the last ','
+    } else if ('*' == paSlices->message[it]) {
+      paSlices->message[it] = 0;
+      if (0 == loChSumAt) {
+        loChSumAt = it;
+      }
     }
-    paSlices->field_index[paSlices->cnt] = ptrCurrentField - paSingleLine;
-    paSlices->cnt += 1;
-    ptrCurrentField = strchr(ptrCurrentField, ',') + 1;
   }
   
-  if (strchr(ptrCurrentField, '*')) { // the last one is check sum preceded with '*' character
-    if (MAXFIELDSINMESSAGE <= paSlices->cnt) {
-      SETCOLORRED DBG("There are too many fields in the NMEA message2\r\n"); NOCOLOR
-      return (-1);
-    }
-    paSlices->field_index[paSlices->cnt] = ptrCurrentField - paSingleLine;
-    paSlices->cnt += 1;
-    ptrCurrentField = strchr(ptrCurrentField, '*') + 1;
-  } else {
+  if (0 == loChSumAt) {
     SETCOLORRED DBG("The NMEA message has no '*' character preceding the check sum\r\n"); NOCOLOR
     return (-1);
   }
-  
-  strcpy(paSlices->message, paSingleLine);
-  
-  for (it=0; it<loLineLength; it++) {
-    if (',' == paSlices->message[it] || '*'== paSlices->message[it]) {
-      paSlices->message[it] = 0;
-    }
-  }
+  ptrCurrentField = paSingleLine + loChSumAt + 1;
   
   // TODO - to check if the checksum could be one digit length
   if (4 != strlen(ptrCurrentField)) {  // two hex digits + \r\n
@@ -46,6 +46,7 @@
 #include <string.h>
 #include <stdio.h>    // stderr
 #include <unistd.h>   // usleep
+#include <time.h>     // clock_gettime
 #define DBG(msg)    fprintf(stderr, "%s", msg);
 #define DBGV(msg)   fprintf(stderr, "%s", msg);
 #define DBGC(msg)   fprintf(stderr, "%c", msg);
@@ -73,6 +74,59 @@
 #endif
 
 
+// The constant tables are placed in the flash memory on the AVR boards (the "const" data is copied to RAM there by default).
+// On the other platforms the "const" data stays in the flash (or in the read-only memory) without any extra effort.
+#if defined(ARDUINO) && defined(__AVR__)
+#include <avr/pgmspace.h>
+#define GNSS_PROGMEM                  PROGMEM
+#define GNSS_READ_TABLE(paDst, paSrc) memcpy_P((void *)(paDst), (const void *)(paSrc), sizeof(*(paDst)));
+#define DBGP(msg)                     Serial.print((const __FlashStringHelper *)(msg));
+#else
+#define GNSS_PROGMEM
+#define GNSS_READ_TABLE(paDst, paSrc) memcpy((void *)(paDst), (const void *)(paSrc), sizeof(*(paDst)));
+#define DBGP(msg)                     DBGV(msg)
+#endif
+
+
+// The minimal footprint build mode (-DGNSS_MINIMAL_FOOTPRINT) is intended for the small MCU (e.g. AVR or SAMD boards).
+// It strips the debug messages, the pretty-printers (printGNSSData, printGSVData, printFieldsStorage) and the names tables
+// (talker names, signal ID names) from the library. The parsers and the error codes work in the same way.
+// The pretty-printers are still declared, but they do nothing, so the sketches can be compiled without any changes.
+#ifdef GNSS_MINIMAL_FOOTPRINT
+#undef  DBG
+#undef  DBGV
+#undef  DBGC
+#undef  DBGT
+#undef  DBGP
+#define DBG(msg)        ;
+#define DBGV(msg)       ;
+#define DBGC(msg)       ;
+#define DBGT(msg, TYPE) ;
+#define DBGP(msg)       ;
+
+#undef  NOCOLOR
+#undef  SETCOLORRED
+#undef  SETCOLORGREEN
+#undef  SETCOLORYELLOW
+#undef  SETCOLORBLUE
+#undef  SETCOLORPURPLE
+#undef  SETCOLORCYAN
+#undef  SETCOLORLIGHTGRAY
+#undef  SETCOLORBLACK
+#undef  SETCOLORDEFAULT
+#define NOCOLOR             {;}
+#define SETCOLORRED         {;}
+#define SETCOLORGREEN       {;}
+#define SETCOLORYELLOW      {;}
+#define SETCOLORBLUE        {;}
+#define SETCOLORPURPLE      {;}
+#define SETCOLORCYAN        {;}
+#define SETCOLORLIGHTGRAY   {;}
+#define SETCOLORBLACK       {;}
+#define SETCOLORDEFAULT     {;}
+#endif
+
+
 inline void printPreciselyDouble(double paValue) {
 // The Latitude and Longitude are given with the precision of 0.00001 minutes.
 // This is the 0.0000001(6) of degrees, so we have to print the position with 8 digits of fraction,
@@ -104,15 +158,75 @@ inline void printDouble(double paValue) {
 }
 
 
-#define PRN_SATS_MAX 6  // we have 6 GNSS constellations (GPS, GLONASS, Galileo, BeiDou, QZSS, NavIC)
+/***************************************************************************************************************************************************
+ *************************************************** the capacity limits of the data structures  ***************************************************
+ ***************************************************************************************************************************************************/
 
-const uint8_t MAXMESSAGELENGTH   = 120;  // Maximum sentence length is limited to 82 characters according to the NMEA restrictions, but sometimes they're longer (e.g. PX1122R by SkyTraQ)
-const uint8_t MAXFIELDSINMESSAGE = 30;
+// All the limits below can be changed at build time with the compiler flags (e.g. -DGNSS_MAXMESSAGELENGTH=82 -DGNSS_MAXGSVSYSTEMSTORAGE=4
+// for the small MCU or -DGNSS_MAXMESSAGELENGTH=300 for the long proprietary sentences on the server).
+// The library and your application have to be compiled with the same values (use the global build flags,
+// e.g. "build_flags" in PlatformIO or "compiler.cpp.extra_flags" in arduino-cli) - the structures layout depends on them.
+
+#ifndef GNSS_MAXMESSAGELENGTH
+#define GNSS_MAXMESSAGELENGTH 120    // Maximum sentence length is limited to 82 characters according to the NMEA restrictions, but sometimes they're longer (e.g. PX1122R by SkyTraQ)
+#endif
+
+#ifndef GNSS_MAXFIELDSINMESSAGE
+#define GNSS_MAXFIELDSINMESSAGE 30
+#endif
+
+#ifndef GNSS_PRN_SATS_MAX
+#define GNSS_PRN_SATS_MAX 6  // we have 6 GNSS constellations (GPS, GLONASS, Galileo, BeiDou, QZSS, NavIC)
+#endif
+
+// some modules (e.g. u-blox MAX-M10S or u-blox ZED-F9P) group GSV messages by Signal ID (it corresponds to the frequency bands), so we need four groups for GPS, four groups for Galileo, etc.
+#ifndef GNSS_MAXGSVSYSTEMSTORAGE
+#define GNSS_MAXGSVSYSTEMSTORAGE 16
+#endif
+
+#ifndef GNSS_MAXGSVMESSAGES
+#define GNSS_MAXGSVMESSAGES 9  // the number of GSV messages stored for single system pack (4 satellites in every message)
+#endif
+
+// the names used by the code (the flags without the GNSS_ prefix are accepted too)
+#ifndef PRN_SATS_MAX
+#define PRN_SATS_MAX GNSS_PRN_SATS_MAX
+#endif
+
+#ifndef MAXGSVSYSTEMSTORAGE
+#define MAXGSVSYSTEMSTORAGE GNSS_MAXGSVSYSTEMSTORAGE
+#endif
+
+#ifndef MAXGSVMESSAGES
+#define MAXGSVMESSAGES GNSS_MAXGSVMESSAGES
+#endif
+
+#if (GNSS_MAXMESSAGELENGTH < 16) || (GNSS_MAXMESSAGELENGTH > 65535)
+#error "GNSS_MAXMESSAGELENGTH shall be in range of 16 .. 65535"
+#endif
+
+#if (GNSS_MAXFIELDSINMESSAGE < 20) || (GNSS_MAXFIELDSINMESSAGE > 255)
+#error "GNSS_MAXFIELDSINMESSAGE shall be in range of 20 .. 255 (the $xxGSV message needs 21 fields)"
+#endif
+
+#if (PRN_SATS_MAX < 1) || (MAXGSVSYSTEMSTORAGE < 1) || (MAXGSVSYSTEMSTORAGE > 254) || (MAXGSVMESSAGES < 1) || (MAXGSVMESSAGES > 255)
+#error "PRN_SATS_MAX, MAXGSVSYSTEMSTORAGE and MAXGSVMESSAGES shall be greater than 0 and fit the uint8_t counters"
+#endif
+
+// the index of the byte in the NMEA message - the single byte is enough for the default message length
+#if (GNSS_MAXMESSAGELENGTH > 255)
+typedef uint16_t NMEA_index_t;
+#else
+typedef uint8_t  NMEA_index_t;
+#endif
+
+const NMEA_index_t MAXMESSAGELENGTH   = GNSS_MAXMESSAGELENGTH;
+const uint8_t      MAXFIELDSINMESSAGE = GNSS_MAXFIELDSINMESSAGE;
 
 struct NMEA_fields {
   char message[MAXMESSAGELENGTH];
-  uint8_t field_index[MAXFIELDSINMESSAGE]; // indexes of the first bytes of the fields
-  uint8_t cnt=0;                           // fields counter
+  NMEA_index_t field_index[MAXFIELDSINMESSAGE]; // indexes of the first bytes of the fields
+  uint8_t cnt=0;                                // fields counter
   int8_t chSum;
 };
 
@@ -230,9 +344,6 @@ struct GNSS_data {
  ***************************************************************************************************************************************************/
 
 
-// some modules (e.g. u-blox MAX-M10S or u-blox ZED-F9P) group GSV messages by Signal ID (it corresponds to the frequency bands), so we need four groups for GPS, four groups for Galileo, etc.
-#define MAXGSVSYSTEMSTORAGE 16
-
 struct GSV_Sat_data {
   uint16_t  prn;
   uint8_t   elev;
@@ -251,7 +362,7 @@ struct GSV_message {          // single GSV message content
 struct GSV_data_by_systemID {
   char    talker[3];          // talker ("GP", "GL", "GA", "BD", etc. - terminated with \0 byte)
   uint8_t msgs;               // messages received already for single talker
-  struct  GSV_message GSV[9]; // the GSV message content
+  struct  GSV_message GSV[MAXGSVMESSAGES]; // the GSV message content
 };
 
 struct GSV_manager {
@@ -261,6 +372,59 @@ struct GSV_manager {
 
 
 
+// The push model callbacks (see GNSSCollector::setSentenceCallback and GNSSCollector::setEpochCallback).
+// They are called directly from the parsing path, so keep them short - the next bytes are waiting in the input buffer.
+// The paUserData is the pointer given with the callback registration (e.g. the object of your class).
+
+// called right after the particular parser has decoded the sentence: paData contains the freshly decoded values
+// (and the values of the sentences received before in the current epoch), paSlices is the sliced sentence itself
+typedef void (*GNSS_sentence_callback)(const struct GNSS_data *paData, const struct NMEA_fields *paSlices, void *paUserData);
+
+// called when the whole pack of sentences with the single timestamp (epoch) has been collected
+// paGSVData is NULL when the GSV data is not collected (see GNSSCollector::GSVSwitch)
+typedef void (*GNSS_epoch_callback)(const struct GNSS_data *paData, const struct GSV_manager *paGSVData, void *paUserData);
+
+// called with the raw bytes as soon as they are received (before they are parsed) - e.g. to record the receiver traffic (see GNSSCapture.h)
+typedef void (*GNSS_raw_callback)(const char *paData, uint16_t paLength, void *paUserData);
+
+// called for every received line with its status (LINE_xxx) - e.g. to mark the rejected sentences (see GNSSFlightRecorder.h)
+// the line is terminated with '\0' (the junk and too long lines are cut at the buffer size)
+typedef void (*GNSS_line_callback)(const char *paLine, int8_t paStatus, void *paUserData);
+
+// the status of the line given to the line callback
+const int8_t LINE_VALID     =  0; // correctly formatted sentence (parsed or ignored by the custom parser)
+const int8_t LINE_MALFORMED = -1; // incorrect NMEA format
+const int8_t LINE_CHECKSUM  = -2; // inconsistent check sum
+const int8_t LINE_TOO_LONG  = -3; // too long sentence or some junk
+const int8_t LINE_REJECTED  = -4; // rejected by the particular parser (e.g. incorrect number of fields)
+
+// The clock used by collectData() and poll() (see GNSSCollector::setClock) - the platform clock is used by default.
+// now() returns any monotonic time in milliseconds, sleep() waits the given number of milliseconds (or only advances the virtual time).
+typedef uint32_t (*GNSS_clock_now)(void *paUserData);
+typedef void     (*GNSS_clock_sleep)(uint32_t paMs, void *paUserData);
+
+// The virtual clock: the time goes forward only when collectData() sleeps (or when you move it, e.g. to the recorded timestamps),
+// so the recorded data can be processed with the same break detection as the live data, but at the CPU speed.
+// Your available_check_callback shall report only the bytes recorded before the virtual "now".
+//   struct GNSS_virtual_clock loClock = {0};
+//   gnss.setClock(GNSS_virtual_clock::now, GNSS_virtual_clock::sleep, &loClock);
+struct GNSS_virtual_clock {
+  uint32_t nowMs;
+  static uint32_t now(void *paClock) { return ((struct GNSS_virtual_clock *)paClock)->nowMs; };
+  static void     sleep(uint32_t paMs, void *paClock) { ((struct GNSS_virtual_clock *)paClock)->nowMs += paMs; };
+};
+
+// the state of the non-blocking processing (see GNSSCollector::process)
+// it is allocated with the first call of the non-blocking methods, so it takes no RAM space if you use collectData() only
+struct GNSS_stream_state {
+  char         line[MAXMESSAGELENGTH]; // the sentence being received
+  NMEA_index_t lineLength;
+  uint32_t     lastByteTime;           // the time of the last received byte [ms]
+  bool         sequenceStarted;        // the first break between the packs of messages has been detected
+  bool         haveData;               // at least one sentence of the current epoch has been collected
+  bool         clearPending;           // the epoch has been completed - the storage will be cleared with the first sentence of the next epoch
+};
+
 class GNSSCollector {
 private:
   // the main GNSS data storage:
@@ -272,26 +436,38 @@ private:
   int8_t (*read_callback)(void);
   int8_t (*atCustomParser)(const struct NMEA_fields *paSlices);
   
+  struct sentence_callback_item {
+    GNSS_sentence_callback callback;
+    void *userData;
+  } atSentenceCallbacks[MSG_MAX];   // indexed by the MSG_xxx message types
+  GNSS_epoch_callback atEpochCallback;
+  void *atEpochCallbackUserData;
+  GNSS_raw_callback atRawCallback;
+  void *atRawCallbackUserData;
+  GNSS_line_callback atLineCallback;
+  void *atLineCallbackUserData;
+  GNSS_clock_now   atClockNow;      // NULL - the platform clock
+  GNSS_clock_sleep atClockSleep;    // NULL - the platform delay
+  void            *atClockUserData;
+  
   // processing data storage:
   struct NMEA_parsers_table {
-    const char *header; // NMEA header for parser function
+    char header[4]; // NMEA header for parser function
     int8_t (GNSSCollector::*parser_method)(const struct NMEA_fields *);
-  } const NMEA_p_t[9] = {
-                          {"GSV", &GNSSCollector::GSV_parser},
-                          {"GSA", &GNSSCollector::GSA_parser},
-                          {"RMC", &GNSSCollector::RMC_parser},
-                          {"GGA", &GNSSCollector::GGA_parser},
-                          {"GLL", &GNSSCollector::GLL_parser},
-                          {"VTG", &GNSSCollector::VTG_parser},
-                          {"TXT", &GNSSCollector::TXT_parser},
-                          {"GBS", &GNSSCollector::GBS_parser},
-                          {"GST", &GNSSCollector::GST_parser}
-                        };
+    uint8_t msgType; // MSG_xxx index of the sentence callback (MSG_MAX - no callback)
+  };
+  static const struct NMEA_parsers_table NMEA_p_t[9]; // shared by all the instances (placed in the flash on AVR boards)
   uint8_t atMessagesBreakLength;   // the time we wait to check if the message pack from single timestamp is complete or not
+  struct GNSS_stream_state *atStreamState; // the non-blocking processing state (NULL until process(), poll() or feed() is called)
   
   // data processing methods:
-  int8_t check_and_slice_NMEA_message(const char *pa_single_line, struct NMEA_fields *paSlices);
   int8_t parse_NMEA_fields_for_particular_message(const struct NMEA_fields *paSlices);
+  int8_t process_single_line(const char *paLine, bool paCollect, bool paShowReceivedMessage, bool paShowCRNLVisible);
+  int8_t stream_state_check(uint32_t paNowMs);
+  void   stream_overflow_check(void);
+  void   stream_byte(char paByte, uint32_t paNowMs);
+  int8_t stream_break_check(uint32_t paNowMs);
+  void   clock_sleep(uint32_t paMs);
   
   // the particular parsers:
   int8_t RMC_parser(const struct NMEA_fields  *paSlices);
@@ -305,7 +481,11 @@ private:
   int8_t TXT_parser(const struct NMEA_fields  *paSlices) { SETCOLORCYAN DBG("                                   ... some info\r\n"); NOCOLOR; return(paSlices->cnt - paSlices->cnt);};
   
   // extra tools:
+#ifndef GNSS_MINIMAL_FOOTPRINT
   static inline void printTalkerName (const char *paTalker, bool paAlign);
+#else
+  static inline void printTalkerName (const char *paTalker, bool paAlign) {(void)paTalker; (void)paAlign;};
+#endif
   static inline uint8_t getSystemIDByTalker(const char *paTalker);
 
 public:
@@ -366,6 +546,41 @@ public:
   // You can use them to filter library operations to the messages you are interested in and save CPU time
   void setCustomParser (int8_t (*paParser)(const struct NMEA_fields *paSlices)) {this->atCustomParser = paParser;};
   
+  // The push model: the callback is called directly from the parser of the given sentence type (MSG_GSV, MSG_GSA, MSG_RMC, MSG_GGA, MSG_VTG,
+  // MSG_GLL, MSG_GBS or MSG_GST) as soon as the sentence is decoded, so you don't have to wait for the end of the epoch (e.g. to get the position
+  // from $xxGGA message). The callback is not called when the sentence is rejected by the parser or consumed by your custom parser.
+  // Give NULL callback to unsubscribe. Returns -1 for unknown message type.
+  int8_t setSentenceCallback(uint8_t paMsgType, GNSS_sentence_callback paCallback, void *paUserData = NULL);
+  inline void onGSV(GNSS_sentence_callback paCallback, void *paUserData = NULL) { this->setSentenceCallback(MSG_GSV, paCallback, paUserData); };
+  inline void onGSA(GNSS_sentence_callback paCallback, void *paUserData = NULL) { this->setSentenceCallback(MSG_GSA, paCallback, paUserData); };
+  inline void onRMC(GNSS_sentence_callback paCallback, void *paUserData = NULL) { this->setSentenceCallback(MSG_RMC, paCallback, paUserData); };
+  inline void onGGA(GNSS_sentence_callback paCallback, void *paUserData = NULL) { this->setSentenceCallback(MSG_GGA, paCallback, paUserData); };
+  inline void onVTG(GNSS_sentence_callback paCallback, void *paUserData = NULL) { this->setSentenceCallback(MSG_VTG, paCallback, paUserData); };
+  inline void onGLL(GNSS_sentence_callback paCallback, void *paUserData = NULL) { this->setSentenceCallback(MSG_GLL, paCallback, paUserData); };
+  inline void onGBS(GNSS_sentence_callback paCallback, void *paUserData = NULL) { this->setSentenceCallback(MSG_GBS, paCallback, paUserData); };
+  inline void onGST(GNSS_sentence_callback paCallback, void *paUserData = NULL) { this->setSentenceCallback(MSG_GST, paCallback, paUserData); };
+  
+  // The epoch callback is called when the whole pack of sentences with the single timestamp has been collected
+  // (just before collectData() returns). Give NULL callback to unsubscribe.
+  inline void setEpochCallback(GNSS_epoch_callback paCallback, void *paUserData = NULL) { this->atEpochCallback = paCallback; this->atEpochCallbackUserData = paUserData; };
+  inline void onEpoch(GNSS_epoch_callback paCallback, void *paUserData = NULL) { this->setEpochCallback(paCallback, paUserData); };
+  
+  // The raw data callback receives every byte read by collectData(), process() or feed() before it is parsed
+  // (collectData() and process() give the bytes one by one, feed() gives the parts of the buffer ending with the lines),
+  // so the line of the line callback is always the last line given to the raw data callback. Give NULL callback to unsubscribe.
+  inline void setRawCallback(GNSS_raw_callback paCallback, void *paUserData = NULL) { this->atRawCallback = paCallback; this->atRawCallbackUserData = paUserData; };
+  // The line callback receives every line received with its status (LINE_VALID, LINE_MALFORMED, LINE_CHECKSUM, LINE_TOO_LONG or LINE_REJECTED)
+  // - the lines received before the first break are given too. Give NULL callback to unsubscribe.
+  inline void setLineCallback(GNSS_line_callback paCallback, void *paUserData = NULL) { this->atLineCallback = paCallback; this->atLineCallbackUserData = paUserData; };
+  
+  // The UTC time of the epoch in milliseconds since 1970-01-01 (the date is taken from the $xxRMC sentence, so it is -1 when the date is unknown)
+  static int64_t getUnixTimeMs(const struct GNSS_data *paData);
+  // the same for the given date (year with the century, e.g. 2024) and time of the day in milliseconds (-1 for the incorrect date)
+  static int64_t getUnixTimeMs(uint16_t paYear, uint8_t paMonth, uint8_t paDay, uint32_t paMsOfDay);
+  // the signed position in degrees (the south latitude and the west longitude are negative)
+  static inline double getLatitude(const struct GNSS_data *paData)  { return (('S' == paData->lat_dir) ? -paData->lat : paData->lat); };
+  static inline double getLongitude(const struct GNSS_data *paData) { return (('W' == paData->lon_dir) ? -paData->lon : paData->lon); };
+  
   // the data access methods:
   inline const struct GNSS_data   *getGNSSData(void) {return ( &this->atDataStorage); }
   inline const struct GSV_manager *getGSVData(void) {return ( this->atGSVData); }
@@ -380,6 +595,44 @@ public:
   // this method refreshes the GNSS data structures, so it is necessary to call them every time you want to have actual GNSS data
   int8_t collectData(bool paShowReceivedMessage, bool paShowCRNLVisible);
   
+  // The non-blocking methods - they never sleep, so they can be used inside the external event loop (e.g. epoll, asio, Arduino loop()).
+  // The break between the packs of messages is detected with the time given by you (any monotonic clock in milliseconds,
+  // e.g. millis() on Arduino or CLOCK_MONOTONIC on linux). Call them often enough - at least once per the break time (see setBreakTime).
+  // They return 1 when the new epoch is ready (getGNSSData() and getGSVData() give its data until the first sentence of the next epoch is processed),
+  // 0 when the epoch is not ready yet or the negative value on error. The epoch callback is called for every completed epoch.
+  //
+  // process() reads all the bytes available with the callbacks given to the constructor (the negative value returned by
+  // the available_check_callback is returned as -5). If the callbacks are NULL, it only checks if the break has occured.
+  int8_t process(uint32_t paNowMs);
+  // poll() is the process() with the clock given with setClock() (the platform clock by default)
+  int8_t poll(void);
+  // feed() processes the bytes given by you (e.g. received from the socket) - the callbacks given to the constructor are not used.
+  // All the bytes are taken at the given time, so the break can be detected only before them: it returns 1 when the epoch
+  // has been completed by the break since the previous call, 0 otherwise (as process()). Use the epoch callback to get the data,
+  // because the given bytes may start the next epoch before feed() returns. Call feed(NULL, 0, now) to check for the break without the data.
+  int8_t feed(const char *paData, uint16_t paLength, uint32_t paNowMs);
+  
+  // the platform clock in milliseconds (millis() on Arduino, CLOCK_MONOTONIC on linux)
+  static uint32_t getPlatformTimeMs(void);
+  
+  // The clock used for the break detection by collectData() (sleep) and poll() (now) - e.g. the GNSS_virtual_clock to replay
+  // the recorded data faster than the real time with the same epochs as the live run. Give NULL to use the platform clock again.
+  inline void setClock(GNSS_clock_now paNow, GNSS_clock_sleep paSleep, void *paUserData = NULL) { this->atClockNow = paNow; this->atClockSleep = paSleep; this->atClockUserData = paUserData; };
+  // the time of the clock set with setClock() (the platform clock by default)
+  inline uint32_t getTimeMs(void) { return ((NULL != this->atClockNow) ? this->atClockNow(this->atClockUserData) : GNSSCollector::getPlatformTimeMs()); };
+  
+  // The line level methods - the epoch boundaries are decided by you (e.g. by the UTC time of the sentences in the recorded log,
+  // see GNSSEpochSplitter in GNSSReplay.h), so no break time and no data source callbacks are used.
+  //
+  // this method checks the integrity of the single NMEA sentence (terminated with "\r\n" and '\0') and slices it into the fields
+  // it returns 0 on success, -1 for incorrectly formatted sentence or -2 for inconsistent check sum
+  static int8_t check_and_slice_NMEA_message(const char *paSingleLine, struct NMEA_fields *paSlices);
+  // this method parses the sliced sentence into the data storage (your custom parser and the sentence callbacks are called as usual)
+  // it returns 1 if the sentence data has been collected, 0 otherwise
+  int8_t parseSentence(const struct NMEA_fields *paSlices);
+  // this method clears the data storage (and the GSV data storage if turned on) before the next epoch
+  void   clearData(void);
+  
   /****************************************************************************************************
    ****************************************************************************************************
    ****************************************************************************************************
@@ -392,6 +645,7 @@ public:
   
   // this function prints the slices from single message 
   static inline void printFieldsStorage(const struct NMEA_fields *paSlices) { // for debug purpose only
+#ifndef GNSS_MINIMAL_FOOTPRINT
     int8_t i;
     
     if (NULL == paSlices) {
@@ -405,10 +659,13 @@ public:
       DBG("] ("); DBGV(GNSSCollector::get_field(paSlices,i)); DBG(")\r\n");
     }
     DBG("============================= FIELDS END =========================================================\r\n")
-    
+#else
+    (void)paSlices;
+#endif
     return;
   }
   
+#ifndef GNSS_MINIMAL_FOOTPRINT
   // this function prints the whole collected data from all parsed messages except of the GSV messages
   void printGNSSData(bool);
   
@@ -416,6 +673,10 @@ public:
   // To collect GSV data, you have to turn on the parser for this messages disabled by default
   // the GSVSwitch(bool turnOn) function is intended for this purpose
   void printGSVData(bool);
+#else
+  void printGNSSData(bool paShowDebugInfo = false) {(void)paShowDebugInfo;};
+  void printGSVData(bool paShowDebugInfo = false)  {(void)paShowDebugInfo;};
+#endif
 };
 
 // this function can be used to prepare NMEA format message to be send to the receiver.
@@ -427,25 +688,25 @@ public:
 // then you can put the message to the receiver to change some settings on them
 int8_t completeTheNMEAMessage(char *paMessage);
 
-  const struct talkerID_Names {
-    const char talker[3];
-    const char name[8];
-    const uint8_t systemID;
-  } talkerNames [] = { {"??","    ???", 0}, /* some unrecognized message (e.g. Teseo-LIV3F has the $PSTMCPU message)*/
-                       {"GP","    GPS", 1}, /* USA - Global Positioning System */
-                       {"GL","GLONASS", 2}, /* Ru - Глобальная навигационная спутниковая система */
-                       {"GA","Galileo", 3}, /* EU system - more precise than GLONASS or GPS */
-                       {"BD"," BeiDou", 4}, /* BeiDou (BDS); Chinese: 北斗卫星导航系统; pinyin: Běidǒu Wèixīng Dǎoháng Xìtǒng */
-                       {"GB"," BeiDou", 4}, /* BeiDou (BDS); Chinese: 北斗卫星导航系统; pinyin: Běidǒu Wèixīng Dǎoháng Xìtǒng */
-                       {"QZ","   QZSS", 5}, /* QZSS (Quasi-Zenith Satellite System), Japan */ /* QZSS regional GPS augmentation system (Japan) */
-                       {"GQ","   QZSS", 5}, /* QZSS (Quasi-Zenith Satellite System), Japan */
-                       {"GI","  NavIC", 6}, /* Indian Regional Navigation Satellite System (IRNSS) */
-                       {"PQ","QZSS-QQ", 5}, /* QZSS (Quasi-Zenith Satellite System), Japan */  /* QZSS (Quectel Quirk) */
-                       {"GN","   GNSS", 0} }; /* Multi constellation - has to be at the end of the table due to presentation layer */
+struct talkerID_Names {
+  char talker[3];
+#ifndef GNSS_MINIMAL_FOOTPRINT
+  char name[8];
+#endif
+  uint8_t systemID;
+};
+
+// the talker ID table (placed in the flash on AVR boards - use GNSS_READ_TABLE to read the single item)
+// the names are not available in the minimal footprint build mode
+#define TALKER_NAMES_MAX 11
+extern const struct talkerID_Names talkerNames[TALKER_NAMES_MAX];
 
 /* there are 6 constellations: GPS, GLONASS, Galileo, BeiDou, QZSS, NavIC */
 #define MAX_SYSTEM_ID 6
 
-extern const char *GNSSsignalIDNames[MAX_SYSTEM_ID + 1][16];
+#ifndef GNSS_MINIMAL_FOOTPRINT
+// the signal names by system ID and signal ID (placed in the flash on AVR boards)
+extern const char GNSSsignalIDNames[MAX_SYSTEM_ID + 1][16][12];
+#endif
 
 #endif